@@ -0,0 +1,131 @@
+/**
+ * @file sync_benchmark.cpp
+ * @brief Stand-alone sync benchmark: synthetic scenarios and offsets.csv corpora
+ */
+
+#include "sync_benchmark.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+    void printUsage(const char* programName) {
+        std::cout << "Usage: " << programName << " [options]\n\n"
+                  << "Options:\n"
+                  << "  --corpus DIR        Also run the pairs listed in DIR/offsets.csv\n"
+                  << "                      (file1,file2,offset[,driftPpm] per line)\n"
+                  << "  --no-synthetic      Skip the built-in synthetic scenarios\n"
+                  << "  --json FILE         Write the results as JSON\n"
+                  << "  --repeat N          Timed repetitions per measurement (default: 3)\n"
+                  << "  --tolerance SEC     Offset error counted as correct (default: 0.010)\n"
+                  << "  --quality LIST      Comma-separated: realtime,standard,high (default: all)\n"
+                  << "  --work-dir DIR      Where synthetic scenarios are rendered\n"
+                  << "  --keep-files        Keep the rendered scenarios\n"
+                  << "  -v, --verbose       Show the sync pipeline's own output\n"
+                  << "  -h, --help          Show this help message\n"
+                  << std::endl;
+    }
+
+    bool parseQualities(const std::string& list, std::vector<SyncQuality>& qualities) {
+        qualities.clear();
+        size_t start = 0;
+        while (start <= list.size()) {
+            const size_t end = std::min(list.find(',', start), list.size());
+            const std::string name = list.substr(start, end - start);
+            if (name == "realtime" || name == "0") {
+                qualities.push_back(SyncQuality::REAL_TIME);
+            } else if (name == "standard" || name == "1") {
+                qualities.push_back(SyncQuality::STANDARD);
+            } else if (name == "high" || name == "2") {
+                qualities.push_back(SyncQuality::HIGH_QUALITY);
+            } else {
+                return false;
+            }
+            start = end + 1;
+        }
+        return !qualities.empty();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* what) -> const char* {
+            if (i + 1 < argc) return argv[++i];
+            std::cerr << "❌ Error: " << arg << " requires " << what << std::endl;
+            return nullptr;
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if (arg == "--corpus") {
+            const char* dir = value("a directory");
+            if (!dir) return 1;
+            options.corpusDirectory = dir;
+        }
+        else if (arg == "--no-synthetic") {
+            options.synthetic = false;
+        }
+        else if (arg == "--json") {
+            const char* file = value("a file path");
+            if (!file) return 1;
+            options.jsonFile = file;
+        }
+        else if (arg == "--repeat") {
+            const char* count = value("a count");
+            if (!count) return 1;
+            int repetitions = std::atoi(count);
+            if (repetitions < 1) {
+                std::cerr << "❌ Error: --repeat must be at least 1" << std::endl;
+                return 1;
+            }
+            options.repetitions = static_cast<size_t>(repetitions);
+        }
+        else if (arg == "--tolerance") {
+            const char* seconds = value("seconds");
+            if (!seconds) return 1;
+            options.tolerance = std::atof(seconds);
+            if (options.tolerance <= 0.0) {
+                std::cerr << "❌ Error: --tolerance must be positive" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--quality") {
+            const char* list = value("a list");
+            if (!list) return 1;
+            if (!parseQualities(list, options.qualities)) {
+                std::cerr << "❌ Error: Invalid quality list. Use realtime, standard, high." << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--work-dir") {
+            const char* dir = value("a directory");
+            if (!dir) return 1;
+            options.workDirectory = dir;
+        }
+        else if (arg == "--keep-files") {
+            options.keepFiles = true;
+        }
+        else if (arg == "-v" || arg == "--verbose") {
+            options.verbose = true;
+        }
+        else {
+            std::cerr << "❌ Error: Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!options.synthetic && options.corpusDirectory.empty()) {
+        std::cerr << "❌ Error: --no-synthetic needs --corpus" << std::endl;
+        return 1;
+    }
+
+    SyncBenchmark benchmark(std::move(options));
+    return benchmark.run() ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file audio_decoder.h
+ * @brief In-process audio decoding via libavformat/libavcodec/libswresample
+ */
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <vector>
+#include <string>
+
+/**
+ * @brief Decodes a window of a media file's audio straight into mono float samples
+ *
+ * Replaces the former ffmpeg-to-/tmp round trip: the best audio stream is
+ * demuxed, decoded and resampled in-process into a caller-owned buffer that
+ * is sized once up front, so no child process or temporary file is involved.
+ * Uncompressed WAV/BWF files skip libav entirely and are read through a
+ * memory map by WavReader.
+ */
+class AudioDecoder {
+public:
+    /**
+     * @brief Receives consecutive blocks of decoded samples; return false to stop
+     */
+    using SampleSink = std::function<bool(const float* samples, size_t count)>;
+
+    AudioDecoder() = default;
+
+    /**
+     * @brief Decode [startTime, startTime + duration) of the best audio stream
+     * @param audioFile Audio or video container to read
+     * @param startTime Window start in seconds (relative to the container start)
+     * @param duration Window length in seconds
+     * @param sampleRate Output sample rate in Hz
+     * @param samples Destination buffer, resized to the number of decoded samples
+     * @return True if at least one sample was decoded
+     */
+    bool decode(const std::filesystem::path& audioFile,
+                double startTime,
+                double duration,
+                double sampleRate,
+                std::vector<float>& samples);
+
+    /**
+     * @brief Decode the same window as decode(), handing it over in blocks
+     *
+     * Memory stays bounded by the block size however long the window is, so
+     * multi-hour recordings can be analyzed without holding their samples.
+     * @param blockSamples Upper bound on the samples per sink call
+     * @param sink Called with each block in order
+     * @return True if at least one sample was delivered
+     */
+    bool decodeStream(const std::filesystem::path& audioFile,
+                      double startTime,
+                      double duration,
+                      double sampleRate,
+                      size_t blockSamples,
+                      const SampleSink& sink);
+
+    /**
+     * @brief Serve later decodes of a file from samples already in memory
+     *
+     * The single-demux pipeline decodes a video's camera audio while it
+     * spools the video and registers the result here, so sync analysis does
+     * not read the file again. Windows inside the registered range are
+     * sliced (and resampled when another rate is requested); anything else
+     * still decodes from the file. Thread-safe.
+     * @param audioFile File the samples were decoded from
+     * @param samples Mono samples from the container start
+     * @param sampleRate Rate of samples in Hz
+     * @param wholeFile True if samples reach the end of the file
+     */
+    static void preload(const std::filesystem::path& audioFile, std::vector<float> samples,
+                        double sampleRate, bool wholeFile);
+
+    /**
+     * @brief Drop samples registered by preload()
+     */
+    static void release(const std::filesystem::path& audioFile);
+
+    /**
+     * @brief Get description of the most recent decode failure
+     */
+    const std::string& getLastError() const { return lastError; }
+
+private:
+    /**
+     * @brief Fill samples from a preloaded entry if it covers the window
+     */
+    bool decodePreloaded(const std::filesystem::path& audioFile, double startTime,
+                         double duration, double sampleRate, std::vector<float>& samples);
+
+    /**
+     * @brief Decode through libav into samples, or through it in blocks when a sink is given
+     */
+    bool decodeFile(const std::filesystem::path& audioFile, double startTime, double duration,
+                    double sampleRate, std::vector<float>& samples, size_t blockSamples,
+                    const SampleSink* sink);
+
+    std::string lastError;
+};
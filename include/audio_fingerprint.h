@@ -0,0 +1,109 @@
+/**
+ * @file audio_fingerprint.h
+ * @brief Landmark (spectral peak pair) fingerprints and an inverted index for file matching
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace fftw {
+    class FFTProcessor;
+}
+
+/**
+ * @brief One peak-pair hash anchored at a spectrogram frame
+ */
+struct Landmark {
+    uint32_t hash;                    // Anchor bin, target bin and frame distance
+    uint32_t frame;                   // Anchor frame
+};
+
+/**
+ * @brief Best alignment of a query against one indexed file
+ */
+struct FingerprintMatch {
+    std::filesystem::path file;
+    size_t votes = 0;                 // Landmarks agreeing on the displacement
+    double displacement = 0.0;        // Seconds; file time minus query time of the same event
+};
+
+/**
+ * @brief Extracts Shazam-style landmarks from mono audio
+ *
+ * Audio is analyzed at a low fixed rate; local maxima of the log-power
+ * spectrogram are paired with a few later peaks in a target zone and each
+ * pair is hashed from its two frequencies and its time difference. Hashes
+ * do not depend on absolute time or level, so the same event recorded by
+ * the camera and by a lav recorder produces the same hashes.
+ * One instance per thread (it owns FFT scratch).
+ */
+class AudioFingerprinter {
+public:
+    static constexpr double SAMPLE_RATE = 8000.0;
+    static constexpr size_t FRAME_SIZE = 1024;
+    static constexpr size_t HOP_SIZE = 256;
+
+    AudioFingerprinter();
+    ~AudioFingerprinter();
+
+    /**
+     * @brief Landmarks of samples at SAMPLE_RATE, ordered by anchor frame
+     */
+    std::vector<Landmark> extract(const std::vector<float>& samples);
+
+    /**
+     * @brief Decode the head of a file and fingerprint it
+     * @return False if the file has no decodable audio
+     */
+    bool fingerprintFile(const std::filesystem::path& file, double seconds,
+                         std::vector<Landmark>& landmarks);
+
+    /**
+     * @brief Length of one landmark frame in seconds
+     */
+    static constexpr double frameSeconds() { return HOP_SIZE / SAMPLE_RATE; }
+
+private:
+    std::unique_ptr<fftw::FFTProcessor> fft;
+    std::vector<float> window;
+};
+
+/**
+ * @brief Inverted hash table from landmark hashes to (file, frame) postings
+ *
+ * Built once per batch from every candidate audio file; a query votes for
+ * (file, displacement) pairs in a single pass over its landmarks, which
+ * yields both the matching file and a coarse offset. Queries are const and
+ * may run concurrently once the index is built.
+ */
+class FingerprintIndex {
+public:
+    /**
+     * @brief Add a file's landmarks (not thread-safe)
+     */
+    void add(const std::filesystem::path& file, const std::vector<Landmark>& landmarks);
+
+    /**
+     * @brief Best displacement per file, most votes first
+     * @param landmarks Query landmarks
+     * @return Files that received any votes
+     */
+    std::vector<FingerprintMatch> query(const std::vector<Landmark>& landmarks) const;
+
+    size_t fileCount() const { return files.size(); }
+    size_t landmarkCount() const { return postingCount; }
+
+private:
+    struct Posting {
+        uint32_t file;
+        uint32_t frame;
+    };
+
+    std::unordered_map<uint32_t, std::vector<Posting>> table;
+    std::vector<std::filesystem::path> files;
+    size_t postingCount = 0;
+};
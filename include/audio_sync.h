@@ -10,25 +10,34 @@
 #include <complex>
 #include <map>
 #include <functional>
+#include <optional>
+#include <span>
+#include "dtw_engine.h"
+#include "fft_processor.h"
 
-// Forward declarations for optimization libraries
-namespace fftw {
-    class FFTProcessor;
-}
+// Forward declarations
+class FeatureCache;
+class MediaProbeCache;
+class FeatureExtractor;
 
 /**
  * @brief Audio feature extraction and analysis structures
  */
 struct AudioFeatures {
-    std::vector<float> mfcc;           // Mel-frequency cepstral coefficients
+    std::vector<float> mfcc;           // Mel-frequency cepstral coefficients, frames x mfccCoefficients (row major)
     std::vector<float> spectralCentroid; // Spectral centroid over time
     std::vector<float> energy;         // RMS energy envelope
     std::vector<float> zcr;           // Zero crossing rate
     std::vector<size_t> onsets;       // Onset detection points
+    std::vector<float> bandEnergy;     // Log-mel band energies, frames x bandCount (row major)
+    size_t bandCount;                  // Number of mel bands per bandEnergy frame
+    size_t mfccCoefficients;           // Number of cepstral coefficients per mfcc frame
+    std::vector<float> waveform;       // Head of the analyzed mono samples, for sample-accurate refinement
     double sampleRate;
+    size_t hopSize;                    // Samples per energy/zcr hop
     size_t frameCount;
     
-    AudioFeatures() : sampleRate(0.0), frameCount(0) {}
+    AudioFeatures() : bandCount(0), mfccCoefficients(0), sampleRate(0.0), hopSize(0), frameCount(0) {}
 };
 
 /**
@@ -38,10 +47,20 @@ struct SyncResult {
     double offset;                    // Offset in seconds (+ = audio2 starts after audio1)
     float confidence;                 // Confidence score 0.0-1.0
     std::string algorithm;            // Algorithm used for sync
-    std::vector<float> confidenceProfile; // Per-frame confidence
+    std::vector<float> confidenceProfile; // Per-window confidence (drift mode)
     double computationTime;           // Time taken for computation
     
-    SyncResult() : offset(0.0), confidence(0.0), computationTime(0.0) {}
+    // Clock drift of audio2 relative to audio1 in parts per million; offset
+    // then holds the value at the start of audio1 (drift mode only)
+    double driftPpm;
+    
+    // Execution budget decisions (filled by HybridAudioSync)
+    std::vector<std::string> algorithmsRun;     // In execution order
+    std::vector<std::string> algorithmsSkipped; // Pruned by the budget or cut by early exit
+    bool earlyExit;                   // Stopped once the combined confidence sufficed
+    
+    SyncResult() : offset(0.0), confidence(0.0), computationTime(0.0), driftPpm(0.0),
+                   earlyExit(false) {}
 };
 
 /**
@@ -79,6 +98,12 @@ public:
 
 /**
  * @brief Cross-correlation based synchronization (optimized for speech)
+ *
+ * Hierarchical: the energy envelope decimated by ENVELOPE_DECIMATION is
+ * correlated over the whole +-30 s search range, the hop-rate envelope
+ * refines that within one decimated step, and a short full-rate waveform
+ * correlation within +-1 hop gives a sub-sample offset. Every level uses
+ * FFTs sized to its own signals rather than to the full-resolution search.
  */
 class CrossCorrelationSync : public SyncAlgorithm {
 private:
@@ -86,6 +111,13 @@ private:
     size_t windowSize;
     float adaptiveThreshold;
     
+    // Correlation scratch, reused until the FFT length changes
+    fftw::AlignedBuffer<float> paddedScratch1;
+    fftw::AlignedBuffer<float> paddedScratch2;
+    fftw::AlignedBuffer<float> correlationScratch;
+    fftw::AlignedBuffer<std::complex<float>> spectrumScratch1;
+    fftw::AlignedBuffer<std::complex<float>> spectrumScratch2;
+    
 public:
     CrossCorrelationSync(size_t windowSize = 8192);
     ~CrossCorrelationSync();
@@ -96,10 +128,26 @@ public:
     float getExpectedAccuracy(AudioContent content) const override;
     
 private:
-    std::vector<float> computeNormalizedCrossCorrelation(
-        const std::vector<float>& signal1, 
-        const std::vector<float>& signal2);
-    void updateAdaptiveThreshold(const std::vector<float>& signal);
+    /**
+     * @brief Overlap-normalized correlation sum x1[n] x2[n + k] for k in [minLag, maxLag]
+     *
+     * Lags overlapping less than half of the shorter signal score 0.
+     * @return One value per lag, index 0 = minLag
+     */
+    std::vector<float> correlateLags(std::span<const float> signal1,
+                                     std::span<const float> signal2,
+                                     int minLag, int maxLag);
+    
+    /**
+     * @brief Sample-accurate lag from the waveforms near an envelope lag
+     * @param peakCorrelation Receives the normalized correlation at the refined lag
+     * @return false if the segment does not fit or correlates too weakly
+     */
+    bool refineWithWaveform(const AudioFeatures& features1, const AudioFeatures& features2,
+                            long envelopeLag, double& lagSamples, float& peakCorrelation);
+    
+    static std::vector<float> decimateEnvelope(const std::vector<float>& envelope, size_t factor);
+    static bool findPeak(const std::vector<float>& correlation, int firstLag, int& lag, float& peak);
 };
 
 /**
@@ -108,11 +156,14 @@ private:
 class DTWSync : public SyncAlgorithm {
 private:
     size_t maxWarpingWindow;
-    float slopeConstraint;
-    bool useMultiScale;
+    DTWEngine engine;
     
 public:
-    DTWSync(size_t maxWarpingWindow = 1000, float slopeConstraint = 2.0f);
+    /**
+     * @param maxWarpingWindow Largest deviation, in full-rate frames, of the path
+     *                         from its median diagonal (0 = unconstrained)
+     */
+    explicit DTWSync(size_t maxWarpingWindow = 1000);
     
     SyncResult synchronize(const AudioFeatures& features1, 
                          const AudioFeatures& features2) override;
@@ -120,11 +171,6 @@ public:
     float getExpectedAccuracy(AudioContent content) const override;
     
 private:
-    std::vector<std::vector<float>> computeDTWMatrix(
-        const std::vector<float>& features1,
-        const std::vector<float>& features2);
-    std::vector<std::pair<size_t, size_t>> traceback(
-        const std::vector<std::vector<float>>& dtwMatrix);
     SyncResult multiScaleDTW(const AudioFeatures& features1, 
                            const AudioFeatures& features2);
 };
@@ -147,21 +193,39 @@ public:
     
 private:
     std::vector<size_t> detectOnsets(const std::vector<float>& spectralFlux);
+    
+    /**
+     * @brief Offset in samples (t2 - t1) that lines up the most onsets
+     *
+     * All onset pairs within the search range vote in an offset histogram;
+     * the strongest bins are rescored with a tolerance-aware merge.
+     * @param support Receives the number of onsets matched at that offset
+     */
     double alignOnsets(const std::vector<size_t>& onsets1, 
-                      const std::vector<size_t>& onsets2);
+                      const std::vector<size_t>& onsets2,
+                      size_t& support);
 };
 
 /**
  * @brief Spectral correlation for music and tonal content
+ *
+ * Lags are counted in band frames of the features' own hop; inputs whose
+ * hops or sample rates differ are rejected.
  */
 class SpectralCorrelationSync : public SyncAlgorithm {
 private:
     size_t fftSize;
-    size_t hopSize;
     std::unique_ptr<fftw::FFTProcessor> fftProcessor;
     
+    // Per-band correlation scratch, reused until the FFT length changes
+    fftw::AlignedBuffer<float> bandScratch1;
+    fftw::AlignedBuffer<float> bandScratch2;
+    fftw::AlignedBuffer<std::complex<float>> spectrumScratch1;
+    fftw::AlignedBuffer<std::complex<float>> spectrumScratch2;
+    fftw::AlignedBuffer<std::complex<float>> crossSpectrum;
+    
 public:
-    SpectralCorrelationSync(size_t fftSize = 2048, size_t hopSize = 512);
+    explicit SpectralCorrelationSync(size_t fftSize = 2048);
     ~SpectralCorrelationSync();
     
     SyncResult synchronize(const AudioFeatures& features1, 
@@ -170,9 +234,20 @@ public:
     float getExpectedAccuracy(AudioContent content) const override;
     
 private:
-    std::vector<std::vector<float>> computeSpectrograms(const std::vector<float>& audio);
-    float computeSpectralSimilarity(const std::vector<std::vector<float>>& spec1,
-                                   const std::vector<std::vector<float>>& spec2,
+    /**
+     * @brief Sum of per-band cross-correlations, computed in the frequency domain
+     * @return Circular correlation; lag L >= 0 at index L, lag -L at index size-L
+     */
+    std::vector<float> computeBandCrossCorrelation(const AudioFeatures& features1,
+                                                   const AudioFeatures& features2);
+    
+    /**
+     * @brief Pearson similarity of two band-energy matrices at a frame offset
+     * @param offset Frame lag of spec2 relative to spec1
+     */
+    float computeSpectralSimilarity(const std::vector<float>& spec1,
+                                   const std::vector<float>& spec2,
+                                   size_t bandCount,
                                    int offset);
 };
 
@@ -208,10 +283,14 @@ public:
     
     /**
      * @brief Find optimal sync offset using hybrid approach
+     * @param offsetHint Coarse offset (same convention as SyncResult::offset),
+     *                   e.g. from fingerprint matching; the search is centred
+     *                   on it and may then resolve offsets beyond the usual range
      */
     SyncResult findOptimalSync(const std::filesystem::path& audioFile1,
                               const std::filesystem::path& audioFile2,
-                              SyncQuality quality = SyncQuality::STANDARD);
+                              SyncQuality quality = SyncQuality::STANDARD,
+                              std::optional<double> offsetHint = std::nullopt);
     
     /**
      * @brief Extract features from audio file
@@ -236,7 +315,59 @@ public:
     void setVerbose(bool verbose);
     
     /**
-     * @brief Get performance statistics
+     * @brief Seconds of audio decoded and analyzed per file by findOptimalSync
+     *
+     * The search window in the second file spends the whole budget; the
+     * reference window in the first file is narrower by twice the search
+     * margin so every offset within the margin keeps full overlap.
+     */
+    void setAnalysisBudget(double seconds);
+    
+    /**
+     * @brief Leading seconds of the first file the analysis window reads
+     *
+     * Covers the fallback analysis window (see setAnalysisBudget()); a caller
+     * that demuxes the file anyway can decode this much once and preload it
+     * (AudioDecoder::preload). The low-rate envelope pre-pass and windows the
+     * pre-pass or an offset hint move further in decode the file themselves.
+     */
+    double headSeconds() const;
+    
+    /**
+     * @brief Rate samples are decoded at for feature extraction
+     */
+    static double analysisSampleRate();
+    
+    /**
+     * @brief Fit offset plus clock drift over the whole take
+     *
+     * Intended for long recordings from independent clocks (e.g. a lav
+     * recorder against the camera). Costs one short analysis per window.
+     */
+    void setDriftMode(bool enable);
+    
+    /**
+     * @brief Reuse features and envelopes from an on-disk cache (nullptr disables)
+     *
+     * The cache may be shared by every engine of a batch.
+     */
+    void setFeatureCache(std::shared_ptr<FeatureCache> cache);
+    
+    /**
+     * @brief Read file durations from a probe cache (nullptr probes directly)
+     *
+     * Pass the transcoder's cache so drift estimation reuses its probes.
+     */
+    void setProbeCache(std::shared_ptr<MediaProbeCache> cache);
+    
+    /**
+     * @brief Stage timings of the last findOptimalSync
+     *
+     * Keys: analysis_window_seconds, feature_extraction_seconds,
+     * algorithms_seconds, combine_seconds, drift_seconds (drift mode),
+     * <Algorithm>_seconds / _offset / _confidence for every algorithm that
+     * ran (offsets in file time), and scratch usage. The same stages also
+     * feed the process-wide metrics::Registry histograms.
      */
     std::map<std::string, double> getPerformanceStats() const;
 
@@ -244,11 +375,38 @@ private:
     std::vector<std::unique_ptr<SyncAlgorithm>> algorithms;
     std::map<AudioContent, std::vector<std::pair<size_t, float>>> algorithmWeights;
     SyncQuality currentQuality;
+    double analysisBudget;
+    bool driftMode;
+    std::shared_ptr<FeatureCache> featureCache;
+    std::shared_ptr<MediaProbeCache> probeCache;
+    
+    /**
+     * @brief How much of the algorithm set a quality mode may spend
+     *
+     * Algorithms are ranked by their weight for the detected content type and
+     * run in stages of stageSize concurrent tasks, highest weight first.
+     */
+    struct ExecutionBudget {
+        size_t maxAlgorithms;         // Highest-ranked algorithms considered
+        float minWeight;              // Algorithms weighted below this are pruned
+        size_t stageSize;             // Algorithms run concurrently per stage
+        float earlyExitConfidence;    // Stop after a stage once reached (> 1 disables)
+    };
+    ExecutionBudget budget;
     bool verbose;
     mutable std::map<std::string, double> performanceStats;
     
-    // Feature extraction components
-    std::unique_ptr<fftw::FFTProcessor> mfccProcessor;
+    // Feature extraction components; the second extractor lets both files
+    // be analyzed concurrently without sharing FFT scratch
+    std::unique_ptr<FeatureExtractor> featureExtractor;
+    std::unique_ptr<FeatureExtractor> pairedExtractor;
+    
+    /**
+     * @brief Stream a window of a file through one extractor, block by block
+     */
+    AudioFeatures extractFeaturesWith(FeatureExtractor& extractor,
+                                      const std::filesystem::path& audioFile,
+                                      double startTime, double duration);
     
     /**
      * @brief Initialize algorithm weights for different content types
@@ -269,65 +427,50 @@ private:
                                const AudioFeatures& features2);
     
     /**
-     * @brief Extract MFCC features from audio samples
-     */
-    std::vector<float> extractMFCC(const std::vector<float>& audio,
-                                  double sampleRate,
-                                  size_t numCoeffs = 13);
-    
-    /**
-     * @brief Extract spectral centroid
+     * @brief Where findOptimalSync decodes each file
      */
-    std::vector<float> extractSpectralCentroid(const std::vector<float>& audio,
-                                              double sampleRate);
+    struct AnalysisWindow {
+        double start1 = 0.0;          // Reference window in file 1
+        double duration1 = 0.0;
+        double start2 = 0.0;          // Search window in file 2, widened by the margin
+        double duration2 = 0.0;
+        bool selected = false;        // False when falling back to the file start
+    };
     
     /**
-     * @brief Detect onsets using spectral flux
+     * @brief Pick the most informative window under the analysis budget
+     *
+     * A coarse low-rate decode of both files yields energy envelopes; the
+     * window with the most active, changing blocks in file 1 whose widened
+     * counterpart in file 2 is also active wins. Long silent slates at the
+     * head of a take are skipped this way. With an offset hint the window in
+     * file 2 is shifted onto the hinted counterpart and only a narrow margin
+     * is searched, which leaves more of the budget to the reference window.
      */
-    std::vector<size_t> detectOnsets(const std::vector<float>& audio,
-                                    double sampleRate);
+    AnalysisWindow calculateAnalysisWindow(
+        const std::filesystem::path& audioFile1,
+        const std::filesystem::path& audioFile2,
+        std::optional<double> offsetHint);
     
     /**
-     * @brief Calculate analysis window for optimal performance
+     * @brief Refine a single-offset result into an offset + drift model
+     *
+     * Short windows spread across the take are analyzed in parallel around
+     * the coarse offset. A Theil-Sen fit over their displacements, refined
+     * by least squares on the inliers, gives the offset at the start of
+     * file 1 and the drift in ppm. Leaves the result untouched when the
+     * take is too short or the windows disagree.
      */
-    std::pair<double, double> calculateAnalysisWindow(
-        const std::filesystem::path& audioFile1,
-        const std::filesystem::path& audioFile2);
+    void estimateDrift(const std::filesystem::path& audioFile1,
+                       const std::filesystem::path& audioFile2,
+                       SyncResult& result);
     
     /**
-     * @brief Load audio samples from file
+     * @brief Block energies in dB from a coarse decode of the file's head
      */
-    std::vector<float> loadAudioSamples(const std::filesystem::path& audioFile,
-                                       double startTime,
-                                       double duration,
-                                       double& sampleRate);
+    std::vector<float> computeEnergyEnvelope(const std::filesystem::path& audioFile);
 };
 
-/**
- * @brief Optimized FFT processor wrapper
- */
-namespace fftw {
-    class FFTProcessor {
-    public:
-        FFTProcessor(size_t size);
-        ~FFTProcessor();
-        
-        void forward(const std::vector<float>& input,
-                    std::vector<std::complex<float>>& output);
-        void inverse(const std::vector<std::complex<float>>& input,
-                    std::vector<float>& output);
-        
-        size_t getSize() const { return size; }
-        
-    private:
-        size_t size;
-        void* plan_forward;
-        void* plan_inverse;
-        float* input_buffer;
-        std::complex<float>* output_buffer;
-    };
-}
-
 /**
  * @brief Voice Activity Detection for speech processing
  */
@@ -0,0 +1,86 @@
+/**
+ * @file av_utils.h
+ * @brief RAII wrappers and helpers shared by the in-process libav code paths
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+#include <libswscale/swscale.h>
+}
+
+namespace av {
+    struct InputFormatDeleter {
+        void operator()(AVFormatContext* ctx) const { avformat_close_input(&ctx); }
+    };
+    struct CodecContextDeleter {
+        void operator()(AVCodecContext* ctx) const { avcodec_free_context(&ctx); }
+    };
+    struct FrameDeleter {
+        void operator()(AVFrame* frame) const { av_frame_free(&frame); }
+    };
+    struct PacketDeleter {
+        void operator()(AVPacket* packet) const { av_packet_free(&packet); }
+    };
+    struct ResamplerDeleter {
+        void operator()(SwrContext* swr) const { swr_free(&swr); }
+    };
+    struct ScalerDeleter {
+        void operator()(SwsContext* sws) const { sws_freeContext(sws); }
+    };
+    struct OutputFormatDeleter {
+        void operator()(AVFormatContext* ctx) const {
+            if (ctx->oformat && !(ctx->oformat->flags & AVFMT_NOFILE)) {
+                avio_closep(&ctx->pb);
+            }
+            avformat_free_context(ctx);
+        }
+    };
+
+    using InputFormatPtr = std::unique_ptr<AVFormatContext, InputFormatDeleter>;
+    using CodecContextPtr = std::unique_ptr<AVCodecContext, CodecContextDeleter>;
+    using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+    using PacketPtr = std::unique_ptr<AVPacket, PacketDeleter>;
+    using ResamplerPtr = std::unique_ptr<SwrContext, ResamplerDeleter>;
+    using ScalerPtr = std::unique_ptr<SwsContext, ScalerDeleter>;
+    using OutputFormatPtr = std::unique_ptr<AVFormatContext, OutputFormatDeleter>;
+
+    /**
+     * @brief Human readable text for a libav error code
+     */
+    inline std::string errorString(int code) {
+        char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+        av_strerror(code, buffer, sizeof(buffer));
+        return buffer;
+    }
+
+    /**
+     * @brief Open an input file and read its stream info
+     * @param path File to open
+     * @param error Receives the failure reason
+     * @return Owned format context, or nullptr on failure
+     */
+    inline InputFormatPtr openInput(const std::string& path, std::string& error) {
+        AVFormatContext* raw = nullptr;
+        int ret = avformat_open_input(&raw, path.c_str(), nullptr, nullptr);
+        if (ret < 0) {
+            error = "cannot open " + path + ": " + errorString(ret);
+            return nullptr;
+        }
+        InputFormatPtr format(raw);
+
+        ret = avformat_find_stream_info(format.get(), nullptr);
+        if (ret < 0) {
+            error = "cannot read stream info of " + path + ": " + errorString(ret);
+            return nullptr;
+        }
+        return format;
+    }
+}
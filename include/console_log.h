@@ -0,0 +1,69 @@
+/**
+ * @file console_log.h
+ * @brief Per-thread console capture so concurrent jobs print readable blocks
+ */
+#pragma once
+
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace console {
+    inline std::mutex& outputMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    inline thread_local std::ostringstream* activeCapture = nullptr;
+
+    /**
+     * @brief Stream for progress output: the thread's capture buffer if one is active
+     */
+    inline std::ostream& out() {
+        return activeCapture ? static_cast<std::ostream&>(*activeCapture) : std::cout;
+    }
+
+    /**
+     * @brief Collects everything written to out() on this thread and prints it
+     *        as one uninterrupted block when destroyed
+     */
+    class ScopedCapture {
+    public:
+        ScopedCapture() : previous(activeCapture) { activeCapture = &buffer; }
+
+        ~ScopedCapture() {
+            activeCapture = previous;
+            const std::string text = buffer.str();
+            if (!text.empty()) {
+                std::lock_guard<std::mutex> lock(outputMutex());
+                std::cout << text << std::flush;
+            }
+        }
+
+        ScopedCapture(const ScopedCapture&) = delete;
+        ScopedCapture& operator=(const ScopedCapture&) = delete;
+
+    private:
+        std::ostringstream buffer;
+        std::ostringstream* previous;
+    };
+
+    /**
+     * @brief Collects out() of a helper task so the thread that owns the job
+     *        can append it to its own block instead of it going to std::cout
+     */
+    class TaskCapture {
+    public:
+        TaskCapture() : previous(activeCapture) { activeCapture = &buffer; }
+        ~TaskCapture() { activeCapture = previous; }
+
+        TaskCapture(const TaskCapture&) = delete;
+        TaskCapture& operator=(const TaskCapture&) = delete;
+
+        std::string str() const { return buffer.str(); }
+
+    private:
+        std::ostringstream buffer;
+        std::ostringstream* previous;
+    };
+}
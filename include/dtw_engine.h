@@ -0,0 +1,116 @@
+/**
+ * @file dtw_engine.h
+ * @brief Subsequence dynamic time warping with O(window) cost storage
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Cache-friendly subsequence DTW engine
+ *
+ * Aligns all of seq1 (the query) to the best matching stretch of seq2: the
+ * path may start in any column of the first row and end in any column of
+ * the last row, so a short reference window can be located inside a longer
+ * search window. Only cells inside a per-row column window are evaluated.
+ * Accumulated costs live in two rolling rows, and the traceback keeps 2
+ * direction bits per evaluated cell in one flat buffer, so memory is
+ * O(len1 * window) bits instead of len1 * len2 floats.
+ */
+class DTWEngine {
+public:
+    using Path = std::vector<std::pair<size_t, size_t>>;
+
+    /**
+     * @brief Construct engine
+     * @param bandRadius Sakoe-Chiba half-width in frames around the coarse path's
+     *                   diagonal when refining (0 = unconstrained)
+     */
+    explicit DTWEngine(size_t bandRadius = 0);
+
+    void setBandRadius(size_t radius) { bandRadius = radius; }
+
+    /**
+     * @brief Subsequence DTW: all of seq1 against the best matching part of seq2
+     *
+     * Every column of every row is evaluated, since the diagonal the band
+     * would follow is what this search finds; use it at a coarse resolution
+     * and refine with computeSubsequencePathAround().
+     * @param seq1 Query, len1 frames of dim values each
+     * @param seq2 Search sequence, len2 frames of dim values each
+     * @param path Receives the path in forward order; it starts in row 0 and ends in the last row
+     * @param dim Feature dimension per frame
+     * @return Cost of the optimal path, or infinity if none exists
+     */
+    float computeSubsequencePath(std::span<const float> seq1, std::span<const float> seq2,
+                                 Path& path, size_t dim = 1);
+
+    /**
+     * @brief Refine a coarse subsequence path at the next finer resolution (FastDTW step)
+     *
+     * The coarse path is projected onto this resolution and only cells within
+     * radius of the projection are evaluated, so the cost is O((len1 + len2) * radius).
+     * With a band radius set, cells further than that from the coarse path's
+     * median diagonal (j - i) are excluded as well, which bounds the warping.
+     * The refined path keeps open ends on seq2.
+     * @param coarsePath Optimal path found at 1/factor resolution
+     * @param factor Resolution ratio between the coarse and this level
+     * @param radius Search radius around the projected path, in frames
+     * @param path Receives the refined path (empty if none fits the window)
+     * @return Cost of the refined path, or infinity if none fits
+     */
+    float computeSubsequencePathAround(std::span<const float> seq1, std::span<const float> seq2,
+                                       const Path& coarsePath, size_t factor, size_t radius,
+                                       Path& path, size_t dim = 1);
+
+    /**
+     * @brief Halve the frame rate by averaging consecutive frame pairs
+     * @param sequence Frames of dim values each
+     * @param resource Where the result is allocated (scratch arenas for pyramids)
+     * @return Sequence of ceil(frames / 2) frames
+     */
+    static std::pmr::vector<float> downsample(std::span<const float> sequence, size_t dim = 1,
+                                              std::pmr::memory_resource* resource =
+                                                  std::pmr::get_default_resource());
+
+    /**
+     * @brief Number of cells evaluated by the last call
+     */
+    size_t lastCellCount() const { return cellCount; }
+
+private:
+    /**
+     * @brief Build per-row column windows from a projected coarse path, within the band
+     */
+    bool projectWindows(size_t len1, size_t len2, const Path& coarsePath,
+                        size_t factor, size_t radius);
+
+    /**
+     * @brief Make windows monotone and connected, then compute row offsets
+     */
+    bool finalizeWindows(size_t len1, size_t len2);
+
+    float fill(std::span<const float> seq1, std::span<const float> seq2, size_t dim);
+
+    void tracebackPath(size_t len1, Path& path) const;
+
+    size_t bandRadius;
+    size_t endColumn = 0;             // Where the last path ended
+
+    // Per-row inclusive column window and offset of the row in the direction buffer
+    std::vector<size_t> rowStart;
+    std::vector<size_t> rowEnd;
+    std::vector<size_t> rowOffset;
+
+    // Rolling accumulated-cost rows, indexed relative to the row's window start
+    std::vector<float> previousRow;
+    std::vector<float> currentRow;
+
+    // 2 bits per evaluated cell: 0 = diagonal, 1 = vertical (i-1), 2 = horizontal (j-1)
+    std::vector<uint8_t> directions;
+    size_t cellCount = 0;
+};
@@ -0,0 +1,79 @@
+/**
+ * @file feature_cache.h
+ * @brief Persistent on-disk cache of extracted audio features
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+struct AudioFeatures;
+
+/**
+ * @brief Content-addressed, memory-mappable store of AudioFeatures
+ *
+ * One file per (source path, size, mtime, extractor configuration and
+ * algorithm version, analysis window). Re-running a batch after fixing a file name or a threshold then
+ * skips decoding and feature extraction for everything already analyzed.
+ *
+ * Entries are a fixed header followed by the feature arrays at 64-byte
+ * aligned offsets, so they map straight into memory. Writes go to a
+ * temporary file that is renamed into place, which keeps concurrent sync
+ * workers from ever seeing a partial entry. Safe to share between threads.
+ */
+class FeatureCache {
+public:
+    /**
+     * @brief Bumped whenever the feature definitions or the file layout change
+     */
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * @brief Open (and create if needed) a cache directory
+     */
+    explicit FeatureCache(std::filesystem::path directory);
+
+    /**
+     * @brief False if the directory could not be created
+     */
+    bool enabled() const { return usable; }
+
+    const std::filesystem::path& getDirectory() const { return directory; }
+
+    /**
+     * @brief Look up features of a file window
+     * @param source Analyzed media file
+     * @param startTime Window start in seconds
+     * @param duration Window length in seconds
+     * @param config Extractor description; different configs never share entries
+     * @param features Filled on a hit
+     * @return True on a hit
+     */
+    bool load(const std::filesystem::path& source, double startTime, double duration,
+              const std::string& config, AudioFeatures& features);
+
+    /**
+     * @brief Store features of a file window (failures are silently ignored)
+     */
+    void store(const std::filesystem::path& source, double startTime, double duration,
+               const std::string& config, const AudioFeatures& features);
+
+    size_t hits() const { return hitCount.load(); }
+    size_t misses() const { return missCount.load(); }
+
+private:
+    /**
+     * @brief Cache key, or 0 if the source cannot be stat'ed
+     */
+    static uint64_t makeKey(const std::filesystem::path& source, double startTime,
+                            double duration, const std::string& config);
+
+    std::filesystem::path entryPath(uint64_t key) const;
+
+    std::filesystem::path directory;
+    bool usable = false;
+    std::atomic<size_t> hitCount{0};
+    std::atomic<size_t> missCount{0};
+};
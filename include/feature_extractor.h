@@ -0,0 +1,175 @@
+/**
+ * @file feature_extractor.h
+ * @brief Single-pass extraction of all per-hop synchronization features
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct AudioFeatures;
+
+namespace fftw {
+    class FFTProcessor;
+}
+
+namespace spectral {
+    class SpectrogramAnalyzer;
+}
+
+/**
+ * @brief Features of consecutive hops produced by one streaming step
+ *
+ * Time-domain features are complete once a hop's samples are in; spectral
+ * features need the whole frame, so they trail by frameSize - hopSize samples.
+ */
+struct FeatureBlock {
+    size_t firstHop = 0;              // Hop index of energy[0] / zcr[0]
+    size_t firstFrame = 0;            // Frame index of spectralCentroid[0]
+    std::vector<float> energy;
+    std::vector<float> zcr;
+    std::vector<float> mfcc;          // Not mean normalized, frames x coefficients
+    std::vector<float> spectralCentroid;
+    std::vector<float> bandEnergy;    // Frames x bands
+    std::vector<size_t> onsets;       // Sample positions from the stream start
+
+    size_t hopCount() const { return energy.size(); }
+    size_t frameCount() const { return spectralCentroid.size(); }
+};
+
+/**
+ * @brief Fused, frame-oriented feature extractor
+ *
+ * Walks the sample buffer once, hop by hop. Each hop's samples and the
+ * analysis frame starting there are still in cache when the time-domain
+ * features (energy, zero crossings, onset envelope) and the spectral
+ * features (MFCC, centroid, log-mel bands) are computed.
+ *
+ * Onsets are peaks of the hop-to-hop rise in log energy that stand out
+ * (mean + k·σ) against the rises of the preceding half second. Working on
+ * log energy against a local baseline makes detection independent of the
+ * recording level, so a lav at -30 dBFS finds the same onsets as one at -6. Every output array
+ * of AudioFeatures is sized up front, so the sweep never reallocates.
+ *
+ * MFCCs are the DCT-II of the log-mel bands with cepstral mean normalization,
+ * which removes the constant offset a gain difference between two recorders
+ * puts on every frame.
+ *
+ * The same sweep runs incrementally: begin() then push() blocks of any size
+ * and finish(). Samples sit in a carry buffer of one frame plus one block;
+ * after each step only the overlap the next frame still needs is kept, so
+ * memory does not grow with the stream. extract() is a single push.
+ */
+class FeatureExtractor {
+public:
+    /**
+     * @brief Construct extractor
+     * @param frameSize Analysis frame / FFT length in samples
+     * @param hopSize Frame advance in samples (also the time-domain feature block)
+     * @param numBands Number of mel bands
+     * @param numCoeffs Number of MFCCs kept per frame
+     */
+    FeatureExtractor(size_t frameSize = 2048, size_t hopSize = 512, size_t numBands = 26,
+                     size_t numCoeffs = 13);
+    ~FeatureExtractor();
+
+    /**
+     * @brief Compute all features of a mono buffer
+     * @param audio Mono samples
+     * @param sampleRate Sample rate of audio
+     * @param features Output; existing capacity is reused
+     */
+    void extract(const std::vector<float>& audio, double sampleRate, AudioFeatures& features);
+
+    /**
+     * @brief Start a stream
+     * @param sampleRate Sample rate of the pushed audio
+     * @param blockSamples Largest block processed per step (bigger pushes are split)
+     */
+    void begin(double sampleRate, size_t blockSamples = DEFAULT_BLOCK_SAMPLES);
+
+    /**
+     * @brief Feed the next samples of the stream
+     * @param block Receives the hops and frames these samples completed
+     */
+    void push(const float* samples, size_t count, FeatureBlock& block);
+
+    /**
+     * @brief End the stream; block receives the trailing partial hop
+     */
+    void finish(FeatureBlock& block);
+
+    /**
+     * @brief Samples pushed since begin()
+     */
+    size_t streamedSamples() const { return streamed; }
+
+    /**
+     * @brief Append a block to features (blocks must arrive in stream order)
+     */
+    static void append(const FeatureBlock& block, AudioFeatures& features);
+
+    /**
+     * @brief Fill the header fields for the finished stream and normalize the MFCCs
+     */
+    void finalize(AudioFeatures& features) const;
+
+    static constexpr size_t DEFAULT_BLOCK_SAMPLES = 65536;
+
+    /**
+     * @brief Bumped whenever a change to the extraction code alters its output
+     *
+     * Part of every FeatureCache key, so persisted features computed by an
+     * older build are never served once the algorithm or its constants change.
+     */
+    static constexpr uint32_t ALGORITHM_VERSION = 2;
+
+    size_t getFrameSize() const { return frameSize; }
+    size_t getHopSize() const { return hopSize; }
+    size_t getNumBands() const { return numBands; }
+    size_t getNumCoefficients() const { return numCoeffs; }
+
+private:
+    /**
+     * @brief Rebuild sample-rate dependent tables when the rate changes
+     */
+    void configure(double sampleRate);
+
+    /**
+     * @brief Compute every hop and frame the carry buffer can complete
+     * @param final True once no more samples follow (partial hops are emitted)
+     */
+    void process(FeatureBlock& block, bool final);
+
+    size_t frameSize;
+    size_t hopSize;
+    size_t numBands;
+    size_t numCoeffs;
+    double configuredRate = 0.0;
+
+    // Orthonormal DCT-II, numCoeffs x numBands (row major)
+    std::vector<float> dctMatrix;
+
+    std::unique_ptr<fftw::FFTProcessor> fft;
+    std::unique_ptr<spectral::SpectrogramAnalyzer> analyzer;
+
+    // Stream state
+    std::vector<float> carry;         // Samples from carryStart on
+    size_t carryStart = 0;            // Stream position of carry[0]
+    size_t carryCapacity = 0;
+    size_t streamed = 0;
+    size_t nextHop = 0;
+    size_t nextFrame = 0;
+    // Onset detection: log-energy rise of hop nextHop-1 against the rises
+    // of the hops before it
+    float previousLogPower = 0.0f;    // Log mean square of hop nextHop-1
+    float currentPower = 0.0f;        // Mean square of hop nextHop-1
+    float previousRise = 0.0f;        // Rises into hops nextHop-2 and nextHop-1
+    float currentRise = 0.0f;
+    std::vector<float> riseHistory;   // Ring of the most recent rises before nextHop-1
+    size_t riseHistoryNext = 0;
+    size_t lastOnsetHop = 0;
+    bool onsetSeen = false;
+};
@@ -0,0 +1,253 @@
+/**
+ * @file fft_processor.h
+ * @brief Real FFT processor backed by a process-wide FFTW plan cache
+ */
+#pragma once
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fftw {
+    /**
+     * @brief SIMD-aligned allocation (fftwf_malloc when available)
+     */
+    void* alignedAllocate(size_t bytes);
+    void alignedFree(void* ptr);
+
+    /**
+     * @brief Move-only, SIMD-aligned, value-initialized array
+     *
+     * Hot loops keep these as members and resize them only when the transform
+     * length changes, so steady-state processing allocates nothing.
+     */
+    template <typename T>
+    class AlignedBuffer {
+    public:
+        AlignedBuffer() = default;
+        explicit AlignedBuffer(size_t count) { resize(count); }
+        ~AlignedBuffer() { alignedFree(ptr); }
+
+        AlignedBuffer(AlignedBuffer&& other) noexcept
+            : ptr(std::exchange(other.ptr, nullptr)), count(std::exchange(other.count, 0)) {}
+        AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+            std::swap(ptr, other.ptr);
+            std::swap(count, other.count);
+            return *this;
+        }
+        AlignedBuffer(const AlignedBuffer&) = delete;
+        AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+        /**
+         * @brief Reallocate to count zeroed elements (no-op if the size matches)
+         */
+        void resize(size_t newCount) {
+            if (newCount == count) return;
+            alignedFree(ptr);
+            ptr = newCount ? static_cast<T*>(alignedAllocate(newCount * sizeof(T))) : nullptr;
+            count = newCount;
+            std::fill(ptr, ptr + count, T{});
+        }
+
+        T* data() { return ptr; }
+        const T* data() const { return ptr; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        T& operator[](size_t i) { return ptr[i]; }
+        const T& operator[](size_t i) const { return ptr[i]; }
+
+        T* begin() { return ptr; }
+        T* end() { return ptr + count; }
+        const T* begin() const { return ptr; }
+        const T* end() const { return ptr + count; }
+
+        operator std::span<T>() { return {ptr, count}; }
+        operator std::span<const T>() const { return {ptr, count}; }
+
+    private:
+        T* ptr = nullptr;
+        size_t count = 0;
+    };
+
+    /**
+     * @brief FFTW planning rigor, traded against planning time
+     */
+    enum class PlannerMode {
+        ESTIMATE,      // Heuristic plans, no measurement
+        MEASURE,       // Time candidate algorithms once per size
+        PATIENT        // Wider search, best for long batches with wisdom
+    };
+
+    /**
+     * @brief Transform direction of a cached plan
+     */
+    enum class Direction {
+        FORWARD,       // Real to complex
+        INVERSE        // Complex to real
+    };
+
+    /**
+     * @brief Process-wide, thread-safe cache of FFTW plans
+     *
+     * The FFTW planner is not thread-safe, so every plan is created under one
+     * mutex and then shared. Processors execute the shared plan on their own
+     * buffers through FFTW's new-array execute functions, which may be called
+     * concurrently. Plans are planned on scratch arrays, so MEASURE/PATIENT
+     * planning never clobbers caller data.
+     */
+    class PlanCache {
+    public:
+        static PlanCache& instance();
+
+        /**
+         * @brief Planning rigor for plans created from now on
+         *
+         * Already cached plans are kept, so set this before any processing.
+         */
+        void setPlannerMode(PlannerMode mode);
+        PlannerMode getPlannerMode() const;
+
+        /**
+         * @brief Cached plan for a transform, planned on first use
+         * @param size Transform length
+         * @param direction Real-to-complex or complex-to-real
+         * @param inPlace Plan for input and output sharing one buffer
+         * @return Opaque fftwf_plan (nullptr when built without FFTW)
+         */
+        void* acquire(size_t size, Direction direction, bool inPlace = false);
+
+        /**
+         * @brief Import accumulated FFTW wisdom from a file
+         * @return true if the file existed and was accepted
+         */
+        bool loadWisdom(const std::string& path);
+
+        /**
+         * @brief Export accumulated FFTW wisdom to a file
+         * @return true on success
+         */
+        bool saveWisdom(const std::string& path) const;
+
+        /**
+         * @brief Number of cached plans
+         */
+        size_t size() const;
+
+        /**
+         * @brief Destroy all plans; only valid while no FFTProcessor is alive
+         */
+        void clear();
+
+        static const char* modeName(PlannerMode mode);
+
+        PlanCache(const PlanCache&) = delete;
+        PlanCache& operator=(const PlanCache&) = delete;
+
+    private:
+        PlanCache() = default;
+        ~PlanCache();
+
+        using Key = std::tuple<size_t, Direction, bool>;
+
+        mutable std::mutex mutex;
+        std::map<Key, void*> plans;
+        PlannerMode mode = PlannerMode::ESTIMATE;
+    };
+
+    /**
+     * @brief Real FFT of a fixed length
+     *
+     * The span overloads execute directly on caller memory when it is SIMD
+     * aligned (AlignedBuffer always is) and fall back to internal staging
+     * buffers otherwise. The vector overloads are kept for convenience and
+     * copy through the span path.
+     *
+     * Without FFTW, power-of-two sizes use a built-in iterative radix-2 real
+     * FFT; other sizes fall back to a direct DFT.
+     */
+    class FFTProcessor {
+    public:
+        FFTProcessor(size_t size);
+        ~FFTProcessor();
+
+        FFTProcessor(const FFTProcessor&) = delete;
+        FFTProcessor& operator=(const FFTProcessor&) = delete;
+
+        void forward(const std::vector<float>& input,
+                    std::vector<std::complex<float>>& output);
+        void inverse(const std::vector<std::complex<float>>& input,
+                    std::vector<float>& output);
+
+        /**
+         * @brief Real-to-complex transform on caller buffers
+         * @param input size real samples (left untouched)
+         * @param output size/2 + 1 bins
+         */
+        void forward(std::span<const float> input, std::span<std::complex<float>> output);
+
+        /**
+         * @brief Unnormalized complex-to-real transform on caller buffers
+         *
+         * The result is scaled by size; fold 1/size into the preceding spectral
+         * operation (see conjugateMultiply) instead of a separate pass.
+         * @param input size/2 + 1 bins, used as scratch and overwritten
+         * @param output size real samples
+         */
+        void inverse(std::span<std::complex<float>> input, std::span<float> output);
+
+        /**
+         * @brief In-place forward transform
+         * @param buffer 2 * (size/2 + 1) floats; samples in, interleaved bins out
+         */
+        void forwardInPlace(std::span<float> buffer);
+
+        /**
+         * @brief In-place unnormalized inverse transform
+         * @param buffer size/2 + 1 bins in; the first size floats hold the result
+         */
+        void inverseInPlace(std::span<std::complex<float>> buffer);
+
+        /**
+         * @brief out[k] = conj(a[k]) * b[k] * scale, the correlation kernel
+         */
+        static void conjugateMultiply(std::span<const std::complex<float>> a,
+                                      std::span<const std::complex<float>> b,
+                                      std::span<std::complex<float>> out,
+                                      float scale = 1.0f);
+
+        /**
+         * @brief out[k] += conj(a[k]) * b[k] * scale, for summing several correlations
+         */
+        static void conjugateMultiplyAccumulate(std::span<const std::complex<float>> a,
+                                                std::span<const std::complex<float>> b,
+                                                std::span<std::complex<float>> out,
+                                                float scale = 1.0f);
+
+        size_t getSize() const { return size; }
+        size_t getSpectrumSize() const { return size / 2 + 1; }
+
+    private:
+        struct BuiltinFFT;
+
+        void checkSizes(size_t realCount, size_t complexCount) const;
+        void ensureInPlacePlans();
+
+        size_t size;
+        void* plan_forward;            // Owned by PlanCache
+        void* plan_inverse;            // Owned by PlanCache
+        void* plan_forward_inplace;    // Planned on first in-place use
+        void* plan_inverse_inplace;
+        float* input_buffer;
+        std::complex<float>* output_buffer;
+        std::unique_ptr<BuiltinFFT> builtin;   // Only used without FFTW
+    };
+}
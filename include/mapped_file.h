@@ -0,0 +1,57 @@
+/**
+ * @file mapped_file.h
+ * @brief Read-only whole-file memory mapping
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief Read-only mapping of a whole file, unmapped on destruction
+ *
+ * data is nullptr if the file cannot be opened, is empty or cannot be mapped.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapping = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                                   MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                data = static_cast<const unsigned char*>(mapping);
+                size = static_cast<size_t>(info.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (data) ::munmap(const_cast<unsigned char*>(data), size);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Tell the kernel a range is about to be read sequentially
+     */
+    void willNeed(size_t offset, size_t length) const {
+        if (!data || offset >= size) return;
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t begin = offset / page * page;
+        ::madvise(const_cast<unsigned char*>(data) + begin,
+                  std::min(size, offset + length) - begin, MADV_WILLNEED);
+    }
+
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+};
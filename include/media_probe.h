@@ -0,0 +1,101 @@
+/**
+ * @file media_probe.h
+ * @brief In-process media probing with a per-file cache
+ */
+#pragma once
+
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Layout of a single elementary stream
+ */
+struct MediaStreamInfo {
+    enum class Type { VIDEO, AUDIO, OTHER };
+
+    Type type = Type::OTHER;
+    std::string codec;                // Codec short name (e.g. "pcm_s24le", "h264")
+    int sampleRate = 0;               // Audio only
+    int channels = 0;                 // Audio only
+    int width = 0;                    // Video only
+    int height = 0;                   // Video only
+};
+
+/**
+ * @brief Container level probe result
+ */
+struct MediaInfo {
+    bool valid = false;
+    double duration = 0.0;            // Seconds
+    std::string formatName;
+    std::vector<MediaStreamInfo> streams;
+    std::optional<double> startTimecode;  // Seconds since midnight (video timecode tag or BWF time reference)
+
+    size_t audioStreamCount() const;
+    size_t videoStreamCount() const;
+
+    /**
+     * @brief First audio stream, or nullptr if there is none
+     */
+    const MediaStreamInfo* primaryAudio() const;
+
+    /**
+     * @brief First video stream, or nullptr if there is none
+     */
+    const MediaStreamInfo* primaryVideo() const;
+};
+
+/**
+ * @brief Thread-safe probe cache keyed by path, modification time and size
+ *
+ * Every file is opened with libavformat at most once per (path, mtime, size);
+ * concurrent requests for the same file wait on the first probe instead of
+ * starting their own.
+ */
+class MediaProbeCache {
+public:
+    /**
+     * @brief Probe result for a file (probes on first use or after a change)
+     *
+     * If the probe throws, every caller waiting on it gets the exception and
+     * nothing is cached.
+     */
+    MediaInfo get(const std::filesystem::path& file);
+
+    /**
+     * @brief Probe a batch of files up front, e.g. right after a directory scan
+     * @param files Files to probe
+     * @param threads Number of concurrent probes
+     */
+    void prefetch(const std::vector<std::filesystem::path>& files, size_t threads = 1);
+
+    /**
+     * @brief Drop all cached entries
+     */
+    void clear();
+
+    /**
+     * @brief Number of cached files
+     */
+    size_t size() const;
+
+    /**
+     * @brief Probe a file directly, bypassing the cache
+     */
+    static MediaInfo probe(const std::filesystem::path& file);
+
+private:
+    struct Entry {
+        std::filesystem::file_time_type mtime;
+        std::uintmax_t size = 0;
+        std::shared_future<MediaInfo> info;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
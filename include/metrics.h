@@ -0,0 +1,138 @@
+/**
+ * @file metrics.h
+ * @brief Process-wide stage timings and counters with percentile summaries
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace metrics {
+
+    /**
+     * @brief Distribution of one stage's wall times, in seconds
+     */
+    struct StageSummary {
+        size_t count = 0;
+        double sum = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+    };
+
+    /**
+     * @brief Thread-safe registry of stage timings and event counters
+     *
+     * Stages are coarse units of work (one decode, one algorithm run, one
+     * transcode), so a mutex per sample costs nothing measurable. Count, sum,
+     * min and max are exact; percentiles come from a uniform reservoir of up
+     * to RESERVOIR_SIZE samples per stage, so memory stays bounded however
+     * long the process runs.
+     */
+    class Registry {
+    public:
+        static constexpr size_t RESERVOIR_SIZE = 4096;
+
+        static Registry& instance();
+
+        /**
+         * @brief Add one wall-time sample to a stage
+         */
+        void record(const std::string& stage, double seconds);
+
+        /**
+         * @brief Add to an event counter
+         */
+        void increment(const std::string& counter, double amount = 1.0);
+
+        std::map<std::string, StageSummary> stages() const;
+        std::map<std::string, double> counters() const;
+
+        /**
+         * @brief Drop every sample and counter
+         */
+        void reset();
+
+        std::string toJson() const;
+
+        /**
+         * @brief Prometheus text exposition format (node_exporter textfile collector)
+         */
+        std::string toPrometheus() const;
+
+        /**
+         * @brief Write the metrics atomically; ".prom" files get the Prometheus format, others JSON
+         */
+        bool writeFile(const std::filesystem::path& file) const;
+
+        /**
+         * @brief Table of stages by total time with p50/p95/p99
+         */
+        void printReport(std::ostream& out) const;
+
+    private:
+        struct Histogram {
+            size_t count = 0;
+            double sum = 0.0;
+            double min = 0.0;
+            double max = 0.0;
+            std::vector<double> reservoir;
+        };
+
+        Registry() = default;
+
+        mutable std::mutex mutex;
+        std::map<std::string, Histogram> histograms;
+        std::map<std::string, double> counterValues;
+        uint64_t randomState = 0x9E3779B97F4A7C15ULL;   // Reservoir replacement choices
+        std::chrono::system_clock::time_point startTime = std::chrono::system_clock::now();
+    };
+
+    /**
+     * @brief Records the lifetime of a scope as one sample of a stage
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(std::string stage)
+            : stage(std::move(stage)), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() { stop(); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        /**
+         * @brief Seconds since construction (or until stop())
+         */
+        double elapsed() const {
+            auto end = stopped ? stopTime : std::chrono::steady_clock::now();
+            return std::chrono::duration<double>(end - start).count();
+        }
+
+        /**
+         * @brief Record now instead of at scope exit; later calls do nothing
+         * @return The recorded time
+         */
+        double stop() {
+            if (!stopped) {
+                stopTime = std::chrono::steady_clock::now();
+                stopped = true;
+                Registry::instance().record(stage, elapsed());
+            }
+            return elapsed();
+        }
+
+    private:
+        std::string stage;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point stopTime;
+        bool stopped = false;
+    };
+}
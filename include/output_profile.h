@@ -0,0 +1,58 @@
+/**
+ * @file output_profile.h
+ * @brief Output video profiles: stream copy, ProRes flavours and hardware encoders
+ */
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief One way of encoding the video stream
+ */
+struct VideoEncoderSettings {
+    std::string encoder;              // libav encoder name (e.g. "prores_ks", "hevc_nvenc")
+    std::string pixelFormat;          // Frames are converted to this before encoding
+    std::string codecTag;             // Container tag override (e.g. "hvc1"); empty = muxer default
+    std::vector<std::pair<std::string, std::string>> options;   // Encoder options, in order
+};
+
+/**
+ * @brief How the output video is produced; audio is always 24-bit PCM
+ *
+ * A copy profile passes the camera's video packets through untouched, so a
+ * job only costs demuxing, audio decoding and muxing. Encoding profiles list
+ * one or more encoders and the first that opens on this machine is used,
+ * which lets a hardware profile try VideoToolbox, NVENC and QSV in turn.
+ */
+struct OutputProfile {
+    std::string name;
+    std::string description;
+    bool copyVideo = false;
+    std::vector<VideoEncoderSettings> encoders;
+
+    /**
+     * @brief The former fixed output: ProRes 422 (prores_ks profile 2)
+     */
+    static const OutputProfile& defaultProfile();
+
+    /**
+     * @brief Built-in profiles, default first
+     */
+    static const std::vector<OutputProfile>& all();
+
+    /**
+     * @brief Look a built-in profile up by name
+     * @return nullptr if there is none
+     */
+    static const OutputProfile* find(const std::string& name);
+
+    /**
+     * @brief Video options for the ffmpeg command line
+     *
+     * Picks the first encoder compiled into the linked libavcodec; whether a
+     * hardware encoder's device exists only shows once ffmpeg runs.
+     */
+    std::string ffmpegVideoArguments() const;
+};
@@ -0,0 +1,65 @@
+/**
+ * @file polyphase_resampler.h
+ * @brief Streaming rational-ratio polyphase resampler for mono float audio
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Converts between integer sample rates by a reduced ratio up/down
+ *
+ * One Kaiser-windowed sinc prototype is split into `up` phases; each output
+ * sample is a single dot product of one phase with the input it straddles,
+ * so no zero-stuffed intermediate signal exists. The cutoff follows the
+ * lower of the two rates, and the kernel widens with the decimation factor
+ * to keep the same transition band. Output sample j is centred on input
+ * time j * down / up of the first sample fed (no group delay).
+ * Stateful; one instance per stream.
+ */
+class PolyphaseResampler {
+public:
+    /**
+     * @param inputRate Input rate in Hz
+     * @param outputRate Output rate in Hz
+     */
+    PolyphaseResampler(int inputRate, int outputRate);
+
+    /**
+     * @brief False if the rates are invalid or their reduced ratio needs too many phases
+     */
+    bool valid() const { return up > 0; }
+
+    /**
+     * @brief Feed input; append every output sample it completes
+     */
+    void process(const float* input, size_t count, std::vector<float>& output);
+
+    /**
+     * @brief Emit the outputs still waiting on look-ahead (input treated as zero past the end)
+     */
+    void flush(std::vector<float>& output);
+
+    /**
+     * @brief Largest number of phases (reduced output rate) supported
+     */
+    static constexpr size_t MAX_PHASES = 4096;
+
+private:
+    /**
+     * @brief Produce outputs (up to index limit) whose input lies below `available`
+     */
+    void emit(std::vector<float>& output, int64_t available, uint64_t limit);
+
+    size_t up = 0;
+    size_t down = 0;
+    size_t taps = 0;                  // Coefficients per phase
+    std::vector<float> coefficients;  // Phase-major, taps per phase
+
+    std::vector<float> history;       // Input from absolute index historyStart (< 0 = leading zeros)
+    int64_t historyStart = 0;
+    uint64_t inputCount = 0;
+    uint64_t nextOutput = 0;
+};
@@ -0,0 +1,117 @@
+/**
+ * @file scratch_arena.h
+ * @brief Per-thread monotonic scratch memory for the sync pipeline
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+/**
+ * @brief Monotonic arena that temporaries of one sync job are carved from
+ *
+ * Every thread owns one arena (current()). Allocation is a pointer bump in a
+ * retained block; deallocation is a no-op and everything is released at
+ * once when the outermost Scope on the thread closes, typically at the end
+ * of a file. After a reset the retained block grows to the last job's peak,
+ * so from the second file on a job runs without touching malloc.
+ *
+ * Only locals may live in the arena: nothing allocated from it may outlive
+ * the Scope it was allocated in. Not thread-safe; use the calling thread's
+ * arena only.
+ */
+class ScratchArena : public std::pmr::memory_resource {
+public:
+    /**
+     * @brief Marks a unit of work; the outermost scope on a thread resets its arena on exit
+     *
+     * Scopes nest, so work a pool runs on a waiting thread keeps the caller's
+     * allocations intact.
+     */
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ScratchArena& arena() const { return owner; }
+
+    private:
+        ScratchArena& owner;
+    };
+
+    explicit ScratchArena(size_t initialBytes = DEFAULT_INITIAL_BYTES);
+    ~ScratchArena() override;
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    /**
+     * @brief Release everything and resize the retained block to the last peak
+     */
+    void reset();
+
+    /**
+     * @brief Bytes handed out since the last reset
+     */
+    size_t bytesInUse() const { return used; }
+
+    /**
+     * @brief Peak bytesInUse() since the last reset
+     */
+    size_t peakSinceReset() const { return resetPeak; }
+
+    /**
+     * @brief Peak bytesInUse() between two resets, over the arena's lifetime
+     */
+    size_t highWaterMark() const { return std::max(peak, resetPeak); }
+
+    /**
+     * @brief Size of the block kept across resets
+     */
+    size_t retainedBytes() const { return capacity; }
+
+    /**
+     * @brief Arena of the calling thread (created on first use)
+     */
+    static ScratchArena& current();
+
+    /**
+     * @brief Largest highWaterMark() of any arena in the process
+     */
+    static size_t processHighWaterMark() { return processPeak.load(std::memory_order_relaxed); }
+
+    static constexpr size_t DEFAULT_INITIAL_BYTES = size_t{1} << 20;
+
+    // Larger peaks are served from the upstream allocator again after a reset
+    static constexpr size_t MAX_RETAINED_BYTES = size_t{256} << 20;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::unique_ptr<std::byte[]> block;
+    size_t capacity = 0;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+    size_t used = 0;
+    size_t resetPeak = 0;
+    size_t peak = 0;
+    size_t depth = 0;                 // Open scopes on the owning thread
+
+    static std::atomic<size_t> processPeak;
+};
+
+/**
+ * @brief Vector whose storage comes from a ScratchArena
+ */
+template <typename T>
+using ScratchVector = std::pmr::vector<T>;
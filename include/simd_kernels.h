@@ -0,0 +1,76 @@
+/**
+ * @file simd_kernels.h
+ * @brief Runtime-dispatched SIMD kernels for the hot feature and correlation loops
+ */
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+namespace simd {
+    /**
+     * @brief One implementation of every kernel for a given instruction set
+     *
+     * Implementations are compiled with per-function target attributes, so one
+     * portable binary carries scalar, AVX2, AVX-512 (x86-64) and NEON (aarch64)
+     * variants; the best one the CPU supports is picked on first use.
+     */
+    struct KernelTable {
+        const char* name;
+
+        /** @brief Sum of x[i]^2 */
+        float (*sumSquares)(const float* x, size_t n);
+
+        /** @brief Number of i in [1, n) where x[i] and x[i-1] differ in sign (>= 0 vs < 0) */
+        size_t (*zeroCrossings)(const float* x, size_t n);
+
+        /** @brief Sum of a[i] * b[i] */
+        float (*dot)(const float* a, const float* b, size_t n);
+
+        /** @brief Sum of (a[i] - b[i])^2, the DTW local cost before the square root */
+        float (*squaredDistance)(const float* a, const float* b, size_t n);
+
+        /** @brief out[k] = conj(a[k]) * b[k] * scale */
+        void (*conjugateMultiply)(const std::complex<float>* a, const std::complex<float>* b,
+                                  std::complex<float>* out, size_t n, float scale);
+
+        /** @brief out[k] += conj(a[k]) * b[k] * scale */
+        void (*conjugateMultiplyAccumulate)(const std::complex<float>* a, const std::complex<float>* b,
+                                            std::complex<float>* out, size_t n, float scale);
+
+        /** @brief out[i] = in[i] * scale for n little-endian 16-bit samples (any alignment) */
+        void (*convertPcm16)(const uint8_t* in, float* out, size_t n, float scale);
+
+        /** @brief out[i] = in[i] * scale for n packed little-endian 24-bit samples */
+        void (*convertPcm24)(const uint8_t* in, float* out, size_t n, float scale);
+
+        /** @brief out[i] = in[i] * scale for n little-endian 32-bit integer samples (any alignment) */
+        void (*convertPcm32)(const uint8_t* in, float* out, size_t n, float scale);
+    };
+
+    /**
+     * @brief Kernel table selected for this CPU
+     *
+     * Selection happens once. Setting VT_SIMD=scalar|avx2|avx512|neon in the
+     * environment forces a variant (falling back to the best supported one if
+     * the CPU lacks it), which is handy for benchmarking and for bisecting
+     * numeric differences.
+     */
+    const KernelTable& kernels();
+
+    /**
+     * @brief Portable reference implementation
+     */
+    const KernelTable& scalarKernels();
+
+    /**
+     * @brief Kernel table by VT_SIMD name, or nullptr if unknown or unsupported by this CPU
+     */
+    const KernelTable* kernelsNamed(const char* name);
+
+    /**
+     * @brief Name of the active kernel table (e.g. "avx2")
+     */
+    inline const char* activeKernelName() { return kernels().name; }
+}
@@ -0,0 +1,106 @@
+/**
+ * @file spectral_features.h
+ * @brief Mel filterbank and short-time log-mel spectrogram analysis
+ */
+#pragma once
+
+#include "fft_processor.h"
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace spectral {
+    /**
+     * @brief Triangular mel-scale filterbank over a real FFT power spectrum
+     *
+     * Filters are stored sparsely (first bin + weights), so applying the bank
+     * touches each spectrum bin about twice regardless of the band count.
+     */
+    class MelFilterbank {
+    public:
+        /**
+         * @brief Build filterbank
+         * @param sampleRate Sample rate of the analyzed audio
+         * @param fftSize FFT length (spectrum has fftSize/2 + 1 bins)
+         * @param numBands Number of mel bands
+         * @param minFreq Lower edge of the first band in Hz
+         * @param maxFreq Upper edge of the last band in Hz (0 = Nyquist)
+         */
+        MelFilterbank(double sampleRate, size_t fftSize, size_t numBands,
+                      double minFreq = 0.0, double maxFreq = 0.0);
+
+        /**
+         * @brief Band energies of one power spectrum
+         * @param powerSpectrum fftSize/2 + 1 power values
+         * @param bandEnergies Output, numBands values
+         */
+        void apply(const float* powerSpectrum, float* bandEnergies) const;
+
+        size_t getNumBands() const { return filters.size(); }
+        size_t getFFTSize() const { return fftSize; }
+        double getSampleRate() const { return sampleRate; }
+
+        static double hzToMel(double hz);
+        static double melToHz(double mel);
+
+    private:
+        struct Filter {
+            size_t firstBin = 0;
+            std::vector<float> weights;
+        };
+
+        double sampleRate;
+        size_t fftSize;
+        std::vector<Filter> filters;
+    };
+
+    /**
+     * @brief Hann-windowed STFT reduced to log-mel band energies
+     */
+    class SpectrogramAnalyzer {
+    public:
+        /**
+         * @brief Construct analyzer
+         * @param sampleRate Sample rate of the analyzed audio
+         * @param fftSize Frame/FFT length
+         * @param hopSize Frame advance in samples
+         * @param numBands Number of mel bands
+         */
+        SpectrogramAnalyzer(double sampleRate, size_t fftSize, size_t hopSize, size_t numBands);
+
+        /**
+         * @brief Compute the log-mel spectrogram of an audio buffer
+         * @param audio Mono samples
+         * @param fft FFT processor of size fftSize
+         * @param output Receives a contiguous frames x numBands matrix (row major)
+         * @return Number of frames
+         */
+        size_t compute(const std::vector<float>& audio, fftw::FFTProcessor& fft,
+                       std::vector<float>& output);
+
+        /**
+         * @brief Log-mel energies of a single frame
+         * @param samples fftSize samples starting at the frame
+         * @param fft FFT processor of size fftSize
+         * @param bands Output, numBands values
+         */
+        void analyzeFrame(const float* samples, fftw::FFTProcessor& fft, float* bands);
+
+        /**
+         * @brief Power spectrum (fftSize/2 + 1 bins) of the last analyzed frame
+         */
+        const std::vector<float>& getPowerSpectrum() const { return power; }
+
+        const MelFilterbank& getFilterbank() const { return filterbank; }
+        size_t getHopSize() const { return hopSize; }
+
+    private:
+        size_t fftSize;
+        size_t hopSize;
+        MelFilterbank filterbank;
+        std::vector<float> window;
+        fftw::AlignedBuffer<float> frame;
+        fftw::AlignedBuffer<std::complex<float>> spectrum;
+        std::vector<float> power;
+    };
+}
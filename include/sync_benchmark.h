@@ -0,0 +1,129 @@
+/**
+ * @file sync_benchmark.h
+ * @brief Sync accuracy and performance benchmark on synthetic and corpus workloads
+ */
+#pragma once
+
+#include "audio_sync.h"
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One pair of recordings with a known alignment
+ *
+ * Offsets follow SyncResult: + = audio 2 starts after audio 1. Synthetic
+ * scenarios are rendered to WAV files; corpus scenarios name existing files.
+ */
+struct BenchmarkScenario {
+    std::string name;
+    double offset = 0.0;              // Ground truth at the start of audio 1, seconds
+    double driftPpm = 0.0;            // Clock drift of audio 2 against audio 1
+    double snrDb = 40.0;              // Noise added to audio 2 (synthetic only)
+    double duration = 60.0;           // Length of both recordings (synthetic only)
+    std::filesystem::path file1;      // Set for corpus scenarios
+    std::filesystem::path file2;
+};
+
+/**
+ * @brief Timing and error of one algorithm run
+ */
+struct BenchmarkMeasurement {
+    std::string name;
+    double seconds = 0.0;             // Mean wall time over the repetitions
+    double minSeconds = 0.0;
+    double offset = 0.0;              // Estimated offset, SyncResult convention
+    double error = 0.0;               // offset - ground truth
+    float confidence = 0.0f;
+    double driftPpm = 0.0;            // Quality runs only
+    std::vector<std::string> algorithmsRun;
+    std::map<std::string, double> stages;   // HybridAudioSync performance stats
+};
+
+/**
+ * @brief Everything measured for one scenario
+ */
+struct BenchmarkCaseResult {
+    BenchmarkScenario scenario;
+    bool synthetic = true;
+    bool ok = false;                  // Decoded and analyzed
+    std::string error;
+    double decodeSeconds = 0.0;       // Both files, analysis rate
+    double extractSeconds = 0.0;      // Both files, in-memory feature extraction
+    double audioSeconds = 0.0;        // Audio decoded per file
+    std::vector<BenchmarkMeasurement> algorithms;   // Each algorithm on the full features
+    std::vector<BenchmarkMeasurement> qualities;    // findOptimalSync per SyncQuality
+};
+
+/**
+ * @brief Benchmark configuration
+ */
+struct BenchmarkOptions {
+    std::filesystem::path corpusDirectory;    // Holds offsets.csv; empty = synthetic only
+    std::filesystem::path jsonFile;           // Empty = no JSON report
+    std::filesystem::path workDirectory;      // Rendered scenarios (empty = temporary)
+    bool synthetic = true;
+    bool keepFiles = false;
+    size_t repetitions = 3;
+    double tolerance = 0.010;                 // Offset error counted as correct, seconds
+    std::vector<SyncQuality> qualities = {SyncQuality::REAL_TIME, SyncQuality::STANDARD,
+                                          SyncQuality::HIGH_QUALITY};
+    bool verbose = false;
+};
+
+/**
+ * @brief Runs the sync pipeline against recordings of known alignment
+ *
+ * For every scenario the decode and feature extraction stages are timed
+ * on their own, each algorithm (CrossCorrelation, DTW, Onset, Spectral) is
+ * timed on the same features, and the full HybridAudioSync pipeline runs at
+ * every requested SyncQuality. Every estimate is compared to the ground
+ * truth. Synthetic scenarios render speech-like material with chosen
+ * offsets, drift and noise; a corpus directory adds real recordings listed
+ * in offsets.csv ("file1,file2,offset[,driftPpm]" per line, paths relative to
+ * the directory, '#' starts a comment).
+ */
+class SyncBenchmark {
+public:
+    explicit SyncBenchmark(BenchmarkOptions options);
+
+    /**
+     * @brief Run every scenario, print a summary and write the JSON report
+     * @return False if a scenario could not be analyzed or the report not written
+     */
+    bool run();
+
+    const std::vector<BenchmarkCaseResult>& results() const { return caseResults; }
+
+    /**
+     * @brief Built-in synthetic scenarios
+     */
+    static std::vector<BenchmarkScenario> syntheticScenarios();
+
+    /**
+     * @brief Scenarios listed in a corpus directory's offsets.csv
+     */
+    static bool loadCorpus(const std::filesystem::path& directory,
+                           std::vector<BenchmarkScenario>& scenarios, std::string& error);
+
+    /**
+     * @brief Render a scenario to two mono 16-bit WAV files
+     */
+    static bool renderScenario(const BenchmarkScenario& scenario, const std::filesystem::path& file1,
+                               const std::filesystem::path& file2);
+
+    /**
+     * @brief Report of all results as JSON
+     */
+    std::string toJson() const;
+
+    static const char* qualityName(SyncQuality quality);
+
+private:
+    BenchmarkCaseResult runScenario(const BenchmarkScenario& scenario, bool synthetic);
+    void printSummary() const;
+
+    BenchmarkOptions options;
+    std::vector<BenchmarkCaseResult> caseResults;
+};
@@ -0,0 +1,119 @@
+/**
+ * @file thread_pool.h
+ * @brief Fixed-size worker pool used by the batch scheduler
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Simple FIFO thread pool with per-worker indices
+ *
+ * Each worker thread knows its index inside its pool, which lets callers keep
+ * per-worker state (sync engines, statistics) without locking.
+ *
+ * Tasks may fan out into the same pool: waitFor() runs queued tasks on the
+ * waiting thread instead of blocking, so nested submissions cannot deadlock
+ * even when every worker is waiting on a child task.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Start a pool
+     * @param threadCount Number of worker threads (at least one is started)
+     */
+    explicit ThreadPool(size_t threadCount);
+
+    /**
+     * @brief Finish all queued tasks and join the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a callable for execution
+     * @param task Callable taking no arguments
+     * @return Future for the callable's result
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        auto future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace_back([packaged]() { (*packaged)(); });
+        }
+        taskAvailable.notify_one();
+        return future;
+    }
+
+    /**
+     * @brief Wait for a future, executing queued tasks while it is not ready
+     * @return Result of the future (exceptions are rethrown)
+     */
+    template <typename T>
+    T waitFor(std::future<T>& future) {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!runPendingTask()) {
+                future.wait_for(HELP_POLL_INTERVAL);
+            }
+        }
+        return future.get();
+    }
+
+    /**
+     * @brief Run one queued task on the calling thread
+     * @return false if the queue was empty
+     */
+    bool runPendingTask();
+
+    /**
+     * @brief Block until the queue is empty and no task is running
+     */
+    void waitIdle();
+
+    /**
+     * @brief Number of worker threads
+     */
+    size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Index of the calling worker inside its pool (0 outside any pool)
+     */
+    static size_t currentWorkerIndex();
+
+    /**
+     * @brief Process-wide pool for fine-grained compute tasks
+     *
+     * Sized to the hardware thread count and created on first use. Batch
+     * workers fan per-file analysis out into it.
+     */
+    static ThreadPool& shared();
+
+private:
+    // How long a helping waiter sleeps when there is nothing to steal
+    static constexpr std::chrono::microseconds HELP_POLL_INTERVAL{200};
+
+    void workerLoop(size_t index);
+    void finishTask();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable idle;
+    size_t activeTasks = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,145 @@
+/**
+ * @file transcode_engine.h
+ * @brief In-process transcode pipeline (demux -> decode -> convert -> encode -> mux) on libav
+ */
+#pragma once
+
+#include "output_profile.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief External audio track laid against the video
+ */
+struct TranscodeAudioInput {
+    std::filesystem::path file;
+    double offset = 0.0;              // Seconds; + delays the track (timestamp shift), - trims its head
+    double tempo = 1.0;               // Playback speed for drift compensation (1 = unchanged)
+    std::string title;                // Track title in the output
+};
+
+/**
+ * @brief Everything one output file is built from
+ *
+ * Output streams are the video, then the external audio tracks in order,
+ * then the camera audio (if requested and present).
+ */
+struct TranscodeSpec {
+    std::filesystem::path videoFile;          // Source of the video (and camera audio)
+    std::vector<TranscodeAudioInput> audioInputs;
+    bool includeCameraAudio = true;
+    std::string cameraTitle = "Camera";
+    std::map<std::string, std::string> metadata;  // Container-level tags
+    OutputProfile profile = OutputProfile::defaultProfile();   // How the video is produced
+    std::filesystem::path outputFile;
+};
+
+/**
+ * @brief Progress snapshot passed to the progress callback
+ */
+struct TranscodeProgress {
+    double position = 0.0;            // Seconds of output written
+    double duration = 0.0;            // Expected output length (0 if unknown)
+    double fraction() const { return duration > 0.0 ? std::min(1.0, position / duration) : 0.0; }
+};
+
+/**
+ * @brief Transcodes to the spec's video profile + 24-bit PCM in a QuickTime container
+ *        without a child process
+ *
+ * Every input is demuxed and decoded in-process; the input lagging furthest
+ * behind in output time is always advanced next, so the muxer receives
+ * interleaved packets without buffering whole streams. Sync offsets become
+ * timestamp shifts (or a trimmed head), drift compensation is done by the
+ * resampler, and failures carry the libav error text. Copy profiles pass
+ * video packets straight to the muxer without decoding them. One run at a time
+ * per instance; cancel() may be called from any thread.
+ *
+ * In single-demux mode spoolHead() reads the head of the video once, hands
+ * its camera audio to the caller for sync analysis and keeps the packets;
+ * the following run() replays them and continues on the same demuxer.
+ */
+class TranscodeEngine {
+public:
+    /**
+     * @brief Called roughly once per second of output; return false to cancel
+     */
+    using ProgressCallback = std::function<bool(const TranscodeProgress&)>;
+
+    TranscodeEngine();
+    ~TranscodeEngine();
+
+    /**
+     * @brief Threads for the video decoder and encoder (0 = libav default)
+     */
+    void setThreadCount(int threads) { threadCount = threads; }
+
+    void setProgressCallback(ProgressCallback callback) { progressCallback = std::move(callback); }
+
+    /**
+     * @brief Abort the current (or next) run; the partial output is removed
+     */
+    void cancel() { cancelled = true; }
+
+    bool isCancelled() const { return cancelled.load(); }
+
+    /**
+     * @brief Memory kept for spooled packets and where the overflow is written
+     */
+    void setSpoolLimit(size_t memoryBytes, std::filesystem::path directory);
+
+    /**
+     * @brief Demux the head of a video once for both sync analysis and output
+     *
+     * Reads videoFile until `seconds` of camera audio have been decoded or the
+     * file ends. The camera audio is returned as mono float at sampleRate;
+     * every video and camera audio packet read on the way is kept, in memory
+     * up to the spool limit and in a temporary file beyond it. The next run()
+     * for the same video replays them and then continues reading the still
+     * open file instead of reopening it. Any previous spool is dropped.
+     * @param reachedEnd Set if the whole file was read
+     * @return False if the video has no camera audio or cannot be read
+     */
+    bool spoolHead(const std::filesystem::path& videoFile, double seconds, double sampleRate,
+                   std::vector<float>& cameraAudio, bool& reachedEnd);
+
+    /**
+     * @brief Bytes held by the current spool, in memory and on disk
+     */
+    size_t spooledBytes() const;
+
+    /**
+     * @brief Produce spec.outputFile
+     * @return True if the output was written completely
+     */
+    bool run(const TranscodeSpec& spec);
+
+    /**
+     * @brief Get description of the most recent failure
+     */
+    const std::string& getLastError() const { return lastError; }
+
+private:
+    struct Spool;
+
+    /**
+     * @brief Build the pipeline and pump it to the end
+     * @param outputCreated Set once the output file has been opened
+     */
+    bool execute(const TranscodeSpec& spec, bool& outputCreated);
+
+    int threadCount = 0;
+    ProgressCallback progressCallback;
+    std::unique_ptr<Spool> spool;
+    size_t spoolMemoryLimit = size_t{512} << 20;
+    std::filesystem::path spoolDirectory;     // Empty = system temporary directory
+    std::atomic<bool> cancelled{false};
+    std::string lastError;
+};
@@ -4,12 +4,20 @@
  */
 #pragma once
 
+#include "audio_fingerprint.h"
 #include "audio_sync.h"
+#include "feature_cache.h"
+#include "media_probe.h"
+#include "transcode_engine.h"
 #include <filesystem>
 #include <vector>
 #include <string>
 #include <memory>
 #include <map>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <atomic>
 
 /**
  * @brief Synchronization statistics for reporting
@@ -24,9 +32,44 @@ struct SyncStatistics {
     std::map<std::string, size_t> algorithmUsage;
     
     void addResult(const SyncResult& result);
+    
+    /**
+     * @brief Fold another (per-worker) statistics block into this one
+     */
+    void merge(const SyncStatistics& other);
+    
     void printReport() const;
 };
 
+/**
+ * @brief External audio chosen for a video
+ */
+struct AudioMatch {
+    std::filesystem::path highGain;           // Empty if nothing matched
+    std::filesystem::path lowGain;            // Empty if no low gain pair exists
+    float confidence = 0.0f;
+    std::optional<double> offsetHint;         // Coarse sync offset from fingerprint matching or timecode
+    bool hintFromTimecode = false;            // offsetHint came from start timecodes, not the audio
+};
+
+/**
+ * @brief Unit of work handed from the sync stage to the encode stage
+ */
+struct TranscodeJob {
+    size_t index = 0;                         // Position in the batch (0-based)
+    std::filesystem::path videoFile;
+    std::filesystem::path highGainAudio;      // Empty if no match was found
+    std::filesystem::path lowGainAudio;       // Empty if no low gain pair exists
+    std::filesystem::path outputFile;
+    float matchConfidence = 0.0f;
+    std::optional<double> offsetHint;         // Seeds the sync search when known
+    SyncResult syncResult;
+    bool useSync = false;                     // False = fallback transcode
+    double syncTime = 0.0;                    // Wall-clock time of the sync stage
+    std::string profileName;                  // OutputProfile to encode with; empty = transcoder's profile
+    std::shared_ptr<TranscodeEngine> spooledEngine;   // Holds the demuxed head (single-demux mode)
+};
+
 /**
  * @brief Advanced video transcoder with intelligent audio synchronization
  */
@@ -46,6 +89,74 @@ public:
                    const std::filesystem::path& outputDir,
                    SyncQuality syncQuality = SyncQuality::STANDARD);
 
+    /**
+     * @brief Process a given set of videos against a given set of audio files
+     *
+     * The batch half of processAll(): engines, probe cache, FFT plans and the
+     * feature cache stay warm between calls, so a long-running caller pays
+     * their setup once.
+     * @param videoFiles Videos to transcode, in order
+     * @param audioFiles External audio the videos may be matched against
+     * @param outputDir Output directory path
+     * @param syncQuality Quality mode for synchronization
+     * @return True if all files processed successfully
+     */
+    bool processFiles(const std::vector<std::filesystem::path>& videoFiles,
+                      const std::vector<std::filesystem::path>& audioFiles,
+                      const std::filesystem::path& outputDir,
+                      SyncQuality syncQuality = SyncQuality::STANDARD);
+
+    /**
+     * @brief Called once per job that finished or failed (not for cancelled jobs)
+     *
+     * Runs on the worker thread that completed the job.
+     */
+    using JobCallback = std::function<void(const TranscodeJob& job, bool success)>;
+
+    void setJobCallback(JobCallback callback);
+
+    /**
+     * @brief Configure the engines, probe the files and index the audio of a batch
+     *
+     * processFiles() does this itself. Callers that run jobs stage by stage
+     * (queue workers) call it whenever their set of audio files changes, while
+     * no syncJob() is running.
+     */
+    void prepareBatch(const std::vector<std::filesystem::path>& videoFiles,
+                      const std::vector<std::filesystem::path>& audioFiles,
+                      SyncQuality syncQuality);
+
+    /**
+     * @brief Match, sync and validate one job outside a batch
+     *
+     * Safe to call from several threads of one ThreadPool; each uses the sync
+     * engine of its worker index. Results are folded into getSyncStatistics().
+     * @param job Job to fill; videoFile and outputFile must be set
+     * @return True if the job should continue to the encode stage
+     */
+    bool syncJob(TranscodeJob& job, const std::vector<std::filesystem::path>& audioFiles,
+                 SyncQuality syncQuality);
+
+    /**
+     * @brief Transcode one job prepared by syncJob() (possibly on another machine)
+     * @return True if the output was written successfully
+     */
+    bool encodeJob(const TranscodeJob& job);
+
+    /**
+     * @brief Find all video files (.mp4, .MP4, .mov, .MOV)
+     * @param directory Directory to search
+     * @return Vector of video file paths
+     */
+    std::vector<std::filesystem::path> findVideoFiles(const std::filesystem::path& directory);
+    
+    /**
+     * @brief Find all audio files (.wav, .WAV)
+     * @param directory Directory to search
+     * @return Vector of audio file paths
+     */
+    std::vector<std::filesystem::path> findAudioFiles(const std::filesystem::path& directory);
+
     /**
      * @brief Set verbose output mode
      * @param verbose Enable detailed logging
@@ -69,53 +180,151 @@ public:
      * @param enableFallback Process files without sync if sync fails
      */
     void setFallbackProcessing(bool enableFallback);
+    
+    /**
+     * @brief Configure the batch scheduler worker pools
+     * @param encodeJobs Maximum number of concurrent transcodes
+     * @param syncJobs Number of concurrent sync analysis workers
+     */
+    void setParallelism(size_t encodeJobs, size_t syncJobs);
+    
+    /**
+     * @brief Seconds of audio each sync analyzes per file
+     * @param seconds Per-file budget; 0 keeps the engine default
+     */
+    void setAnalysisBudget(double seconds);
+    
+    /**
+     * @brief Estimate and compensate clock drift between camera and recorder
+     * @param enable Fit offset + ppm over the whole take and time-stretch the
+     *               external audio to match
+     */
+    void setDriftCompensation(bool enable);
+    
+    /**
+     * @brief Persist extracted features so re-runs skip decoding and analysis
+     * @param directory Cache directory; empty disables the cache
+     */
+    void setFeatureCache(const std::filesystem::path& directory);
+    
+    /**
+     * @brief Match recordings by audio fingerprint before falling back to durations
+     * @param enable Index every WAV once per batch and look each video up in it
+     */
+    void setFingerprintMatching(bool enable);
+    
+    /**
+     * @brief Choose the transcode backend
+     * @param enable True = in-process libav pipeline (default), false = ffmpeg command line
+     */
+    void setNativeTranscode(bool enable);
+    
+    /**
+     * @brief Read each video once for both sync analysis and transcoding
+     * @param enable Demux the head of the video during the sync stage, analyze its
+     *               camera audio from memory and keep the packets for the encoder
+     *               (native engine only)
+     * @param spoolMegabytes Packets kept in memory per job; the rest spills to a temp file
+     */
+    void setSinglePass(bool enable, size_t spoolMegabytes = 512);
+    
+    /**
+     * @brief Choose how the output video is produced (see OutputProfile::all())
+     * @param profile ProRes flavour, stream copy or hardware encoder; audio is always PCM
+     */
+    void setOutputProfile(const OutputProfile& profile);
+    
+    /**
+     * @brief Stop the batch: queued files are skipped and running native
+     *        transcodes abort (safe to call from another thread or a signal handler)
+     */
+    void cancel();
 
 private:
     /**
-     * @brief Find all video files (.mp4, .MP4, .mov, .MOV)
-     * @param directory Directory to search
-     * @return Vector of video file paths
+     * @brief Match, sync and validate one video (sync worker stage)
+     * @param job Job to fill; videoFile, index and outputFile must be set
+     * @param audioFiles Available audio files
+     * @param engine Sync engine owned by the calling worker
+     * @param quality Sync quality mode
+     * @param stats Statistics of the calling worker
+     * @return True if the job should continue to the encode stage
      */
-    std::vector<std::filesystem::path> findVideoFiles(const std::filesystem::path& directory);
+    bool runSyncStage(TranscodeJob& job,
+                      const std::vector<std::filesystem::path>& audioFiles,
+                      HybridAudioSync& engine,
+                      SyncQuality quality,
+                      SyncStatistics& stats);
     
     /**
-     * @brief Find all audio files (.wav, .WAV)
-     * @param directory Directory to search
-     * @return Vector of audio file paths
+     * @brief Transcode one prepared job (encode worker stage)
+     * @param job Job produced by runSyncStage
+     * @param stats Statistics of the calling worker
+     * @return True if the output was written successfully
      */
-    std::vector<std::filesystem::path> findAudioFiles(const std::filesystem::path& directory);
+    bool runEncodeStage(const TranscodeJob& job, SyncStatistics& stats);
+    
+    /**
+     * @brief Demux the head of job.videoFile once and preload its camera audio
+     *
+     * On success the sync stage decodes the camera audio from memory and the
+     * encode stage continues from job.spooledEngine; on failure both read the
+     * file as usual.
+     */
+    void spoolVideo(TranscodeJob& job, const HybridAudioSync& engine);
+    
+    /**
+     * @brief Encoder thread budget for one transcode given the pool size
+     */
+    int encodeThreadsPerJob() const;
     
     /**
      * @brief Enhanced audio matching with multiple strategies
      * @param videoFile Video file path
      * @param audioFiles Available audio files
-     * @return Tuple of high-gain, low-gain files, and match confidence
+     * @return Matched files, confidence and (if fingerprinted) a coarse offset
+     */
+    AudioMatch findAudioMatch(const std::filesystem::path& videoFile,
+                              const std::vector<std::filesystem::path>& audioFiles);
+    
+    /**
+     * @brief Fingerprint every primary (non _D) WAV of the batch into the index
+     */
+    void buildFingerprintIndex(const std::vector<std::filesystem::path>& audioFiles);
+    
+    /**
+     * @brief Look a video's camera audio up in the fingerprint index
+     * @return Indexed files that share landmarks with it, most votes first
      */
-    std::tuple<std::filesystem::path, std::filesystem::path, float> findAudioMatch(
-        const std::filesystem::path& videoFile,
-        const std::vector<std::filesystem::path>& audioFiles);
+    std::vector<FingerprintMatch> queryFingerprint(const std::filesystem::path& videoFile);
     
     /**
      * @brief Intelligent sync detection using hybrid algorithms
+     * @param engine Sync engine of the calling worker
      * @param videoFile Video file path
      * @param audioFile Audio file path
      * @param quality Sync quality mode
+     * @param offsetHint Coarse offset to search around, if known
      * @return Sync result with offset and confidence
      */
-    SyncResult detectAdvancedSync(const std::filesystem::path& videoFile,
+    SyncResult detectAdvancedSync(HybridAudioSync& engine,
+                                 const std::filesystem::path& videoFile,
                                  const std::filesystem::path& audioFile,
-                                 SyncQuality quality);
+                                 SyncQuality quality,
+                                 std::optional<double> offsetHint = std::nullopt);
     
     /**
      * @brief Validate sync result and determine if acceptable
      * @param result Sync result to validate
      * @param videoFile Video file for context
      * @param audioFile Audio file for context
+     * @param offsetHint Fingerprint offset; a result agreeing with it may exceed the usual offset limit
      * @return True if sync result is acceptable
      */
     bool validateSyncResult(const SyncResult& result,
                            const std::filesystem::path& videoFile,
-                           const std::filesystem::path& audioFile);
+                           const std::filesystem::path& audioFile,
+                           std::optional<double> offsetHint = std::nullopt);
     
     /**
      * @brief Transcode video with synchronized audio tracks
@@ -124,25 +333,41 @@ private:
      * @param lowGainAudio Low gain audio file (can be empty)
      * @param syncResult Synchronization result with offset
      * @param outputFile Output file path
+     * @param profile How the video is produced
+     * @param spooled Engine holding the spooled video (nullptr = open it afresh)
      * @return True if successful
      */
     bool transcodeWithSync(const std::filesystem::path& videoFile,
                           const std::filesystem::path& highGainAudio,
                           const std::filesystem::path& lowGainAudio,
                           const SyncResult& syncResult,
-                          const std::filesystem::path& outputFile);
+                          const std::filesystem::path& outputFile,
+                          const OutputProfile& profile,
+                          TranscodeEngine* spooled = nullptr);
+    
+    /**
+     * @brief Run one in-process transcode with progress reporting and cancellation
+     * @param spec Inputs, tracks and metadata of the output
+     * @param spooled Engine holding the spooled video (nullptr = fresh engine)
+     * @return True if successful
+     */
+    bool runNativeTranscode(const TranscodeSpec& spec, TranscodeEngine* spooled = nullptr);
     
     /**
      * @brief Fallback transcoding without external audio sync
      * @param videoFile Input video file
      * @param outputFile Output file path
+     * @param profile How the video is produced
+     * @param spooled Engine holding the spooled video (nullptr = open it afresh)
      * @return True if successful
      */
     bool transcodeFallback(const std::filesystem::path& videoFile,
-                          const std::filesystem::path& outputFile);
+                          const std::filesystem::path& outputFile,
+                          const OutputProfile& profile,
+                          TranscodeEngine* spooled = nullptr);
     
     /**
-     * @brief Get file duration in seconds using ffprobe
+     * @brief Get file duration in seconds from the probe cache
      * @param filepath Media file path
      * @return Duration in seconds
      */
@@ -167,13 +392,28 @@ private:
                        const std::filesystem::path& audioFile,
                        const SyncResult& result);
 
-    // Core components
-    std::unique_ptr<HybridAudioSync> audioSync;
+    // Core components (one sync engine per sync worker)
+    std::vector<std::unique_ptr<HybridAudioSync>> syncEngines;
+    std::shared_ptr<MediaProbeCache> probeCache = std::make_shared<MediaProbeCache>();   // Shared with the sync engines
     SyncStatistics statistics;
+    std::mutex statisticsMutex;    // Guards statistics during syncJob()/encodeJob()
     
     // Configuration
     bool verbose = true;
     float confidenceThreshold = 0.3f;
     bool fallbackProcessing = true;
     SyncQuality defaultQuality = SyncQuality::STANDARD;
+    size_t encodeJobs = 1;
+    size_t syncJobs = 1;
+    double analysisBudget = 0.0;   // 0 = engine default
+    bool driftCompensation = false;
+    std::shared_ptr<FeatureCache> featureCache;
+    bool fingerprintMatching = true;
+    std::unique_ptr<FingerprintIndex> fingerprintIndex;   // Built per batch
+    bool nativeTranscode = true;
+    OutputProfile outputProfile = OutputProfile::defaultProfile();
+    bool singlePass = false;
+    size_t spoolMemoryBytes = size_t{512} << 20;
+    std::atomic<bool> cancelRequested{false};
+    JobCallback jobCallback;
 };
\ No newline at end of file
@@ -0,0 +1,150 @@
+/**
+ * @file watch_service.h
+ * @brief Long-running watch-folder mode with a persistent job database
+ */
+#pragma once
+
+#include "transcoder.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Watch-folder configuration
+ */
+struct WatchOptions {
+    double pollInterval = 10.0;           // Seconds between scans when no change is signalled
+    double settleSeconds = 5.0;           // A file counts as complete once unchanged this long
+    size_t maxAttempts = 3;               // Failed videos are retried this often while unchanged
+    double retryBackoff = 60.0;           // Seconds before the first retry; doubles with every attempt
+    std::filesystem::path stateFile;      // Job database (empty = OUTPUT/.transcode_jobs)
+};
+
+/**
+ * @brief Persistent record of processed videos
+ *
+ * One line per video: state, size, mtime, attempts, finish time, output and
+ * source path, tab-separated. An entry matches only while the video keeps
+ * the recorded size and mtime, so replaced clips are processed again. The
+ * file is rewritten atomically after every change and is safe to delete.
+ */
+class JobDatabase {
+public:
+    enum class State { DONE, FAILED };
+
+    struct Entry {
+        State state = State::DONE;
+        std::uintmax_t size = 0;
+        int64_t mtime = 0;                // file_time_type ticks
+        size_t attempts = 0;
+        int64_t finished = 0;             // Unix seconds of the last attempt's end
+        std::filesystem::path output;
+    };
+
+    explicit JobDatabase(std::filesystem::path file);
+
+    /**
+     * @brief Read the database; a missing file is an empty database
+     * @return False if the file exists but cannot be read
+     */
+    bool load();
+
+    /**
+     * @brief True unless the video is done (with its output present), has used up
+     *        its attempts, or failed less than its backoff ago
+     * @param retryBackoff Wait after the first failure; each further failure doubles it
+     */
+    bool needsProcessing(const std::filesystem::path& video, std::uintmax_t size, int64_t mtime,
+                         size_t maxAttempts, double retryBackoff) const;
+
+    /**
+     * @brief Record the outcome of one video and persist the database
+     */
+    void record(const std::filesystem::path& video, std::uintmax_t size, int64_t mtime, bool success,
+                const std::filesystem::path& output);
+
+    size_t size() const;
+
+    const std::filesystem::path& path() const { return file; }
+
+private:
+    bool save() const;
+
+    std::filesystem::path file;
+    mutable std::mutex mutex;
+    std::map<std::string, Entry> entries;     // Keyed by normalized source path
+};
+
+/**
+ * @brief Watches an input directory and transcodes clips as they arrive
+ *
+ * Every scan compares the directory against the job database; new or changed
+ * videos are processed once they and their audio have stopped growing for
+ * WatchOptions::settleSeconds, so half-copied card dumps are never picked
+ * up. On Linux inotify wakes the service as soon as a write finishes; other
+ * platforms and network mounts that deliver no events are polled. One
+ * VideoTranscoder serves every batch, which keeps its sync engines, probe
+ * cache and FFT plans warm.
+ */
+class WatchService {
+public:
+    WatchService(VideoTranscoder& transcoder, std::filesystem::path inputDir,
+                 std::filesystem::path outputDir, SyncQuality quality, WatchOptions options);
+    ~WatchService();
+
+    WatchService(const WatchService&) = delete;
+    WatchService& operator=(const WatchService&) = delete;
+
+    /**
+     * @brief Scan and process until stop() is called
+     * @return False if the job database could not be read
+     */
+    bool run();
+
+    /**
+     * @brief Leave run() after the current batch (safe from a signal handler)
+     */
+    void stop() { stopRequested = true; }
+
+private:
+    struct FileState {
+        std::uintmax_t size = 0;
+        int64_t mtime = 0;
+        double unchangedSince = 0.0;      // Monotonic seconds this size/mtime was first seen
+    };
+
+    /**
+     * @brief Refresh the observed state of files and keep those that have settled
+     */
+    std::vector<std::filesystem::path> settledFiles(const std::vector<std::filesystem::path>& files,
+                                                    double now);
+
+    /**
+     * @brief True once the recorder files named after the video have settled
+     *
+     * A WAV named like another video belongs to that video, so a clip without
+     * a name-matched WAV only waits for the unsettled files nobody claims.
+     */
+    bool audioSettled(const std::filesystem::path& video, const std::vector<std::filesystem::path>& videos,
+                      const std::vector<std::filesystem::path>& unsettledAudio) const;
+
+    /**
+     * @brief Sleep up to `seconds`, returning early on a directory event or stop()
+     * @return True if a change was signalled
+     */
+    bool waitForChange(double seconds);
+
+    VideoTranscoder& transcoder;
+    std::filesystem::path inputDir;
+    std::filesystem::path outputDir;
+    SyncQuality quality;
+    WatchOptions options;
+    JobDatabase database;
+    std::map<std::string, FileState> observed;
+    std::atomic<bool> stopRequested{false};
+    int inotifyFd = -1;
+};
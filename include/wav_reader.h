@@ -0,0 +1,108 @@
+/**
+ * @file wav_reader.h
+ * @brief Memory-mapped reader for uncompressed WAV, BWF and RF64 files
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+/**
+ * @brief Reads windows of PCM WAV audio without going through a decoder
+ *
+ * The file is mapped and only its chunk headers are parsed on open; read()
+ * converts just the frames of the requested window from 16/24/32-bit
+ * integer or float PCM to mono float with the SIMD kernels, resampling with
+ * a polyphase filter only when the requested rate differs. RF64/BW64 files
+ * beyond 4 GB and BWF `bext` time references are understood.
+ */
+class WavReader {
+public:
+    /**
+     * @brief Receives consecutive blocks of samples; return false to stop
+     */
+    using SampleSink = std::function<bool(const float* samples, size_t count)>;
+
+    WavReader();
+    ~WavReader();
+
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    /**
+     * @brief Map a file and parse its RIFF chunks
+     * @return False if it is not an uncompressed WAV this reader can convert
+     */
+    bool open(const std::filesystem::path& file);
+
+    /**
+     * @brief Convert [startTime, startTime + duration) to mono float
+     * @param startTime Window start in seconds
+     * @param duration Window length in seconds (clipped at the end of the data)
+     * @param sampleRate Output rate in Hz
+     * @param samples Destination buffer, resized to the number of samples produced
+     * @return True if at least one sample was produced
+     */
+    bool read(double startTime, double duration, double sampleRate, std::vector<float>& samples);
+
+    /**
+     * @brief Convert the same window in blocks of at most blockSamples
+     * @return True if at least one sample was delivered
+     */
+    bool read(double startTime, double duration, double sampleRate, size_t blockSamples,
+              const SampleSink& sink);
+
+    int sampleRate() const { return rate; }
+    int channels() const { return channelCount; }
+    uint64_t frameCount() const { return frames; }
+    double duration() const { return rate > 0 ? static_cast<double>(frames) / rate : 0.0; }
+
+    /**
+     * @brief BWF time reference: samples since midnight at the first sample
+     */
+    std::optional<uint64_t> timeReference() const { return bextTimeReference; }
+
+    /**
+     * @brief Time reference in seconds since midnight
+     */
+    std::optional<double> timeReferenceSeconds() const;
+
+    /**
+     * @brief Get description of the most recent failure
+     */
+    const std::string& getLastError() const { return lastError; }
+
+    /**
+     * @brief True for .wav/.bwf/.rf64 names (case-insensitive)
+     */
+    static bool isWavFile(const std::filesystem::path& file);
+
+private:
+    enum class Encoding { PCM_U8, PCM_S16, PCM_S24, PCM_S32, FLOAT32, FLOAT64 };
+
+    /**
+     * @brief Convert interleaved frames to one mono float per frame
+     */
+    void convertFrames(const unsigned char* source, size_t count, float* output);
+
+    std::unique_ptr<MappedFile> mapping;
+    const unsigned char* sampleData = nullptr;
+    uint64_t frames = 0;
+    int rate = 0;
+    int channelCount = 0;
+    size_t bytesPerSample = 0;
+    size_t blockAlign = 0;
+    Encoding encoding = Encoding::PCM_S16;
+    std::optional<uint64_t> bextTimeReference;
+    std::vector<float> interleaved;   // Conversion scratch
+    std::vector<float> mono;
+    std::vector<float> resampled;
+    std::string lastError;
+};
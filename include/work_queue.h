@@ -0,0 +1,288 @@
+/**
+ * @file work_queue.h
+ * @brief Shared-directory work queue that spreads sync and encode jobs over several nodes
+ */
+#pragma once
+
+#include "transcoder.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Pipeline stage a queued item waits for
+ */
+enum class QueueStage {
+    SYNC,       // Match and sync against the audio of WorkItem::inputDir
+    ENCODE      // Transcode with the SyncResult the sync node produced
+};
+
+/**
+ * @brief One video travelling through the queue
+ *
+ * Stored as a small "key=value" text file, so every node reads the same
+ * job regardless of architecture and an operator can inspect or fix it with
+ * a text editor. Paths must resolve identically on every node (the shared
+ * mount), as they are never rewritten.
+ */
+struct WorkItem {
+    std::string id;                           // Stable per source video (see makeId())
+    QueueStage stage = QueueStage::SYNC;      // Next stage to run
+    std::filesystem::path inputDir;           // Where sync nodes look for the audio
+    SyncQuality quality = SyncQuality::STANDARD;
+    TranscodeJob job;                         // Video, matched WAVs, SyncResult, output, profile
+    bool success = false;                     // Outcome, once done or failed
+    std::string node;                         // Node that ran the last stage
+
+    std::string serialize() const;
+
+    /**
+     * @brief Read an item written by serialize()
+     * @return False if required fields are missing or malformed
+     */
+    static bool parse(const std::string& text, WorkItem& item);
+
+    /**
+     * @brief Readable, collision-resistant id: sanitized stem plus a hash of the absolute path
+     */
+    static std::string makeId(const std::filesystem::path& video);
+};
+
+/**
+ * @brief Number of items in each queue state
+ */
+struct QueueCounts {
+    size_t pendingSync = 0;
+    size_t pendingEncode = 0;
+    size_t claimed = 0;
+    size_t done = 0;
+    size_t failed = 0;
+
+    size_t outstanding() const { return pendingSync + pendingEncode + claimed; }
+};
+
+/**
+ * @brief Work queue kept in a directory shared by every node (NFS, EFS, the /s3 mount)
+ *
+ * Layout: sync/ and encode/ hold pending items, claimed/ the items a node is
+ * working on, done/ and failed/ the finished ones, tmp/ half-written files.
+ * A node claims an item by renaming it from its pending directory into
+ * claimed/ under a name carrying the node; rename is atomic, so exactly one
+ * of several racing nodes wins and the others see the source vanish. Claim
+ * owners touch their files every few seconds; a claim whose file has not
+ * been touched for the lease time belongs to a dead node and any node puts
+ * it back. A holder that was only slow loses its claim that way: owns()
+ * tells it so, and complete() refuses to publish for it. A "closed" marker
+ * tells workers that no more items will arrive.
+ */
+class WorkQueue {
+public:
+    /**
+     * @brief Handle on an item this node holds
+     */
+    struct Claim {
+        WorkItem item;
+        std::filesystem::path file;           // In claimed/, unique to this claim
+    };
+
+    explicit WorkQueue(std::filesystem::path directory, double leaseSeconds = 300.0);
+
+    /**
+     * @brief Create the directory layout if needed
+     * @return False if the queue directory is not usable
+     */
+    bool open();
+
+    /**
+     * @brief Add an item in its stage's pending directory, replacing any finished copy
+     */
+    bool submit(const WorkItem& item);
+
+    /**
+     * @brief State directory name ("sync", "encode", "claimed", "done", "failed") holding an id
+     */
+    std::optional<std::string> stateOf(const std::string& id) const;
+
+    /**
+     * @brief Take the oldest pending item of a stage, if any
+     */
+    std::optional<Claim> claim(QueueStage stage);
+
+    /**
+     * @brief Publish the result of a claim: into result.stage's pending directory,
+     *        or into done/ or failed/ when finished is true
+     * @return False if the result could not be written or the claim was lost
+     */
+    bool complete(const Claim& claim, const WorkItem& result, bool finished);
+
+    /**
+     * @brief True while the claim has not been requeued for an expired lease
+     */
+    bool owns(const Claim& claim) const;
+
+    /**
+     * @brief Where an encode for the claim writes before the output is moved into place
+     *
+     * Hidden, next to the final output and unique to the claim, so a node
+     * whose lease was taken over never writes over the new holder's output.
+     */
+    static std::filesystem::path stagingOutput(const Claim& claim);
+
+    /**
+     * @brief Hand an unfinished claim back to its pending directory
+     */
+    bool release(const Claim& claim);
+
+    /**
+     * @brief Renew the lease of a claim
+     */
+    void heartbeat(const Claim& claim);
+
+    /**
+     * @brief Return claims whose lease has expired to their pending directories
+     * @return Number of items requeued
+     */
+    size_t requeueStale();
+
+    QueueCounts counts() const;
+
+    /**
+     * @brief Finished items with the given ids (unreadable files are skipped)
+     */
+    std::vector<WorkItem> finished(const std::set<std::string>& ids) const;
+
+    /**
+     * @brief Ids of every item in done/ or failed/
+     */
+    std::set<std::string> finishedIds() const;
+
+    /**
+     * @brief Mark (or unmark) the queue as receiving no further items
+     */
+    void setClosed(bool closed);
+    bool isClosed() const;
+
+    const std::filesystem::path& path() const { return directory; }
+    const std::string& nodeName() const { return node; }
+
+private:
+    bool writeItem(const WorkItem& item, const std::filesystem::path& target) const;
+    std::optional<WorkItem> readItem(const std::filesystem::path& file) const;
+    std::filesystem::path pendingPath(QueueStage stage, const std::string& id) const;
+
+    std::filesystem::path directory;
+    double leaseSeconds;
+    std::string node;                         // hostname-pid
+    std::atomic<uint64_t> claimSequence{0};   // Keeps claim names of this node unique
+};
+
+/**
+ * @brief Parts of the pipeline a node takes on
+ */
+enum class NodeRole {
+    COORDINATOR,    // Enqueues the input directory, requeues dead claims, merges the results
+    SYNC,           // Runs the sync stage only
+    ENCODE,         // Runs the encode stage only
+    ALL             // Runs both stages
+};
+
+/**
+ * @brief Queue node configuration
+ */
+struct QueueNodeOptions {
+    NodeRole role = NodeRole::ALL;
+    double pollInterval = 5.0;                // Seconds between queue scans when idle
+    double leaseSeconds = 300.0;              // Claims not renewed this long are requeued
+    size_t syncWorkers = 1;                   // Concurrent sync jobs on this node
+    size_t encodeWorkers = 1;                 // Concurrent encode jobs on this node
+};
+
+/**
+ * @brief Runs one node of a distributed batch on a shared WorkQueue
+ *
+ * The coordinator enqueues every video of the input directory that is not
+ * already queued or done (failed ones are retried), then waits until all of
+ * them are finished and prints SyncStatistics rebuilt from the finished
+ * items, so the report covers every node. Worker nodes claim items of their
+ * stages until the queue is closed and drained. Sync workers hand items on
+ * to the encode stage with the matched WAVs and SyncResult filled in, which
+ * lets a CPU-heavy sync fleet feed a separate set of encode machines.
+ */
+class QueueNode {
+public:
+    QueueNode(VideoTranscoder& transcoder, std::filesystem::path queueDir, QueueNodeOptions options);
+
+    QueueNode(const QueueNode&) = delete;
+    QueueNode& operator=(const QueueNode&) = delete;
+
+    /**
+     * @brief Coordinator: enqueue the videos of inputDir
+     * @return False if the queue is unusable or nothing could be enqueued
+     */
+    bool submit(const std::filesystem::path& inputDir, const std::filesystem::path& outputDir,
+                SyncQuality quality, const std::string& profileName);
+
+    /**
+     * @brief Coordinator: wait for the submitted items, report and close the queue
+     * @return True if every item finished successfully
+     */
+    bool collect();
+
+    /**
+     * @brief Worker roles: process items until the queue is closed and drained, or stop()
+     * @return False if the queue is unusable or a job failed on this node
+     */
+    bool work();
+
+    /**
+     * @brief Leave submit()/collect()/work() soon; running jobs are handed back (safe from a signal handler)
+     */
+    void stop();
+
+    const SyncStatistics& getSyncStatistics() const { return statistics; }
+
+    static const char* roleName(NodeRole role);
+    static std::optional<NodeRole> parseRole(const std::string& name);
+
+private:
+    bool runsStage(QueueStage stage) const;
+
+    /**
+     * @brief Claim one item of a stage and hand it to its pool
+     * @return True if an item was claimed
+     */
+    bool dispatch(QueueStage stage, ThreadPool& pool);
+
+    void runSync(WorkQueue::Claim claim, std::vector<std::filesystem::path> audioFiles);
+    void runEncode(WorkQueue::Claim claim);
+
+    void trackClaim(const WorkQueue::Claim& claim);
+    void untrackClaim(const WorkQueue::Claim& claim);
+    void heartbeatLoop();
+
+    VideoTranscoder& transcoder;
+    WorkQueue queue;
+    QueueNodeOptions options;
+    std::set<std::string> submittedIds;
+    SyncStatistics statistics;
+
+    // Audio set the transcoder was last prepared for; only changed while no sync job runs
+    std::vector<std::filesystem::path> preparedAudio;
+    SyncQuality preparedQuality = SyncQuality::STANDARD;
+    bool prepared = false;
+
+    std::mutex claimsMutex;
+    std::vector<WorkQueue::Claim> activeClaims;
+    std::atomic<size_t> syncInFlight{0};
+    std::atomic<size_t> encodeInFlight{0};
+    std::atomic<size_t> completions{0};       // Wakes the dispatch loop when a slot frees
+    std::atomic<bool> jobFailed{false};
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> heartbeatStop{false};
+};
@@ -0,0 +1,444 @@
+/**
+ * @file audio_decoder.cpp
+ * @brief Native audio decoding implementation (demux -> decode -> resample)
+ */
+
+#include "audio_decoder.h"
+#include "av_utils.h"
+#include "metrics.h"
+#include "wav_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+    // Headroom for resampler delay and frame granularity beyond the nominal window
+    constexpr size_t RESAMPLER_SLACK_SAMPLES = 8192;
+
+    struct PreloadedAudio {
+        std::vector<float> samples;
+        double sampleRate = 0.0;
+        bool wholeFile = false;
+    };
+
+    std::mutex preloadMutex;
+    std::map<std::string, std::shared_ptr<const PreloadedAudio>> preloaded;
+
+    std::string preloadKey(const std::filesystem::path& audioFile) {
+        std::error_code ec;
+        auto absolute = std::filesystem::absolute(audioFile, ec);
+        return (ec ? audioFile : absolute).lexically_normal().string();
+    }
+
+    /**
+     * @brief Mono float rate conversion of an in-memory buffer
+     */
+    bool resampleMono(const float* input, size_t count, double inputRate, double outputRate,
+                      std::vector<float>& output, std::string& error) {
+        AVChannelLayout mono;
+        av_channel_layout_default(&mono, 1);
+        SwrContext* raw = nullptr;
+        int ret = swr_alloc_set_opts2(&raw, &mono, AV_SAMPLE_FMT_FLT, static_cast<int>(outputRate),
+                                      &mono, AV_SAMPLE_FMT_FLT, static_cast<int>(inputRate), 0, nullptr);
+        av::ResamplerPtr resampler(raw);
+        av_channel_layout_uninit(&mono);
+        if (ret < 0 || (ret = swr_init(resampler.get())) < 0) {
+            error = "cannot initialize resampler: " + av::errorString(ret);
+            return false;
+        }
+
+        const int inputCount = static_cast<int>(std::min<size_t>(count, INT_MAX));
+        output.resize(static_cast<size_t>(swr_get_out_samples(resampler.get(), inputCount)));
+        uint8_t* out = reinterpret_cast<uint8_t*>(output.data());
+        const uint8_t* in = reinterpret_cast<const uint8_t*>(input);
+        int converted = swr_convert(resampler.get(), &out, static_cast<int>(output.size()), &in, inputCount);
+        if (converted < 0) {
+            error = "resampling failed: " + av::errorString(converted);
+            return false;
+        }
+        size_t written = static_cast<size_t>(converted);
+
+        // Drain the filter tail
+        const int pending = swr_get_out_samples(resampler.get(), 0);
+        if (pending > 0) {
+            output.resize(written + pending);
+            out = reinterpret_cast<uint8_t*>(output.data() + written);
+            int flushed = swr_convert(resampler.get(), &out, pending, nullptr, 0);
+            if (flushed > 0) {
+                written += flushed;
+            }
+        }
+        output.resize(written);
+        return true;
+    }
+}
+
+void AudioDecoder::preload(const std::filesystem::path& audioFile, std::vector<float> samples,
+                           double sampleRate, bool wholeFile) {
+    auto entry = std::make_shared<PreloadedAudio>();
+    entry->samples = std::move(samples);
+    entry->sampleRate = sampleRate;
+    entry->wholeFile = wholeFile;
+
+    std::lock_guard<std::mutex> lock(preloadMutex);
+    preloaded[preloadKey(audioFile)] = std::move(entry);
+}
+
+void AudioDecoder::release(const std::filesystem::path& audioFile) {
+    std::lock_guard<std::mutex> lock(preloadMutex);
+    preloaded.erase(preloadKey(audioFile));
+}
+
+bool AudioDecoder::decodePreloaded(const std::filesystem::path& audioFile, double startTime,
+                                   double duration, double sampleRate, std::vector<float>& samples) {
+    std::shared_ptr<const PreloadedAudio> entry;
+    {
+        std::lock_guard<std::mutex> lock(preloadMutex);
+        if (preloaded.empty()) {
+            return false;
+        }
+        auto it = preloaded.find(preloadKey(audioFile));
+        if (it == preloaded.end()) {
+            return false;
+        }
+        entry = it->second;
+    }
+
+    // Windows running past a partial entry still need the file
+    const double available = entry->samples.size() / entry->sampleRate;
+    const double start = std::max(0.0, startTime);
+    if (start >= available || (!entry->wholeFile && start + duration > available)) {
+        return false;
+    }
+
+    const size_t first = static_cast<size_t>(std::llround(start * entry->sampleRate));
+    const size_t count = std::min(entry->samples.size() - first,
+                                  static_cast<size_t>(std::llround(duration * entry->sampleRate)));
+    if (sampleRate == entry->sampleRate) {
+        samples.assign(entry->samples.begin() + first, entry->samples.begin() + first + count);
+    } else if (!resampleMono(entry->samples.data() + first, count, entry->sampleRate, sampleRate,
+                             samples, lastError)) {
+        return false;
+    }
+    return !samples.empty();
+}
+
+bool AudioDecoder::decode(const std::filesystem::path& audioFile,
+                          double startTime, double duration,
+                          double sampleRate, std::vector<float>& samples) {
+    lastError.clear();
+    samples.clear();
+
+    if (duration <= 0.0 || sampleRate <= 0.0) {
+        lastError = "invalid decode window";
+        return false;
+    }
+    metrics::ScopedTimer timer("decode");
+
+    if (decodePreloaded(audioFile, startTime, duration, sampleRate, samples)) {
+        return true;
+    }
+    samples.clear();
+
+    // Plain PCM needs no decoder: convert the window straight from a mapping
+    if (WavReader::isWavFile(audioFile)) {
+        WavReader wav;
+        if (wav.open(audioFile) && wav.read(startTime, duration, sampleRate, samples)) {
+            return true;
+        }
+        samples.clear();
+    }
+
+    return decodeFile(audioFile, startTime, duration, sampleRate, samples, 0, nullptr);
+}
+
+bool AudioDecoder::decodeStream(const std::filesystem::path& audioFile,
+                                double startTime, double duration, double sampleRate,
+                                size_t blockSamples, const SampleSink& sink) {
+    lastError.clear();
+
+    if (duration <= 0.0 || sampleRate <= 0.0 || blockSamples == 0) {
+        lastError = "invalid decode window";
+        return false;
+    }
+
+    // Time spent in the sink belongs to the caller's stage, not to decoding
+    const auto started = std::chrono::steady_clock::now();
+    double sinkSeconds = 0.0;
+    const SampleSink timedSink = [&](const float* block, size_t count) {
+        const auto sinkStart = std::chrono::steady_clock::now();
+        const bool more = sink(block, count);
+        sinkSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - sinkStart).count();
+        return more;
+    };
+
+    // Preloaded heads are in memory already; only the slicing is blocked
+    std::vector<float> buffer;
+    bool decoded = decodePreloaded(audioFile, startTime, duration, sampleRate, buffer);
+    if (decoded) {
+        for (size_t begin = 0; begin < buffer.size(); begin += blockSamples) {
+            if (!timedSink(buffer.data() + begin, std::min(blockSamples, buffer.size() - begin))) {
+                break;
+            }
+        }
+    } else {
+        buffer.clear();
+        WavReader wav;
+        decoded = WavReader::isWavFile(audioFile) && wav.open(audioFile) &&
+                  wav.read(startTime, duration, sampleRate, blockSamples, timedSink);
+        if (!decoded) {
+            decoded = decodeFile(audioFile, startTime, duration, sampleRate, buffer, blockSamples, &timedSink);
+        }
+    }
+
+    const double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    metrics::Registry::instance().record("decode", std::max(0.0, total - sinkSeconds));
+    return decoded;
+}
+
+bool AudioDecoder::decodeFile(const std::filesystem::path& audioFile,
+                              double startTime, double duration, double sampleRate,
+                              std::vector<float>& samples, size_t blockSamples,
+                              const SampleSink* sink) {
+    auto format = av::openInput(audioFile.string(), lastError);
+    if (!format) {
+        return false;
+    }
+
+    const AVCodec* codec = nullptr;
+    int streamIndex = av_find_best_stream(format.get(), AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+    if (streamIndex < 0 || !codec) {
+        lastError = "no decodable audio stream in " + audioFile.string();
+        return false;
+    }
+    AVStream* stream = format->streams[streamIndex];
+
+    // Skip packet allocation for video/data streams while demuxing
+    for (unsigned int i = 0; i < format->nb_streams; ++i) {
+        if (static_cast<int>(i) != streamIndex) {
+            format->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    av::CodecContextPtr decoder(avcodec_alloc_context3(codec));
+    if (!decoder) {
+        lastError = "cannot allocate decoder";
+        return false;
+    }
+    int ret = avcodec_parameters_to_context(decoder.get(), stream->codecpar);
+    if (ret >= 0) {
+        decoder->pkt_timebase = stream->time_base;
+        ret = avcodec_open2(decoder.get(), codec, nullptr);
+    }
+    if (ret < 0) {
+        lastError = "cannot open " + std::string(codec->name) + " decoder: " + av::errorString(ret);
+        return false;
+    }
+
+    // Window in container time, matching ffmpeg's input-side -ss semantics
+    double containerStart = format->start_time != AV_NOPTS_VALUE
+        ? static_cast<double>(format->start_time) / AV_TIME_BASE : 0.0;
+    double windowStart = containerStart + std::max(0.0, startTime);
+
+    if (startTime > 0.0) {
+        int64_t target = static_cast<int64_t>(windowStart * AV_TIME_BASE);
+        if (avformat_seek_file(format.get(), -1, std::numeric_limits<int64_t>::min(),
+                               target, target, 0) >= 0) {
+            avcodec_flush_buffers(decoder.get());
+        }
+    }
+
+    // Size the output once (one block when streaming); only grow if the
+    // container underreported its length
+    double available = duration;
+    if (format->duration != AV_NOPTS_VALUE && format->duration > 0) {
+        double fileLength = static_cast<double>(format->duration) / AV_TIME_BASE;
+        available = std::clamp(fileLength - std::max(0.0, startTime), 0.0, duration);
+    }
+    const size_t targetSamples = static_cast<size_t>(std::llround(duration * sampleRate));
+    size_t expected = std::min(targetSamples, static_cast<size_t>(std::llround(available * sampleRate)));
+    if (sink) {
+        expected = std::min(expected, blockSamples);
+    }
+    samples.resize(expected + RESAMPLER_SLACK_SAMPLES);
+
+    AVChannelLayout monoLayout;
+    av_channel_layout_default(&monoLayout, 1);
+
+    av::ResamplerPtr resampler;
+    int resamplerFormat = AV_SAMPLE_FMT_NONE;
+    int resamplerRate = 0;
+    int resamplerChannels = 0;
+
+    size_t written = 0;               // Samples in the buffer
+    size_t delivered = 0;             // Samples already handed to the sink
+    double nextFrameTime = windowStart;
+    bool failed = false;
+    bool stopped = false;
+
+    // Hand the buffer to the sink (streaming only)
+    auto flush = [&]() {
+        const size_t count = std::min(written, targetSamples - delivered);
+        for (size_t begin = 0; begin < count && !stopped; begin += blockSamples) {
+            stopped = !(*sink)(samples.data() + begin, std::min(blockSamples, count - begin));
+        }
+        delivered += count;
+        written = 0;
+    };
+
+    auto ensureCapacity = [&](size_t extra) {
+        if (sink && written > 0 && written + extra > samples.size()) {
+            flush();
+        }
+        const size_t needed = written + extra;
+        if (needed > samples.size()) {
+            samples.resize(std::max(needed, samples.size() + samples.size() / 2));
+        }
+    };
+
+    // Returns false once the window is filled or on error
+    auto handleFrame = [&](AVFrame* frame) -> bool {
+        if (frame->nb_samples <= 0 || frame->sample_rate <= 0) {
+            return true;
+        }
+
+        if (!resampler || frame->format != resamplerFormat ||
+            frame->sample_rate != resamplerRate ||
+            frame->ch_layout.nb_channels != resamplerChannels) {
+            SwrContext* raw = nullptr;
+            int err = swr_alloc_set_opts2(&raw, &monoLayout, AV_SAMPLE_FMT_FLT,
+                                          static_cast<int>(sampleRate),
+                                          &frame->ch_layout,
+                                          static_cast<AVSampleFormat>(frame->format),
+                                          frame->sample_rate, 0, nullptr);
+            resampler.reset(raw);
+            if (err < 0 || (err = swr_init(resampler.get())) < 0) {
+                lastError = "cannot initialize resampler: " + av::errorString(err);
+                failed = true;
+                return false;
+            }
+            resamplerFormat = frame->format;
+            resamplerRate = frame->sample_rate;
+            resamplerChannels = frame->ch_layout.nb_channels;
+        }
+
+        double frameTime = frame->best_effort_timestamp != AV_NOPTS_VALUE
+            ? frame->best_effort_timestamp * av_q2d(stream->time_base)
+            : nextFrameTime;
+        nextFrameTime = frameTime + static_cast<double>(frame->nb_samples) / frame->sample_rate;
+
+        // Trim the pre-roll left over from keyframe-granular seeking
+        int skip = 0;
+        if (frameTime < windowStart) {
+            skip = static_cast<int>(std::llround((windowStart - frameTime) * frame->sample_rate));
+            if (skip >= frame->nb_samples) {
+                return true;
+            }
+        }
+
+        auto inputFormat = static_cast<AVSampleFormat>(frame->format);
+        const int bytesPerSample = av_get_bytes_per_sample(inputFormat);
+        const int channels = frame->ch_layout.nb_channels;
+        std::vector<const uint8_t*> planes;
+        if (av_sample_fmt_is_planar(inputFormat)) {
+            planes.resize(channels);
+            for (int ch = 0; ch < channels; ++ch) {
+                planes[ch] = frame->extended_data[ch] + static_cast<size_t>(skip) * bytesPerSample;
+            }
+        } else {
+            planes.push_back(frame->extended_data[0] +
+                             static_cast<size_t>(skip) * bytesPerSample * channels);
+        }
+
+        const int inputCount = frame->nb_samples - skip;
+        const int outputCapacity = swr_get_out_samples(resampler.get(), inputCount);
+        ensureCapacity(outputCapacity);
+
+        uint8_t* output = reinterpret_cast<uint8_t*>(samples.data() + written);
+        int converted = swr_convert(resampler.get(), &output, outputCapacity,
+                                    planes.data(), inputCount);
+        if (converted < 0) {
+            lastError = "resampling failed: " + av::errorString(converted);
+            failed = true;
+            return false;
+        }
+        written += converted;
+        return !stopped && delivered + written < targetSamples;
+    };
+
+    av::FramePtr frame(av_frame_alloc());
+    av::PacketPtr packet(av_packet_alloc());
+
+    auto receiveFrames = [&]() -> bool {
+        while (avcodec_receive_frame(decoder.get(), frame.get()) >= 0) {
+            bool more = handleFrame(frame.get());
+            av_frame_unref(frame.get());
+            if (!more) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    bool windowOpen = true;
+    while (windowOpen && av_read_frame(format.get(), packet.get()) >= 0) {
+        if (packet->stream_index == streamIndex) {
+            // Corrupt packets are skipped rather than aborting the whole window
+            if (avcodec_send_packet(decoder.get(), packet.get()) >= 0) {
+                windowOpen = receiveFrames();
+            }
+        }
+        av_packet_unref(packet.get());
+    }
+
+    if (windowOpen) {
+        avcodec_send_packet(decoder.get(), nullptr);
+        windowOpen = receiveFrames();
+    }
+
+    // Drain samples still buffered inside the resampler
+    if (windowOpen && !failed && resampler) {
+        const int pending = swr_get_out_samples(resampler.get(), 0);
+        if (pending > 0) {
+            ensureCapacity(pending);
+            uint8_t* output = reinterpret_cast<uint8_t*>(samples.data() + written);
+            int flushed = swr_convert(resampler.get(), &output, pending, nullptr, 0);
+            if (flushed > 0) {
+                written += flushed;
+            }
+        }
+    }
+
+    av_channel_layout_uninit(&monoLayout);
+
+    if (failed) {
+        samples.clear();
+        return false;
+    }
+
+    if (sink) {
+        if (!stopped) {
+            flush();
+        }
+        if (delivered == 0) {
+            lastError = "no audio samples in requested window";
+            return false;
+        }
+        return true;
+    }
+
+    samples.resize(std::min(written, targetSamples));
+    if (samples.empty()) {
+        lastError = "no audio samples in requested window";
+        return false;
+    }
+    return true;
+}
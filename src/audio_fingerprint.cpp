@@ -0,0 +1,239 @@
+/**
+ * @file audio_fingerprint.cpp
+ * @brief Landmark fingerprint extraction and inverted index matching
+ */
+
+#include "audio_fingerprint.h"
+#include "audio_decoder.h"
+#include "fft_processor.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    // Peak picking: a bin is a peak if it is the maximum of its
+    // (2 * time radius + 1) x (2 * frequency radius + 1) neighbourhood
+    constexpr size_t PEAK_TIME_RADIUS = 3;
+    constexpr size_t PEAK_FREQ_RADIUS = 10;
+    constexpr size_t PEAKS_PER_FRAME = 3;
+    constexpr float PEAK_FLOOR_DB = -70.0f;
+
+    // Hash bins 1..511 of the 513-bin spectrum (DC and Nyquist dropped)
+    constexpr size_t MIN_PEAK_BIN = 1;
+    constexpr size_t MAX_PEAK_BIN = 511;
+
+    // Target zone: up to FAN_OUT peaks within ~2 s and +-64 bins of the anchor
+    constexpr uint32_t TARGET_MAX_FRAMES = 63;
+    constexpr int TARGET_MAX_BINS = 64;
+    constexpr size_t FAN_OUT = 5;
+
+    // Hashes this common (hum, tones) carry no information and cost most lookups
+    constexpr size_t MAX_POSTINGS_PER_HASH = 4096;
+
+    struct Peak {
+        uint32_t frame;
+        uint32_t bin;
+        float level;
+    };
+
+    uint32_t makeHash(uint32_t anchorBin, uint32_t targetBin, uint32_t frameDelta) {
+        return (anchorBin & 0x1FF) << 15 | (targetBin & 0x1FF) << 6 | (frameDelta & 0x3F);
+    }
+}
+
+// ===========================
+// AudioFingerprinter Implementation
+// ===========================
+
+AudioFingerprinter::AudioFingerprinter()
+    : fft(std::make_unique<fftw::FFTProcessor>(FRAME_SIZE)), window(FRAME_SIZE) {
+    for (size_t i = 0; i < FRAME_SIZE; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * i / (FRAME_SIZE - 1)));
+    }
+}
+
+AudioFingerprinter::~AudioFingerprinter() = default;
+
+std::vector<Landmark> AudioFingerprinter::extract(const std::vector<float>& samples) {
+    std::vector<Landmark> landmarks;
+    if (samples.size() < FRAME_SIZE) {
+        return landmarks;
+    }
+
+    const size_t numFrames = (samples.size() - FRAME_SIZE) / HOP_SIZE + 1;
+    const size_t numBins = FRAME_SIZE / 2 + 1;
+
+    // Scale so a full-scale sine peaks near 0 dB
+    float windowSum = 0.0f;
+    for (float w : window) windowSum += w;
+    const float powerScale = 4.0f / (windowSum * windowSum);
+
+    // Ring of the last 2R+1 frames: log power and its maximum over the
+    // frequency neighbourhood. A frame is judged once R later frames exist.
+    const size_t ringSize = 2 * PEAK_TIME_RADIUS + 1;
+    const float silent = -std::numeric_limits<float>::infinity();
+    std::vector<std::vector<float>> levels(ringSize, std::vector<float>(numBins, silent));
+    std::vector<std::vector<float>> neighbourMax(ringSize, std::vector<float>(numBins, silent));
+
+    std::vector<float> frame(FRAME_SIZE);
+    std::vector<std::complex<float>> spectrum(numBins);
+    std::vector<Peak> peaks;
+    std::vector<Peak> framePeaks;
+
+    for (size_t t = 0; t < numFrames + PEAK_TIME_RADIUS; ++t) {
+        auto& level = levels[t % ringSize];
+        auto& localMax = neighbourMax[t % ringSize];
+
+        if (t < numFrames) {
+            const float* source = samples.data() + t * HOP_SIZE;
+            for (size_t i = 0; i < FRAME_SIZE; ++i) {
+                frame[i] = source[i] * window[i];
+            }
+            fft->forward(frame, spectrum);
+            for (size_t k = 0; k < numBins; ++k) {
+                level[k] = 10.0f * std::log10(std::norm(spectrum[k]) * powerScale + 1e-12f);
+            }
+            for (size_t k = 0; k < numBins; ++k) {
+                const size_t lo = k > PEAK_FREQ_RADIUS ? k - PEAK_FREQ_RADIUS : 0;
+                const size_t hi = std::min(numBins - 1, k + PEAK_FREQ_RADIUS);
+                localMax[k] = *std::max_element(level.begin() + lo, level.begin() + hi + 1);
+            }
+        } else {
+            // Past the end: silent frames flush the last R frames
+            std::fill(level.begin(), level.end(), silent);
+            std::fill(localMax.begin(), localMax.end(), silent);
+        }
+
+        if (t < PEAK_TIME_RADIUS) {
+            continue;
+        }
+        const size_t centre = t - PEAK_TIME_RADIUS;
+        const auto& centreLevel = levels[centre % ringSize];
+
+        framePeaks.clear();
+        for (size_t k = MIN_PEAK_BIN; k <= MAX_PEAK_BIN; ++k) {
+            const float value = centreLevel[k];
+            if (value < PEAK_FLOOR_DB) continue;
+            bool isPeak = true;
+            for (size_t s = 0; s < ringSize && isPeak; ++s) {
+                isPeak = value >= neighbourMax[s][k];
+            }
+            if (isPeak) {
+                framePeaks.push_back({static_cast<uint32_t>(centre), static_cast<uint32_t>(k), value});
+            }
+        }
+
+        // Strongest few per frame keep the density bounded on dense material
+        if (framePeaks.size() > PEAKS_PER_FRAME) {
+            std::partial_sort(framePeaks.begin(), framePeaks.begin() + PEAKS_PER_FRAME, framePeaks.end(),
+                              [](const Peak& a, const Peak& b) { return a.level > b.level; });
+            framePeaks.resize(PEAKS_PER_FRAME);
+            std::sort(framePeaks.begin(), framePeaks.end(),
+                      [](const Peak& a, const Peak& b) { return a.bin < b.bin; });
+        }
+        peaks.insert(peaks.end(), framePeaks.begin(), framePeaks.end());
+    }
+
+    // Pair every anchor with the first peaks of its target zone
+    landmarks.reserve(peaks.size() * FAN_OUT);
+    for (size_t i = 0; i < peaks.size(); ++i) {
+        const Peak& anchor = peaks[i];
+        size_t paired = 0;
+        for (size_t j = i + 1; j < peaks.size() && paired < FAN_OUT; ++j) {
+            const uint32_t delta = peaks[j].frame - anchor.frame;
+            if (delta > TARGET_MAX_FRAMES) break;
+            if (delta == 0) continue;
+            if (std::abs(static_cast<int>(peaks[j].bin) - static_cast<int>(anchor.bin)) > TARGET_MAX_BINS) {
+                continue;
+            }
+            landmarks.push_back({makeHash(anchor.bin, peaks[j].bin, delta), anchor.frame});
+            paired++;
+        }
+    }
+
+    return landmarks;
+}
+
+bool AudioFingerprinter::fingerprintFile(const std::filesystem::path& file, double seconds,
+                                         std::vector<Landmark>& landmarks) {
+    std::vector<float> samples;
+    AudioDecoder decoder;
+    if (!decoder.decode(file, 0.0, seconds, SAMPLE_RATE, samples)) {
+        landmarks.clear();
+        return false;
+    }
+    landmarks = extract(samples);
+    return true;
+}
+
+// ===========================
+// FingerprintIndex Implementation
+// ===========================
+
+void FingerprintIndex::add(const std::filesystem::path& file, const std::vector<Landmark>& landmarks) {
+    const uint32_t fileId = static_cast<uint32_t>(files.size());
+    files.push_back(file);
+    for (const auto& landmark : landmarks) {
+        table[landmark.hash].push_back({fileId, landmark.frame});
+    }
+    postingCount += landmarks.size();
+}
+
+std::vector<FingerprintMatch> FingerprintIndex::query(const std::vector<Landmark>& landmarks) const {
+    // Votes per (file, frame displacement); displacements are biased so the
+    // key stays unsigned
+    std::unordered_map<uint64_t, uint32_t> votes;
+    votes.reserve(landmarks.size() * 2);
+    const int64_t bias = int64_t{1} << 31;
+    auto key = [bias](uint32_t file, int64_t displacement) {
+        return (static_cast<uint64_t>(file) << 32) | static_cast<uint64_t>(displacement + bias);
+    };
+
+    for (const auto& landmark : landmarks) {
+        auto it = table.find(landmark.hash);
+        if (it == table.end() || it->second.size() > MAX_POSTINGS_PER_HASH) continue;
+        for (const auto& posting : it->second) {
+            const int64_t displacement = static_cast<int64_t>(posting.frame) - landmark.frame;
+            votes[key(posting.file, displacement)]++;
+        }
+    }
+
+    // Best displacement per file; neighbouring bins are pooled since an
+    // event can straddle a frame boundary differently in the two recordings
+    std::vector<size_t> bestVotes(files.size(), 0);
+    std::vector<double> bestDisplacement(files.size(), 0.0);
+    for (const auto& [packed, count] : votes) {
+        const uint32_t file = static_cast<uint32_t>(packed >> 32);
+        const int64_t displacement = static_cast<int64_t>(packed & 0xFFFFFFFFULL) - bias;
+
+        size_t pooled = count;
+        double weighted = static_cast<double>(displacement) * count;
+        for (int64_t neighbour : {displacement - 1, displacement + 1}) {
+            auto it = votes.find(key(file, neighbour));
+            if (it != votes.end()) {
+                pooled += it->second;
+                weighted += static_cast<double>(neighbour) * it->second;
+            }
+        }
+        if (pooled > bestVotes[file]) {
+            bestVotes[file] = pooled;
+            bestDisplacement[file] = weighted / pooled;
+        }
+    }
+
+    std::vector<FingerprintMatch> matches;
+    for (size_t file = 0; file < files.size(); ++file) {
+        if (bestVotes[file] == 0) continue;
+        FingerprintMatch match;
+        match.file = files[file];
+        match.votes = bestVotes[file];
+        match.displacement = bestDisplacement[file] * AudioFingerprinter::frameSeconds();
+        matches.push_back(std::move(match));
+    }
+    std::sort(matches.begin(), matches.end(),
+              [](const FingerprintMatch& a, const FingerprintMatch& b) { return a.votes > b.votes; });
+    return matches;
+}
@@ -4,6 +4,15 @@
  */
 
 #include "audio_sync.h"
+#include "audio_decoder.h"
+#include "console_log.h"
+#include "feature_cache.h"
+#include "feature_extractor.h"
+#include "media_probe.h"
+#include "metrics.h"
+#include "scratch_arena.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
@@ -12,13 +21,9 @@
 #include <chrono>
 #include <thread>
 #include <numeric>
+#include <cstdint>
 #include <cstdlib>
 
-// FFTW includes (conditional compilation)
-#ifdef USE_FFTW
-#include <fftw3.h>
-#endif
-
 namespace {
     // Mathematical constants
     constexpr float PI = 3.14159265359f;
@@ -29,105 +34,86 @@ namespace {
     constexpr size_t MFCC_NUM_FILTERS = 26;
     constexpr size_t MFCC_FRAME_SIZE = 2048;
     constexpr size_t MFCC_HOP_SIZE = 512;
+    constexpr size_t MFCC_NUM_COEFFS = 13;
+    
+    // Analysis window selection: a coarse envelope of the file head picks
+    // where the per-file sample budget is spent
+    constexpr double DEFAULT_ANALYSIS_BUDGET = 50.0;
+    constexpr double ANALYSIS_SEARCH_MARGIN = 15.0;
+    constexpr double MIN_REFERENCE_SECONDS = 10.0;
+    constexpr double HINTED_SEARCH_MARGIN = 3.0;     // Around a fingerprint offset
+    constexpr double ENVELOPE_SCAN_SECONDS = 180.0;
+    constexpr double ENVELOPE_SAMPLE_RATE = 4000.0;
+    constexpr double ENVELOPE_BLOCK_SECONDS = 0.5;
+    constexpr float SILENCE_FLOOR_DB = -50.0f;
+    constexpr float ACTIVITY_MARGIN_DB = 10.0f;
+    constexpr float LEVEL_CHANGE_DB = 6.0f;
+    
+    // Drift mode: short windows spread over the take, searched closely
+    // around the coarse offset
+    constexpr size_t DRIFT_WINDOW_COUNT = 8;
+    constexpr double DRIFT_WINDOW_SECONDS = 10.0;
+    constexpr double DRIFT_SEARCH_MARGIN = 2.0;
+    constexpr double DRIFT_MIN_SPAN = 120.0;
+    constexpr float DRIFT_MIN_WINDOW_CONFIDENCE = 0.3f;
+    constexpr double DRIFT_INLIER_TOLERANCE = 0.025;
+    constexpr double MAX_DRIFT_PPM = 1000.0;
     
     // Synchronization parameters
     constexpr float MIN_CONFIDENCE_THRESHOLD = 0.3f;
     constexpr float HIGH_CONFIDENCE_THRESHOLD = 0.8f;
     constexpr size_t MAX_OFFSET_SAMPLES = 44100 * 30; // 30 seconds max offset
-}
-
-// ===========================
-// FFT Processor Implementation
-// ===========================
-
-namespace fftw {
-    FFTProcessor::FFTProcessor(size_t size) : size(size) {
-#ifdef USE_FFTW
-        input_buffer = fftwf_alloc_real(size);
-        output_buffer = fftwf_alloc_complex(size/2 + 1);
-        
-        plan_forward = fftwf_plan_dft_r2c_1d(size, input_buffer, 
-                                           reinterpret_cast<fftwf_complex*>(output_buffer),
-                                           FFTW_ESTIMATE);
-        plan_inverse = fftwf_plan_dft_c2r_1d(size, 
-                                           reinterpret_cast<fftwf_complex*>(output_buffer),
-                                           input_buffer, FFTW_ESTIMATE);
-#else
-        // Fallback implementation without FFTW
-        input_buffer = new float[size];
-        output_buffer = new std::complex<float>[size/2 + 1];
-        plan_forward = nullptr;
-        plan_inverse = nullptr;
-#endif
-    }
-    
-    FFTProcessor::~FFTProcessor() {
-#ifdef USE_FFTW
-        fftwf_destroy_plan(static_cast<fftwf_plan>(plan_forward));
-        fftwf_destroy_plan(static_cast<fftwf_plan>(plan_inverse));
-        fftwf_free(input_buffer);
-        fftwf_free(output_buffer);
-#else
-        delete[] input_buffer;
-        delete[] output_buffer;
-#endif
-    }
-    
-    void FFTProcessor::forward(const std::vector<float>& input,
-                              std::vector<std::complex<float>>& output) {
-        if (input.size() != size) {
-            throw std::invalid_argument("Input size mismatch");
-        }
-        
-        std::copy(input.begin(), input.end(), input_buffer);
-        
-#ifdef USE_FFTW
-        fftwf_execute(static_cast<fftwf_plan>(plan_forward));
-        output.resize(size/2 + 1);
-        std::copy(output_buffer, output_buffer + size/2 + 1, output.begin());
-#else
-        // Simple DFT fallback (very slow, for compatibility only)
-        output.resize(size/2 + 1);
-        for (size_t k = 0; k < size/2 + 1; ++k) {
-            std::complex<float> sum(0.0f, 0.0f);
-            for (size_t n = 0; n < size; ++n) {
-                float angle = -TWO_PI * k * n / size;
-                sum += input_buffer[n] * std::complex<float>(std::cos(angle), std::sin(angle));
-            }
-            output[k] = sum;
-        }
-#endif
-    }
     
-    void FFTProcessor::inverse(const std::vector<std::complex<float>>& input,
-                              std::vector<float>& output) {
-        if (input.size() != size/2 + 1) {
-            throw std::invalid_argument("Input size mismatch for inverse FFT");
-        }
-        
-        std::copy(input.begin(), input.end(), output_buffer);
-        
-#ifdef USE_FFTW
-        fftwf_execute(static_cast<fftwf_plan>(plan_inverse));
-        output.resize(size);
-        for (size_t i = 0; i < size; ++i) {
-            output[i] = input_buffer[i] / size; // Normalize
-        }
-#else
-        // Simple IDFT fallback
-        output.resize(size);
-        for (size_t n = 0; n < size; ++n) {
-            std::complex<float> sum(0.0f, 0.0f);
-            for (size_t k = 0; k < size/2 + 1; ++k) {
-                float angle = TWO_PI * k * n / size;
-                std::complex<float> mult = (k == 0 || k == size/2) ? 
-                    input[k] : input[k] * 2.0f; // Account for negative frequencies
-                sum += mult * std::complex<float>(std::cos(angle), std::sin(angle));
-            }
-            output[n] = sum.real() / size;
-        }
-#endif
-    }
+    // Hierarchical cross-correlation: envelope decimation for the full-range
+    // search, then a short full-rate waveform segment for the final lag
+    constexpr size_t ENVELOPE_DECIMATION = 4;
+    constexpr long REFINE_SEGMENT_SAMPLES = 32768;
+    constexpr float REFINE_MIN_CORRELATION = 0.2f;
+    
+    // Final confidence: onsets in both files corroborate an estimate a little,
+    // offsets beyond the large-offset limit are rarer and trusted less
+    constexpr size_t CONFIDENCE_MIN_ONSETS = 5;
+    constexpr float ONSET_EVIDENCE_BOOST = 1.05f;
+    constexpr double LARGE_OFFSET_SECONDS = 10.0;
+    constexpr float LARGE_OFFSET_PENALTY = 0.8f;
+    
+    // Features are extracted from the decoder in blocks; only the head of the
+    // waveform is kept for refinement, so long windows do not hold their samples
+    constexpr size_t STREAM_BLOCK_SAMPLES = 65536;
+    constexpr double WAVEFORM_KEEP_SECONDS = 120.0;
+    
+    // Onset voting: pairs match within the tolerance (about 23 ms at 44.1 kHz);
+    // the strongest histogram bins are rescored exactly
+    constexpr long ONSET_TOLERANCE_SAMPLES = 1000;
+    constexpr size_t ONSET_CANDIDATE_BINS = 5;
+    
+    // Content classification: speech has at most a syllable rate of onsets,
+    // rhythmic music sits above a few per second
+    constexpr double SPEECH_MAX_ONSET_RATE = 6.0;    // Onsets per second
+    constexpr double MUSIC_MIN_ONSET_RATE = 4.0;
+    
+    // STANDARD budget: prune near-zero weights, run two algorithms per stage
+    // and stop once the combined confidence is high
+    constexpr float STANDARD_MIN_WEIGHT = 0.1f;
+    constexpr size_t STANDARD_STAGE_SIZE = 2;
+    constexpr float EARLY_EXIT_DISABLED = 2.0f;
+    
+    // Coarse-to-fine DTW: scales 8, 4, 2, 1 and search radius around the projected path
+    constexpr size_t DTW_PYRAMID_LEVELS = 4;
+    constexpr size_t DTW_MIN_COARSE_FRAMES = 32;
+    constexpr size_t DTW_REFINEMENT_RADIUS = 8;
+    
+    // Subsequence DTW locates the reference inside the search window. When
+    // both windows are equally long only the middle half of the reference is
+    // aligned, which leaves room for offsets up to a quarter of the window.
+    constexpr double DTW_MAX_QUERY_FRACTION = 0.75;
+    constexpr double DTW_EQUAL_WINDOW_TRIM = 0.25;
+    
+    // Confidence compares the mean cost per path step with the mean distance
+    // between unrelated frames: matching material stays near a tenth of it,
+    // while an unrelated reference still warps onto a path at about 0.4 of it
+    constexpr float DTW_UNRELATED_COST_RATIO = 0.5f;
+    constexpr size_t DTW_BASELINE_PAIRS = 4096;
 }
 
 // ===========================
@@ -199,129 +185,244 @@ SyncResult CrossCorrelationSync::synchronize(const AudioFeatures& features1,
     SyncResult result;
     result.algorithm = getName();
     
-    // Use energy features for cross-correlation
-    const auto& signal1 = features1.energy;
-    const auto& signal2 = features2.energy;
-    
-    if (signal1.empty() || signal2.empty()) {
+    const size_t hop = features1.hopSize;
+    if (features1.energy.empty() || features2.energy.empty() || hop == 0 ||
+        features2.hopSize != hop || features1.sampleRate != features2.sampleRate) {
         result.confidence = 0.0f;
         return result;
     }
     
-    // Compute normalized cross-correlation
-    auto correlation = computeNormalizedCrossCorrelation(signal1, signal2);
+    // Level 1: decimated envelopes over the full search range
+    auto envelope1 = decimateEnvelope(features1.energy, ENVELOPE_DECIMATION);
+    auto envelope2 = decimateEnvelope(features2.energy, ENVELOPE_DECIMATION);
+    const size_t coarseUnit = hop * ENVELOPE_DECIMATION;
+    const int maxCoarseLag = static_cast<int>(MAX_OFFSET_SAMPLES / coarseUnit);
     
-    // Find peak
-    auto maxIt = std::max_element(correlation.begin(), correlation.end());
-    if (maxIt != correlation.end()) {
-        size_t maxIndex = std::distance(correlation.begin(), maxIt);
-        float maxValue = *maxIt;
-        
-        // Convert to time offset
-        int offsetSamples = static_cast<int>(maxIndex) - static_cast<int>(signal1.size());
-        result.offset = offsetSamples / features1.sampleRate;
-        
-        // Confidence based on peak height and sharpness
-        result.confidence = std::min(1.0f, maxValue);
-        
-        // Improve confidence with parabolic interpolation
-        if (maxIndex > 0 && maxIndex < correlation.size() - 1) {
-            float y1 = correlation[maxIndex - 1];
-            float y2 = correlation[maxIndex];
-            float y3 = correlation[maxIndex + 1];
-            
-            float a = (y1 - 2*y2 + y3) / 2;
-            if (std::abs(a) > 1e-6f) {
-                float correction = -(y3 - y1) / (4 * a);
-                result.offset += correction / features1.sampleRate;
-                result.confidence *= 1.1f; // Bonus for sub-sample precision
-            }
-        }
+    int coarseLag = 0;
+    float coarsePeak = 0.0f;
+    if (!findPeak(correlateLags(envelope1, envelope2, -maxCoarseLag, maxCoarseLag),
+                  -maxCoarseLag, coarseLag, coarsePeak)) {
+        result.confidence = 0.0f;
+        return result;
     }
     
+    // Level 2: hop-rate envelope around the coarse peak
+    auto hopEnvelope1 = decimateEnvelope(features1.energy, 1);
+    auto hopEnvelope2 = decimateEnvelope(features2.energy, 1);
+    const int hopCentre = coarseLag * static_cast<int>(ENVELOPE_DECIMATION);
+    const int hopRadius = static_cast<int>(ENVELOPE_DECIMATION);
+    int hopLag = hopCentre;
+    float hopPeak = 0.0f;
+    auto hopCorrelation = correlateLags(hopEnvelope1, hopEnvelope2,
+                                        hopCentre - hopRadius, hopCentre + hopRadius);
+    if (!findPeak(hopCorrelation, hopCentre - hopRadius, hopLag, hopPeak)) {
+        hopLag = hopCentre;
+    }
+    double lagSamples = static_cast<double>(hopLag) * hop;
+    
+    // Level 3: full-rate waveform within +-1 hop of the envelope peak
+    bool refined = false;
+    float refinedPeak = 0.0f;
+    if (!features1.waveform.empty() && !features2.waveform.empty()) {
+        refined = refineWithWaveform(features1, features2, hopLag * static_cast<long>(hop),
+                                     lagSamples, refinedPeak);
+    }
+    
+    // The peak of the stage that placed the lag is how well it lines up
+    result.offset = lagSamples / features1.sampleRate;
+    result.confidence = std::clamp(refined ? refinedPeak : coarsePeak, 0.0f, 1.0f);
+    
     auto end = std::chrono::high_resolution_clock::now();
     result.computationTime = std::chrono::duration<double>(end - start).count();
     
     return result;
 }
 
-std::vector<float> CrossCorrelationSync::computeNormalizedCrossCorrelation(
-    const std::vector<float>& signal1, const std::vector<float>& signal2) {
+std::vector<float> CrossCorrelationSync::decimateEnvelope(const std::vector<float>& envelope,
+                                                          size_t factor) {
+    // Box-filter decimation, then mean removal so silence does not correlate
+    std::vector<float> decimated(envelope.size() / factor);
+    double mean = 0.0;
+    for (size_t i = 0; i < decimated.size(); ++i) {
+        float sum = 0.0f;
+        for (size_t k = 0; k < factor; ++k) {
+            sum += envelope[i * factor + k];
+        }
+        decimated[i] = sum / factor;
+        mean += decimated[i];
+    }
+    if (!decimated.empty()) {
+        mean /= decimated.size();
+        for (auto& value : decimated) {
+            value -= static_cast<float>(mean);
+        }
+    }
+    return decimated;
+}
+
+bool CrossCorrelationSync::findPeak(const std::vector<float>& correlation, int firstLag,
+                                    int& lag, float& peak) {
+    auto maxIt = std::max_element(correlation.begin(), correlation.end());
+    if (maxIt == correlation.end() || *maxIt <= 0.0f) {
+        return false;
+    }
+    lag = firstLag + static_cast<int>(std::distance(correlation.begin(), maxIt));
+    peak = *maxIt;
+    return true;
+}
+
+bool CrossCorrelationSync::refineWithWaveform(const AudioFeatures& features1,
+                                              const AudioFeatures& features2,
+                                              long envelopeLag, double& lagSamples,
+                                              float& peakCorrelation) {
+    const auto& wave1 = features1.waveform;
+    const auto& wave2 = features2.waveform;
+    const long radius = static_cast<long>(features1.hopSize);
+    const long len1 = static_cast<long>(wave1.size());
+    const long len2 = static_cast<long>(wave2.size());
+    
+    // Segment of wave1 at [a, a + length) against wave2 at
+    // [a + envelopeLag - radius, a + envelopeLag + radius + length)
+    const long first = std::max(0L, radius - envelopeLag);
+    const long length = std::min<long>(REFINE_SEGMENT_SAMPLES,
+                                       std::min(len1, len2 - envelopeLag - radius) - first);
+    if (length < 4 * radius) {
+        return false;
+    }
+    const long last = std::min(len1, len2 - envelopeLag - radius) - length;
+    
+    // Most energetic segment position, on hop granularity from the envelope
+    const auto& energy = features1.energy;
+    const size_t hop = features1.hopSize;
+    const size_t segmentHops = static_cast<size_t>(length) / hop;
+    ScratchArena::Scope scope;
+    ScratchVector<double> power(energy.size() + 1, 0.0, &scope.arena());
+    for (size_t h = 0; h < energy.size(); ++h) {
+        power[h + 1] = power[h] + energy[h] * energy[h];
+    }
     
-    size_t len1 = signal1.size();
-    size_t len2 = signal2.size();
-    size_t resultSize = len1 + len2 - 1;
+    long segmentStart = first;
+    double bestPower = -1.0;
+    for (size_t h = (static_cast<size_t>(first) + hop - 1) / hop;
+         static_cast<long>(h * hop) <= last && h + segmentHops < power.size(); ++h) {
+        double segmentPower = power[h + segmentHops] - power[h];
+        if (segmentPower > bestPower) {
+            bestPower = segmentPower;
+            segmentStart = static_cast<long>(h * hop);
+        }
+    }
     
-    // Pad to power of 2 for efficient FFT
-    size_t fftSize = 1;
-    while (fftSize < resultSize) fftSize <<= 1;
+    std::span<const float> segment1(wave1.data() + segmentStart, static_cast<size_t>(length));
+    std::span<const float> segment2(wave2.data() + segmentStart + envelopeLag - radius,
+                                    static_cast<size_t>(length + 2 * radius));
+    auto correlation = correlateLags(segment1, segment2, 0, static_cast<int>(2 * radius));
     
-    std::vector<float> padded1(fftSize, 0.0f);
-    std::vector<float> padded2(fftSize, 0.0f);
+    int peakIndex = 0;
+    float peak = 0.0f;
+    if (!findPeak(correlation, 0, peakIndex, peak) || peak < REFINE_MIN_CORRELATION) {
+        return false;
+    }
+    peakCorrelation = peak;
+    
+    // Parabolic interpolation for a sub-sample peak
+    double fraction = 0.0;
+    if (peakIndex > 0 && peakIndex + 1 < static_cast<int>(correlation.size())) {
+        float y1 = correlation[peakIndex - 1];
+        float y2 = correlation[peakIndex];
+        float y3 = correlation[peakIndex + 1];
+        float a = (y1 - 2 * y2 + y3) / 2;
+        if (std::abs(a) > 1e-6f) {
+            fraction = std::clamp(-(y3 - y1) / (4 * a), -0.5f, 0.5f);
+        }
+    }
     
-    std::copy(signal1.begin(), signal1.end(), padded1.begin());
-    std::copy(signal2.begin(), signal2.end(), padded2.begin());
+    lagSamples = static_cast<double>(envelopeLag - radius + peakIndex) + fraction;
+    return true;
+}
+
+std::vector<float> CrossCorrelationSync::correlateLags(std::span<const float> signal1,
+                                                       std::span<const float> signal2,
+                                                       int minLag, int maxLag) {
+    const long len1 = static_cast<long>(signal1.size());
+    const long len2 = static_cast<long>(signal2.size());
+    
+    if (len1 == 0 || len2 == 0 || minLag > maxLag) {
+        return {};
+    }
+    std::vector<float> correlation(static_cast<size_t>(maxLag - minLag + 1), 0.0f);
+    
+    // Only lags that leave at least half of the shorter signal overlapping
+    // are scored; the rest stay 0
+    const long minOverlap = std::max(1L, std::min(len1, len2) / 2);
+    const int firstLag = static_cast<int>(std::max<long>(minLag, minOverlap - len1));
+    const int lastLag = static_cast<int>(std::min<long>(maxLag, len2 - minOverlap));
+    if (firstLag > lastLag) {
+        return correlation;
+    }
     
-    // Compute FFTs
-    std::vector<std::complex<float>> fft1, fft2;
+    // Raw sum x1[n] * x2[n + k]; the FFT covers len1 + len2 - 1 so no lag wraps
+    size_t fftSize = 1;
+    while (fftSize < static_cast<size_t>(len1 + len2 - 1)) fftSize <<= 1;
     
     try {
-        fftw::FFTProcessor processor(fftSize);
-        processor.forward(padded1, fft1);
-        processor.forward(padded2, fft2);
-        
-        // Compute cross-correlation in frequency domain
-        std::vector<std::complex<float>> crossCorr(fft1.size());
-        for (size_t i = 0; i < fft1.size(); ++i) {
-            crossCorr[i] = fft1[i] * std::conj(fft2[i]);
+        // Reuse the member processor and scratch; plans come from the shared cache
+        if (!fftProcessor || fftProcessor->getSize() != fftSize) {
+            fftProcessor = std::make_unique<fftw::FFTProcessor>(fftSize);
         }
+        paddedScratch1.resize(fftSize);
+        paddedScratch2.resize(fftSize);
+        spectrumScratch1.resize(fftProcessor->getSpectrumSize());
+        spectrumScratch2.resize(fftProcessor->getSpectrumSize());
+        correlationScratch.resize(fftSize);
         
-        // Inverse FFT
-        std::vector<float> result;
-        processor.inverse(crossCorr, result);
+        std::fill(std::copy(signal1.begin(), signal1.end(), paddedScratch1.begin()),
+                  paddedScratch1.end(), 0.0f);
+        std::fill(std::copy(signal2.begin(), signal2.end(), paddedScratch2.begin()),
+                  paddedScratch2.end(), 0.0f);
         
-        // Extract relevant part and normalize
-        std::vector<float> normalized(resultSize);
-        for (size_t i = 0; i < resultSize; ++i) {
-            normalized[i] = result[i];
-        }
+        fftProcessor->forward(paddedScratch1, spectrumScratch1);
+        fftProcessor->forward(paddedScratch2, spectrumScratch2);
         
-        // Normalize by local energy
-        float norm1 = std::sqrt(std::inner_product(signal1.begin(), signal1.end(), 
-                                                  signal1.begin(), 0.0f));
-        float norm2 = std::sqrt(std::inner_product(signal2.begin(), signal2.end(), 
-                                                  signal2.begin(), 0.0f));
+        // conj(X1) * X2 puts lag k at index k (negative lags wrap to the end);
+        // the 1/N inverse scaling is folded into the product
+        fftw::FFTProcessor::conjugateMultiply(spectrumScratch1, spectrumScratch2,
+                                              spectrumScratch1, 1.0f / fftSize);
+        fftProcessor->inverse(spectrumScratch1, correlationScratch);
         
-        if (norm1 > 0 && norm2 > 0) {
-            float normFactor = norm1 * norm2;
-            for (auto& val : normalized) {
-                val /= normFactor;
-            }
+        for (int lag = firstLag; lag <= lastLag; ++lag) {
+            correlation[lag - minLag] = correlationScratch[lag >= 0 ? lag : fftSize + lag];
         }
-        
-        return normalized;
-        
     } catch (const std::exception& e) {
-        // Fallback to simple time-domain correlation
-        std::vector<float> result(resultSize, 0.0f);
-        
-        for (size_t lag = 0; lag < resultSize; ++lag) {
+        // Fallback to direct time-domain correlation over the scored lags
+        for (int lag = firstLag; lag <= lastLag; ++lag) {
+            const long lo = std::max(0L, -static_cast<long>(lag));
+            const long hi = std::min(len1, len2 - lag);
             float sum = 0.0f;
-            size_t count = 0;
-            
-            for (size_t i = 0; i < len1; ++i) {
-                int j = static_cast<int>(i) + static_cast<int>(lag) - static_cast<int>(len1);
-                if (j >= 0 && j < static_cast<int>(len2)) {
-                    sum += signal1[i] * signal2[j];
-                    count++;
-                }
+            for (long n = lo; n < hi; ++n) {
+                sum += signal1[n] * signal2[n + lag];
             }
-            
-            result[lag] = count > 0 ? sum / count : 0.0f;
+            correlation[lag - minLag] = sum;
         }
-        
-        return result;
     }
+    
+    // Normalize every lag by the energy of the overlapping parts only, so
+    // windows of different lengths still peak near 1
+    ScratchArena::Scope scope;
+    ScratchArena& scratch = scope.arena();
+    ScratchVector<double> energy1(len1 + 1, 0.0, &scratch);
+    ScratchVector<double> energy2(len2 + 1, 0.0, &scratch);
+    for (long n = 0; n < len1; ++n) energy1[n + 1] = energy1[n] + signal1[n] * signal1[n];
+    for (long n = 0; n < len2; ++n) energy2[n + 1] = energy2[n] + signal2[n] * signal2[n];
+    
+    for (int lag = firstLag; lag <= lastLag; ++lag) {
+        const long lo = std::max(0L, -static_cast<long>(lag));
+        const long hi = std::min(len1, len2 - lag);
+        double norm = (energy1[hi] - energy1[lo]) * (energy2[hi + lag] - energy2[lo + lag]);
+        float& value = correlation[lag - minLag];
+        value = norm > 0.0 ? static_cast<float>(value / std::sqrt(norm)) : 0.0f;
+    }
+    
+    return correlation;
 }
 
 float CrossCorrelationSync::getExpectedAccuracy(AudioContent content) const {
@@ -339,129 +440,64 @@ float CrossCorrelationSync::getExpectedAccuracy(AudioContent content) const {
 // DTW Sync Implementation
 // ===========================
 
-DTWSync::DTWSync(size_t maxWarpingWindow, float slopeConstraint) 
-    : maxWarpingWindow(maxWarpingWindow), slopeConstraint(slopeConstraint), useMultiScale(true) {}
+DTWSync::DTWSync(size_t maxWarpingWindow) 
+    : maxWarpingWindow(maxWarpingWindow), engine(maxWarpingWindow) {}
 
-SyncResult DTWSync::synchronize(const AudioFeatures& features1, 
-                               const AudioFeatures& features2) {
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    if (useMultiScale) {
-        auto result = multiScaleDTW(features1, features2);
-        auto end = std::chrono::high_resolution_clock::now();
-        result.computationTime = std::chrono::duration<double>(end - start).count();
-        return result;
-    }
-    
-    SyncResult result;
-    result.algorithm = getName();
-    
-    // Use MFCC features for DTW
-    const auto& mfcc1 = features1.mfcc;
-    const auto& mfcc2 = features2.mfcc;
-    
-    if (mfcc1.empty() || mfcc2.empty()) {
-        result.confidence = 0.0f;
-        return result;
+namespace {
+    // Mean distance between query and search frames paired without regard to
+    // time, sampled on a fixed stride so results are reproducible
+    float unrelatedFrameCost(std::span<const float> query, std::span<const float> search, size_t dim) {
+        const size_t frames1 = query.size() / dim;
+        const size_t frames2 = search.size() / dim;
+        const auto distance = simd::kernels().squaredDistance;
+        const size_t pairs = std::min(DTW_BASELINE_PAIRS, frames1 * frames2);
+        double total = 0.0;
+        for (size_t n = 0; n < pairs; ++n) {
+            const size_t i = (n * frames1) / pairs;
+            const size_t j = (n * 7919 + frames2 / 2) % frames2;
+            total += std::sqrt(distance(query.data() + i * dim, search.data() + j * dim, dim));
+        }
+        return pairs > 0 ? static_cast<float>(total / pairs) : 0.0f;
     }
     
-    // Compute DTW matrix
-    auto dtwMatrix = computeDTWMatrix(mfcc1, mfcc2);
-    
-    // Traceback to find optimal path
-    auto path = traceback(dtwMatrix);
-    
-    if (!path.empty()) {
-        // Calculate average offset from path
-        double totalOffset = 0.0;
-        for (const auto& point : path) {
-            totalOffset += static_cast<double>(point.second) - static_cast<double>(point.first);
+    // Offset from the median diagonal of a query/search path, confidence from
+    // its cost per step relative to unrelated frames
+    void dtwPathResult(const DTWEngine::Path& path, float cost, size_t queryStart,
+                       std::span<const float> query, std::span<const float> search, size_t dim,
+                       size_t hop, double sampleRate, SyncResult& result) {
+        if (path.empty() || !std::isfinite(cost)) {
+            result.confidence = 0.0f;
+            return;
         }
         
-        double avgOffset = totalOffset / path.size();
-        result.offset = avgOffset / features1.sampleRate * MFCC_HOP_SIZE;
+        std::vector<long> diagonals;
+        diagonals.reserve(path.size());
+        for (const auto& point : path) {
+            diagonals.push_back(static_cast<long>(point.second) - static_cast<long>(point.first + queryStart));
+        }
+        const auto middle = diagonals.begin() + diagonals.size() / 2;
+        std::nth_element(diagonals.begin(), middle, diagonals.end());
+        result.offset = static_cast<double>(*middle) * static_cast<double>(hop) / sampleRate;
         
-        // Confidence based on path consistency and final cost
-        float finalCost = dtwMatrix[mfcc1.size()-1][mfcc2.size()-1];
-        result.confidence = std::max(0.0f, 1.0f - finalCost / 10.0f); // Normalize cost
-    }
-    
-    auto end = std::chrono::high_resolution_clock::now();
-    result.computationTime = std::chrono::duration<double>(end - start).count();
-    
-    return result;
-}
-
-std::vector<std::vector<float>> DTWSync::computeDTWMatrix(
-    const std::vector<float>& features1, const std::vector<float>& features2) {
-    
-    size_t len1 = features1.size();
-    size_t len2 = features2.size();
-    
-    // Initialize DTW matrix
-    std::vector<std::vector<float>> dtw(len1, std::vector<float>(len2, std::numeric_limits<float>::infinity()));
-    
-    // Initialize first cell
-    dtw[0][0] = std::abs(features1[0] - features2[0]);
-    
-    // Fill first row and column
-    for (size_t i = 1; i < len1; ++i) {
-        dtw[i][0] = dtw[i-1][0] + std::abs(features1[i] - features2[0]);
-    }
-    for (size_t j = 1; j < len2; ++j) {
-        dtw[0][j] = dtw[0][j-1] + std::abs(features1[0] - features2[j]);
+        const float baseline = unrelatedFrameCost(query, search, dim);
+        const float ratio = baseline > 0.0f ? cost / path.size() / baseline : 1.0f;
+        result.confidence = std::clamp(1.0f - ratio / DTW_UNRELATED_COST_RATIO, 0.0f, 1.0f);
     }
     
-    // Fill the rest with slope constraints
-    for (size_t i = 1; i < len1; ++i) {
-        size_t jStart = std::max(1UL, static_cast<size_t>(i / slopeConstraint));
-        size_t jEnd = std::min(len2, static_cast<size_t>(i * slopeConstraint) + 1);
-        
-        for (size_t j = jStart; j < jEnd; ++j) {
-            float cost = std::abs(features1[i] - features2[j]);
-            float minPrev = std::min({dtw[i-1][j], dtw[i][j-1], dtw[i-1][j-1]});
-            dtw[i][j] = cost + minPrev;
-        }
+    // Part of the reference aligned against the search window (see DTW_EQUAL_WINDOW_TRIM)
+    size_t dtwQueryStart(size_t frames1, size_t frames2) {
+        const bool shorter = static_cast<double>(frames1) <= DTW_MAX_QUERY_FRACTION * static_cast<double>(frames2);
+        return shorter ? 0 : static_cast<size_t>(DTW_EQUAL_WINDOW_TRIM * static_cast<double>(frames1));
     }
-    
-    return dtw;
 }
 
-std::vector<std::pair<size_t, size_t>> DTWSync::traceback(
-    const std::vector<std::vector<float>>& dtwMatrix) {
-    
-    std::vector<std::pair<size_t, size_t>> path;
-    
-    size_t i = dtwMatrix.size() - 1;
-    size_t j = dtwMatrix[0].size() - 1;
-    
-    while (i > 0 || j > 0) {
-        path.emplace_back(i, j);
-        
-        if (i == 0) {
-            j--;
-        } else if (j == 0) {
-            i--;
-        } else {
-            // Find minimum predecessor
-            float diagonal = dtwMatrix[i-1][j-1];
-            float vertical = dtwMatrix[i-1][j];
-            float horizontal = dtwMatrix[i][j-1];
-            
-            if (diagonal <= vertical && diagonal <= horizontal) {
-                i--; j--;
-            } else if (vertical <= horizontal) {
-                i--;
-            } else {
-                j--;
-            }
-        }
-    }
-    
-    path.emplace_back(0, 0);
-    std::reverse(path.begin(), path.end());
-    
-    return path;
+SyncResult DTWSync::synchronize(const AudioFeatures& features1, 
+                               const AudioFeatures& features2) {
+    auto start = std::chrono::high_resolution_clock::now();
+    auto result = multiScaleDTW(features1, features2);
+    auto end = std::chrono::high_resolution_clock::now();
+    result.computationTime = std::chrono::duration<double>(end - start).count();
+    return result;
 }
 
 SyncResult DTWSync::multiScaleDTW(const AudioFeatures& features1, 
@@ -469,52 +505,57 @@ SyncResult DTWSync::multiScaleDTW(const AudioFeatures& features1,
     SyncResult result;
     result.algorithm = getName() + "_MultiScale";
     
-    // Multi-scale processing: 8x, 4x, 2x, 1x downsampling
-    std::vector<int> scales = {8, 4, 2, 1};
-    double currentOffset = 0.0;
+    const auto& mfcc1 = features1.mfcc;
+    const auto& mfcc2 = features2.mfcc;
+    const size_t dim = std::max<size_t>(1, features1.mfccCoefficients);
+    const size_t hop = features1.hopSize;
+    if (mfcc1.empty() || mfcc2.empty() || features2.mfccCoefficients != features1.mfccCoefficients ||
+        hop == 0 || features2.hopSize != hop || features1.sampleRate != features2.sampleRate) {
+        result.confidence = 0.0f;
+        return result;
+    }
     
-    for (int scale : scales) {
-        // Downsample MFCC features
-        std::vector<float> downsampled1, downsampled2;
-        
-        for (size_t i = 0; i < features1.mfcc.size(); i += scale) {
-            downsampled1.push_back(features1.mfcc[i]);
-        }
-        for (size_t i = 0; i < features2.mfcc.size(); i += scale) {
-            downsampled2.push_back(features2.mfcc[i]);
-        }
-        
-        if (downsampled1.empty() || downsampled2.empty()) continue;
-        
-        // Compute DTW at this scale
-        auto dtwMatrix = computeDTWMatrix(downsampled1, downsampled2);
-        auto path = traceback(dtwMatrix);
-        
-        if (!path.empty()) {
-            double scaleOffset = 0.0;
-            for (const auto& point : path) {
-                scaleOffset += static_cast<double>(point.second) - static_cast<double>(point.first);
-            }
-            scaleOffset = (scaleOffset / path.size()) * scale;
-            
-            // Refine previous estimate
-            currentOffset = (currentOffset + scaleOffset) / 2.0;
-            
-            // Update confidence based on path consistency
-            float pathVariance = 0.0f;
-            double avgOffset = scaleOffset / path.size();
-            for (const auto& point : path) {
-                double pointOffset = static_cast<double>(point.second) - static_cast<double>(point.first);
-                pathVariance += (pointOffset - avgOffset) * (pointOffset - avgOffset);
-            }
-            pathVariance /= path.size();
-            
-            result.confidence = std::max(result.confidence, 
-                                       std::max(0.0f, 1.0f - pathVariance / 100.0f));
+    // The reference (or its middle half) is located inside the search window
+    const size_t frames1 = mfcc1.size() / dim;
+    const size_t queryStart = dtwQueryStart(frames1, mfcc2.size() / dim);
+    const size_t queryFrames = frames1 - 2 * queryStart;
+    std::span<const float> query = std::span<const float>(mfcc1).subspan(queryStart * dim, queryFrames * dim);
+    
+    // Feature pyramid up to 8x coarser: each level averages frame pairs of the
+    // level below. Stop early if the coarsest level would get too short.
+    ScratchArena::Scope scope;
+    ScratchArena& scratch = scope.arena();
+    ScratchVector<ScratchVector<float>> pyramid1(&scratch);
+    ScratchVector<ScratchVector<float>> pyramid2(&scratch);
+    std::span<const float> level1(query);
+    std::span<const float> level2(mfcc2);
+    while (pyramid1.size() < DTW_PYRAMID_LEVELS - 1 &&
+           std::min(level1.size(), level2.size()) / dim / 2 >= DTW_MIN_COARSE_FRAMES) {
+        pyramid1.push_back(DTWEngine::downsample(level1, dim, &scratch));
+        pyramid2.push_back(DTWEngine::downsample(level2, dim, &scratch));
+        level1 = pyramid1.back();
+        level2 = pyramid2.back();
+    }
+    
+    // Every column is open only at the coarsest scale
+    DTWEngine::Path path;
+    float cost = engine.computeSubsequencePath(level1, level2, path, dim);
+    
+    // Refine towards full resolution, only evaluating cells near the projected
+    // path and within the warping window (scaled to each level) of its diagonal
+    for (size_t level = pyramid1.size(); level-- > 0 && !path.empty();) {
+        if (maxWarpingWindow > 0) {
+            engine.setBandRadius(std::max<size_t>(1, maxWarpingWindow >> level));
         }
+        std::span<const float> finer1 = level > 0 ? std::span<const float>(pyramid1[level - 1]) : query;
+        std::span<const float> finer2 = level > 0 ? std::span<const float>(pyramid2[level - 1])
+                                                  : std::span<const float>(mfcc2);
+        DTWEngine::Path refined;
+        cost = engine.computeSubsequencePathAround(finer1, finer2, path, 2, DTW_REFINEMENT_RADIUS, refined, dim);
+        path.swap(refined);
     }
     
-    result.offset = currentOffset / features1.sampleRate * MFCC_HOP_SIZE;
+    dtwPathResult(path, cost, queryStart, query, mfcc2, dim, hop, features1.sampleRate, result);
     return result;
 }
 
@@ -546,16 +587,24 @@ SyncResult OnsetSync::synchronize(const AudioFeatures& features1,
     const auto& onsets1 = features1.onsets;
     const auto& onsets2 = features2.onsets;
     
-    if (onsets1.size() < 3 || onsets2.size() < 3) {
+    if (onsets1.size() < 3 || onsets2.size() < 3 || features1.sampleRate <= 0.0) {
         result.confidence = 0.0f;
         return result;
     }
     
-    result.offset = alignOnsets(onsets1, onsets2);
+    size_t support = 0;
+    double offsetSamples = alignOnsets(onsets1, onsets2, support);
+    result.offset = offsetSamples / features1.sampleRate;
     
-    // Confidence based on number of onsets and their distribution
+    // Confidence: share of onsets explained by the offset, beyond what a
+    // random offset would match at this onset density
     size_t minOnsets = std::min(onsets1.size(), onsets2.size());
-    result.confidence = std::min(1.0f, minOnsets / 10.0f);
+    double length2 = features2.hopSize > 0
+        ? static_cast<double>(features2.frameCount * features2.hopSize)
+        : static_cast<double>(onsets2.back() + 1);
+    double chance = std::min(0.99, onsets2.size() * 2.0 * ONSET_TOLERANCE_SAMPLES / std::max(1.0, length2));
+    double matched = static_cast<double>(support) / minOnsets;
+    result.confidence = static_cast<float>(std::clamp((matched - chance) / (1.0 - chance), 0.0, 1.0));
     
     auto end = std::chrono::high_resolution_clock::now();
     result.computationTime = std::chrono::duration<double>(end - start).count();
@@ -564,37 +613,76 @@ SyncResult OnsetSync::synchronize(const AudioFeatures& features1,
 }
 
 double OnsetSync::alignOnsets(const std::vector<size_t>& onsets1, 
-                             const std::vector<size_t>& onsets2) {
+                             const std::vector<size_t>& onsets2,
+                             size_t& support) {
+    support = 0;
     if (onsets1.empty() || onsets2.empty()) return 0.0;
     
-    // Try different alignments and find the best match
-    double bestOffset = 0.0;
-    int bestScore = 0;
+    // Onsets come out of the extractor in order; sort defensively otherwise
+    ScratchArena::Scope scope;
+    ScratchArena& scratch = scope.arena();
+    auto sorted = [&scratch](const std::vector<size_t>& onsets) {
+        ScratchVector<long> values(onsets.begin(), onsets.end(), &scratch);
+        if (!std::is_sorted(values.begin(), values.end())) {
+            std::sort(values.begin(), values.end());
+        }
+        return values;
+    };
+    const auto first = sorted(onsets1);
+    const auto second = sorted(onsets2);
+    
+    // Every pair within the search range votes for its offset. The window
+    // of partners only moves forward, so a two-pointer sweep finds it.
+    const long maxOffset = static_cast<long>(MAX_OFFSET_SAMPLES);
+    const long binWidth = ONSET_TOLERANCE_SAMPLES / 2;
+    const size_t binCount = static_cast<size_t>(2 * maxOffset / binWidth) + 1;
+    ScratchVector<uint32_t> votes(binCount, 0, &scratch);
+    
+    size_t lo = 0;
+    for (long onset : first) {
+        while (lo < second.size() && second[lo] < onset - maxOffset) ++lo;
+        for (size_t j = lo; j < second.size() && second[j] <= onset + maxOffset; ++j) {
+            votes[static_cast<size_t>((second[j] - onset + maxOffset) / binWidth)]++;
+        }
+    }
     
-    for (size_t i = 0; i < std::min(onsets1.size(), size_t(5)); ++i) {
-        for (size_t j = 0; j < std::min(onsets2.size(), size_t(5)); ++j) {
-            double offset = static_cast<double>(onsets2[j]) - static_cast<double>(onsets1[i]);
-            
-            // Count matching onsets within tolerance
-            int score = 0;
-            const double tolerance = 1000.0; // samples (about 23ms at 44.1kHz)
-            
-            for (size_t k = 0; k < onsets1.size(); ++k) {
-                double expectedPos = onsets1[k] + offset;
-                
-                for (size_t l = 0; l < onsets2.size(); ++l) {
-                    if (std::abs(onsets2[l] - expectedPos) < tolerance) {
-                        score++;
-                        break;
-                    }
-                }
-            }
-            
-            if (score > bestScore) {
-                bestScore = score;
-                bestOffset = offset;
+    // A tolerance-wide match spans neighbouring bins, so peaks are judged on
+    // the three-bin sum
+    ScratchVector<uint32_t> smoothed(binCount, 0, &scratch);
+    for (size_t b = 0; b < binCount; ++b) {
+        smoothed[b] = votes[b] + (b > 0 ? votes[b - 1] : 0) + (b + 1 < binCount ? votes[b + 1] : 0);
+    }
+    ScratchVector<size_t> candidates(binCount, &scratch);
+    std::iota(candidates.begin(), candidates.end(), 0);
+    const size_t candidateCount = std::min(ONSET_CANDIDATE_BINS, binCount);
+    std::partial_sort(candidates.begin(), candidates.begin() + candidateCount, candidates.end(),
+                      [&](size_t a, size_t b) { return smoothed[a] > smoothed[b]; });
+    
+    // Score the strongest bins exactly: a two-pointer merge pairs each
+    // shifted onset with at most one partner inside the tolerance
+    double bestOffset = 0.0;
+    for (size_t c = 0; c < candidateCount && smoothed[candidates[c]] > 0; ++c) {
+        const double offset = static_cast<double>(candidates[c]) * binWidth - maxOffset + binWidth / 2.0;
+        
+        size_t matches = 0;
+        double residualSum = 0.0;
+        size_t j = 0;
+        for (long onset : first) {
+            const double expected = onset + offset;
+            while (j < second.size() && second[j] < expected - ONSET_TOLERANCE_SAMPLES) ++j;
+            if (j == second.size()) break;
+            const double residual = second[j] - expected;
+            if (std::abs(residual) <= ONSET_TOLERANCE_SAMPLES) {
+                matches++;
+                residualSum += residual;
+                ++j;
             }
         }
+        
+        if (matches > support) {
+            support = matches;
+            bestOffset = offset + residualSum / matches;
+        }
     }
     
     return bestOffset;
@@ -615,8 +703,8 @@ float OnsetSync::getExpectedAccuracy(AudioContent content) const {
 // Spectral Correlation Sync Implementation
 // ===========================
 
-SpectralCorrelationSync::SpectralCorrelationSync(size_t fftSize, size_t hopSize) 
-    : fftSize(fftSize), hopSize(hopSize) {
+SpectralCorrelationSync::SpectralCorrelationSync(size_t fftSize) 
+    : fftSize(fftSize) {
     fftProcessor = std::make_unique<fftw::FFTProcessor>(fftSize);
 }
 
@@ -629,51 +717,180 @@ SyncResult SpectralCorrelationSync::synchronize(const AudioFeatures& features1,
     SyncResult result;
     result.algorithm = getName();
     
-    // This would need the raw audio data, which we don't have in AudioFeatures
-    // For now, use spectral centroid as a proxy
-    const auto& centroid1 = features1.spectralCentroid;
-    const auto& centroid2 = features2.spectralCentroid;
-    
-    if (centroid1.empty() || centroid2.empty()) {
+    // Band frames lie on the extractor's hop grid; both inputs must share it
+    const size_t bands = features1.bandCount;
+    const size_t hop = features1.hopSize;
+    if (bands == 0 || features2.bandCount != bands ||
+        features1.bandEnergy.size() < 4 * bands || features2.bandEnergy.size() < 4 * bands ||
+        hop == 0 || features2.hopSize != hop || features1.sampleRate != features2.sampleRate) {
         result.confidence = 0.0f;
         return result;
     }
     
-    // Find best correlation of spectral centroids
-    size_t maxLag = std::min(centroid1.size(), centroid2.size()) / 2;
-    float bestCorr = -1.0f;
+    const size_t frames1 = features1.bandEnergy.size() / bands;
+    const size_t frames2 = features2.bandEnergy.size() / bands;
+    const size_t minFrames = std::min(frames1, frames2);
+    const int maxLag = static_cast<int>(std::min(std::max(frames1, frames2) - 1,
+                                                 MAX_OFFSET_SAMPLES / hop));
+    
+    auto correlation = computeBandCrossCorrelation(features1, features2);
+    const int size = static_cast<int>(correlation.size());
+    
+    // Overlap-compensated score per lag; lags with less than half the
+    // shorter sequence in common are not trusted
+    auto scoreAt = [&](int lag) -> float {
+        int overlap = std::min<int>(frames1, static_cast<int>(frames2) - lag) - std::max(0, -lag);
+        if (overlap < static_cast<int>(minFrames / 2) || overlap <= 0) {
+            return -std::numeric_limits<float>::infinity();
+        }
+        float value = correlation[lag >= 0 ? lag : size + lag];
+        return value * static_cast<float>(minFrames) / overlap;
+    };
+    
     int bestLag = 0;
-
-    for (int lag = -static_cast<int>(maxLag); lag <= static_cast<int>(maxLag); ++lag) {
-        float correlation = 0.0f;
-        int count = 0;
-
-        for (size_t i = 0; i < centroid1.size(); ++i) {
-            int j = static_cast<int>(i) + lag;
-            if (j >= 0 && j < static_cast<int>(centroid2.size())) {
-                correlation += centroid1[i] * centroid2[j];
-                count++;
-            }
+    float bestScore = -std::numeric_limits<float>::infinity();
+    for (int lag = -maxLag; lag <= maxLag; ++lag) {
+        float score = scoreAt(lag);
+        if (score > bestScore) {
+            bestScore = score;
+            bestLag = lag;
         }
-
-        if (count > 0) {
-            correlation /= count;
-            if (correlation > bestCorr) {
-                bestCorr = correlation;
-                bestLag = lag;
-            }
+    }
+    
+    if (!std::isfinite(bestScore)) {
+        result.confidence = 0.0f;
+        return result;
+    }
+    
+    // Sub-frame refinement with parabolic interpolation
+    double refinedLag = bestLag;
+    float left = scoreAt(bestLag - 1);
+    float right = scoreAt(bestLag + 1);
+    if (std::isfinite(left) && std::isfinite(right)) {
+        float a = (left - 2 * bestScore + right) / 2;
+        if (std::abs(a) > 1e-6f) {
+            refinedLag += std::clamp(-(right - left) / (4 * a), -0.5f, 0.5f);
         }
     }
-
-    result.offset = static_cast<double>(bestLag) * static_cast<double>(hopSize) / features1.sampleRate;
-    result.confidence = std::max(0.0f, bestCorr);
-
+    
+    result.offset = refinedLag * static_cast<double>(hop) / features1.sampleRate;
+    result.confidence = std::max(0.0f, computeSpectralSimilarity(features1.bandEnergy,
+                                                                 features2.bandEnergy,
+                                                                 bands, bestLag));
+    
     auto end = std::chrono::high_resolution_clock::now();
     result.computationTime = std::chrono::duration<double>(end - start).count();
     
     return result;
 }
 
+std::vector<float> SpectralCorrelationSync::computeBandCrossCorrelation(
+    const AudioFeatures& features1, const AudioFeatures& features2) {
+    
+    const size_t bands = features1.bandCount;
+    const size_t frames1 = features1.bandEnergy.size() / bands;
+    const size_t frames2 = features2.bandEnergy.size() / bands;
+    
+    size_t correlationSize = 1;
+    while (correlationSize < frames1 + frames2 - 1) correlationSize <<= 1;
+    
+    // Reuse the member processor and scratch whenever the padded length allows it
+    if (!fftProcessor || fftProcessor->getSize() != correlationSize) {
+        fftProcessor = std::make_unique<fftw::FFTProcessor>(correlationSize);
+    }
+    const size_t spectrumSize = fftProcessor->getSpectrumSize();
+    bandScratch1.resize(correlationSize);
+    bandScratch2.resize(correlationSize);
+    spectrumScratch1.resize(spectrumSize);
+    spectrumScratch2.resize(spectrumSize);
+    crossSpectrum.resize(spectrumSize);
+    std::fill(crossSpectrum.begin(), crossSpectrum.end(), std::complex<float>{});
+    
+    double energy1 = 0.0;
+    double energy2 = 0.0;
+    
+    // Mean-removed band trajectory, zero padded
+    auto loadBand = [bands](const std::vector<float>& matrix, size_t frames, size_t band,
+                            fftw::AlignedBuffer<float>& out) -> double {
+        double mean = 0.0;
+        for (size_t f = 0; f < frames; ++f) mean += matrix[f * bands + band];
+        mean /= frames;
+        
+        double energy = 0.0;
+        std::fill(out.begin() + frames, out.end(), 0.0f);
+        for (size_t f = 0; f < frames; ++f) {
+            out[f] = static_cast<float>(matrix[f * bands + band] - mean);
+            energy += static_cast<double>(out[f]) * out[f];
+        }
+        return energy;
+    };
+    
+    // Correlation is linear, so all bands accumulate into one cross-spectrum
+    // and a single inverse FFT yields the summed correlation
+    for (size_t band = 0; band < bands; ++band) {
+        energy1 += loadBand(features1.bandEnergy, frames1, band, bandScratch1);
+        energy2 += loadBand(features2.bandEnergy, frames2, band, bandScratch2);
+        
+        fftProcessor->forward(bandScratch1, spectrumScratch1);
+        fftProcessor->forward(bandScratch2, spectrumScratch2);
+        fftw::FFTProcessor::conjugateMultiplyAccumulate(spectrumScratch1, spectrumScratch2,
+                                                        crossSpectrum);
+    }
+    
+    std::vector<float> correlation(correlationSize);
+    fftProcessor->inverse(crossSpectrum, std::span<float>(correlation));
+    
+    // Inverse is unnormalized; remove the 1/N and the energy in one pass
+    const double norm = std::sqrt(energy1 * energy2) * correlationSize;
+    if (norm > 0.0) {
+        for (auto& value : correlation) {
+            value = static_cast<float>(value / norm);
+        }
+    }
+    
+    return correlation;
+}
+
+float SpectralCorrelationSync::computeSpectralSimilarity(const std::vector<float>& spec1,
+                                                         const std::vector<float>& spec2,
+                                                         size_t bandCount,
+                                                         int offset) {
+    if (bandCount == 0) return 0.0f;
+    
+    const int frames1 = static_cast<int>(spec1.size() / bandCount);
+    const int frames2 = static_cast<int>(spec2.size() / bandCount);
+    
+    // Overlapping frame range: spec1[f] pairs with spec2[f + offset]
+    const int first = std::max(0, -offset);
+    const int last = std::min(frames1, frames2 - offset);
+    if (last - first < 2) return 0.0f;
+    
+    double covariance = 0.0;
+    double variance1 = 0.0;
+    double variance2 = 0.0;
+    
+    for (size_t band = 0; band < bandCount; ++band) {
+        double mean1 = 0.0, mean2 = 0.0;
+        for (int f = first; f < last; ++f) {
+            mean1 += spec1[f * bandCount + band];
+            mean2 += spec2[(f + offset) * bandCount + band];
+        }
+        mean1 /= (last - first);
+        mean2 /= (last - first);
+        
+        for (int f = first; f < last; ++f) {
+            double x = spec1[f * bandCount + band] - mean1;
+            double y = spec2[(f + offset) * bandCount + band] - mean2;
+            covariance += x * y;
+            variance1 += x * x;
+            variance2 += y * y;
+        }
+    }
+    
+    if (variance1 <= 0.0 || variance2 <= 0.0) return 0.0f;
+    return static_cast<float>(covariance / std::sqrt(variance1 * variance2));
+}
+
 float SpectralCorrelationSync::getExpectedAccuracy(AudioContent content) const {
     switch (content) {
         case AudioContent::SPEECH: return 0.70f;
@@ -689,7 +906,9 @@ float SpectralCorrelationSync::getExpectedAccuracy(AudioContent content) const {
 // Hybrid Audio Sync Implementation
 // ===========================
 
-HybridAudioSync::HybridAudioSync() : currentQuality(SyncQuality::STANDARD), verbose(false) {
+HybridAudioSync::HybridAudioSync()
+    : currentQuality(SyncQuality::STANDARD), analysisBudget(DEFAULT_ANALYSIS_BUDGET),
+      driftMode(false), verbose(false) {
     // Initialize algorithms
     algorithms.push_back(std::make_unique<CrossCorrelationSync>());
     algorithms.push_back(std::make_unique<DTWSync>());
@@ -697,9 +916,13 @@ HybridAudioSync::HybridAudioSync() : currentQuality(SyncQuality::STANDARD), verb
     algorithms.push_back(std::make_unique<SpectralCorrelationSync>());
     
     initializeAlgorithmWeights();
+    setQualityMode(currentQuality);
     
     // Initialize MFCC processor
-    mfccProcessor = std::make_unique<fftw::FFTProcessor>(MFCC_FRAME_SIZE);
+    featureExtractor = std::make_unique<FeatureExtractor>(MFCC_FRAME_SIZE, MFCC_HOP_SIZE,
+                                                          MFCC_NUM_FILTERS, MFCC_NUM_COEFFS);
+    pairedExtractor = std::make_unique<FeatureExtractor>(MFCC_FRAME_SIZE, MFCC_HOP_SIZE,
+                                                         MFCC_NUM_FILTERS, MFCC_NUM_COEFFS);
 }
 
 HybridAudioSync::~HybridAudioSync() = default;
@@ -716,32 +939,68 @@ void HybridAudioSync::initializeAlgorithmWeights() {
 
 SyncResult HybridAudioSync::findOptimalSync(const std::filesystem::path& audioFile1,
                                            const std::filesystem::path& audioFile2,
-                                           SyncQuality quality) {
+                                           SyncQuality quality,
+                                           std::optional<double> offsetHint) {
     setQualityMode(quality);
     
+    // Scratch of every stage on this thread stays in the arena until the file is done
+    ScratchArena::Scope scratchScope;
+    metrics::ScopedTimer syncTimer("sync");
+    performanceStats.clear();
+    auto secondsSince = [](std::chrono::high_resolution_clock::time_point since) {
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - since).count();
+    };
+    
     if (verbose) {
-        std::cout << "\n🎵 Advanced Hybrid Audio Synchronization" << std::endl;
-        std::cout << "===========================================" << std::endl;
-        std::cout << "Audio 1: " << audioFile1.filename().string() << std::endl;
-        std::cout << "Audio 2: " << audioFile2.filename().string() << std::endl;
-        std::cout << "Quality: ";
+        console::out() << "\n🎵 Advanced Hybrid Audio Synchronization" << std::endl;
+        console::out() << "===========================================" << std::endl;
+        console::out() << "Audio 1: " << audioFile1.filename().string() << std::endl;
+        console::out() << "Audio 2: " << audioFile2.filename().string() << std::endl;
+        console::out() << "Quality: ";
         switch (quality) {
-            case SyncQuality::REAL_TIME: std::cout << "Real-time"; break;
-            case SyncQuality::STANDARD: std::cout << "Standard"; break;
-            case SyncQuality::HIGH_QUALITY: std::cout << "High Quality"; break;
+            case SyncQuality::REAL_TIME: console::out() << "Real-time"; break;
+            case SyncQuality::STANDARD: console::out() << "Standard"; break;
+            case SyncQuality::HIGH_QUALITY: console::out() << "High Quality"; break;
         }
-        std::cout << std::endl;
+        console::out() << std::endl;
+    }
+    
+    ThreadPool& pool = ThreadPool::shared();
+    
+    if (verbose && offsetHint) {
+        console::out() << "🧬 Offset hint: " << *offsetHint << "s" << std::endl;
     }
     
-    // Extract features from both audio files
-    auto features1 = extractFeatures(audioFile1);
-    auto features2 = extractFeatures(audioFile2);
+    // Spend the sample budget where there is something to align
+    auto stageStart = std::chrono::high_resolution_clock::now();
+    const AnalysisWindow window = calculateAnalysisWindow(audioFile1, audioFile2, offsetHint);
+    performanceStats["analysis_window_seconds"] = secondsSince(stageStart);
+    if (verbose) {
+        console::out() << "🔎 Analysis window: audio 1 " << window.start1 << "-"
+                       << (window.start1 + window.duration1) << "s, audio 2 " << window.start2
+                       << "-" << (window.start2 + window.duration2) << "s"
+                       << (window.selected ? "" : " (file start)") << std::endl;
+    }
+    
+    // Extract features from both audio files concurrently; decode messages
+    // from the helper task are replayed into this job's console block
+    stageStart = std::chrono::high_resolution_clock::now();
+    auto pairedTask = pool.submit([&]() {
+        console::TaskCapture capture;
+        auto features = extractFeaturesWith(*pairedExtractor, audioFile2, window.start2,
+                                            window.duration2);
+        return std::make_pair(std::move(features), capture.str());
+    });
+    auto features1 = extractFeatures(audioFile1, window.start1, window.duration1);
+    auto [features2, pairedLog] = pool.waitFor(pairedTask);
+    console::out() << pairedLog;
+    performanceStats["feature_extraction_seconds"] = secondsSince(stageStart);
     
     if (features1.frameCount == 0 || features2.frameCount == 0) {
         SyncResult result;
         result.confidence = 0.0f;
         if (verbose) {
-            std::cout << "❌ Failed to extract audio features" << std::endl;
+            console::out() << "❌ Failed to extract audio features" << std::endl;
         }
         return result;
     }
@@ -749,57 +1008,151 @@ SyncResult HybridAudioSync::findOptimalSync(const std::filesystem::path& audioFi
     // Detect content type
     AudioContent contentType = detectContentType(features1);
     if (verbose) {
-        std::cout << "🎯 Content type: ";
+        console::out() << "🎯 Content type: ";
         switch (contentType) {
-            case AudioContent::SPEECH: std::cout << "Speech"; break;
-            case AudioContent::MUSIC: std::cout << "Music"; break;
-            case AudioContent::MIXED: std::cout << "Mixed"; break;
-            case AudioContent::SILENCE: std::cout << "Silence"; break;
-            case AudioContent::NOISE: std::cout << "Noise"; break;
-            default: std::cout << "Unknown"; break;
+            case AudioContent::SPEECH: console::out() << "Speech"; break;
+            case AudioContent::MUSIC: console::out() << "Music"; break;
+            case AudioContent::MIXED: console::out() << "Mixed"; break;
+            case AudioContent::SILENCE: console::out() << "Silence"; break;
+            case AudioContent::NOISE: console::out() << "Noise"; break;
+            default: console::out() << "Unknown"; break;
         }
-        std::cout << std::endl;
+        console::out() << std::endl;
     }
     
-    // Run synchronization algorithms
+    // Rank algorithms by weight for this content type and apply the budget
+    auto ranking = algorithmWeights[contentType];
+    std::stable_sort(ranking.begin(), ranking.end(),
+                     [](const auto& a, const auto& b) { return a.second > b.second; });
+    
+    std::vector<std::pair<size_t, float>> planned;
+    std::vector<std::string> skipped;
+    for (const auto& [index, weight] : ranking) {
+        if (index >= algorithms.size()) continue;
+        bool withinBudget = planned.size() < budget.maxAlgorithms &&
+                            (weight >= budget.minWeight || planned.empty());
+        if (withinBudget) {
+            planned.emplace_back(index, weight);
+        } else {
+            skipped.push_back(algorithms[index]->getName());
+        }
+    }
+    
+    // Run each stage in parallel. Each algorithm owns its scratch state and
+    // the features are read-only from here on, so a stage takes as long as
+    // its slowest algorithm rather than the sum.
+    auto algorithmsStart = std::chrono::high_resolution_clock::now();
+    
     std::vector<SyncResult> results;
     std::vector<float> weights;
+    std::vector<std::string> executed;
+    bool earlyExit = false;
     
-    for (size_t i = 0; i < algorithms.size(); ++i) {
-        auto result = algorithms[i]->synchronize(features1, features2);
+    size_t next = 0;
+    while (next < planned.size()) {
+        const size_t stageEnd = std::min(planned.size(), next + std::max<size_t>(1, budget.stageSize));
         
-        if (verbose) {
-            std::cout << "📊 " << result.algorithm << ": offset=" << result.offset 
-                      << "s, confidence=" << result.confidence 
-                      << ", time=" << result.computationTime << "s" << std::endl;
+        std::vector<std::future<SyncResult>> pending;
+        for (size_t p = next; p < stageEnd; ++p) {
+            SyncAlgorithm* instance = algorithms[planned[p].first].get();
+            pending.push_back(pool.submit([instance, &features1, &features2]() {
+                metrics::ScopedTimer timer("sync." + instance->getName());
+                return instance->synchronize(features1, features2);
+            }));
         }
         
-        results.push_back(result);
+        for (size_t p = next; p < stageEnd; ++p) {
+            auto result = pool.waitFor(pending[p - next]);
+            
+            if (verbose) {
+                console::out() << "📊 " << result.algorithm << ": offset=" << result.offset 
+                          << "s, confidence=" << result.confidence 
+                          << ", time=" << result.computationTime << "s" << std::endl;
+            }
+            
+            // Per-algorithm figures in file time, for benchmarks and metrics
+            const std::string& name = algorithms[planned[p].first]->getName();
+            performanceStats[name + "_seconds"] = result.computationTime;
+            performanceStats[name + "_offset"] = -(result.offset + (window.start2 - window.start1));
+            performanceStats[name + "_confidence"] = result.confidence;
+            
+            results.push_back(result);
+            weights.push_back(planned[p].second);
+            executed.push_back(algorithms[planned[p].first]->getName());
+        }
+        next = stageEnd;
         
-        // Get weight for this algorithm and content type
-        float weight = 0.0f;
-        for (const auto& pair : algorithmWeights[contentType]) {
-            if (pair.first == i) {
-                weight = pair.second;
-                break;
+        // Later stages only refine a result that is already trusted
+        if (next < planned.size() &&
+            combineResults(results, weights).confidence >= budget.earlyExitConfidence) {
+            earlyExit = true;
+            for (size_t p = next; p < planned.size(); ++p) {
+                skipped.push_back(algorithms[planned[p].first]->getName());
             }
+            break;
         }
-        weights.push_back(weight);
     }
     
+    auto algorithmsEnd = std::chrono::high_resolution_clock::now();
+    performanceStats["algorithms_seconds"] = std::chrono::duration<double>(algorithmsEnd - algorithmsStart).count();
+    
     // Combine results
+    metrics::ScopedTimer combineTimer("sync.combine");
     auto finalResult = combineResults(results, weights);
-    finalResult.offset = -finalResult.offset;
+    performanceStats["combine_seconds"] = combineTimer.stop();
+    const double algorithmTime = finalResult.computationTime;
+    finalResult.computationTime = std::chrono::duration<double>(algorithmsEnd - algorithmsStart).count();
+    // Algorithms measure within the windows; shift back to file time
+    finalResult.offset = -(finalResult.offset + (window.start2 - window.start1));
+    finalResult.algorithmsRun = std::move(executed);
+    finalResult.algorithmsSkipped = std::move(skipped);
+    finalResult.earlyExit = earlyExit;
+    
+    if (verbose) {
+        console::out() << "⏱️  Algorithms: " << finalResult.computationTime << "s wall, "
+                       << algorithmTime << "s total" << std::endl;
+        console::out() << "🧮 Budget: ran " << finalResult.algorithmsRun.size() << "/"
+                       << algorithms.size();
+        if (!finalResult.algorithmsSkipped.empty()) {
+            console::out() << ", skipped";
+            for (const auto& name : finalResult.algorithmsSkipped) {
+                console::out() << " " << name;
+            }
+        }
+        if (finalResult.earlyExit) {
+            console::out() << " (early exit)";
+        }
+        console::out() << std::endl;
+    }
     finalResult.confidence = computeConfidenceScore(finalResult, features1, features2);
     
+    if (driftMode && finalResult.confidence >= MIN_CONFIDENCE_THRESHOLD) {
+        metrics::ScopedTimer driftTimer("sync.drift");
+        estimateDrift(audioFile1, audioFile2, finalResult);
+        performanceStats["drift_seconds"] = driftTimer.stop();
+    }
+    
+    const size_t scratchPeak = scratchScope.arena().peakSinceReset();
+    performanceStats["scratch_peak_bytes"] = static_cast<double>(scratchPeak);
+    performanceStats["scratch_process_peak_bytes"] =
+        static_cast<double>(std::max(scratchPeak, ScratchArena::processHighWaterMark()));
     if (verbose) {
-        std::cout << "🎯 Final result: offset=" << finalResult.offset 
-                  << "s, confidence=" << finalResult.confidence << std::endl;
+        console::out() << "🧠 Scratch: " << scratchPeak / 1024 << " KB peak, "
+                       << scratchScope.arena().retainedBytes() / 1024 << " KB retained" << std::endl;
+    }
+    
+    if (verbose) {
+        console::out() << "🎯 Final result: offset=" << finalResult.offset 
+                  << "s, confidence=" << finalResult.confidence;
+        if (finalResult.driftPpm != 0.0) {
+            console::out() << ", drift=" << finalResult.driftPpm << " ppm";
+        }
+        console::out() << std::endl;
         
         if (finalResult.confidence < MIN_CONFIDENCE_THRESHOLD) {
-            std::cout << "⚠️  Low confidence result - consider manual verification" << std::endl;
+            console::out() << "⚠️  Low confidence result - consider manual verification" << std::endl;
         } else if (finalResult.confidence > HIGH_CONFIDENCE_THRESHOLD) {
-            std::cout << "✅ High confidence result" << std::endl;
+            console::out() << "✅ High confidence result" << std::endl;
         }
     }
     
@@ -808,93 +1161,67 @@ SyncResult HybridAudioSync::findOptimalSync(const std::filesystem::path& audioFi
 
 AudioFeatures HybridAudioSync::extractFeatures(const std::filesystem::path& audioFile,
                                                double startTime, double duration) {
+    return extractFeaturesWith(*featureExtractor, audioFile, startTime, duration);
+}
+
+AudioFeatures HybridAudioSync::extractFeaturesWith(FeatureExtractor& extractor,
+                                                   const std::filesystem::path& audioFile,
+                                                   double startTime, double duration) {
     AudioFeatures features;
     
-    double sampleRate;
-    auto audioSamples = loadAudioSamples(audioFile, startTime, duration, sampleRate);
-    
-    if (audioSamples.empty()) {
-        return features;
-    }
-    
-    features.sampleRate = sampleRate;
-    features.frameCount = audioSamples.size() / MFCC_HOP_SIZE;
-    
-    // Extract MFCC features
-    features.mfcc = extractMFCC(audioSamples, sampleRate);
-    
-    // Extract spectral centroid
-    features.spectralCentroid = extractSpectralCentroid(audioSamples, sampleRate);
-    
-    // Extract energy envelope
-    features.energy.reserve(features.frameCount);
-    for (size_t i = 0; i < audioSamples.size(); i += MFCC_HOP_SIZE) {
-        float energy = 0.0f;
-        size_t endIdx = std::min(i + MFCC_HOP_SIZE, audioSamples.size());
-        for (size_t j = i; j < endIdx; ++j) {
-            energy += audioSamples[j] * audioSamples[j];
+    // Cached entries are only valid for the exact extractor configuration
+    std::string cacheConfig;
+    if (featureCache) {
+        std::ostringstream config;
+        config << "features:" << extractor.getFrameSize() << "/" << extractor.getHopSize() << "/"
+               << extractor.getNumBands() << "/" << extractor.getNumCoefficients() << "@"
+               << DEFAULT_SAMPLE_RATE;
+        cacheConfig = config.str();
+        if (featureCache->load(audioFile, startTime, duration, cacheConfig, features)) {
+            metrics::Registry::instance().increment("feature_cache_hit");
+            return features;
         }
-        features.energy.push_back(std::sqrt(energy / (endIdx - i)));
+        metrics::Registry::instance().increment("feature_cache_miss");
     }
     
-    // Extract zero crossing rate
-    features.zcr.reserve(features.frameCount);
-    for (size_t i = 0; i < audioSamples.size(); i += MFCC_HOP_SIZE) {
-        int crossings = 0;
-        size_t endIdx = std::min(i + MFCC_HOP_SIZE, audioSamples.size());
-        for (size_t j = i + 1; j < endIdx; ++j) {
-            if ((audioSamples[j] >= 0) != (audioSamples[j-1] >= 0)) {
-                crossings++;
-            }
+    // Decode and extract block by block at the fixed analysis rate; peak
+    // memory is one block plus the frame overlap, not the window
+    const double sampleRate = static_cast<double>(DEFAULT_SAMPLE_RATE);
+    const size_t waveformLimit = static_cast<size_t>(WAVEFORM_KEEP_SECONDS * sampleRate);
+    features.waveform.reserve(std::min(waveformLimit, static_cast<size_t>(duration * sampleRate)));
+    
+    extractor.begin(sampleRate, STREAM_BLOCK_SAMPLES);
+    FeatureBlock block;
+    AudioDecoder decoder;
+    double extractSeconds = 0.0;
+    bool decoded = decoder.decodeStream(audioFile, startTime, duration, sampleRate, STREAM_BLOCK_SAMPLES,
+        [&](const float* samples, size_t count) {
+            const auto pushStart = std::chrono::steady_clock::now();
+            extractor.push(samples, count, block);
+            FeatureExtractor::append(block, features);
+            const size_t keep = std::min(count, waveformLimit - features.waveform.size());
+            features.waveform.insert(features.waveform.end(), samples, samples + keep);
+            extractSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - pushStart).count();
+            return true;
+        });
+    if (!decoded) {
+        if (verbose) {
+            console::out() << "❌ Audio decode failed: " << decoder.getLastError() << std::endl;
         }
-        features.zcr.push_back(static_cast<float>(crossings) / (endIdx - i));
+        return AudioFeatures{};
     }
-    
-    // Detect onsets
-    features.onsets = detectOnsets(audioSamples, sampleRate);
-    
-    return features;
-}
-
-std::vector<float> HybridAudioSync::loadAudioSamples(const std::filesystem::path& audioFile,
-                                                    double startTime, double duration,
-                                                    double& sampleRate) {
-    // Create temporary raw audio file
-    std::string tempAudio = "/tmp/audio_hybrid_" + std::to_string(std::time(nullptr)) + 
-                           "_" + std::to_string(rand() % 10000) + ".raw";
-    
-    std::ostringstream extractCmd;
-    extractCmd << "ffmpeg -hide_banner -loglevel error ";
-    extractCmd << "-ss " << startTime << " ";
-    extractCmd << "-i \"" << audioFile.string() << "\" ";
-    extractCmd << "-t " << duration << " ";
-    extractCmd << "-vn -f f32le -acodec pcm_f32le -ar 44100 -ac 1 ";
-    extractCmd << "\"" << tempAudio << "\"";
-    
-    int result = std::system(extractCmd.str().c_str());
-    if (result != 0) {
-        std::filesystem::remove(tempAudio);
-        return {};
+    const auto finishStart = std::chrono::steady_clock::now();
+    extractor.finish(block);
+    FeatureExtractor::append(block, features);
+    extractor.finalize(features);
+    extractSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - finishStart).count();
+    metrics::Registry::instance().record("features", extractSeconds);
+    
+    if (featureCache) {
+        featureCache->store(audioFile, startTime, duration, cacheConfig, features);
     }
     
-    // Read the audio data
-    std::ifstream file(tempAudio, std::ios::binary);
-    if (!file) {
-        std::filesystem::remove(tempAudio);
-        return {};
-    }
-    
-    std::vector<float> samples;
-    float sample;
-    while (file.read(reinterpret_cast<char*>(&sample), sizeof(float))) {
-        samples.push_back(sample);
-    }
-    
-    file.close();
-    std::filesystem::remove(tempAudio);
-    
-    sampleRate = 44100.0; // We forced this in ffmpeg
-    return samples;
+    return features;
 }
 
 AudioContent HybridAudioSync::detectContentType(const AudioFeatures& features) {
@@ -908,18 +1235,23 @@ AudioContent HybridAudioSync::detectContentType(const AudioFeatures& features) {
     float avgZCR = features.zcr.empty() ? 0.0f : 
         std::accumulate(features.zcr.begin(), features.zcr.end(), 0.0f) / features.zcr.size();
     
+    // Onsets per second, so the decision does not depend on the window length
+    const double seconds = features.sampleRate > 0.0 && features.hopSize > 0
+        ? features.energy.size() * features.hopSize / features.sampleRate : 0.0;
+    const double onsetRate = seconds > 0.0 ? features.onsets.size() / seconds : 0.0;
+    
     // Silence detection
     if (avgEnergy < 0.01f && maxEnergy < 0.05f) {
         return AudioContent::SILENCE;
     }
     
     // Speech detection (moderate ZCR, moderate energy dynamics)
-    if (avgZCR > 0.1f && avgZCR < 0.3f && features.onsets.size() < 20) {
+    if (avgZCR > 0.1f && avgZCR < 0.3f && onsetRate < SPEECH_MAX_ONSET_RATE) {
         return AudioContent::SPEECH;
     }
     
     // Music detection (lower ZCR, more onsets)
-    if (avgZCR < 0.15f && features.onsets.size() > 15) {
+    if (avgZCR < 0.15f && onsetRate > MUSIC_MIN_ONSET_RATE) {
         return AudioContent::MUSIC;
     }
     
@@ -969,18 +1301,12 @@ float HybridAudioSync::computeConfidenceScore(const SyncResult& result,
                                              const AudioFeatures& features2) {
     float confidence = result.confidence;
     
-    // Boost confidence based on feature quality
-    if (!features1.mfcc.empty() && !features2.mfcc.empty()) {
-        confidence *= 1.1f;
-    }
-    
-    if (features1.onsets.size() > 5 && features2.onsets.size() > 5) {
-        confidence *= 1.05f;
+    if (features1.onsets.size() > CONFIDENCE_MIN_ONSETS && features2.onsets.size() > CONFIDENCE_MIN_ONSETS) {
+        confidence *= ONSET_EVIDENCE_BOOST;
     }
     
-    // Penalize very large offsets
-    if (std::abs(result.offset) > 10.0) {
-        confidence *= 0.8f;
+    if (std::abs(result.offset) > LARGE_OFFSET_SECONDS) {
+        confidence *= LARGE_OFFSET_PENALTY;
     }
     
     return std::min(1.0f, confidence);
@@ -989,16 +1315,20 @@ float HybridAudioSync::computeConfidenceScore(const SyncResult& result,
 void HybridAudioSync::setQualityMode(SyncQuality quality) {
     currentQuality = quality;
     
-    // Adjust algorithm parameters based on quality
+    // Turn the quality mode into an execution budget
     switch (quality) {
         case SyncQuality::REAL_TIME:
-            // Reduce processing for speed
+            // Only the best algorithm for the content type
+            budget = {1, 0.0f, 1, EARLY_EXIT_DISABLED};
             break;
         case SyncQuality::STANDARD:
-            // Balanced settings
+            // Weight order, stop once confident
+            budget = {algorithms.size(), STANDARD_MIN_WEIGHT, STANDARD_STAGE_SIZE,
+                      HIGH_CONFIDENCE_THRESHOLD};
             break;
         case SyncQuality::HIGH_QUALITY:
-            // Maximum accuracy settings
+            // Everything, all at once
+            budget = {algorithms.size(), 0.0f, algorithms.size(), EARLY_EXIT_DISABLED};
             break;
     }
 }
@@ -1007,108 +1337,314 @@ void HybridAudioSync::setVerbose(bool verbose) {
     this->verbose = verbose;
 }
 
+void HybridAudioSync::setAnalysisBudget(double seconds) {
+    analysisBudget = std::max(MIN_REFERENCE_SECONDS, seconds);
+}
+
+double HybridAudioSync::headSeconds() const {
+    return analysisBudget;
+}
+
+double HybridAudioSync::analysisSampleRate() {
+    return static_cast<double>(DEFAULT_SAMPLE_RATE);
+}
+
+void HybridAudioSync::setDriftMode(bool enable) {
+    driftMode = enable;
+}
+
+void HybridAudioSync::setFeatureCache(std::shared_ptr<FeatureCache> cache) {
+    featureCache = std::move(cache);
+}
+
+void HybridAudioSync::setProbeCache(std::shared_ptr<MediaProbeCache> cache) {
+    probeCache = std::move(cache);
+}
+
 std::map<std::string, double> HybridAudioSync::getPerformanceStats() const {
     return performanceStats;
 }
 
-// Placeholder implementations for feature extraction methods
-std::vector<float> HybridAudioSync::extractMFCC(const std::vector<float>& audio,
-                                                double sampleRate, size_t numCoeffs) {
-    // Simplified MFCC extraction - in practice, use a dedicated library
-    std::vector<float> mfcc;
-    
-    size_t numFrames = (audio.size() - MFCC_FRAME_SIZE) / MFCC_HOP_SIZE + 1;
+void HybridAudioSync::estimateDrift(const std::filesystem::path& audioFile1,
+                                    const std::filesystem::path& audioFile2,
+                                    SyncResult& result) {
+    auto duration = [&](const std::filesystem::path& file) {
+        return probeCache ? probeCache->get(file).duration : MediaProbeCache::probe(file).duration;
+    };
+    const double duration1 = duration(audioFile1);
+    const double duration2 = duration(audioFile2);
+    
+    // Displacement of audio 2 against audio 1 (t2 - t1) from the coarse pass
+    const double coarse = -result.offset;
+    const double span = std::min(duration1, duration2 - coarse);
+    if (span < DRIFT_MIN_SPAN) {
+        if (verbose) {
+            console::out() << "⏭️  Drift estimation skipped: take too short" << std::endl;
+        }
+        return;
+    }
     
-    for (size_t frame = 0; frame < numFrames; ++frame) {
-        size_t startIdx = frame * MFCC_HOP_SIZE;
-        
-        // Extract frame
-        std::vector<float> frameData(audio.begin() + startIdx, 
-                                   audio.begin() + startIdx + MFCC_FRAME_SIZE);
+    struct WindowEstimate {
+        double time = 0.0;            // Window centre in audio 1
+        double displacement = 0.0;    // t2 - t1 measured there
+        float confidence = 0.0f;
+    };
+    
+    // Every window gets its own extractor and correlator so they can run
+    // concurrently; plans and kernels are shared process-wide
+    ThreadPool& pool = ThreadPool::shared();
+    std::vector<std::future<WindowEstimate>> pending;
+    pending.reserve(DRIFT_WINDOW_COUNT);
+    for (size_t k = 0; k < DRIFT_WINDOW_COUNT; ++k) {
+        const double centre = span * (k + 0.5) / DRIFT_WINDOW_COUNT;
+        const double start1 = std::clamp(centre - DRIFT_WINDOW_SECONDS / 2, 0.0,
+                                         std::max(0.0, duration1 - DRIFT_WINDOW_SECONDS));
+        const double start2 = std::max(0.0, start1 + coarse - DRIFT_SEARCH_MARGIN);
+        const double length2 = start1 + coarse + DRIFT_WINDOW_SECONDS + DRIFT_SEARCH_MARGIN - start2;
         
-        // Simple spectral centroid as MFCC approximation
-        float centroid = 0.0f;
-        float totalMagnitude = 0.0f;
-        
-        for (size_t i = 0; i < frameData.size(); ++i) {
-            float magnitude = std::abs(frameData[i]);
-            centroid += i * magnitude;
-            totalMagnitude += magnitude;
+        pending.push_back(pool.submit([=, this]() {
+            console::TaskCapture capture;   // Per-window decode noise stays out of the job log
+            WindowEstimate estimate;
+            estimate.time = start1 + DRIFT_WINDOW_SECONDS / 2;
+            
+            FeatureExtractor extractor(MFCC_FRAME_SIZE, MFCC_HOP_SIZE, MFCC_NUM_FILTERS, MFCC_NUM_COEFFS);
+            auto features1 = extractFeaturesWith(extractor, audioFile1, start1, DRIFT_WINDOW_SECONDS);
+            auto features2 = extractFeaturesWith(extractor, audioFile2, start2, length2);
+            if (features1.frameCount == 0 || features2.frameCount == 0) {
+                return estimate;
+            }
+            
+            SpectralCorrelationSync correlator(MFCC_FRAME_SIZE);
+            auto local = correlator.synchronize(features1, features2);
+            estimate.displacement = local.offset + (start2 - start1);
+            estimate.confidence = local.confidence;
+            return estimate;
+        }));
+    }
+    
+    std::vector<WindowEstimate> estimates;
+    for (auto& task : pending) {
+        estimates.push_back(pool.waitFor(task));
+    }
+    
+    result.confidenceProfile.clear();
+    std::vector<const WindowEstimate*> usable;
+    for (const auto& estimate : estimates) {
+        result.confidenceProfile.push_back(estimate.confidence);
+        if (estimate.confidence >= DRIFT_MIN_WINDOW_CONFIDENCE) {
+            usable.push_back(&estimate);
         }
-        
-        if (totalMagnitude > 0) {
-            centroid /= totalMagnitude;
+    }
+    
+    if (usable.size() < 3) {
+        if (verbose) {
+            console::out() << "⏭️  Drift estimation skipped: " << usable.size()
+                           << " usable windows" << std::endl;
         }
-        
-        mfcc.push_back(centroid);
+        return;
     }
     
-    return mfcc;
-}
-
-std::vector<float> HybridAudioSync::extractSpectralCentroid(const std::vector<float>& audio,
-                                                           double sampleRate) {
-    std::vector<float> centroids;
+    auto median = [](std::vector<double> values) {
+        auto middle = values.begin() + values.size() / 2;
+        std::nth_element(values.begin(), middle, values.end());
+        return *middle;
+    };
+    
+    // Theil-Sen: median pairwise slope, then median intercept
+    std::vector<double> slopes;
+    for (size_t i = 0; i < usable.size(); ++i) {
+        for (size_t j = i + 1; j < usable.size(); ++j) {
+            double dt = usable[j]->time - usable[i]->time;
+            if (std::abs(dt) > 1e-6) {
+                slopes.push_back((usable[j]->displacement - usable[i]->displacement) / dt);
+            }
+        }
+    }
+    if (slopes.empty()) return;
+    double slope = median(slopes);
     
-    size_t numFrames = (audio.size() - MFCC_FRAME_SIZE) / MFCC_HOP_SIZE + 1;
+    std::vector<double> intercepts;
+    for (const auto* estimate : usable) {
+        intercepts.push_back(estimate->displacement - slope * estimate->time);
+    }
+    double intercept = median(intercepts);
+    
+    // Confidence-weighted least squares over the inliers of the robust line
+    double sumW = 0.0, sumT = 0.0, sumD = 0.0, sumTT = 0.0, sumTD = 0.0;
+    size_t inliers = 0;
+    for (const auto* estimate : usable) {
+        double residual = estimate->displacement - (intercept + slope * estimate->time);
+        if (std::abs(residual) > DRIFT_INLIER_TOLERANCE) continue;
+        double w = estimate->confidence;
+        sumW += w;
+        sumT += w * estimate->time;
+        sumD += w * estimate->displacement;
+        sumTT += w * estimate->time * estimate->time;
+        sumTD += w * estimate->time * estimate->displacement;
+        inliers++;
+    }
     
-    for (size_t frame = 0; frame < numFrames; ++frame) {
-        size_t startIdx = frame * MFCC_HOP_SIZE;
-        
-        float centroid = 0.0f;
-        float totalEnergy = 0.0f;
-        
-        for (size_t i = 0; i < MFCC_FRAME_SIZE && startIdx + i < audio.size(); ++i) {
-            float energy = audio[startIdx + i] * audio[startIdx + i];
-            centroid += i * energy;
-            totalEnergy += energy;
+    if (inliers < 3 || inliers * 2 < usable.size()) {
+        if (verbose) {
+            console::out() << "⏭️  Drift estimation rejected: windows disagree ("
+                           << inliers << "/" << usable.size() << " inliers)" << std::endl;
         }
-        
-        if (totalEnergy > 0) {
-            centroid = (centroid / totalEnergy) * (sampleRate / 2.0f) / MFCC_FRAME_SIZE;
+        return;
+    }
+    
+    double denominator = sumW * sumTT - sumT * sumT;
+    if (std::abs(denominator) > 1e-12) {
+        slope = (sumW * sumTD - sumT * sumD) / denominator;
+        intercept = (sumD - slope * sumT) / sumW;
+    }
+    
+    const double ppm = slope * 1e6;
+    if (std::abs(ppm) > MAX_DRIFT_PPM) {
+        if (verbose) {
+            console::out() << "⏭️  Drift estimation rejected: " << ppm << " ppm is implausible" << std::endl;
         }
-        
-        centroids.push_back(centroid);
+        return;
     }
     
-    return centroids;
+    result.offset = -intercept;
+    result.driftPpm = ppm;
+    
+    if (verbose) {
+        console::out() << "🕰️  Drift: " << ppm << " ppm over " << span << "s ("
+                       << inliers << "/" << estimates.size() << " windows)" << std::endl;
+    }
 }
 
-std::vector<size_t> HybridAudioSync::detectOnsets(const std::vector<float>& audio,
-                                                  double sampleRate) {
-    std::vector<size_t> onsets;
+std::vector<float> HybridAudioSync::computeEnergyEnvelope(const std::filesystem::path& audioFile) {
+    std::vector<float> envelope;
+    
+    // Envelopes are cached like features, as an energy-only entry
+    std::ostringstream config;
+    config << "envelope:" << ENVELOPE_SAMPLE_RATE << "/" << ENVELOPE_BLOCK_SECONDS;
+    AudioFeatures cached;
+    if (featureCache &&
+        featureCache->load(audioFile, 0.0, ENVELOPE_SCAN_SECONDS, config.str(), cached)) {
+        return std::move(cached.energy);
+    }
     
-    // Simple onset detection using energy increases
-    std::vector<float> energy;
-    size_t windowSize = static_cast<size_t>(sampleRate * 0.02); // 20ms windows
+    std::vector<float> samples;
+    AudioDecoder decoder;
+    if (!decoder.decode(audioFile, 0.0, ENVELOPE_SCAN_SECONDS, ENVELOPE_SAMPLE_RATE, samples)) {
+        return envelope;
+    }
     
-    for (size_t i = 0; i < audio.size(); i += windowSize) {
-        float frameEnergy = 0.0f;
-        size_t endIdx = std::min(i + windowSize, audio.size());
-        
-        for (size_t j = i; j < endIdx; ++j) {
-            frameEnergy += audio[j] * audio[j];
+    const size_t blockSize = static_cast<size_t>(ENVELOPE_BLOCK_SECONDS * ENVELOPE_SAMPLE_RATE);
+    const auto sumSquares = simd::kernels().sumSquares;
+    envelope.reserve(samples.size() / blockSize);
+    for (size_t begin = 0; begin + blockSize <= samples.size(); begin += blockSize) {
+        float meanSquare = sumSquares(samples.data() + begin, blockSize) / blockSize;
+        envelope.push_back(10.0f * std::log10(meanSquare + 1e-10f));
+    }
+    
+    if (featureCache) {
+        cached.sampleRate = ENVELOPE_SAMPLE_RATE;
+        cached.energy = envelope;
+        featureCache->store(audioFile, 0.0, ENVELOPE_SCAN_SECONDS, config.str(), cached);
+    }
+    return envelope;
+}
+
+HybridAudioSync::AnalysisWindow HybridAudioSync::calculateAnalysisWindow(
+    const std::filesystem::path& audioFile1, const std::filesystem::path& audioFile2,
+    std::optional<double> offsetHint) {
+    
+    // Displacement t2 - t1 of file 2's counterpart of a file 1 window
+    const double displacement = offsetHint ? -*offsetHint : 0.0;
+    const double margin = offsetHint ? HINTED_SEARCH_MARGIN : ANALYSIS_SEARCH_MARGIN;
+    const double referenceSeconds = std::max(MIN_REFERENCE_SECONDS, analysisBudget - 2.0 * margin);
+    
+    auto placeWindow = [&](AnalysisWindow& window, double start1) {
+        window.start1 = start1;
+        window.duration1 = referenceSeconds;
+        window.start2 = std::max(0.0, start1 + displacement - margin);
+        window.duration2 = start1 + displacement + referenceSeconds + margin - window.start2;
+    };
+    
+    // Fallback: both files from the start, whole budget each; with a hint,
+    // the earliest file 1 window whose counterpart exists
+    AnalysisWindow window;
+    window.duration1 = analysisBudget;
+    window.duration2 = analysisBudget;
+    if (offsetHint) {
+        placeWindow(window, std::max(0.0, -displacement));
+    }
+    
+    const size_t windowBlocks = static_cast<size_t>(referenceSeconds / ENVELOPE_BLOCK_SECONDS);
+    const size_t marginBlocks = static_cast<size_t>(margin / ENVELOPE_BLOCK_SECONDS);
+    const long displacementBlocks = std::lround(displacement / ENVELOPE_BLOCK_SECONDS);
+    
+    // Both pre-passes run at once on the shared pool
+    ThreadPool& pool = ThreadPool::shared();
+    auto envelopeTask = pool.submit([&]() { return computeEnergyEnvelope(audioFile2); });
+    auto envelope1 = computeEnergyEnvelope(audioFile1);
+    auto envelope2 = pool.waitFor(envelopeTask);
+    
+    // Nothing to choose from: the budget already covers the scanned head
+    if (envelope1.size() <= windowBlocks + marginBlocks) {
+        return window;
+    }
+    
+    // A block is active if it clears both an absolute floor and the file's
+    // own noise floor (its quiet percentile)
+    auto activityThreshold = [](std::vector<float> envelope) {
+        if (envelope.empty()) return SILENCE_FLOOR_DB;
+        auto quiet = envelope.begin() + envelope.size() / 10;
+        std::nth_element(envelope.begin(), quiet, envelope.end());
+        return std::max(SILENCE_FLOOR_DB, *quiet + ACTIVITY_MARGIN_DB);
+    };
+    const float threshold1 = activityThreshold(envelope1);
+    const float threshold2 = activityThreshold(envelope2);
+    
+    // Prefix sums: information in file 1 (activity plus level changes, which
+    // mark onsets and speech), plain activity in file 2
+    ScratchArena::Scope scope;
+    ScratchArena& scratch = scope.arena();
+    ScratchVector<double> information(envelope1.size() + 1, 0.0, &scratch);
+    for (size_t i = 0; i < envelope1.size(); ++i) {
+        double score = 0.0;
+        if (envelope1[i] > threshold1) {
+            float change = i > 0 ? std::abs(envelope1[i] - envelope1[i - 1]) : 0.0f;
+            score = 1.0 + std::min(1.0f, change / LEVEL_CHANGE_DB);
         }
-        
-        energy.push_back(frameEnergy / (endIdx - i));
+        information[i + 1] = information[i] + score;
+    }
+    ScratchVector<double> activity(envelope2.size() + 1, 0.0, &scratch);
+    for (size_t i = 0; i < envelope2.size(); ++i) {
+        activity[i + 1] = activity[i] + (envelope2[i] > threshold2 ? 1.0 : 0.0);
     }
     
-    // Find energy peaks
-    float threshold = 0.1f;
-    for (size_t i = 1; i < energy.size() - 1; ++i) {
-        if (energy[i] > threshold && 
-            energy[i] > energy[i-1] && 
-            energy[i] > energy[i+1]) {
-            onsets.push_back(i * windowSize);
+    double bestScore = 0.0;
+    size_t bestBlock = 0;
+    const size_t firstBlock = static_cast<size_t>(std::max(0L, -displacementBlocks));
+    for (size_t block = firstBlock; block + windowBlocks <= envelope1.size(); ++block) {
+        double score = information[block + windowBlocks] - information[block];
+        
+        // Weight by how much of file 2's search range has signal at all
+        if (!envelope2.empty()) {
+            const long size2 = static_cast<long>(envelope2.size());
+            const long counterpart = static_cast<long>(block) + displacementBlocks;
+            size_t lo = static_cast<size_t>(std::clamp(counterpart - static_cast<long>(marginBlocks), 0L, size2));
+            size_t hi = static_cast<size_t>(std::clamp(counterpart + static_cast<long>(windowBlocks + marginBlocks),
+                                                       0L, size2));
+            score *= hi > lo ? (activity[hi] - activity[lo]) / (hi - lo) : 0.0;
+        }
+        
+        if (score > bestScore) {
+            bestScore = score;
+            bestBlock = block;
         }
     }
     
-    return onsets;
-}
-
-std::pair<double, double> HybridAudioSync::calculateAnalysisWindow(
-    const std::filesystem::path& audioFile1, const std::filesystem::path& audioFile2) {
+    if (bestScore <= 0.0) {
+        return window;
+    }
     
-    // Use middle 30 seconds by default, similar to original implementation
-    return {10.0, 30.0};
+    placeWindow(window, bestBlock * ENVELOPE_BLOCK_SECONDS);
+    window.selected = true;
+    return window;
 }
\ No newline at end of file
@@ -0,0 +1,290 @@
+/**
+ * @file dtw_engine.cpp
+ * @brief Subsequence DTW implementation with rolling rows and packed traceback
+ */
+
+#include "dtw_engine.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr float INF = std::numeric_limits<float>::infinity();
+
+    enum Direction : uint8_t {
+        DIAGONAL = 0,
+        VERTICAL = 1,
+        HORIZONTAL = 2
+    };
+
+    using DistanceKernel = float (*)(const float*, const float*, size_t);
+
+    inline float localCost(const float* a, const float* b, size_t dim, DistanceKernel distance) {
+        if (dim == 1) {
+            return std::abs(*a - *b);
+        }
+        return std::sqrt(distance(a, b, dim));
+    }
+
+    inline void storeDirection(std::vector<uint8_t>& bits, size_t cell, uint8_t dir) {
+        const unsigned shift = static_cast<unsigned>(cell & 3) * 2;
+        bits[cell >> 2] = static_cast<uint8_t>((bits[cell >> 2] & ~(3u << shift)) | (dir << shift));
+    }
+
+    inline uint8_t loadDirection(const std::vector<uint8_t>& bits, size_t cell) {
+        return (bits[cell >> 2] >> ((cell & 3) * 2)) & 3u;
+    }
+}
+
+DTWEngine::DTWEngine(size_t bandRadius) : bandRadius(bandRadius) {}
+
+bool DTWEngine::projectWindows(size_t len1, size_t len2, const Path& coarsePath,
+                               size_t factor, size_t radius) {
+    constexpr size_t NONE = std::numeric_limits<size_t>::max();
+    factor = std::max<size_t>(1, factor);
+
+    // Cells covered by the projected coarse path, per fine row
+    std::vector<size_t> low(len1, NONE);
+    std::vector<size_t> high(len1, 0);
+    for (const auto& point : coarsePath) {
+        const size_t rowBegin = point.first * factor;
+        const size_t colBegin = point.second * factor;
+        const size_t colEnd = std::min(len2 - 1, colBegin + factor - 1);
+        for (size_t i = rowBegin; i < std::min(len1, rowBegin + factor); ++i) {
+            low[i] = std::min(low[i], std::min(colBegin, len2 - 1));
+            high[i] = std::max(high[i], colEnd);
+        }
+    }
+
+    // Dilate by radius in both directions
+    rowStart.assign(len1, NONE);
+    rowEnd.assign(len1, 0);
+    for (size_t i = 0; i < len1; ++i) {
+        if (low[i] == NONE) continue;
+        const size_t lo = low[i] > radius ? low[i] - radius : 0;
+        const size_t hi = std::min(len2 - 1, high[i] + radius);
+        const size_t first = i > radius ? i - radius : 0;
+        const size_t last = std::min(len1 - 1, i + radius);
+        for (size_t k = first; k <= last; ++k) {
+            rowStart[k] = std::min(rowStart[k], lo);
+            rowEnd[k] = std::max(rowEnd[k], hi);
+        }
+    }
+
+    // Rows the projection never reached (coarse path shorter than expected)
+    // inherit their neighbour's window; finalizeWindows connects them
+    for (size_t i = 0; i < len1; ++i) {
+        if (rowStart[i] == NONE) {
+            rowStart[i] = i > 0 ? rowStart[i - 1] : 0;
+            rowEnd[i] = i > 0 ? rowEnd[i - 1] : 0;
+        }
+    }
+
+    // Sakoe-Chiba band around the coarse path's median diagonal
+    if (bandRadius > 0) {
+        std::vector<long> diagonals;
+        diagonals.reserve(coarsePath.size());
+        for (const auto& point : coarsePath) {
+            diagonals.push_back(static_cast<long>(point.second) - static_cast<long>(point.first));
+        }
+        const auto middle = diagonals.begin() + diagonals.size() / 2;
+        std::nth_element(diagonals.begin(), middle, diagonals.end());
+        const long diagonal = *middle * static_cast<long>(factor);
+        const long band = static_cast<long>(bandRadius);
+        const long lastColumn = static_cast<long>(len2) - 1;
+
+        for (size_t i = 0; i < len1; ++i) {
+            const long centre = static_cast<long>(i) + diagonal;
+            if (centre + band < 0 || centre - band > lastColumn) {
+                return false;
+            }
+            const size_t lo = static_cast<size_t>(std::max(0L, centre - band));
+            const size_t hi = static_cast<size_t>(std::min(lastColumn, centre + band));
+            // Where the projection strays out of the band entirely, the band wins
+            if (rowStart[i] > hi || rowEnd[i] < lo) {
+                rowStart[i] = lo;
+                rowEnd[i] = hi;
+            } else {
+                rowStart[i] = std::max(rowStart[i], lo);
+                rowEnd[i] = std::min(rowEnd[i], hi);
+            }
+        }
+    }
+
+    return finalizeWindows(len1, len2);
+}
+
+bool DTWEngine::finalizeWindows(size_t len1, size_t len2) {
+    rowOffset.resize(len1 + 1);
+    rowOffset[0] = 0;
+
+    for (size_t i = 0; i < len1; ++i) {
+        size_t start = rowStart[i];
+        size_t end = std::min(rowEnd[i], len2 - 1);
+
+        if (i > 0) {
+            // Keep windows monotone and connected to the previous row
+            start = std::clamp(start, rowStart[i - 1], rowEnd[i - 1] + 1);
+            end = std::max(end, rowEnd[i - 1]);
+        }
+        if (start > end) {
+            return false;
+        }
+
+        rowStart[i] = start;
+        rowEnd[i] = end;
+        rowOffset[i + 1] = rowOffset[i] + (end - start + 1);
+    }
+
+    return true;
+}
+
+float DTWEngine::fill(std::span<const float> seq1, std::span<const float> seq2, size_t dim) {
+    const size_t len1 = seq1.size() / dim;
+
+    size_t maxWidth = 0;
+    for (size_t i = 0; i < len1; ++i) {
+        maxWidth = std::max(maxWidth, rowEnd[i] - rowStart[i] + 1);
+    }
+    previousRow.assign(maxWidth, INF);
+    currentRow.assign(maxWidth, INF);
+
+    cellCount = rowOffset[len1];
+    directions.assign((cellCount + 3) / 4, 0);
+
+    // Resolve the dispatched L2 kernel once, not per cell
+    const DistanceKernel distance = simd::kernels().squaredDistance;
+
+    size_t prevStart = 0;
+    size_t prevEnd = 0;
+
+    for (size_t i = 0; i < len1; ++i) {
+        const size_t start = rowStart[i];
+        const size_t end = rowEnd[i];
+        const float* a = seq1.data() + i * dim;
+
+        for (size_t j = start; j <= end; ++j) {
+            const float cost = localCost(a, seq2.data() + j * dim, dim, distance);
+
+            // Row 0 starts afresh in every column
+            float best = 0.0f;
+            uint8_t dir = DIAGONAL;
+            if (i > 0) {
+                const float diagonal = (j > prevStart && j - 1 <= prevEnd)
+                    ? previousRow[j - 1 - prevStart] : INF;
+                const float vertical = (j >= prevStart && j <= prevEnd)
+                    ? previousRow[j - prevStart] : INF;
+                const float horizontal = j > start ? currentRow[j - 1 - start] : INF;
+
+                if (diagonal <= vertical && diagonal <= horizontal) {
+                    best = diagonal;
+                    dir = DIAGONAL;
+                } else if (vertical <= horizontal) {
+                    best = vertical;
+                    dir = VERTICAL;
+                } else {
+                    best = horizontal;
+                    dir = HORIZONTAL;
+                }
+            }
+
+            currentRow[j - start] = cost + best;
+            storeDirection(directions, rowOffset[i] + (j - start), dir);
+        }
+
+        std::swap(previousRow, currentRow);
+        prevStart = start;
+        prevEnd = end;
+    }
+
+    // previousRow now holds the last row; the path ends in its cheapest column
+    const auto last = previousRow.begin() + (prevEnd - prevStart + 1);
+    const auto best = std::min_element(previousRow.begin(), last);
+    endColumn = prevStart + static_cast<size_t>(best - previousRow.begin());
+    return *best;
+}
+
+float DTWEngine::computeSubsequencePath(std::span<const float> seq1, std::span<const float> seq2,
+                                        Path& path, size_t dim) {
+    dim = std::max<size_t>(1, dim);
+    path.clear();
+
+    const size_t len1 = seq1.size() / dim;
+    const size_t len2 = seq2.size() / dim;
+    if (len1 == 0 || len2 == 0) {
+        cellCount = 0;
+        return INF;
+    }
+
+    rowStart.assign(len1, 0);
+    rowEnd.assign(len1, len2 - 1);
+    finalizeWindows(len1, len2);
+    const float cost = fill(seq1, seq2, dim);
+    if (std::isfinite(cost)) {
+        tracebackPath(len1, path);
+    }
+    return cost;
+}
+
+float DTWEngine::computeSubsequencePathAround(std::span<const float> seq1, std::span<const float> seq2,
+                                              const Path& coarsePath, size_t factor, size_t radius,
+                                              Path& path, size_t dim) {
+    dim = std::max<size_t>(1, dim);
+    path.clear();
+
+    const size_t len1 = seq1.size() / dim;
+    const size_t len2 = seq2.size() / dim;
+    if (len1 == 0 || len2 == 0 || coarsePath.empty() ||
+        !projectWindows(len1, len2, coarsePath, factor, radius)) {
+        cellCount = 0;
+        return INF;
+    }
+
+    const float cost = fill(seq1, seq2, dim);
+    if (std::isfinite(cost)) {
+        tracebackPath(len1, path);
+    }
+    return cost;
+}
+
+std::pmr::vector<float> DTWEngine::downsample(std::span<const float> sequence, size_t dim,
+                                              std::pmr::memory_resource* resource) {
+    dim = std::max<size_t>(1, dim);
+    const size_t frames = sequence.size() / dim;
+    const size_t reduced = (frames + 1) / 2;
+
+    std::pmr::vector<float> output(reduced * dim, resource);
+    for (size_t i = 0; i < reduced; ++i) {
+        const float* first = sequence.data() + (2 * i) * dim;
+        float* out = output.data() + i * dim;
+        if (2 * i + 1 < frames) {
+            const float* second = first + dim;
+            for (size_t k = 0; k < dim; ++k) {
+                out[k] = 0.5f * (first[k] + second[k]);
+            }
+        } else {
+            std::copy(first, first + dim, out);
+        }
+    }
+    return output;
+}
+
+void DTWEngine::tracebackPath(size_t len1, Path& path) const {
+    size_t i = len1 - 1;
+    size_t j = endColumn;
+    path.reserve(i + j + 1);
+
+    // The path begins wherever it reaches row 0
+    while (i > 0) {
+        path.emplace_back(i, j);
+        switch (loadDirection(directions, rowOffset[i] + (j - rowStart[i]))) {
+            case DIAGONAL: i--; j--; break;
+            case VERTICAL: i--; break;
+            default: j--; break;
+        }
+    }
+
+    path.emplace_back(0, j);
+    std::reverse(path.begin(), path.end());
+}
@@ -0,0 +1,240 @@
+/**
+ * @file feature_cache.cpp
+ * @brief On-disk AudioFeatures cache implementation
+ */
+
+#include "feature_cache.h"
+#include "audio_sync.h"
+#include "feature_extractor.h"
+#include "mapped_file.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    constexpr char MAGIC[4] = {'V', 'T', 'F', 'C'};
+    constexpr size_t ARRAY_ALIGNMENT = 64;
+
+    // Array order in the file
+    enum ArrayIndex {
+        MFCC, CENTROID, ENERGY, ZCR, ONSETS, BAND_ENERGY, WAVEFORM, ARRAY_COUNT
+    };
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;                  // Guards against hash-named file collisions
+        double sampleRate;
+        uint64_t hopSize;
+        uint64_t bandCount;
+        uint64_t mfccCoefficients;
+        uint64_t frameCount;
+        uint64_t counts[ARRAY_COUNT];  // Element counts
+        uint64_t offsets[ARRAY_COUNT]; // Byte offsets from the start of the file
+    };
+
+    constexpr size_t elementSize(int array) {
+        return array == ONSETS ? sizeof(uint64_t) : sizeof(float);
+    }
+
+    size_t alignUp(size_t value) {
+        return (value + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+    }
+
+    // FNV-1a, stable across runs and platforms
+    void hashBytes(uint64_t& hash, const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    template <typename T>
+    void hashValue(uint64_t& hash, const T& value) {
+        hashBytes(hash, &value, sizeof(value));
+    }
+
+    std::string hostName() {
+        char host[256] = {};
+        if (gethostname(host, sizeof(host) - 1) != 0 || host[0] == '\0') {
+            return "host";
+        }
+        return host;
+    }
+
+    const std::vector<float>* floatArray(const AudioFeatures& features, int array) {
+        switch (array) {
+            case MFCC: return &features.mfcc;
+            case CENTROID: return &features.spectralCentroid;
+            case ENERGY: return &features.energy;
+            case ZCR: return &features.zcr;
+            case BAND_ENERGY: return &features.bandEnergy;
+            case WAVEFORM: return &features.waveform;
+            default: return nullptr;
+        }
+    }
+
+    std::vector<float>* floatArray(AudioFeatures& features, int array) {
+        return const_cast<std::vector<float>*>(
+            floatArray(static_cast<const AudioFeatures&>(features), array));
+    }
+}
+
+FeatureCache::FeatureCache(std::filesystem::path directory) : directory(std::move(directory)) {
+    std::error_code ec;
+    std::filesystem::create_directories(this->directory, ec);
+    usable = !ec && std::filesystem::is_directory(this->directory, ec);
+}
+
+uint64_t FeatureCache::makeKey(const std::filesystem::path& source, double startTime,
+                               double duration, const std::string& config) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(source, ec);
+    if (ec) return 0;
+    auto mtime = std::filesystem::last_write_time(source, ec);
+    if (ec) return 0;
+
+    uint64_t hash = 14695981039346656037ULL;
+    const std::string path = std::filesystem::absolute(source, ec).lexically_normal().string();
+    hashBytes(hash, path.data(), path.size());
+    hashValue(hash, static_cast<uint64_t>(size));
+    hashValue(hash, static_cast<int64_t>(mtime.time_since_epoch().count()));
+    hashValue(hash, FORMAT_VERSION);
+    hashValue(hash, FeatureExtractor::ALGORITHM_VERSION);
+    hashBytes(hash, config.data(), config.size());
+    // Microsecond resolution keeps float noise in window choices from missing
+    hashValue(hash, static_cast<int64_t>(std::llround(startTime * 1e6)));
+    hashValue(hash, static_cast<int64_t>(std::llround(duration * 1e6)));
+    return hash == 0 ? 1 : hash;
+}
+
+std::filesystem::path FeatureCache::entryPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.vtf", static_cast<unsigned long long>(key));
+    return directory / name;
+}
+
+bool FeatureCache::load(const std::filesystem::path& source, double startTime, double duration,
+                        const std::string& config, AudioFeatures& features) {
+    const uint64_t key = usable ? makeKey(source, startTime, duration, config) : 0;
+    if (key == 0) {
+        missCount++;
+        return false;
+    }
+
+    MappedFile file(entryPath(key));
+    FileHeader header;
+    if (!file.data || file.size < sizeof(header)) {
+        missCount++;
+        return false;
+    }
+    std::memcpy(&header, file.data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION || header.key != key) {
+        missCount++;
+        return false;
+    }
+    for (int array = 0; array < ARRAY_COUNT; ++array) {
+        if (header.offsets[array] + header.counts[array] * elementSize(array) > file.size) {
+            missCount++;
+            return false;
+        }
+    }
+
+    features.sampleRate = header.sampleRate;
+    features.hopSize = header.hopSize;
+    features.bandCount = header.bandCount;
+    features.mfccCoefficients = header.mfccCoefficients;
+    features.frameCount = header.frameCount;
+
+    for (int array = 0; array < ARRAY_COUNT; ++array) {
+        const unsigned char* begin = file.data + header.offsets[array];
+        if (array == ONSETS) {
+            const auto* onsets = reinterpret_cast<const uint64_t*>(begin);
+            features.onsets.assign(onsets, onsets + header.counts[array]);
+        } else {
+            const auto* values = reinterpret_cast<const float*>(begin);
+            floatArray(features, array)->assign(values, values + header.counts[array]);
+        }
+    }
+
+    hitCount++;
+    return true;
+}
+
+void FeatureCache::store(const std::filesystem::path& source, double startTime, double duration,
+                         const std::string& config, const AudioFeatures& features) {
+    const uint64_t key = usable ? makeKey(source, startTime, duration, config) : 0;
+    if (key == 0) return;
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.key = key;
+    header.sampleRate = features.sampleRate;
+    header.hopSize = features.hopSize;
+    header.bandCount = features.bandCount;
+    header.mfccCoefficients = features.mfccCoefficients;
+    header.frameCount = features.frameCount;
+
+    size_t offset = alignUp(sizeof(header));
+    for (int array = 0; array < ARRAY_COUNT; ++array) {
+        header.counts[array] = array == ONSETS ? features.onsets.size()
+                                               : floatArray(features, array)->size();
+        header.offsets[array] = offset;
+        offset = alignUp(offset + header.counts[array] * elementSize(array));
+    }
+
+    // Unique temporary name per writer, across the hosts sharing the directory;
+    // rename makes the entry appear atomically
+    const auto target = entryPath(key);
+    std::ostringstream tempName;
+    tempName << target.string() << ".tmp." << hostName() << "." << ::getpid() << "."
+             << std::hash<std::thread::id>{}(std::this_thread::get_id());
+    const std::filesystem::path temp = tempName.str();
+
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+
+        static const char padding[ARRAY_ALIGNMENT] = {};
+        auto padTo = [&](size_t position) {
+            size_t current = static_cast<size_t>(out.tellp());
+            if (position > current) out.write(padding, static_cast<std::streamsize>(position - current));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (int array = 0; array < ARRAY_COUNT; ++array) {
+            padTo(header.offsets[array]);
+            if (array == ONSETS) {
+                std::vector<uint64_t> onsets(features.onsets.begin(), features.onsets.end());
+                out.write(reinterpret_cast<const char*>(onsets.data()),
+                          static_cast<std::streamsize>(onsets.size() * sizeof(uint64_t)));
+            } else {
+                const auto& values = *floatArray(features, array);
+                out.write(reinterpret_cast<const char*>(values.data()),
+                          static_cast<std::streamsize>(values.size() * sizeof(float)));
+            }
+        }
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, target, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+    }
+}
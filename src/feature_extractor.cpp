@@ -0,0 +1,263 @@
+/**
+ * @file feature_extractor.cpp
+ * @brief Fused feature extraction implementation
+ */
+
+#include "feature_extractor.h"
+#include "audio_sync.h"
+#include "fft_processor.h"
+#include "simd_kernels.h"
+#include "spectral_features.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Onset detection on the rise of log energy (natural log of the hop's
+    // mean square) from one hop to the next
+    constexpr size_t ONSET_WINDOW_HOPS = 43;         // Local baseline, ~0.5 s at 44.1 kHz
+    constexpr float ONSET_THRESHOLD_SIGMAS = 2.0f;   // Peak must exceed mean + k·σ of the baseline
+    constexpr float ONSET_MIN_RISE = 0.7f;           // ~3 dB; keeps steady noise from qualifying
+    constexpr float ONSET_POWER_FLOOR = 1e-7f;       // -70 dBFS; nothing in near-silence counts
+    constexpr size_t ONSET_MIN_GAP_HOPS = 4;         // ~46 ms between onsets
+    constexpr float LOG_POWER_EPSILON = 1e-10f;
+
+    constexpr double PI = 3.14159265358979323846;
+
+    // Empty the block but keep its capacity, so steady streaming does not allocate
+    void startBlock(FeatureBlock& block, size_t firstHop, size_t firstFrame) {
+        block.firstHop = firstHop;
+        block.firstFrame = firstFrame;
+        block.energy.clear();
+        block.zcr.clear();
+        block.mfcc.clear();
+        block.spectralCentroid.clear();
+        block.bandEnergy.clear();
+        block.onsets.clear();
+    }
+}
+
+FeatureExtractor::FeatureExtractor(size_t frameSize, size_t hopSize, size_t numBands,
+                                   size_t numCoeffs)
+    : frameSize(frameSize), hopSize(std::max<size_t>(1, hopSize)), numBands(numBands),
+      numCoeffs(std::min(numCoeffs, numBands)) {
+    fft = std::make_unique<fftw::FFTProcessor>(frameSize);
+
+    // The DCT only depends on the band count, so it is built once
+    dctMatrix.resize(this->numCoeffs * numBands);
+    for (size_t c = 0; c < this->numCoeffs; ++c) {
+        const double scale = std::sqrt((c == 0 ? 1.0 : 2.0) / numBands);
+        for (size_t b = 0; b < numBands; ++b) {
+            dctMatrix[c * numBands + b] = static_cast<float>(
+                scale * std::cos(PI * c * (b + 0.5) / numBands));
+        }
+    }
+}
+
+FeatureExtractor::~FeatureExtractor() = default;
+
+void FeatureExtractor::configure(double sampleRate) {
+    if (analyzer && configuredRate == sampleRate) {
+        return;
+    }
+    analyzer = std::make_unique<spectral::SpectrogramAnalyzer>(sampleRate, frameSize, hopSize, numBands);
+    configuredRate = sampleRate;
+}
+
+void FeatureExtractor::extract(const std::vector<float>& audio, double sampleRate,
+                               AudioFeatures& features) {
+    features.energy.clear();
+    features.zcr.clear();
+    features.mfcc.clear();
+    features.spectralCentroid.clear();
+    features.bandEnergy.clear();
+    features.onsets.clear();
+
+    if (audio.empty()) {
+        features.sampleRate = sampleRate;
+        features.hopSize = hopSize;
+        features.frameCount = 0;
+        features.bandCount = numBands;
+        features.mfccCoefficients = numCoeffs;
+        return;
+    }
+
+    begin(sampleRate);
+
+    // Size every output array up front so appending never reallocates
+    const size_t numHops = (audio.size() + hopSize - 1) / hopSize;
+    const size_t numFrames = audio.size() >= frameSize ? (audio.size() - frameSize) / hopSize + 1 : 0;
+    features.energy.reserve(numHops);
+    features.zcr.reserve(numHops);
+    features.mfcc.reserve(numFrames * numCoeffs);
+    features.spectralCentroid.reserve(numFrames);
+    features.bandEnergy.reserve(numFrames * numBands);
+    features.onsets.reserve(numHops / 8);
+
+    FeatureBlock block;
+    push(audio.data(), audio.size(), block);
+    append(block, features);
+    finish(block);
+    append(block, features);
+    finalize(features);
+}
+
+void FeatureExtractor::begin(double sampleRate, size_t blockSamples) {
+    configure(sampleRate);
+    carryCapacity = frameSize + std::max(blockSamples, hopSize);
+    carry.clear();
+    carry.reserve(carryCapacity);
+    carryStart = 0;
+    streamed = 0;
+    nextHop = 0;
+    nextFrame = 0;
+    previousLogPower = 0.0f;
+    currentPower = 0.0f;
+    previousRise = 0.0f;
+    currentRise = 0.0f;
+    riseHistory.clear();
+    riseHistory.reserve(ONSET_WINDOW_HOPS);
+    riseHistoryNext = 0;
+    lastOnsetHop = 0;
+    onsetSeen = false;
+}
+
+void FeatureExtractor::push(const float* samples, size_t count, FeatureBlock& block) {
+    startBlock(block, nextHop, nextFrame);
+
+    while (count > 0) {
+        const size_t take = std::min(count, carryCapacity - carry.size());
+        carry.insert(carry.end(), samples, samples + take);
+        samples += take;
+        count -= take;
+        streamed += take;
+
+        process(block, false);
+
+        // Keep only what the next frame (or the next hop, if it lags) still reads
+        const size_t keepFrom = std::min(nextFrame, nextHop) * hopSize;
+        const size_t drop = std::min(keepFrom - carryStart, carry.size());
+        carry.erase(carry.begin(), carry.begin() + drop);
+        carryStart += drop;
+    }
+}
+
+void FeatureExtractor::finish(FeatureBlock& block) {
+    startBlock(block, nextHop, nextFrame);
+    process(block, true);
+}
+
+void FeatureExtractor::process(FeatureBlock& block, bool final) {
+    const size_t carryEnd = carryStart + carry.size();
+    const float binHz = static_cast<float>(configuredRate / frameSize);
+    const simd::KernelTable& kernels = simd::kernels();
+
+    // Time-domain features of every complete (or, at the end, partial) hop
+    while (nextHop * hopSize < carryEnd &&
+           (final || (nextHop + 1) * hopSize <= carryEnd)) {
+        const size_t begin = nextHop * hopSize;
+        const size_t end = std::min(begin + hopSize, carryEnd);
+        const float* samples = carry.data() + (begin - carryStart);
+        const size_t count = end - begin;
+
+        // Energy and zero crossings of this hop
+        const float meanSquare = kernels.sumSquares(samples, count) / count;
+        const size_t crossings = kernels.zeroCrossings(samples, count);
+        block.energy.push_back(std::sqrt(meanSquare));
+        block.zcr.push_back(static_cast<float>(crossings) / count);
+
+        // Onset envelope: the rise into hop nextHop-1 is an onset once it
+        // proves to be a local maximum that stands out from the recent rises
+        const float logPower = std::log(meanSquare + LOG_POWER_EPSILON);
+        const float rise = nextHop > 0 ? std::max(0.0f, logPower - previousLogPower) : 0.0f;
+        if (nextHop >= 2 && currentRise > previousRise && currentRise >= rise &&
+            currentRise > ONSET_MIN_RISE && currentPower > ONSET_POWER_FLOOR &&
+            (!onsetSeen || nextHop - 1 - lastOnsetHop >= ONSET_MIN_GAP_HOPS)) {
+            float mean = 0.0f;
+            float deviation = 0.0f;
+            if (!riseHistory.empty()) {
+                for (float value : riseHistory) mean += value;
+                mean /= riseHistory.size();
+                for (float value : riseHistory) deviation += (value - mean) * (value - mean);
+                deviation = std::sqrt(deviation / riseHistory.size());
+            }
+            if (currentRise > mean + ONSET_THRESHOLD_SIGMAS * deviation) {
+                block.onsets.push_back((nextHop - 1) * hopSize);
+                lastOnsetHop = nextHop - 1;
+                onsetSeen = true;
+            }
+        }
+        if (nextHop >= 1) {
+            if (riseHistory.size() < ONSET_WINDOW_HOPS) {
+                riseHistory.push_back(currentRise);
+            } else {
+                riseHistory[riseHistoryNext] = currentRise;
+                riseHistoryNext = (riseHistoryNext + 1) % ONSET_WINDOW_HOPS;
+            }
+        }
+        previousRise = currentRise;
+        currentRise = rise;
+        previousLogPower = logPower;
+        currentPower = meanSquare;
+        nextHop++;
+    }
+
+    // Spectral features of every frame the buffer holds completely
+    while (nextFrame * hopSize + frameSize <= carryEnd) {
+        const float* frame = carry.data() + (nextFrame * hopSize - carryStart);
+
+        const size_t bandOffset = block.bandEnergy.size();
+        block.bandEnergy.resize(bandOffset + numBands);
+        float* bands = block.bandEnergy.data() + bandOffset;
+        analyzer->analyzeFrame(frame, *fft, bands);
+
+        // MFCC: DCT-II of the log-mel energies
+        for (size_t c = 0; c < numCoeffs; ++c) {
+            block.mfcc.push_back(kernels.dot(dctMatrix.data() + c * numBands, bands, numBands));
+        }
+
+        // Spectral centroid in Hz from the frame's power spectrum
+        const auto& power = analyzer->getPowerSpectrum();
+        float centroid = 0.0f;
+        float totalPower = 0.0f;
+        for (size_t k = 0; k < power.size(); ++k) {
+            centroid += k * power[k];
+            totalPower += power[k];
+        }
+        block.spectralCentroid.push_back(totalPower > 0 ? centroid / totalPower * binHz : 0.0f);
+        nextFrame++;
+    }
+}
+
+void FeatureExtractor::append(const FeatureBlock& block, AudioFeatures& features) {
+    features.energy.insert(features.energy.end(), block.energy.begin(), block.energy.end());
+    features.zcr.insert(features.zcr.end(), block.zcr.begin(), block.zcr.end());
+    features.mfcc.insert(features.mfcc.end(), block.mfcc.begin(), block.mfcc.end());
+    features.spectralCentroid.insert(features.spectralCentroid.end(),
+                                     block.spectralCentroid.begin(), block.spectralCentroid.end());
+    features.bandEnergy.insert(features.bandEnergy.end(), block.bandEnergy.begin(), block.bandEnergy.end());
+    features.onsets.insert(features.onsets.end(), block.onsets.begin(), block.onsets.end());
+}
+
+void FeatureExtractor::finalize(AudioFeatures& features) const {
+    features.sampleRate = configuredRate;
+    features.hopSize = hopSize;
+    features.frameCount = streamed / hopSize;
+    features.bandCount = numBands;
+    features.mfccCoefficients = numCoeffs;
+
+    // Cepstral mean normalization
+    const size_t numFrames = numCoeffs > 0 ? features.mfcc.size() / numCoeffs : 0;
+    if (numFrames > 0) {
+        std::vector<double> mean(numCoeffs, 0.0);
+        for (size_t f = 0; f < numFrames; ++f) {
+            for (size_t c = 0; c < numCoeffs; ++c) {
+                mean[c] += features.mfcc[f * numCoeffs + c];
+            }
+        }
+        for (size_t f = 0; f < numFrames; ++f) {
+            for (size_t c = 0; c < numCoeffs; ++c) {
+                features.mfcc[f * numCoeffs + c] -= static_cast<float>(mean[c] / numFrames);
+            }
+        }
+    }
+}
@@ -0,0 +1,484 @@
+/**
+ * @file fft_processor.cpp
+ * @brief FFT processor and FFTW plan cache implementation
+ */
+
+#include "fft_processor.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+// FFTW includes (conditional compilation)
+#ifdef USE_FFTW
+#include <fftw3.h>
+#endif
+
+namespace {
+    constexpr float PI = 3.14159265359f;
+    constexpr float TWO_PI = 2.0f * PI;
+    constexpr double TWO_PI_PRECISE = 6.283185307179586476925;
+
+    // Alignment for buffers handed to vectorized kernels (AVX-512 width)
+    constexpr size_t SIMD_ALIGNMENT = 64;
+
+#ifdef USE_FFTW
+    unsigned plannerFlags(fftw::PlannerMode mode) {
+        switch (mode) {
+            case fftw::PlannerMode::MEASURE: return FFTW_MEASURE;
+            case fftw::PlannerMode::PATIENT: return FFTW_PATIENT;
+            default: return FFTW_ESTIMATE;
+        }
+    }
+#endif
+}
+
+namespace fftw {
+
+    // ===========================
+    // Plan Cache Implementation
+    // ===========================
+
+    PlanCache& PlanCache::instance() {
+        static PlanCache cache;
+        return cache;
+    }
+
+    PlanCache::~PlanCache() {
+        clear();
+    }
+
+    void PlanCache::setPlannerMode(PlannerMode newMode) {
+        std::lock_guard<std::mutex> lock(mutex);
+        mode = newMode;
+    }
+
+    PlannerMode PlanCache::getPlannerMode() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return mode;
+    }
+
+    const char* PlanCache::modeName(PlannerMode mode) {
+        switch (mode) {
+            case PlannerMode::MEASURE: return "measure";
+            case PlannerMode::PATIENT: return "patient";
+            default: return "estimate";
+        }
+    }
+
+    void* PlanCache::acquire(size_t size, Direction direction, bool inPlace) {
+#ifdef USE_FFTW
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const Key key{size, direction, inPlace};
+        auto it = plans.find(key);
+        if (it != plans.end()) {
+            return it->second;
+        }
+
+        // Plan on scratch arrays allocated like the processors' buffers, so the
+        // plan is valid for their new-array execute and measuring is harmless
+        const int n = static_cast<int>(size);
+        const unsigned flags = plannerFlags(mode);
+        fftwf_complex* spectrum = fftwf_alloc_complex(size / 2 + 1);
+        float* real = inPlace ? reinterpret_cast<float*>(spectrum) : fftwf_alloc_real(size);
+
+        fftwf_plan plan = direction == Direction::FORWARD
+            ? fftwf_plan_dft_r2c_1d(n, real, spectrum, flags)
+            : fftwf_plan_dft_c2r_1d(n, spectrum, real, flags);
+
+        if (!inPlace) {
+            fftwf_free(real);
+        }
+        fftwf_free(spectrum);
+
+        if (!plan) {
+            throw std::runtime_error("FFTW failed to create plan of size " + std::to_string(size));
+        }
+
+        plans.emplace(key, plan);
+        return plan;
+#else
+        (void)size;
+        (void)direction;
+        (void)inPlace;
+        return nullptr;
+#endif
+    }
+
+    bool PlanCache::loadWisdom(const std::string& path) {
+#ifdef USE_FFTW
+        std::lock_guard<std::mutex> lock(mutex);
+        return fftwf_import_wisdom_from_filename(path.c_str()) != 0;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    bool PlanCache::saveWisdom(const std::string& path) const {
+#ifdef USE_FFTW
+        std::lock_guard<std::mutex> lock(mutex);
+        return fftwf_export_wisdom_to_filename(path.c_str()) != 0;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+    size_t PlanCache::size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return plans.size();
+    }
+
+    void PlanCache::clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+#ifdef USE_FFTW
+        for (auto& entry : plans) {
+            fftwf_destroy_plan(static_cast<fftwf_plan>(entry.second));
+        }
+#endif
+        plans.clear();
+    }
+
+    // ===========================
+    // Aligned Allocation
+    // ===========================
+
+    void* alignedAllocate(size_t bytes) {
+#ifdef USE_FFTW
+        void* ptr = fftwf_malloc(bytes);
+#else
+        // aligned_alloc requires the size to be a multiple of the alignment
+        void* ptr = std::aligned_alloc(SIMD_ALIGNMENT,
+                                       (bytes + SIMD_ALIGNMENT - 1) / SIMD_ALIGNMENT * SIMD_ALIGNMENT);
+#endif
+        if (!ptr && bytes > 0) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    void alignedFree(void* ptr) {
+#ifdef USE_FFTW
+        if (ptr) fftwf_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+
+    // ===========================
+    // Built-in Radix-2 FFT
+    // ===========================
+
+    /**
+     * An N-point real FFT computed as an N/2-point complex FFT of the
+     * even/odd interleaved samples plus one split pass. Bit-reversal and
+     * twiddle tables are built once per processor; butterflies work on
+     * separate real/imaginary operands so the inner loops vectorize.
+     */
+    struct FFTProcessor::BuiltinFFT {
+        explicit BuiltinFFT(size_t size);
+
+        static bool supports(size_t size) {
+            return size >= 2 && (size & (size - 1)) == 0;
+        }
+
+        void forward(const float* input, std::complex<float>* output);
+        void inverse(const std::complex<float>* input, float* output);
+
+    private:
+        void butterflies(bool inverse);
+
+        size_t half;                                // Complex transform length N/2
+        std::vector<uint32_t> bitReverse;           // Permutation for N/2 points
+        std::vector<float> twiddleRe, twiddleIm;    // exp(-2*pi*i*j/(N/2)), j < N/4
+        std::vector<float> splitRe, splitIm;        // exp(-2*pi*i*k/N), k <= N/2
+        std::vector<float> workRe, workIm;
+    };
+
+    FFTProcessor::BuiltinFFT::BuiltinFFT(size_t size)
+        : half(size / 2), bitReverse(half), twiddleRe(half / 2), twiddleIm(half / 2),
+          splitRe(half + 1), splitIm(half + 1), workRe(half), workIm(half) {
+        unsigned bits = 0;
+        while ((size_t{1} << bits) < half) ++bits;
+        for (size_t i = 0; i < half; ++i) {
+            uint32_t reversed = 0;
+            for (unsigned b = 0; b < bits; ++b) {
+                reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+            }
+            bitReverse[i] = reversed;
+        }
+
+        // Tables in double precision so large sizes keep float accuracy
+        for (size_t j = 0; j < half / 2; ++j) {
+            const double angle = -TWO_PI_PRECISE * j / half;
+            twiddleRe[j] = static_cast<float>(std::cos(angle));
+            twiddleIm[j] = static_cast<float>(std::sin(angle));
+        }
+        for (size_t k = 0; k <= half; ++k) {
+            const double angle = -TWO_PI_PRECISE * k / size;
+            splitRe[k] = static_cast<float>(std::cos(angle));
+            splitIm[k] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    void FFTProcessor::BuiltinFFT::butterflies(bool inverse) {
+        float* re = workRe.data();
+        float* im = workIm.data();
+        const float sign = inverse ? -1.0f : 1.0f;
+
+        for (size_t length = 2; length <= half; length <<= 1) {
+            const size_t span = length / 2;
+            const size_t stride = half / length;
+            for (size_t block = 0; block < half; block += length) {
+                float* aRe = re + block;
+                float* aIm = im + block;
+                float* bRe = aRe + span;
+                float* bIm = aIm + span;
+                for (size_t j = 0; j < span; ++j) {
+                    const float wRe = twiddleRe[j * stride];
+                    const float wIm = sign * twiddleIm[j * stride];
+                    const float tRe = bRe[j] * wRe - bIm[j] * wIm;
+                    const float tIm = bRe[j] * wIm + bIm[j] * wRe;
+                    bRe[j] = aRe[j] - tRe;
+                    bIm[j] = aIm[j] - tIm;
+                    aRe[j] += tRe;
+                    aIm[j] += tIm;
+                }
+            }
+        }
+    }
+
+    void FFTProcessor::BuiltinFFT::forward(const float* input, std::complex<float>* output) {
+        // Pack even samples as real and odd samples as imaginary parts
+        for (size_t n = 0; n < half; ++n) {
+            workRe[bitReverse[n]] = input[2 * n];
+            workIm[bitReverse[n]] = input[2 * n + 1];
+        }
+        butterflies(false);
+
+        // Split: X[k] = E[k] + W^k O[k], with E/O recovered from Z[k], conj(Z[M-k])
+        for (size_t k = 0; k <= half; ++k) {
+            const size_t a = k % half;
+            const size_t b = (half - k) % half;
+            const float eRe = 0.5f * (workRe[a] + workRe[b]);
+            const float eIm = 0.5f * (workIm[a] - workIm[b]);
+            const float oRe = 0.5f * (workIm[a] + workIm[b]);
+            const float oIm = -0.5f * (workRe[a] - workRe[b]);
+            output[k] = {eRe + splitRe[k] * oRe - splitIm[k] * oIm,
+                         eIm + splitRe[k] * oIm + splitIm[k] * oRe};
+        }
+    }
+
+    void FFTProcessor::BuiltinFFT::inverse(const std::complex<float>* input, float* output) {
+        // Undo the split; the implicit factor 2 makes the result scaled by N like FFTW
+        for (size_t k = 0; k < half; ++k) {
+            const std::complex<float> x = input[k];
+            const std::complex<float> y = std::conj(input[half - k]);
+            const float eRe = x.real() + y.real();
+            const float eIm = x.imag() + y.imag();
+            const float dRe = x.real() - y.real();
+            const float dIm = x.imag() - y.imag();
+            // O = (X - conj(X[M-k])) * conj(W^k)
+            const float oRe = dRe * splitRe[k] + dIm * splitIm[k];
+            const float oIm = dIm * splitRe[k] - dRe * splitIm[k];
+            workRe[bitReverse[k]] = eRe - oIm;
+            workIm[bitReverse[k]] = eIm + oRe;
+        }
+        butterflies(true);
+
+        for (size_t n = 0; n < half; ++n) {
+            output[2 * n] = workRe[n];
+            output[2 * n + 1] = workIm[n];
+        }
+    }
+
+    // ===========================
+    // FFT Processor Implementation
+    // ===========================
+
+    FFTProcessor::FFTProcessor(size_t size)
+        : size(size), plan_forward(nullptr), plan_inverse(nullptr),
+          plan_forward_inplace(nullptr), plan_inverse_inplace(nullptr) {
+#ifdef USE_FFTW
+        plan_forward = PlanCache::instance().acquire(size, Direction::FORWARD);
+        plan_inverse = PlanCache::instance().acquire(size, Direction::INVERSE);
+#else
+        if (BuiltinFFT::supports(size)) {
+            builtin = std::make_unique<BuiltinFFT>(size);
+        }
+#endif
+        input_buffer = static_cast<float*>(alignedAllocate(size * sizeof(float)));
+        output_buffer = static_cast<std::complex<float>*>(
+            alignedAllocate((size/2 + 1) * sizeof(std::complex<float>)));
+    }
+
+    FFTProcessor::~FFTProcessor() {
+        // Plans belong to the cache and outlive this processor
+        alignedFree(input_buffer);
+        alignedFree(output_buffer);
+    }
+
+    void FFTProcessor::checkSizes(size_t realCount, size_t complexCount) const {
+        if (realCount < size || complexCount < size/2 + 1) {
+            throw std::invalid_argument("Buffer size mismatch for FFT of size " + std::to_string(size));
+        }
+    }
+
+    void FFTProcessor::ensureInPlacePlans() {
+        if (!plan_forward_inplace) {
+            plan_forward_inplace = PlanCache::instance().acquire(size, Direction::FORWARD, true);
+            plan_inverse_inplace = PlanCache::instance().acquire(size, Direction::INVERSE, true);
+        }
+    }
+
+    void FFTProcessor::forward(const std::vector<float>& input,
+                              std::vector<std::complex<float>>& output) {
+        if (input.size() != size) {
+            throw std::invalid_argument("Input size mismatch");
+        }
+        output.resize(size/2 + 1);
+        forward(std::span<const float>(input), std::span<std::complex<float>>(output));
+    }
+
+    void FFTProcessor::inverse(const std::vector<std::complex<float>>& input,
+                              std::vector<float>& output) {
+        if (input.size() != size/2 + 1) {
+            throw std::invalid_argument("Input size mismatch for inverse FFT");
+        }
+
+        // The span path overwrites its input, so stage the caller's copy
+        std::copy(input.begin(), input.end(), output_buffer);
+        output.resize(size);
+        inverse(std::span<std::complex<float>>(output_buffer, size/2 + 1), std::span<float>(output));
+
+        const float scale = 1.0f / size;
+        for (auto& value : output) {
+            value *= scale; // Normalize
+        }
+    }
+
+    void FFTProcessor::forward(std::span<const float> input, std::span<std::complex<float>> output) {
+        checkSizes(input.size(), output.size());
+        float* in = const_cast<float*>(input.data());
+
+#ifdef USE_FFTW
+        auto* out = reinterpret_cast<fftwf_complex*>(output.data());
+        // New-array execute needs the alignment the plan was made with;
+        // r2c without FFTW_DESTROY_INPUT leaves the input untouched
+        if (fftwf_alignment_of(in) == 0 && fftwf_alignment_of(reinterpret_cast<float*>(out)) == 0) {
+            fftwf_execute_dft_r2c(static_cast<fftwf_plan>(plan_forward), in, out);
+        } else {
+            std::copy(input.begin(), input.begin() + size, input_buffer);
+            fftwf_execute_dft_r2c(static_cast<fftwf_plan>(plan_forward), input_buffer,
+                                  reinterpret_cast<fftwf_complex*>(output_buffer));
+            std::copy(output_buffer, output_buffer + size/2 + 1, output.begin());
+        }
+#else
+        if (builtin) {
+            builtin->forward(in, output.data());
+            return;
+        }
+
+        // Direct DFT for sizes the radix-2 path cannot handle
+        for (size_t k = 0; k < size/2 + 1; ++k) {
+            std::complex<float> sum(0.0f, 0.0f);
+            for (size_t n = 0; n < size; ++n) {
+                float angle = -TWO_PI * k * n / size;
+                sum += in[n] * std::complex<float>(std::cos(angle), std::sin(angle));
+            }
+            output[k] = sum;
+        }
+#endif
+    }
+
+    void FFTProcessor::inverse(std::span<std::complex<float>> input, std::span<float> output) {
+        checkSizes(output.size(), input.size());
+
+#ifdef USE_FFTW
+        auto* in = reinterpret_cast<fftwf_complex*>(input.data());
+        if (fftwf_alignment_of(reinterpret_cast<float*>(in)) == 0 &&
+            fftwf_alignment_of(output.data()) == 0) {
+            fftwf_execute_dft_c2r(static_cast<fftwf_plan>(plan_inverse), in, output.data());
+        } else {
+            std::copy(input.begin(), input.begin() + size/2 + 1, output_buffer);
+            fftwf_execute_dft_c2r(static_cast<fftwf_plan>(plan_inverse),
+                                  reinterpret_cast<fftwf_complex*>(output_buffer), input_buffer);
+            std::copy(input_buffer, input_buffer + size, output.begin());
+        }
+#else
+        if (builtin) {
+            builtin->inverse(input.data(), output.data());
+            return;
+        }
+
+        // Direct IDFT (unnormalized, matching FFTW's c2r)
+        for (size_t n = 0; n < size; ++n) {
+            std::complex<float> sum(0.0f, 0.0f);
+            for (size_t k = 0; k < size/2 + 1; ++k) {
+                float angle = TWO_PI * k * n / size;
+                std::complex<float> mult = (k == 0 || k == size/2) ?
+                    input[k] : input[k] * 2.0f; // Account for negative frequencies
+                sum += mult * std::complex<float>(std::cos(angle), std::sin(angle));
+            }
+            output[n] = sum.real();
+        }
+#endif
+    }
+
+    void FFTProcessor::forwardInPlace(std::span<float> buffer) {
+        checkSizes(buffer.size(), buffer.size() / 2);
+        auto* spectrum = reinterpret_cast<std::complex<float>*>(buffer.data());
+
+#ifdef USE_FFTW
+        if (fftwf_alignment_of(buffer.data()) == 0) {
+            ensureInPlacePlans();
+            fftwf_execute_dft_r2c(static_cast<fftwf_plan>(plan_forward_inplace), buffer.data(),
+                                  reinterpret_cast<fftwf_complex*>(spectrum));
+            return;
+        }
+#endif
+        std::copy(buffer.begin(), buffer.begin() + size, input_buffer);
+        forward(std::span<const float>(input_buffer, size),
+                std::span<std::complex<float>>(output_buffer, size/2 + 1));
+        std::copy(output_buffer, output_buffer + size/2 + 1, spectrum);
+    }
+
+    void FFTProcessor::inverseInPlace(std::span<std::complex<float>> buffer) {
+        checkSizes(buffer.size() * 2, buffer.size());
+        float* samples = reinterpret_cast<float*>(buffer.data());
+
+#ifdef USE_FFTW
+        if (fftwf_alignment_of(samples) == 0) {
+            ensureInPlacePlans();
+            fftwf_execute_dft_c2r(static_cast<fftwf_plan>(plan_inverse_inplace),
+                                  reinterpret_cast<fftwf_complex*>(buffer.data()), samples);
+            return;
+        }
+#endif
+        std::copy(buffer.begin(), buffer.begin() + size/2 + 1, output_buffer);
+        inverse(std::span<std::complex<float>>(output_buffer, size/2 + 1),
+                std::span<float>(input_buffer, size));
+        std::copy(input_buffer, input_buffer + size, samples);
+    }
+
+    void FFTProcessor::conjugateMultiply(std::span<const std::complex<float>> a,
+                                         std::span<const std::complex<float>> b,
+                                         std::span<std::complex<float>> out,
+                                         float scale) {
+        const size_t count = std::min({a.size(), b.size(), out.size()});
+        simd::kernels().conjugateMultiply(a.data(), b.data(), out.data(), count, scale);
+    }
+
+    void FFTProcessor::conjugateMultiplyAccumulate(std::span<const std::complex<float>> a,
+                                                   std::span<const std::complex<float>> b,
+                                                   std::span<std::complex<float>> out,
+                                                   float scale) {
+        const size_t count = std::min({a.size(), b.size(), out.size()});
+        simd::kernels().conjugateMultiplyAccumulate(a.data(), b.data(), out.data(), count, scale);
+    }
+}
@@ -4,11 +4,38 @@
  */
 
 #include "transcoder.h"
+#include "fft_processor.h"
+#include "metrics.h"
+#include "sync_benchmark.h"
+#include "watch_service.h"
+#include "work_queue.h"
+#include <csignal>
 #include <iostream>
 #include <filesystem>
 #include <chrono>
 #include <iomanip>
 
+namespace {
+    // Targets of the Ctrl-C handler while a batch, the watch loop or a queue node runs
+    VideoTranscoder* activeTranscoder = nullptr;
+    WatchService* activeWatch = nullptr;
+    QueueNode* activeQueue = nullptr;
+    
+    void handleInterrupt(int) {
+        if (activeWatch) {
+            activeWatch->stop();
+        }
+        if (activeQueue) {
+            activeQueue->stop();
+        }
+        if (activeTranscoder) {
+            activeTranscoder->cancel();
+        }
+        // A second Ctrl-C terminates immediately
+        std::signal(SIGINT, SIG_DFL);
+    }
+}
+
 void printBanner() {
     std::cout << R"(
     ╔══════════════════════════════════════════════════════════════╗
@@ -38,61 +65,51 @@ void printUsage(const char* programName) {
               << "  -c, --confidence FLOAT    Minimum confidence threshold (0.0-1.0, default: 0.3)\n"
               << "  -f, --fallback            Enable fallback processing (default: enabled)\n"
               << "  --no-fallback             Disable fallback processing\n"
+              << "  -j, --jobs N              Concurrent transcodes (default: 1)\n"
+              << "  --sync-jobs N             Concurrent sync analysis workers (default: 1)\n"
+              << "  --analysis-budget SEC     Audio analyzed per file for sync (default: 50)\n"
+              << "  --drift                   Estimate and compensate recorder clock drift\n"
+              << "  --feature-cache DIR       Feature cache (default: OUTPUT/.feature_cache)\n"
+              << "  --no-feature-cache        Always decode and analyze from scratch\n"
+              << "  --no-fingerprint          Match audio by name and duration only\n"
+              << "  --engine NAME             Transcode engine: native [default], ffmpeg\n"
+              << "  --single-pass             Read each video once for sync and transcode (native engine)\n"
+              << "  --spool-memory MB         Single-pass packet spool kept in memory per job (default: 512)\n"
+              << "  --profile NAME            Output video profile (default: prores):\n";
+    for (const auto& profile : OutputProfile::all()) {
+        std::cout << "                              " << std::left << std::setw(19) << profile.name
+                  << std::right << profile.description << "\n";
+    }
+    std::cout << "  --fft-planner MODE        FFTW planning: estimate [default], measure, patient\n"
+              << "  --fft-wisdom FILE         Load FFTW wisdom at startup and save it on exit\n"
+              << "  --watch                   Keep running and process new or changed clips as they arrive\n"
+              << "  --poll-interval SEC       Watch/queue mode: seconds between scans (default: 10)\n"
+              << "  --settle SEC              Watch mode: a file is complete once unchanged this long (default: 5)\n"
+              << "  --queue DIR               Share the batch with other nodes through a work queue in DIR\n"
+              << "  --role ROLE               Queue mode: coordinator, sync, encode or all [default]\n"
+              << "  --lease SEC               Queue mode: claims not renewed this long are requeued (default: 300)\n"
+              << "  --metrics-file FILE       Write stage timings and counters on exit\n"
+              << "                              (Prometheus textfile if FILE ends in .prom, else JSON)\n"
               << "  -v, --verbose             Enable detailed output\n"
               << "  -s, --silent              Minimal output\n"
-              << "  --benchmark               Run performance benchmark\n"
+              << "  --benchmark               Run the sync benchmark on synthetic scenarios\n"
+              << "  --benchmark-corpus DIR    Also benchmark the pairs listed in DIR/offsets.csv\n"
+              << "  --benchmark-json FILE     Write benchmark results as JSON\n"
               << "\nExamples:\n"
               << "  " << programName << "                                    # Process /s3 with standard quality\n"
               << "  " << programName << " -d ./input -o ./output -q 2        # High quality processing\n"
               << "  " << programName << " -c 0.5 --no-fallback              # Strict sync requirements\n"
+              << "  " << programName << " -j 4 --sync-jobs 8                 # Parallel batch on a large host\n"
+              << "  " << programName << " --fft-planner measure --fft-wisdom ~/.vt_wisdom  # Reuse tuned FFT plans\n"
+              << "  " << programName << " --profile copy                     # Attach lav tracks without re-encoding\n"
+              << "  " << programName << " --watch --poll-interval 30         # Ingest service for a shared folder\n"
+              << "  " << programName << " --queue /s3/queue --role coordinator  # Enqueue /s3 for a cluster\n"
+              << "  " << programName << " --queue /s3/queue --role sync -j 1 --sync-jobs 16  # Sync-only worker\n"
               << "  " << programName << " --benchmark                        # Performance testing\n"
               << std::endl;
 }
 
 
-void runBenchmark() {
-    std::cout << "\n🏁 Running Performance Benchmark..." << std::endl;
-    std::cout << "====================================" << std::endl;
-    
-    // This would contain actual benchmark code
-    auto start = std::chrono::high_resolution_clock::now();
-    
-    // Simulate benchmark operations
-    HybridAudioSync audioSync;
-    
-    std::cout << "Testing synchronization algorithms..." << std::endl;
-    std::cout << "• Cross-correlation sync: ✅" << std::endl;
-    std::cout << "• DTW with MFCC features: ✅" << std::endl;
-    std::cout << "• Onset detection: ✅" << std::endl;
-    std::cout << "• Spectral correlation: ✅" << std::endl;
-    
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration<double>(end - start).count();
-    
-    std::cout << "Benchmark completed in " << std::fixed << std::setprecision(3) 
-              << duration << "s" << std::endl;
-    
-#ifdef USE_FFTW
-    std::cout << "FFTW acceleration: ✅ Enabled" << std::endl;
-#else
-    std::cout << "FFTW acceleration: ❌ Disabled (using fallback)" << std::endl;
-#endif
-
-#ifdef USE_AVX2
-    std::cout << "AVX2 SIMD: ✅ Enabled" << std::endl;
-#elif defined(USE_NEON)
-    std::cout << "ARM NEON: ✅ Enabled" << std::endl;
-#else
-    std::cout << "SIMD acceleration: ❌ Not available" << std::endl;
-#endif
-
-#ifdef USE_OPENMP
-    std::cout << "OpenMP parallel processing: ✅ Enabled" << std::endl;
-#else
-    std::cout << "OpenMP parallel processing: ❌ Disabled" << std::endl;
-#endif
-}
-
 int main(int argc, char* argv[]) {
     printBanner();
     
@@ -104,6 +121,25 @@ int main(int argc, char* argv[]) {
     bool enableFallback = true;
     bool verbose = true;
     bool runBenchmarkMode = false;
+    BenchmarkOptions benchmarkOptions;
+    size_t encodeJobs = 1;
+    size_t syncJobs = 1;
+    fftw::PlannerMode fftPlanner = fftw::PlannerMode::ESTIMATE;
+    std::string fftWisdomFile;
+    std::filesystem::path metricsFile;
+    bool watchMode = false;
+    WatchOptions watchOptions;
+    std::filesystem::path queueDir;
+    QueueNodeOptions queueOptions;
+    double analysisBudget = 0.0;
+    bool driftCompensation = false;
+    std::filesystem::path featureCacheDir;
+    bool fingerprintMatching = true;
+    bool nativeTranscode = true;
+    bool singlePass = false;
+    size_t spoolMegabytes = 512;
+    const OutputProfile* outputProfile = &OutputProfile::defaultProfile();
+    bool useFeatureCache = true;
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -163,6 +199,205 @@ int main(int argc, char* argv[]) {
         else if (arg == "--no-fallback") {
             enableFallback = false;
         }
+        else if (arg == "-j" || arg == "--jobs") {
+            if (i + 1 < argc) {
+                int jobs = std::atoi(argv[++i]);
+                if (jobs < 1) {
+                    std::cerr << "❌ Error: --jobs must be at least 1" << std::endl;
+                    return 1;
+                }
+                encodeJobs = static_cast<size_t>(jobs);
+            } else {
+                std::cerr << "❌ Error: --jobs requires a count" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--sync-jobs") {
+            if (i + 1 < argc) {
+                int jobs = std::atoi(argv[++i]);
+                if (jobs < 1) {
+                    std::cerr << "❌ Error: --sync-jobs must be at least 1" << std::endl;
+                    return 1;
+                }
+                syncJobs = static_cast<size_t>(jobs);
+            } else {
+                std::cerr << "❌ Error: --sync-jobs requires a count" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--analysis-budget") {
+            if (i + 1 < argc) {
+                analysisBudget = std::atof(argv[++i]);
+                if (analysisBudget <= 0.0) {
+                    std::cerr << "❌ Error: --analysis-budget must be positive" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "❌ Error: --analysis-budget requires a duration in seconds" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--drift") {
+            driftCompensation = true;
+        }
+        else if (arg == "--feature-cache") {
+            if (i + 1 < argc) {
+                featureCacheDir = argv[++i];
+                useFeatureCache = true;
+            } else {
+                std::cerr << "❌ Error: --feature-cache requires a directory path" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--no-feature-cache") {
+            useFeatureCache = false;
+        }
+        else if (arg == "--no-fingerprint") {
+            fingerprintMatching = false;
+        }
+        else if (arg == "--engine") {
+            if (i + 1 < argc) {
+                std::string engine = argv[++i];
+                if (engine == "native") {
+                    nativeTranscode = true;
+                } else if (engine == "ffmpeg") {
+                    nativeTranscode = false;
+                } else {
+                    std::cerr << "❌ Error: --engine must be native or ffmpeg" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "❌ Error: --engine requires a name" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--single-pass") {
+            singlePass = true;
+        }
+        else if (arg == "--spool-memory") {
+            if (i + 1 < argc) {
+                int megabytes = std::atoi(argv[++i]);
+                if (megabytes < 1) {
+                    std::cerr << "❌ Error: --spool-memory must be at least 1" << std::endl;
+                    return 1;
+                }
+                spoolMegabytes = static_cast<size_t>(megabytes);
+            } else {
+                std::cerr << "❌ Error: --spool-memory requires a size in MB" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--profile") {
+            if (i + 1 < argc) {
+                outputProfile = OutputProfile::find(argv[++i]);
+                if (!outputProfile) {
+                    std::cerr << "❌ Error: unknown profile '" << argv[i] << "'. Available:";
+                    for (const auto& profile : OutputProfile::all()) {
+                        std::cerr << " " << profile.name;
+                    }
+                    std::cerr << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "❌ Error: --profile requires a name" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--fft-planner") {
+            if (i + 1 < argc) {
+                std::string mode = argv[++i];
+                if (mode == "estimate") {
+                    fftPlanner = fftw::PlannerMode::ESTIMATE;
+                } else if (mode == "measure") {
+                    fftPlanner = fftw::PlannerMode::MEASURE;
+                } else if (mode == "patient") {
+                    fftPlanner = fftw::PlannerMode::PATIENT;
+                } else {
+                    std::cerr << "❌ Error: Invalid FFT planner. Use estimate, measure, or patient." << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "❌ Error: --fft-planner requires a mode" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--fft-wisdom") {
+            if (i + 1 < argc) {
+                fftWisdomFile = argv[++i];
+            } else {
+                std::cerr << "❌ Error: --fft-wisdom requires a file path" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--watch") {
+            watchMode = true;
+        }
+        else if (arg == "--poll-interval") {
+            if (i + 1 < argc) {
+                watchOptions.pollInterval = std::atof(argv[++i]);
+                if (watchOptions.pollInterval <= 0.0) {
+                    std::cerr << "❌ Error: --poll-interval must be positive" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "❌ Error: --poll-interval requires seconds" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--settle") {
+            if (i + 1 < argc) {
+                watchOptions.settleSeconds = std::atof(argv[++i]);
+                if (watchOptions.settleSeconds < 0.0) {
+                    std::cerr << "❌ Error: --settle cannot be negative" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "❌ Error: --settle requires seconds" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--queue") {
+            if (i + 1 < argc) {
+                queueDir = argv[++i];
+            } else {
+                std::cerr << "❌ Error: --queue requires a directory" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--role") {
+            if (i + 1 < argc) {
+                auto role = QueueNode::parseRole(argv[++i]);
+                if (!role) {
+                    std::cerr << "❌ Error: Unknown role: " << argv[i]
+                              << " (use coordinator, sync, encode or all)" << std::endl;
+                    return 1;
+                }
+                queueOptions.role = *role;
+            } else {
+                std::cerr << "❌ Error: --role requires a role" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--lease") {
+            if (i + 1 < argc) {
+                queueOptions.leaseSeconds = std::atof(argv[++i]);
+                if (queueOptions.leaseSeconds <= 0.0) {
+                    std::cerr << "❌ Error: --lease must be positive" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "❌ Error: --lease requires seconds" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--metrics-file") {
+            if (i + 1 < argc) {
+                metricsFile = argv[++i];
+            } else {
+                std::cerr << "❌ Error: --metrics-file requires a file path" << std::endl;
+                return 1;
+            }
+        }
         else if (arg == "-v" || arg == "--verbose") {
             verbose = true;
         }
@@ -172,6 +407,24 @@ int main(int argc, char* argv[]) {
         else if (arg == "--benchmark") {
             runBenchmarkMode = true;
         }
+        else if (arg == "--benchmark-corpus") {
+            if (i + 1 < argc) {
+                benchmarkOptions.corpusDirectory = argv[++i];
+                runBenchmarkMode = true;
+            } else {
+                std::cerr << "❌ Error: --benchmark-corpus requires a directory" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--benchmark-json") {
+            if (i + 1 < argc) {
+                benchmarkOptions.jsonFile = argv[++i];
+                runBenchmarkMode = true;
+            } else {
+                std::cerr << "❌ Error: --benchmark-json requires a file path" << std::endl;
+                return 1;
+            }
+        }
         else {
             std::cerr << "❌ Error: Unknown option: " << arg << std::endl;
             printUsage(argv[0]);
@@ -179,14 +432,51 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // FFT plans are shared process-wide; configure the planner before any
+    // processor exists so every plan picks up the mode and imported wisdom
+    auto& planCache = fftw::PlanCache::instance();
+    planCache.setPlannerMode(fftPlanner);
+    if (!fftWisdomFile.empty() && std::filesystem::exists(fftWisdomFile)) {
+        if (planCache.loadWisdom(fftWisdomFile)) {
+            std::cout << "🧠 Loaded FFT wisdom: " << fftWisdomFile << std::endl;
+        } else {
+            std::cerr << "⚠️  Could not load FFT wisdom: " << fftWisdomFile << std::endl;
+        }
+    }
+    
+    auto saveWisdom = [&]() {
+        if (!fftWisdomFile.empty() && !planCache.saveWisdom(fftWisdomFile)) {
+            std::cerr << "⚠️  Could not save FFT wisdom: " << fftWisdomFile << std::endl;
+        }
+    };
+    
+    auto writeMetrics = [&]() {
+        if (metricsFile.empty()) return;
+        if (metrics::Registry::instance().writeFile(metricsFile)) {
+            std::cout << "📈 Metrics written: " << metricsFile.string() << std::endl;
+        } else {
+            std::cerr << "⚠️  Could not write metrics: " << metricsFile.string() << std::endl;
+        }
+    };
+    
     // Run benchmark if requested
     if (runBenchmarkMode) {
-        runBenchmark();
-        return 0;
+        benchmarkOptions.verbose = false;
+        bool passed = SyncBenchmark(std::move(benchmarkOptions)).run();
+        saveWisdom();
+        writeMetrics();
+        return passed ? 0 : 1;
+    }
+    
+    const bool queueMode = !queueDir.empty();
+    if (queueMode && watchMode) {
+        std::cerr << "❌ Error: --queue and --watch cannot be combined" << std::endl;
+        return 1;
     }
     
-    // Validate input directory
-    if (!std::filesystem::exists(inputDir)) {
+    // Validate input directory (queue workers take theirs from the queued jobs)
+    const bool queueWorker = queueMode && queueOptions.role != NodeRole::COORDINATOR;
+    if (!queueWorker && !std::filesystem::exists(inputDir)) {
         std::cerr << "❌ ERROR: Input directory not found: " << inputDir << std::endl;
         return 1;
     }
@@ -213,18 +503,94 @@ int main(int argc, char* argv[]) {
     std::cout << "  Confidence threshold: " << confidenceThreshold << std::endl;
     std::cout << "  Fallback processing: " << (enableFallback ? "enabled" : "disabled") << std::endl;
     std::cout << "  Verbose output: " << (verbose ? "enabled" : "disabled") << std::endl;
+    std::cout << "  Workers: " << syncJobs << " sync, " << encodeJobs << " encode" << std::endl;
+    if (useFeatureCache && featureCacheDir.empty()) {
+        featureCacheDir = outputDir / ".feature_cache";
+    }
+    std::cout << "  Feature cache: " << (useFeatureCache ? featureCacheDir.string() : "disabled") << std::endl;
+    std::cout << "  Drift compensation: " << (driftCompensation ? "enabled" : "disabled") << std::endl;
+    std::cout << "  Fingerprint matching: " << (fingerprintMatching ? "enabled" : "disabled") << std::endl;
+    std::cout << "  Transcode engine: " << (nativeTranscode ? "native" : "ffmpeg") << std::endl;
+    std::cout << "  Single-demux pipeline: " << (singlePass ? "enabled" : "disabled") << std::endl;
+    std::cout << "  Watch mode: " << (watchMode ? "enabled" : "disabled") << std::endl;
+    if (queueMode) {
+        std::cout << "  Work queue: " << queueDir.string() << " (" << QueueNode::roleName(queueOptions.role)
+                  << ")" << std::endl;
+        if (singlePass) {
+            std::cout << "  ⚠️  Single-demux pipeline is not used in queue mode" << std::endl;
+        }
+    }
+    std::cout << "  Output profile: " << outputProfile->name << std::endl;
+    std::cout << "  FFT planner: " << fftw::PlanCache::modeName(fftPlanner);
+    if (!fftWisdomFile.empty()) {
+        std::cout << " (wisdom: " << fftWisdomFile << ")";
+    }
+    std::cout << std::endl;
     
     // Initialize transcoder
     VideoTranscoder transcoder;
     transcoder.setVerbose(verbose);
     transcoder.setConfidenceThreshold(confidenceThreshold);
     transcoder.setFallbackProcessing(enableFallback);
+    transcoder.setParallelism(encodeJobs, syncJobs);
+    transcoder.setAnalysisBudget(analysisBudget);
+    transcoder.setDriftCompensation(driftCompensation);
+    transcoder.setFeatureCache(useFeatureCache ? featureCacheDir : std::filesystem::path());
+    transcoder.setFingerprintMatching(fingerprintMatching);
+    transcoder.setNativeTranscode(nativeTranscode);
+    transcoder.setSinglePass(singlePass, spoolMegabytes);
+    transcoder.setOutputProfile(*outputProfile);
+    
+    // Watch mode runs batches until Ctrl-C; caches and FFT plans stay warm between them
+    if (watchMode) {
+        WatchService service(transcoder, inputDir, outputDir, quality, watchOptions);
+        activeTranscoder = &transcoder;
+        activeWatch = &service;
+        std::signal(SIGINT, handleInterrupt);
+        std::signal(SIGTERM, handleInterrupt);
+        bool ran = service.run();
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        activeWatch = nullptr;
+        activeTranscoder = nullptr;
+        saveWisdom();
+        writeMetrics();
+        return ran ? 0 : 1;
+    }
+    
+    // Queue mode: this process is one node of a batch shared through a directory
+    if (queueMode) {
+        queueOptions.pollInterval = watchOptions.pollInterval;
+        queueOptions.syncWorkers = syncJobs;
+        queueOptions.encodeWorkers = encodeJobs;
+        QueueNode node(transcoder, queueDir, queueOptions);
+        activeTranscoder = &transcoder;
+        activeQueue = &node;
+        std::signal(SIGINT, handleInterrupt);
+        std::signal(SIGTERM, handleInterrupt);
+        bool ran = queueOptions.role == NodeRole::COORDINATOR
+            ? node.submit(inputDir, outputDir, quality, outputProfile->name) && node.collect()
+            : node.work();
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        activeQueue = nullptr;
+        activeTranscoder = nullptr;
+        saveWisdom();
+        writeMetrics();
+        return ran ? 0 : 1;
+    }
     
     // Record start time
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    // Run transcoding
+    // Run transcoding; Ctrl-C finishes nothing new and aborts running transcodes
+    activeTranscoder = &transcoder;
+    std::signal(SIGINT, handleInterrupt);
     bool success = transcoder.processAll(inputDir, outputDir, quality);
+    std::signal(SIGINT, SIG_DFL);
+    activeTranscoder = nullptr;
+    saveWisdom();
+    writeMetrics();
     
     // Record end time
     auto endTime = std::chrono::high_resolution_clock::now();
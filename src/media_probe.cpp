@@ -0,0 +1,200 @@
+/**
+ * @file media_probe.cpp
+ * @brief libavformat based probing and probe cache implementation
+ */
+
+#include "media_probe.h"
+#include "av_utils.h"
+#include "metrics.h"
+#include "thread_pool.h"
+#include "wav_reader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <system_error>
+
+namespace {
+    /**
+     * @brief Seconds since midnight of an "HH:MM:SS:FF" (or ';'/'.' separated) timecode
+     */
+    std::optional<double> parseTimecode(const char* text, AVRational frameRate) {
+        int hours = 0, minutes = 0, seconds = 0, frames = 0;
+        char separator = 0;
+        if (!text || std::sscanf(text, "%d:%d:%d%c%d", &hours, &minutes, &seconds, &separator, &frames) != 5 ||
+            hours < 0 || hours > 23 || minutes < 0 || minutes > 59 || seconds < 0 || seconds > 59 || frames < 0) {
+            return std::nullopt;
+        }
+        // Drop-frame labels run slightly ahead of real time; the label time is what both devices jam to
+        double time = hours * 3600.0 + minutes * 60.0 + seconds;
+        if (frameRate.num > 0 && frameRate.den > 0) {
+            const double nominal = std::round(av_q2d(frameRate));
+            if (nominal > 0.0) time += frames / nominal;
+        }
+        return time;
+    }
+
+    std::optional<double> findTimecode(const AVFormatContext* format) {
+        for (unsigned int i = 0; i < format->nb_streams; ++i) {
+            const AVStream* stream = format->streams[i];
+            if (stream->codecpar->codec_type != AVMEDIA_TYPE_VIDEO) continue;
+            const AVDictionaryEntry* tag = av_dict_get(stream->metadata, "timecode", nullptr, 0);
+            if (!tag) tag = av_dict_get(format->metadata, "timecode", nullptr, 0);
+            if (tag) return parseTimecode(tag->value, stream->avg_frame_rate);
+        }
+        // QuickTime keeps it on a tmcd data stream
+        for (unsigned int i = 0; i < format->nb_streams; ++i) {
+            const AVStream* stream = format->streams[i];
+            if (const AVDictionaryEntry* tag = av_dict_get(stream->metadata, "timecode", nullptr, 0)) {
+                return parseTimecode(tag->value, stream->avg_frame_rate);
+            }
+        }
+        return std::nullopt;
+    }
+}
+
+// ===========================
+// MediaInfo Implementation
+// ===========================
+
+size_t MediaInfo::audioStreamCount() const {
+    return std::count_if(streams.begin(), streams.end(), [](const MediaStreamInfo& s) {
+        return s.type == MediaStreamInfo::Type::AUDIO;
+    });
+}
+
+size_t MediaInfo::videoStreamCount() const {
+    return std::count_if(streams.begin(), streams.end(), [](const MediaStreamInfo& s) {
+        return s.type == MediaStreamInfo::Type::VIDEO;
+    });
+}
+
+const MediaStreamInfo* MediaInfo::primaryAudio() const {
+    for (const auto& stream : streams) {
+        if (stream.type == MediaStreamInfo::Type::AUDIO) return &stream;
+    }
+    return nullptr;
+}
+
+const MediaStreamInfo* MediaInfo::primaryVideo() const {
+    for (const auto& stream : streams) {
+        if (stream.type == MediaStreamInfo::Type::VIDEO) return &stream;
+    }
+    return nullptr;
+}
+
+// ===========================
+// MediaProbeCache Implementation
+// ===========================
+
+MediaInfo MediaProbeCache::probe(const std::filesystem::path& file) {
+    metrics::ScopedTimer timer("probe");
+    MediaInfo info;
+
+    std::string error;
+    auto format = av::openInput(file.string(), error);
+    if (!format) {
+        return info;
+    }
+
+    info.valid = true;
+    info.formatName = format->iformat ? format->iformat->name : "";
+    if (format->duration != AV_NOPTS_VALUE && format->duration > 0) {
+        info.duration = static_cast<double>(format->duration) / AV_TIME_BASE;
+    }
+
+    info.streams.reserve(format->nb_streams);
+    for (unsigned int i = 0; i < format->nb_streams; ++i) {
+        const AVCodecParameters* params = format->streams[i]->codecpar;
+
+        MediaStreamInfo stream;
+        stream.codec = avcodec_get_name(params->codec_id);
+        if (params->codec_type == AVMEDIA_TYPE_AUDIO) {
+            stream.type = MediaStreamInfo::Type::AUDIO;
+            stream.sampleRate = params->sample_rate;
+            stream.channels = params->ch_layout.nb_channels;
+        } else if (params->codec_type == AVMEDIA_TYPE_VIDEO) {
+            stream.type = MediaStreamInfo::Type::VIDEO;
+            stream.width = params->width;
+            stream.height = params->height;
+        }
+        info.streams.push_back(std::move(stream));
+    }
+
+    info.startTimecode = findTimecode(format.get());
+    if (!info.startTimecode && WavReader::isWavFile(file)) {
+        WavReader wav;
+        if (wav.open(file)) {
+            info.startTimecode = wav.timeReferenceSeconds();
+        }
+    }
+
+    return info;
+}
+
+MediaInfo MediaProbeCache::get(const std::filesystem::path& file) {
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(file, ec);
+    auto size = ec ? 0 : std::filesystem::file_size(file, ec);
+    if (ec) {
+        return MediaInfo{};
+    }
+
+    const std::string key = file.lexically_normal().string();
+    std::shared_future<MediaInfo> pending;
+    std::promise<MediaInfo> promise;
+    bool owner = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.mtime == mtime && it->second.size == size) {
+            pending = it->second.info;
+        } else {
+            pending = promise.get_future().share();
+            entries[key] = Entry{mtime, size, pending};
+            owner = true;
+        }
+    }
+
+    metrics::Registry::instance().increment(owner ? "probe_cache_miss" : "probe_cache_hit");
+
+    // Probe outside the lock; concurrent callers for this file wait on the future
+    if (owner) {
+        try {
+            promise.set_value(probe(file));
+        } catch (...) {
+            // Waiters see the failure; the next call probes again
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = entries.find(key);
+                if (it != entries.end() && it->second.mtime == mtime && it->second.size == size) {
+                    entries.erase(it);
+                }
+            }
+            promise.set_exception(std::current_exception());
+        }
+    }
+    return pending.get();
+}
+
+void MediaProbeCache::prefetch(const std::vector<std::filesystem::path>& files, size_t threads) {
+    if (files.empty()) {
+        return;
+    }
+
+    ThreadPool pool(std::min(std::max<size_t>(1, threads), files.size()));
+    for (const auto& file : files) {
+        pool.submit([this, file]() { get(file); });
+    }
+    pool.waitIdle();
+}
+
+void MediaProbeCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+size_t MediaProbeCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
@@ -0,0 +1,226 @@
+/**
+ * @file metrics.cpp
+ * @brief Metrics registry, percentile summaries and JSON/Prometheus export
+ */
+
+#include "metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+    // Prometheus metric family names
+    constexpr const char* STAGE_FAMILY = "video_transcoder_stage_seconds";
+    constexpr const char* COUNTER_FAMILY = "video_transcoder_events_total";
+
+    // Quantile from sorted samples, interpolating between neighbours
+    double quantile(const std::vector<double>& sorted, double q) {
+        if (sorted.empty()) return 0.0;
+        const double position = q * (sorted.size() - 1);
+        const size_t below = static_cast<size_t>(position);
+        const size_t above = std::min(below + 1, sorted.size() - 1);
+        return sorted[below] + (position - below) * (sorted[above] - sorted[below]);
+    }
+
+    std::string number(double value) {
+        if (!std::isfinite(value)) return "0";
+        std::ostringstream text;
+        text << std::setprecision(9) << value;
+        return text.str();
+    }
+
+    // Escapes for JSON strings and Prometheus label values
+    std::string escaped(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (c == '\n') {
+                out += "\\n";
+                continue;
+            }
+            out += c;
+        }
+        return out;
+    }
+}
+
+namespace metrics {
+
+    // ===========================
+    // Registry Implementation
+    // ===========================
+
+    Registry& Registry::instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    void Registry::record(const std::string& stage, double seconds) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Histogram& histogram = histograms[stage];
+        if (histogram.count == 0) {
+            histogram.min = histogram.max = seconds;
+        } else {
+            histogram.min = std::min(histogram.min, seconds);
+            histogram.max = std::max(histogram.max, seconds);
+        }
+        histogram.count++;
+        histogram.sum += seconds;
+
+        // Reservoir sampling (algorithm R) keeps a uniform sample of every run
+        if (histogram.reservoir.size() < RESERVOIR_SIZE) {
+            histogram.reservoir.push_back(seconds);
+        } else {
+            randomState ^= randomState << 13;
+            randomState ^= randomState >> 7;
+            randomState ^= randomState << 17;
+            const size_t slot = static_cast<size_t>(randomState % histogram.count);
+            if (slot < RESERVOIR_SIZE) histogram.reservoir[slot] = seconds;
+        }
+    }
+
+    void Registry::increment(const std::string& counter, double amount) {
+        std::lock_guard<std::mutex> lock(mutex);
+        counterValues[counter] += amount;
+    }
+
+    std::map<std::string, StageSummary> Registry::stages() const {
+        std::map<std::string, StageSummary> summaries;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [name, histogram] : histograms) {
+            std::vector<double> sorted = histogram.reservoir;
+            std::sort(sorted.begin(), sorted.end());
+
+            StageSummary& summary = summaries[name];
+            summary.count = histogram.count;
+            summary.sum = histogram.sum;
+            summary.min = histogram.min;
+            summary.max = histogram.max;
+            summary.p50 = quantile(sorted, 0.50);
+            summary.p95 = quantile(sorted, 0.95);
+            summary.p99 = quantile(sorted, 0.99);
+        }
+        return summaries;
+    }
+
+    std::map<std::string, double> Registry::counters() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counterValues;
+    }
+
+    void Registry::reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        histograms.clear();
+        counterValues.clear();
+        startTime = std::chrono::system_clock::now();
+    }
+
+    std::string Registry::toJson() const {
+        const auto summaries = stages();
+        const auto events = counters();
+        std::chrono::system_clock::time_point since;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            since = startTime;
+        }
+        const auto now = std::chrono::system_clock::now();
+
+        std::ostringstream json;
+        json << "{\n"
+             << "  \"timestamp\": " << std::chrono::duration_cast<std::chrono::seconds>(
+                    now.time_since_epoch()).count() << ",\n"
+             << "  \"elapsed_seconds\": " << number(std::chrono::duration<double>(now - since).count()) << ",\n"
+             << "  \"stages\": {";
+        bool first = true;
+        for (const auto& [name, s] : summaries) {
+            json << (first ? "\n" : ",\n") << "    \"" << escaped(name) << "\": {"
+                 << "\"count\": " << s.count << ", \"sum\": " << number(s.sum)
+                 << ", \"min\": " << number(s.min) << ", \"max\": " << number(s.max)
+                 << ", \"p50\": " << number(s.p50) << ", \"p95\": " << number(s.p95)
+                 << ", \"p99\": " << number(s.p99) << "}";
+            first = false;
+        }
+        json << (first ? "" : "\n  ") << "},\n  \"counters\": {";
+        first = true;
+        for (const auto& [name, value] : events) {
+            json << (first ? "\n" : ",\n") << "    \"" << escaped(name) << "\": " << number(value);
+            first = false;
+        }
+        json << (first ? "" : "\n  ") << "}\n}\n";
+        return json.str();
+    }
+
+    std::string Registry::toPrometheus() const {
+        const auto summaries = stages();
+        const auto events = counters();
+
+        std::ostringstream text;
+        text << "# HELP " << STAGE_FAMILY << " Wall time per pipeline stage invocation\n"
+             << "# TYPE " << STAGE_FAMILY << " summary\n";
+        for (const auto& [name, s] : summaries) {
+            const std::string label = "stage=\"" + escaped(name) + "\"";
+            text << STAGE_FAMILY << "{" << label << ",quantile=\"0.5\"} " << number(s.p50) << "\n"
+                 << STAGE_FAMILY << "{" << label << ",quantile=\"0.95\"} " << number(s.p95) << "\n"
+                 << STAGE_FAMILY << "{" << label << ",quantile=\"0.99\"} " << number(s.p99) << "\n"
+                 << STAGE_FAMILY << "_sum{" << label << "} " << number(s.sum) << "\n"
+                 << STAGE_FAMILY << "_count{" << label << "} " << s.count << "\n";
+        }
+        text << "# HELP " << COUNTER_FAMILY << " Pipeline events\n"
+             << "# TYPE " << COUNTER_FAMILY << " counter\n";
+        for (const auto& [name, value] : events) {
+            text << COUNTER_FAMILY << "{event=\"" << escaped(name) << "\"} " << number(value) << "\n";
+        }
+        return text.str();
+    }
+
+    bool Registry::writeFile(const std::filesystem::path& file) const {
+        const std::string content = file.extension() == ".prom" ? toPrometheus() : toJson();
+
+        // Collectors may read at any moment; rename makes the update atomic
+        std::filesystem::path temp = file;
+        temp += ".tmp." + std::to_string(::getpid());
+        {
+            std::ofstream out(temp, std::ios::trunc);
+            out << content;
+            if (!out) {
+                out.close();
+                std::error_code ec;
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temp, file, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    void Registry::printReport(std::ostream& out) const {
+        const auto summaries = stages();
+        if (summaries.empty()) return;
+
+        // Largest share of wall-clock first
+        std::vector<std::pair<std::string, StageSummary>> ordered(summaries.begin(), summaries.end());
+        std::stable_sort(ordered.begin(), ordered.end(),
+                         [](const auto& a, const auto& b) { return a.second.sum > b.second.sum; });
+
+        out << "\n⏱️  Stage timings (seconds):" << std::endl;
+        out << "  " << std::left << std::setw(26) << "stage" << std::right << std::setw(7) << "count"
+            << std::setw(10) << "total" << std::setw(9) << "p50" << std::setw(9) << "p95"
+            << std::setw(9) << "p99" << std::endl;
+        for (const auto& [name, s] : ordered) {
+            out << "  " << std::left << std::setw(26) << name << std::right << std::setw(7) << s.count
+                << std::fixed << std::setprecision(2) << std::setw(10) << s.sum << std::setprecision(3)
+                << std::setw(9) << s.p50 << std::setw(9) << s.p95 << std::setw(9) << s.p99 << std::endl;
+        }
+        out << std::defaultfloat;
+    }
+}
@@ -0,0 +1,136 @@
+/**
+ * @file output_profile.cpp
+ * @brief Built-in output profiles
+ */
+
+#include "output_profile.h"
+#include "av_utils.h"
+#include <sstream>
+
+namespace {
+    constexpr const char* PRORES_ENCODER = "prores_ks";
+    constexpr const char* PRORES_VENDOR = "apl0";
+
+    // Hardware encoders are tried in this order; the first that opens wins
+    struct HardwareBackend {
+        const char* suffix;               // Encoder name suffix (h264_<suffix>)
+        const char* label;
+    };
+    constexpr HardwareBackend HARDWARE_BACKENDS[] = {
+        {"videotoolbox", "VideoToolbox"}, {"nvenc", "NVENC"}, {"qsv", "Quick Sync"}};
+
+    // Mezzanine-grade rates: far below ProRes, well above delivery encodes
+    constexpr const char* HEVC_BITRATE = "80M";
+    constexpr const char* H264_BITRATE = "60M";
+    constexpr const char* NVENC_CONSTANT_QUALITY = "19";
+
+    OutputProfile makeProRes(const std::string& name, const std::string& description,
+                             const std::string& profile, const std::string& pixelFormat) {
+        OutputProfile result;
+        result.name = name;
+        result.description = description;
+        result.encoders.push_back({PRORES_ENCODER, pixelFormat, "",
+                                   {{"profile", profile}, {"vendor", PRORES_VENDOR}}});
+        return result;
+    }
+
+    VideoEncoderSettings makeHardwareEncoder(const std::string& codec, const std::string& backend) {
+        const bool hevc = codec == "hevc";
+        VideoEncoderSettings settings;
+        settings.encoder = codec + "_" + backend;
+        // Apple players only accept HEVC in QuickTime with the hvc1 tag
+        settings.codecTag = hevc ? "hvc1" : "";
+        if (backend == "nvenc") {
+            settings.pixelFormat = hevc ? "p010le" : "yuv420p";
+            settings.options = {{"preset", "p5"}, {"rc", "vbr"}, {"cq", NVENC_CONSTANT_QUALITY}, {"b", "0"}};
+        } else if (backend == "qsv") {
+            settings.pixelFormat = hevc ? "p010le" : "nv12";
+            settings.options = {{"preset", "medium"}, {"b", hevc ? HEVC_BITRATE : H264_BITRATE}};
+        } else {
+            settings.pixelFormat = hevc ? "p010le" : "nv12";
+            settings.options = {{"b", hevc ? HEVC_BITRATE : H264_BITRATE}};
+        }
+        return settings;
+    }
+
+    std::vector<OutputProfile> makeProfiles() {
+        std::vector<OutputProfile> profiles;
+
+        OutputProfile standard = makeProRes("prores", "ProRes 422 [default]", "2", "yuv422p10le");
+        standard.encoders.front().options.emplace_back("bits_per_mb", "8000");
+        profiles.push_back(std::move(standard));
+        profiles.push_back(makeProRes("prores-proxy", "ProRes 422 Proxy", "0", "yuv422p10le"));
+        profiles.push_back(makeProRes("prores-lt", "ProRes 422 LT", "1", "yuv422p10le"));
+        profiles.push_back(makeProRes("prores-hq", "ProRes 422 HQ", "3", "yuv422p10le"));
+        profiles.push_back(makeProRes("prores-4444", "ProRes 4444", "4", "yuv444p10le"));
+
+        OutputProfile copy;
+        copy.name = "copy";
+        copy.description = "Camera video stream copied, PCM audio muxed (remux only)";
+        copy.copyVideo = true;
+        profiles.push_back(std::move(copy));
+
+        for (const std::string codec : {"hevc", "h264"}) {
+            const std::string label = codec == "hevc" ? "HEVC" : "H.264";
+
+            OutputProfile automatic;
+            automatic.name = codec + "-hw";
+            automatic.description = label + " on the first available hardware encoder";
+            for (const auto& backend : HARDWARE_BACKENDS) {
+                automatic.encoders.push_back(makeHardwareEncoder(codec, backend.suffix));
+            }
+            profiles.push_back(std::move(automatic));
+
+            for (const auto& backend : HARDWARE_BACKENDS) {
+                OutputProfile single;
+                single.name = codec + "-" + backend.suffix;
+                single.description = label + " on " + backend.label;
+                single.encoders.push_back(makeHardwareEncoder(codec, backend.suffix));
+                profiles.push_back(std::move(single));
+            }
+        }
+        return profiles;
+    }
+}
+
+const std::vector<OutputProfile>& OutputProfile::all() {
+    static const std::vector<OutputProfile> profiles = makeProfiles();
+    return profiles;
+}
+
+const OutputProfile& OutputProfile::defaultProfile() {
+    return all().front();
+}
+
+const OutputProfile* OutputProfile::find(const std::string& name) {
+    for (const auto& profile : all()) {
+        if (profile.name == name) {
+            return &profile;
+        }
+    }
+    return nullptr;
+}
+
+std::string OutputProfile::ffmpegVideoArguments() const {
+    if (copyVideo || encoders.empty()) {
+        return "-c:v copy ";
+    }
+
+    const VideoEncoderSettings* chosen = &encoders.front();
+    for (const auto& settings : encoders) {
+        if (avcodec_find_encoder_by_name(settings.encoder.c_str())) {
+            chosen = &settings;
+            break;
+        }
+    }
+
+    std::ostringstream arguments;
+    arguments << "-c:v " << chosen->encoder << " -pix_fmt " << chosen->pixelFormat << " ";
+    if (!chosen->codecTag.empty()) {
+        arguments << "-tag:v " << chosen->codecTag << " ";
+    }
+    for (const auto& [key, value] : chosen->options) {
+        arguments << "-" << key << ":v " << value << " ";
+    }
+    return arguments.str();
+}
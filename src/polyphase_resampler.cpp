@@ -0,0 +1,128 @@
+/**
+ * @file polyphase_resampler.cpp
+ * @brief Polyphase filter design and streaming evaluation
+ */
+
+#include "polyphase_resampler.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    // Kernel width in input samples at ratio 1, widened by the decimation factor
+    constexpr size_t BASE_TAPS = 32;
+    constexpr double KAISER_BETA = 8.0;
+
+    // Cutoff as a fraction of the lower Nyquist frequency
+    constexpr double PASSBAND = 0.92;
+
+    // Drop consumed input once this much has piled up
+    constexpr size_t HISTORY_COMPACT_THRESHOLD = 1 << 16;
+
+    double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 64; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+}
+
+PolyphaseResampler::PolyphaseResampler(int inputRate, int outputRate) {
+    if (inputRate <= 0 || outputRate <= 0) {
+        return;
+    }
+    const int divisor = std::gcd(inputRate, outputRate);
+    const size_t phases = static_cast<size_t>(outputRate / divisor);
+    if (phases > MAX_PHASES) {
+        return;
+    }
+    up = phases;
+    down = static_cast<size_t>(inputRate / divisor);
+
+    // Cutoff in cycles per input sample
+    const double ratio = std::min(1.0, static_cast<double>(up) / down);
+    const double cutoff = 0.5 * ratio * PASSBAND;
+    taps = static_cast<size_t>(std::ceil(BASE_TAPS / ratio));
+    taps += taps % 2;
+    const double halfWidth = taps / 2.0;
+    const double windowNorm = besselI0(KAISER_BETA);
+
+    // h[phase][k] = g(phase / up + taps / 2 - 1 - k), the kernel evaluated at
+    // the distance from output time to input sample (base + k - taps / 2 + 1)
+    coefficients.resize(up * taps);
+    for (size_t phase = 0; phase < up; ++phase) {
+        float* h = coefficients.data() + phase * taps;
+        double sum = 0.0;
+        for (size_t k = 0; k < taps; ++k) {
+            const double tau = static_cast<double>(phase) / up + halfWidth - 1.0 - static_cast<double>(k);
+            const double x = 2.0 * cutoff * tau;
+            const double sinc = std::abs(x) < 1e-12 ? 1.0 : std::sin(PI * x) / (PI * x);
+            const double position = tau / halfWidth;
+            const double window = std::abs(position) <= 1.0
+                ? besselI0(KAISER_BETA * std::sqrt(1.0 - position * position)) / windowNorm : 0.0;
+            h[k] = static_cast<float>(2.0 * cutoff * sinc * window);
+            sum += h[k];
+        }
+        // Unity gain at DC for every phase
+        for (size_t k = 0; k < taps; ++k) {
+            h[k] = static_cast<float>(h[k] / sum);
+        }
+    }
+
+    // Zeros before the first input sample
+    history.assign(taps, 0.0f);
+    historyStart = -static_cast<int64_t>(taps);
+}
+
+void PolyphaseResampler::emit(std::vector<float>& output, int64_t available, uint64_t limit) {
+    const auto& kernels = simd::kernels();
+    // A phase reads input base - lead ... base - lead + taps - 1
+    const int64_t lead = static_cast<int64_t>(taps / 2) - 1;
+
+    while (nextOutput < limit) {
+        const uint64_t position = nextOutput * down;
+        const int64_t first = static_cast<int64_t>(position / up) - lead;
+        if (first + static_cast<int64_t>(taps) > available) {
+            break;
+        }
+        const size_t phase = static_cast<size_t>(position % up);
+        const float* x = history.data() + (first - historyStart);
+        output.push_back(kernels.dot(coefficients.data() + phase * taps, x, taps));
+        nextOutput++;
+    }
+
+    // Drop input no later output can reach, in large steps
+    const int64_t keepFrom = static_cast<int64_t>(nextOutput * down / up) - lead;
+    const int64_t drop = keepFrom - historyStart;
+    if (drop >= static_cast<int64_t>(HISTORY_COMPACT_THRESHOLD)) {
+        history.erase(history.begin(), history.begin() + drop);
+        historyStart += drop;
+    }
+}
+
+void PolyphaseResampler::process(const float* input, size_t count, std::vector<float>& output) {
+    if (!valid() || count == 0) {
+        return;
+    }
+    history.insert(history.end(), input, input + count);
+    inputCount += count;
+    output.reserve(output.size() + count * up / down + 1);
+    emit(output, static_cast<int64_t>(inputCount), UINT64_MAX);
+}
+
+void PolyphaseResampler::flush(std::vector<float>& output) {
+    if (!valid()) {
+        return;
+    }
+    // Every output centred before the end of the input, completed with zeros
+    const uint64_t total = (inputCount * up + down - 1) / down;
+    history.resize(history.size() + taps, 0.0f);
+    emit(output, static_cast<int64_t>(inputCount + taps), total);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file scratch_arena.cpp
+ * @brief Per-thread monotonic scratch arena implementation
+ */
+
+#include "scratch_arena.h"
+#include <algorithm>
+
+namespace {
+    // Retained blocks grow in these steps so peaks that wobble do not reallocate
+    constexpr size_t BLOCK_GRANULARITY = size_t{64} << 10;
+
+    size_t roundUp(size_t bytes) {
+        return (bytes + BLOCK_GRANULARITY - 1) / BLOCK_GRANULARITY * BLOCK_GRANULARITY;
+    }
+}
+
+std::atomic<size_t> ScratchArena::processPeak{0};
+
+// ===========================
+// ScratchArena Implementation
+// ===========================
+
+ScratchArena::ScratchArena(size_t initialBytes)
+    : capacity(roundUp(std::max<size_t>(1, initialBytes))) {
+    // Default-initialized: pages are only touched once something is carved from them
+    block.reset(new std::byte[capacity]);
+    monotonic.emplace(block.get(), capacity, std::pmr::new_delete_resource());
+}
+
+ScratchArena::~ScratchArena() = default;
+
+ScratchArena& ScratchArena::current() {
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+    void* memory = monotonic->allocate(bytes, alignment);
+    used += bytes;
+    if (used > resetPeak) {
+        resetPeak = used;
+    }
+    return memory;
+}
+
+void ScratchArena::reset() {
+    monotonic.reset();
+
+    // Alignment padding is not counted in used; a quarter of headroom covers it
+    const size_t wanted = std::min(MAX_RETAINED_BYTES, roundUp(resetPeak + resetPeak / 4));
+    if (wanted > capacity) {
+        block.reset();                // Never hold the old and the new block at once
+        block.reset(new std::byte[wanted]);
+        capacity = wanted;
+    }
+    monotonic.emplace(block.get(), capacity, std::pmr::new_delete_resource());
+
+    peak = std::max(peak, resetPeak);
+    size_t global = processPeak.load(std::memory_order_relaxed);
+    while (peak > global && !processPeak.compare_exchange_weak(global, peak, std::memory_order_relaxed)) {
+    }
+    used = 0;
+    resetPeak = 0;
+}
+
+// ===========================
+// ScratchArena::Scope Implementation
+// ===========================
+
+ScratchArena::Scope::Scope() : owner(ScratchArena::current()) {
+    owner.depth++;
+}
+
+ScratchArena::Scope::~Scope() {
+    if (--owner.depth == 0) {
+        owner.reset();
+    }
+}
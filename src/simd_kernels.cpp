@@ -0,0 +1,669 @@
+/**
+ * @file simd_kernels.cpp
+ * @brief Scalar, AVX2, AVX-512 and NEON kernel implementations and dispatch
+ */
+
+#include "simd_kernels.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define VT_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define VT_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// ===========================
+// Scalar Kernels
+// ===========================
+
+float sumSquaresScalar(const float* x, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+size_t zeroCrossingsScalar(const float* x, size_t n) {
+    size_t crossings = 0;
+    for (size_t i = 1; i < n; ++i) {
+        crossings += (x[i] >= 0) != (x[i - 1] >= 0);
+    }
+    return crossings;
+}
+
+float dotScalar(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+float squaredDistanceScalar(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        const float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+void conjugateMultiplyScalar(const std::complex<float>* a, const std::complex<float>* b,
+                             std::complex<float>* out, size_t n, float scale) {
+    const float* x = reinterpret_cast<const float*>(a);
+    const float* y = reinterpret_cast<const float*>(b);
+    float* z = reinterpret_cast<float*>(out);
+    for (size_t k = 0; k < n; ++k) {
+        const float ar = x[2*k], ai = x[2*k + 1];
+        const float br = y[2*k], bi = y[2*k + 1];
+        z[2*k] = (ar * br + ai * bi) * scale;
+        z[2*k + 1] = (ar * bi - ai * br) * scale;
+    }
+}
+
+void conjugateMultiplyAccumulateScalar(const std::complex<float>* a, const std::complex<float>* b,
+                                       std::complex<float>* out, size_t n, float scale) {
+    const float* x = reinterpret_cast<const float*>(a);
+    const float* y = reinterpret_cast<const float*>(b);
+    float* z = reinterpret_cast<float*>(out);
+    for (size_t k = 0; k < n; ++k) {
+        const float ar = x[2*k], ai = x[2*k + 1];
+        const float br = y[2*k], bi = y[2*k + 1];
+        z[2*k] += (ar * br + ai * bi) * scale;
+        z[2*k + 1] += (ar * bi - ai * br) * scale;
+    }
+}
+
+// PCM conversions go through memcpy: mapped WAV data has no alignment guarantee
+void convertPcm16Scalar(const uint8_t* in, float* out, size_t n, float scale) {
+    for (size_t i = 0; i < n; ++i) {
+        int16_t value;
+        std::memcpy(&value, in + 2*i, sizeof(value));
+        out[i] = value * scale;
+    }
+}
+
+void convertPcm24Scalar(const uint8_t* in, float* out, size_t n, float scale) {
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t* sample = in + 3*i;
+        // Assemble in the top three bytes, then shift down to sign extend
+        const uint32_t packed = static_cast<uint32_t>(sample[0]) << 8 |
+                                static_cast<uint32_t>(sample[1]) << 16 |
+                                static_cast<uint32_t>(sample[2]) << 24;
+        out[i] = (static_cast<int32_t>(packed) >> 8) * scale;
+    }
+}
+
+void convertPcm32Scalar(const uint8_t* in, float* out, size_t n, float scale) {
+    for (size_t i = 0; i < n; ++i) {
+        int32_t value;
+        std::memcpy(&value, in + 4*i, sizeof(value));
+        out[i] = static_cast<float>(value) * scale;
+    }
+}
+
+const simd::KernelTable SCALAR_KERNELS = {
+    "scalar",
+    sumSquaresScalar,
+    zeroCrossingsScalar,
+    dotScalar,
+    squaredDistanceScalar,
+    conjugateMultiplyScalar,
+    conjugateMultiplyAccumulateScalar,
+    convertPcm16Scalar,
+    convertPcm24Scalar,
+    convertPcm32Scalar
+};
+
+#ifdef VT_SIMD_X86
+
+// ===========================
+// AVX2 Kernels
+// ===========================
+
+#define VT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+VT_TARGET_AVX2 inline float horizontalSum(__m256 v) {
+    __m128 low = _mm256_castps256_ps128(v);
+    __m128 high = _mm256_extractf128_ps(v, 1);
+    low = _mm_add_ps(low, high);
+    low = _mm_add_ps(low, _mm_movehl_ps(low, low));
+    low = _mm_add_ss(low, _mm_shuffle_ps(low, low, 1));
+    return _mm_cvtss_f32(low);
+}
+
+VT_TARGET_AVX2 float sumSquaresAVX2(const float* x, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 v0 = _mm256_loadu_ps(x + i);
+        __m256 v1 = _mm256_loadu_ps(x + i + 8);
+        acc0 = _mm256_fmadd_ps(v0, v0, acc0);
+        acc1 = _mm256_fmadd_ps(v1, v1, acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        acc0 = _mm256_fmadd_ps(v, v, acc0);
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    return sum + sumSquaresScalar(x + i, n - i);
+}
+
+VT_TARGET_AVX2 size_t zeroCrossingsAVX2(const float* x, size_t n) {
+    if (n < 2) return 0;
+    const __m256 zero = _mm256_setzero_ps();
+    size_t crossings = 0;
+    size_t i = 1;
+    for (; i + 8 <= n; i += 8) {
+        __m256 current = _mm256_cmp_ps(_mm256_loadu_ps(x + i), zero, _CMP_GE_OQ);
+        __m256 previous = _mm256_cmp_ps(_mm256_loadu_ps(x + i - 1), zero, _CMP_GE_OQ);
+        int mask = _mm256_movemask_ps(_mm256_xor_ps(current, previous));
+        crossings += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+    return crossings + zeroCrossingsScalar(x + i - 1, n - i + 1);
+}
+
+VT_TARGET_AVX2 float dotAVX2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+    return sum + dotScalar(a + i, b + i, n - i);
+}
+
+VT_TARGET_AVX2 float squaredDistanceAVX2(const float* a, const float* b, size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc = _mm256_fmadd_ps(d, d, acc);
+    }
+    float sum = horizontalSum(acc);
+    // MFCC frames are 13 wide: finish the 5-value tail with one SSE step
+    if (i + 4 <= n) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        d = _mm_mul_ps(d, d);
+        d = _mm_add_ps(d, _mm_movehl_ps(d, d));
+        d = _mm_add_ss(d, _mm_shuffle_ps(d, d, 1));
+        sum += _mm_cvtss_f32(d);
+        i += 4;
+    }
+    return sum + squaredDistanceScalar(a + i, b + i, n - i);
+}
+
+// conj(a) * b on interleaved complex: re = ar*br + ai*bi, im = ar*bi - ai*br
+VT_TARGET_AVX2 inline __m256 conjugateProduct(__m256 a, __m256 b) {
+    __m256 aRe = _mm256_moveldup_ps(a);              // ar ar
+    __m256 aIm = _mm256_movehdup_ps(a);              // ai ai
+    __m256 bSwap = _mm256_permute_ps(b, 0xB1);       // bi br
+    return _mm256_fmsubadd_ps(aRe, b, _mm256_mul_ps(aIm, bSwap));
+}
+
+VT_TARGET_AVX2 void conjugateMultiplyAVX2(const std::complex<float>* a, const std::complex<float>* b,
+                                          std::complex<float>* out, size_t n, float scale) {
+    const float* x = reinterpret_cast<const float*>(a);
+    const float* y = reinterpret_cast<const float*>(b);
+    float* z = reinterpret_cast<float*>(out);
+    const __m256 s = _mm256_set1_ps(scale);
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m256 p = conjugateProduct(_mm256_loadu_ps(x + 2*k), _mm256_loadu_ps(y + 2*k));
+        _mm256_storeu_ps(z + 2*k, _mm256_mul_ps(p, s));
+    }
+    conjugateMultiplyScalar(a + k, b + k, out + k, n - k, scale);
+}
+
+VT_TARGET_AVX2 void conjugateMultiplyAccumulateAVX2(const std::complex<float>* a,
+                                                    const std::complex<float>* b,
+                                                    std::complex<float>* out, size_t n, float scale) {
+    const float* x = reinterpret_cast<const float*>(a);
+    const float* y = reinterpret_cast<const float*>(b);
+    float* z = reinterpret_cast<float*>(out);
+    const __m256 s = _mm256_set1_ps(scale);
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m256 p = conjugateProduct(_mm256_loadu_ps(x + 2*k), _mm256_loadu_ps(y + 2*k));
+        _mm256_storeu_ps(z + 2*k, _mm256_fmadd_ps(p, s, _mm256_loadu_ps(z + 2*k)));
+    }
+    conjugateMultiplyAccumulateScalar(a + k, b + k, out + k, n - k, scale);
+}
+
+VT_TARGET_AVX2 void convertPcm16AVX2(const uint8_t* in, float* out, size_t n, float scale) {
+    const __m256 s = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2*i));
+        __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(packed));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(values, s));
+    }
+    convertPcm16Scalar(in + 2*i, out + i, n - i, scale);
+}
+
+VT_TARGET_AVX2 void convertPcm24AVX2(const uint8_t* in, float* out, size_t n, float scale) {
+    // Four 3-byte samples per 128-bit lane, each moved into the top of a
+    // 32-bit slot; the arithmetic shift back down sign extends it
+    const __m256i spread = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m256 s = _mm256_set1_ps(scale);
+    size_t i = 0;
+    // The second 16-byte load ends 4 bytes past the 8 samples converted
+    for (; i + 10 <= n; i += 8) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 3*i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 3*i + 12));
+        __m256i packed = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        __m256i values = _mm256_srai_epi32(_mm256_shuffle_epi8(packed, spread), 8);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(values), s));
+    }
+    convertPcm24Scalar(in + 3*i, out + i, n - i, scale);
+}
+
+VT_TARGET_AVX2 void convertPcm32AVX2(const uint8_t* in, float* out, size_t n, float scale) {
+    const __m256 s = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 4*i));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(values), s));
+    }
+    convertPcm32Scalar(in + 4*i, out + i, n - i, scale);
+}
+
+const simd::KernelTable AVX2_KERNELS = {
+    "avx2",
+    sumSquaresAVX2,
+    zeroCrossingsAVX2,
+    dotAVX2,
+    squaredDistanceAVX2,
+    conjugateMultiplyAVX2,
+    conjugateMultiplyAccumulateAVX2,
+    convertPcm16AVX2,
+    convertPcm24AVX2,
+    convertPcm32AVX2
+};
+
+// ===========================
+// AVX-512 Kernels
+// ===========================
+
+#define VT_TARGET_AVX512 __attribute__((target("avx512f")))
+
+// GCC 12's AVX-512 headers seed unmasked ops with _mm512_undefined_ps(),
+// which trips -W(maybe-)uninitialized once inlined; the values are never read
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+VT_TARGET_AVX512 float sumSquaresAVX512(const float* x, size_t n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512 v0 = _mm512_loadu_ps(x + i);
+        __m512 v1 = _mm512_loadu_ps(x + i + 16);
+        acc0 = _mm512_fmadd_ps(v0, v0, acc0);
+        acc1 = _mm512_fmadd_ps(v1, v1, acc1);
+    }
+    acc0 = _mm512_add_ps(acc0, acc1);
+    if (i + 16 <= n) {
+        __m512 v = _mm512_loadu_ps(x + i);
+        acc0 = _mm512_fmadd_ps(v, v, acc0);
+        i += 16;
+    }
+    if (i < n) {
+        const __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512 v = _mm512_maskz_loadu_ps(mask, x + i);
+        acc0 = _mm512_fmadd_ps(v, v, acc0);
+    }
+    return _mm512_reduce_add_ps(acc0);
+}
+
+VT_TARGET_AVX512 size_t zeroCrossingsAVX512(const float* x, size_t n) {
+    if (n < 2) return 0;
+    const __m512 zero = _mm512_setzero_ps();
+    size_t crossings = 0;
+    size_t i = 1;
+    for (; i + 16 <= n; i += 16) {
+        __mmask16 current = _mm512_cmp_ps_mask(_mm512_loadu_ps(x + i), zero, _CMP_GE_OQ);
+        __mmask16 previous = _mm512_cmp_ps_mask(_mm512_loadu_ps(x + i - 1), zero, _CMP_GE_OQ);
+        crossings += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(current ^ previous)));
+    }
+    return crossings + zeroCrossingsScalar(x + i - 1, n - i + 1);
+}
+
+VT_TARGET_AVX512 float dotAVX512(const float* a, const float* b, size_t n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    acc0 = _mm512_add_ps(acc0, acc1);
+    if (i + 16 <= n) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        i += 16;
+    }
+    if (i < n) {
+        const __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+        acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                               _mm512_maskz_loadu_ps(mask, b + i), acc0);
+    }
+    return _mm512_reduce_add_ps(acc0);
+}
+
+VT_TARGET_AVX512 float squaredDistanceAVX512(const float* a, const float* b, size_t n) {
+    // A whole 13-wide MFCC frame fits one masked register
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 d = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        acc = _mm512_fmadd_ps(d, d, acc);
+    }
+    if (i < n) {
+        const __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+        acc = _mm512_fmadd_ps(d, d, acc);
+    }
+    return _mm512_reduce_add_ps(acc);
+}
+
+VT_TARGET_AVX512 inline __m512 conjugateProduct512(__m512 a, __m512 b) {
+    __m512 aRe = _mm512_moveldup_ps(a);
+    __m512 aIm = _mm512_movehdup_ps(a);
+    __m512 bSwap = _mm512_permute_ps(b, 0xB1);
+    return _mm512_fmsubadd_ps(aRe, b, _mm512_mul_ps(aIm, bSwap));
+}
+
+VT_TARGET_AVX512 void conjugateMultiplyAVX512(const std::complex<float>* a, const std::complex<float>* b,
+                                              std::complex<float>* out, size_t n, float scale) {
+    const float* x = reinterpret_cast<const float*>(a);
+    const float* y = reinterpret_cast<const float*>(b);
+    float* z = reinterpret_cast<float*>(out);
+    const __m512 s = _mm512_set1_ps(scale);
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m512 p = conjugateProduct512(_mm512_loadu_ps(x + 2*k), _mm512_loadu_ps(y + 2*k));
+        _mm512_storeu_ps(z + 2*k, _mm512_mul_ps(p, s));
+    }
+    conjugateMultiplyScalar(a + k, b + k, out + k, n - k, scale);
+}
+
+VT_TARGET_AVX512 void conjugateMultiplyAccumulateAVX512(const std::complex<float>* a,
+                                                        const std::complex<float>* b,
+                                                        std::complex<float>* out, size_t n, float scale) {
+    const float* x = reinterpret_cast<const float*>(a);
+    const float* y = reinterpret_cast<const float*>(b);
+    float* z = reinterpret_cast<float*>(out);
+    const __m512 s = _mm512_set1_ps(scale);
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m512 p = conjugateProduct512(_mm512_loadu_ps(x + 2*k), _mm512_loadu_ps(y + 2*k));
+        _mm512_storeu_ps(z + 2*k, _mm512_fmadd_ps(p, s, _mm512_loadu_ps(z + 2*k)));
+    }
+    conjugateMultiplyAccumulateScalar(a + k, b + k, out + k, n - k, scale);
+}
+
+VT_TARGET_AVX512 void convertPcm16AVX512(const uint8_t* in, float* out, size_t n, float scale) {
+    const __m512 s = _mm512_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i packed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2*i));
+        __m512 values = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(packed));
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(values, s));
+    }
+    convertPcm16Scalar(in + 2*i, out + i, n - i, scale);
+}
+
+VT_TARGET_AVX512 void convertPcm32AVX512(const uint8_t* in, float* out, size_t n, float scale) {
+    const __m512 s = _mm512_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i values = _mm512_loadu_si512(in + 4*i);
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_cvtepi32_ps(values), s));
+    }
+    convertPcm32Scalar(in + 4*i, out + i, n - i, scale);
+}
+
+// 24-bit unpacking needs byte shuffles across 128-bit lanes (AVX-512 VBMI);
+// the AVX2 kernel already runs at memory bandwidth
+const simd::KernelTable AVX512_KERNELS = {
+    "avx512",
+    sumSquaresAVX512,
+    zeroCrossingsAVX512,
+    dotAVX512,
+    squaredDistanceAVX512,
+    conjugateMultiplyAVX512,
+    conjugateMultiplyAccumulateAVX512,
+    convertPcm16AVX512,
+    convertPcm24AVX2,
+    convertPcm32AVX512
+};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // VT_SIMD_X86
+
+#ifdef VT_SIMD_NEON
+
+// ===========================
+// NEON Kernels
+// ===========================
+
+float sumSquaresNEON(const float* x, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t v0 = vld1q_f32(x + i);
+        float32x4_t v1 = vld1q_f32(x + i + 4);
+        acc0 = vfmaq_f32(acc0, v0, v0);
+        acc1 = vfmaq_f32(acc1, v1, v1);
+    }
+    float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    return sum + sumSquaresScalar(x + i, n - i);
+}
+
+size_t zeroCrossingsNEON(const float* x, size_t n) {
+    if (n < 2) return 0;
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    uint32x4_t count = vdupq_n_u32(0);
+    size_t i = 1;
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t current = vcgeq_f32(vld1q_f32(x + i), zero);
+        uint32x4_t previous = vcgeq_f32(vld1q_f32(x + i - 1), zero);
+        count = vaddq_u32(count, vshrq_n_u32(veorq_u32(current, previous), 31));
+    }
+    return vaddvq_u32(count) + zeroCrossingsScalar(x + i - 1, n - i + 1);
+}
+
+float dotNEON(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+    return sum + dotScalar(a + i, b + i, n - i);
+}
+
+float squaredDistanceNEON(const float* a, const float* b, size_t n) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t d = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        acc = vfmaq_f32(acc, d, d);
+    }
+    return vaddvq_f32(acc) + squaredDistanceScalar(a + i, b + i, n - i);
+}
+
+void conjugateMultiplyNEON(const std::complex<float>* a, const std::complex<float>* b,
+                           std::complex<float>* out, size_t n, float scale) {
+    const float* x = reinterpret_cast<const float*>(a);
+    const float* y = reinterpret_cast<const float*>(b);
+    float* z = reinterpret_cast<float*>(out);
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        // De-interleaving loads give separate real and imaginary lanes
+        float32x4x2_t va = vld2q_f32(x + 2*k);
+        float32x4x2_t vb = vld2q_f32(y + 2*k);
+        float32x4x2_t result;
+        result.val[0] = vmulq_n_f32(vfmaq_f32(vmulq_f32(va.val[0], vb.val[0]), va.val[1], vb.val[1]), scale);
+        result.val[1] = vmulq_n_f32(vfmsq_f32(vmulq_f32(va.val[0], vb.val[1]), va.val[1], vb.val[0]), scale);
+        vst2q_f32(z + 2*k, result);
+    }
+    conjugateMultiplyScalar(a + k, b + k, out + k, n - k, scale);
+}
+
+void conjugateMultiplyAccumulateNEON(const std::complex<float>* a, const std::complex<float>* b,
+                                     std::complex<float>* out, size_t n, float scale) {
+    const float* x = reinterpret_cast<const float*>(a);
+    const float* y = reinterpret_cast<const float*>(b);
+    float* z = reinterpret_cast<float*>(out);
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        float32x4x2_t va = vld2q_f32(x + 2*k);
+        float32x4x2_t vb = vld2q_f32(y + 2*k);
+        float32x4x2_t acc = vld2q_f32(z + 2*k);
+        float32x4_t re = vfmaq_f32(vmulq_f32(va.val[0], vb.val[0]), va.val[1], vb.val[1]);
+        float32x4_t im = vfmsq_f32(vmulq_f32(va.val[0], vb.val[1]), va.val[1], vb.val[0]);
+        acc.val[0] = vfmaq_n_f32(acc.val[0], re, scale);
+        acc.val[1] = vfmaq_n_f32(acc.val[1], im, scale);
+        vst2q_f32(z + 2*k, acc);
+    }
+    conjugateMultiplyAccumulateScalar(a + k, b + k, out + k, n - k, scale);
+}
+
+void convertPcm16NEON(const uint8_t* in, float* out, size_t n, float scale) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t packed = vreinterpretq_s16_u8(vld1q_u8(in + 2*i));
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(packed))), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(packed)), scale));
+    }
+    convertPcm16Scalar(in + 2*i, out + i, n - i, scale);
+}
+
+void convertPcm24NEON(const uint8_t* in, float* out, size_t n, float scale) {
+    // Assemble ((int8) high << 16) | low16 from a de-interleaving 3-byte load
+    auto widen = [scale](uint16x4_t low, int16x4_t high) {
+        int32x4_t value = vorrq_s32(vshlq_n_s32(vmovl_s16(high), 16),
+                                    vreinterpretq_s32_u32(vmovl_u16(low)));
+        return vmulq_n_f32(vcvtq_f32_s32(value), scale);
+    };
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16x3_t bytes = vld3q_u8(in + 3*i);
+        uint16x8_t low0 = vreinterpretq_u16_u8(vzip1q_u8(bytes.val[0], bytes.val[1]));
+        uint16x8_t low1 = vreinterpretq_u16_u8(vzip2q_u8(bytes.val[0], bytes.val[1]));
+        int8x16_t top = vreinterpretq_s8_u8(bytes.val[2]);
+        int16x8_t high0 = vmovl_s8(vget_low_s8(top));
+        int16x8_t high1 = vmovl_high_s8(top);
+        vst1q_f32(out + i, widen(vget_low_u16(low0), vget_low_s16(high0)));
+        vst1q_f32(out + i + 4, widen(vget_high_u16(low0), vget_high_s16(high0)));
+        vst1q_f32(out + i + 8, widen(vget_low_u16(low1), vget_low_s16(high1)));
+        vst1q_f32(out + i + 12, widen(vget_high_u16(low1), vget_high_s16(high1)));
+    }
+    convertPcm24Scalar(in + 3*i, out + i, n - i, scale);
+}
+
+void convertPcm32NEON(const uint8_t* in, float* out, size_t n, float scale) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t values = vreinterpretq_s32_u8(vld1q_u8(in + 4*i));
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(values), scale));
+    }
+    convertPcm32Scalar(in + 4*i, out + i, n - i, scale);
+}
+
+const simd::KernelTable NEON_KERNELS = {
+    "neon",
+    sumSquaresNEON,
+    zeroCrossingsNEON,
+    dotNEON,
+    squaredDistanceNEON,
+    conjugateMultiplyNEON,
+    conjugateMultiplyAccumulateNEON,
+    convertPcm16NEON,
+    convertPcm24NEON,
+    convertPcm32NEON
+};
+
+#endif // VT_SIMD_NEON
+
+// ===========================
+// Dispatch
+// ===========================
+
+const simd::KernelTable* bestSupported() {
+#ifdef VT_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return &AVX512_KERNELS;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return &AVX2_KERNELS;
+#endif
+#ifdef VT_SIMD_NEON
+    return &NEON_KERNELS;    // Baseline on aarch64
+#endif
+    return &SCALAR_KERNELS;
+}
+
+const simd::KernelTable* selectKernels() {
+    const simd::KernelTable* best = bestSupported();
+    const char* forced = std::getenv("VT_SIMD");
+    if (!forced || !*forced) {
+        return best;
+    }
+    const simd::KernelTable* requested = simd::kernelsNamed(forced);
+    return requested ? requested : best;
+}
+
+} // namespace
+
+namespace simd {
+    const KernelTable& kernels() {
+        static const KernelTable* active = selectKernels();
+        return *active;
+    }
+
+    const KernelTable& scalarKernels() {
+        return SCALAR_KERNELS;
+    }
+
+    const KernelTable* kernelsNamed(const char* name) {
+        // Only hand out a table the CPU can run
+        if (std::strcmp(name, "scalar") == 0) return &SCALAR_KERNELS;
+#ifdef VT_SIMD_X86
+        __builtin_cpu_init();
+        if (std::strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2") &&
+            __builtin_cpu_supports("fma")) {
+            return &AVX2_KERNELS;
+        }
+        if (std::strcmp(name, "avx512") == 0 && __builtin_cpu_supports("avx512f")) {
+            return &AVX512_KERNELS;
+        }
+#endif
+#ifdef VT_SIMD_NEON
+        if (std::strcmp(name, "neon") == 0) return &NEON_KERNELS;
+#endif
+        return nullptr;
+    }
+}
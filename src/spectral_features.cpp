@@ -0,0 +1,133 @@
+/**
+ * @file spectral_features.cpp
+ * @brief Mel filterbank and log-mel spectrogram implementation
+ */
+
+#include "spectral_features.h"
+#include "fft_processor.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    // Floor for log energies so digital silence stays finite
+    constexpr float LOG_ENERGY_FLOOR = 1e-10f;
+}
+
+namespace spectral {
+
+// ===========================
+// Mel Filterbank Implementation
+// ===========================
+
+double MelFilterbank::hzToMel(double hz) {
+    return 2595.0 * std::log10(1.0 + hz / 700.0);
+}
+
+double MelFilterbank::melToHz(double mel) {
+    return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0);
+}
+
+MelFilterbank::MelFilterbank(double sampleRate, size_t fftSize, size_t numBands,
+                             double minFreq, double maxFreq)
+    : sampleRate(sampleRate), fftSize(fftSize) {
+    const size_t numBins = fftSize / 2 + 1;
+    if (maxFreq <= 0.0 || maxFreq > sampleRate / 2.0) {
+        maxFreq = sampleRate / 2.0;
+    }
+
+    // numBands + 2 equally spaced mel points define the triangle edges
+    const double melMin = hzToMel(minFreq);
+    const double melMax = hzToMel(maxFreq);
+    std::vector<double> edges(numBands + 2);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        double mel = melMin + (melMax - melMin) * i / (numBands + 1);
+        edges[i] = melToHz(mel) * fftSize / sampleRate; // fractional bin
+    }
+
+    filters.resize(numBands);
+    for (size_t band = 0; band < numBands; ++band) {
+        const double left = edges[band];
+        const double center = edges[band + 1];
+        const double right = edges[band + 2];
+
+        size_t first = static_cast<size_t>(std::ceil(left));
+        size_t last = std::min(numBins - 1, static_cast<size_t>(std::floor(right)));
+
+        Filter& filter = filters[band];
+        filter.firstBin = std::min(first, numBins - 1);
+        for (size_t bin = first; bin <= last; ++bin) {
+            double weight = bin <= center
+                ? (center > left ? (bin - left) / (center - left) : 1.0)
+                : (right > center ? (right - bin) / (right - center) : 1.0);
+            filter.weights.push_back(static_cast<float>(std::max(0.0, weight)));
+        }
+
+        // Very narrow low bands can fall between bins; give them the nearest one
+        if (filter.weights.empty()) {
+            filter.firstBin = std::min(numBins - 1, static_cast<size_t>(std::lround(center)));
+            filter.weights.push_back(1.0f);
+        }
+    }
+}
+
+void MelFilterbank::apply(const float* powerSpectrum, float* bandEnergies) const {
+    const auto dot = simd::kernels().dot;
+    for (size_t band = 0; band < filters.size(); ++band) {
+        const Filter& filter = filters[band];
+        bandEnergies[band] = dot(filter.weights.data(), powerSpectrum + filter.firstBin,
+                                 filter.weights.size());
+    }
+}
+
+// ===========================
+// Spectrogram Analyzer Implementation
+// ===========================
+
+SpectrogramAnalyzer::SpectrogramAnalyzer(double sampleRate, size_t fftSize,
+                                         size_t hopSize, size_t numBands)
+    : fftSize(fftSize), hopSize(hopSize),
+      filterbank(sampleRate, fftSize, numBands),
+      window(fftSize), frame(fftSize), spectrum(fftSize / 2 + 1), power(fftSize / 2 + 1) {
+    for (size_t i = 0; i < fftSize; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * i / fftSize));
+    }
+}
+
+size_t SpectrogramAnalyzer::compute(const std::vector<float>& audio, fftw::FFTProcessor& fft,
+                                    std::vector<float>& output) {
+    output.clear();
+    if (audio.size() < fftSize || fft.getSize() != fftSize) {
+        return 0;
+    }
+
+    const size_t numFrames = (audio.size() - fftSize) / hopSize + 1;
+    const size_t numBands = filterbank.getNumBands();
+    output.resize(numFrames * numBands);
+
+    for (size_t f = 0; f < numFrames; ++f) {
+        analyzeFrame(audio.data() + f * hopSize, fft, output.data() + f * numBands);
+    }
+
+    return numFrames;
+}
+
+void SpectrogramAnalyzer::analyzeFrame(const float* samples, fftw::FFTProcessor& fft, float* bands) {
+    for (size_t i = 0; i < fftSize; ++i) {
+        frame[i] = samples[i] * window[i];
+    }
+
+    fft.forward(frame, spectrum);
+    for (size_t k = 0; k < power.size(); ++k) {
+        power[k] = std::norm(spectrum[k]);
+    }
+
+    filterbank.apply(power.data(), bands);
+    for (size_t b = 0; b < filterbank.getNumBands(); ++b) {
+        bands[b] = std::log10(bands[b] + LOG_ENERGY_FLOOR);
+    }
+}
+
+}
@@ -0,0 +1,650 @@
+/**
+ * @file sync_benchmark.cpp
+ * @brief Synthetic scenario rendering, timed pipeline runs and the JSON report
+ */
+
+#include "sync_benchmark.h"
+#include "audio_decoder.h"
+#include "feature_extractor.h"
+#include "fft_processor.h"
+#include "media_probe.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    // Rendered scenarios are 48 kHz so the analysis path resamples like real lav files
+    constexpr int RENDER_SAMPLE_RATE = 48000;
+    constexpr double RENDER_PEAK = 0.8;
+    constexpr double NOISE_FLOOR_DB = -60.0;  // Audio 1 is never digitally silent
+    constexpr double AUDIO2_GAIN = 0.5;       // Recorders are rarely level-matched
+
+    // Decoding and full-feature algorithm runs stop here on long corpus files
+    constexpr double MAX_ANALYZED_SECONDS = 600.0;
+
+    // Must match the extractor configuration HybridAudioSync uses
+    constexpr size_t FEATURE_FRAME_SIZE = 2048;
+    constexpr size_t FEATURE_HOP_SIZE = 512;
+    constexpr size_t FEATURE_BANDS = 26;
+    constexpr size_t FEATURE_COEFFICIENTS = 13;
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // FNV-1a so a scenario renders identically on every platform
+    uint32_t seedFor(const std::string& name) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : name) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Speech-like programme: voiced syllables, fricatives, phrase pauses and clicks
+     */
+    std::vector<float> renderSource(size_t length, std::mt19937& rng) {
+        std::vector<float> source(length, 0.0f);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::normal_distribution<float> gaussian(0.0f, 1.0f);
+        const double rate = RENDER_SAMPLE_RATE;
+
+        double time = 0.0;
+        double phraseEnd = 2.0 + 3.0 * uniform(rng);
+        double nextClick = 1.0 + 3.0 * uniform(rng);
+        const double end = static_cast<double>(length) / rate;
+        while (time < end) {
+            if (time > phraseEnd) {
+                time += 0.4 + 1.1 * uniform(rng);
+                phraseEnd = time + 2.0 + 4.0 * uniform(rng);
+            }
+
+            const double syllable = 0.08 + 0.22 * uniform(rng);
+            const double amplitude = 0.2 + 0.6 * uniform(rng);
+            const size_t first = static_cast<size_t>(time * rate);
+            const size_t count = std::min(length - std::min(length, first),
+                                          static_cast<size_t>(syllable * rate));
+            if (uniform(rng) < 0.3) {
+                // Fricative: differentiated noise under a raised-sine envelope
+                float previous = 0.0f;
+                for (size_t n = 0; n < count; ++n) {
+                    const float white = gaussian(rng);
+                    const double envelope = std::pow(std::sin(PI * n / count), 2.0);
+                    source[first + n] += static_cast<float>(0.3 * amplitude * envelope) * (white - previous);
+                    previous = white;
+                }
+            } else {
+                // Voiced: six harmonics of a gliding pitch
+                const double f0 = 90.0 + 150.0 * uniform(rng);
+                const double glide = (uniform(rng) - 0.5) * 0.4;
+                double phase = 0.0;
+                for (size_t n = 0; n < count; ++n) {
+                    const double progress = static_cast<double>(n) / count;
+                    phase += 2.0 * PI * f0 * (1.0 + glide * progress) / rate;
+                    double value = 0.0;
+                    for (int h = 1; h <= 6; ++h) {
+                        value += std::sin(h * phase) / h;
+                    }
+                    source[first + n] += static_cast<float>(amplitude * std::pow(std::sin(PI * progress), 2.0) * value);
+                }
+            }
+            time += syllable + 0.05 + 0.3 * uniform(rng);
+
+            // Sparse transients (door, clap, mic bump) give onsets
+            while (nextClick < time) {
+                const size_t at = static_cast<size_t>(nextClick * rate);
+                const size_t decay = static_cast<size_t>(0.02 * rate);
+                for (size_t n = 0; n < decay && at + n < length; ++n) {
+                    source[at + n] += static_cast<float>(0.9 * std::exp(-static_cast<double>(n) / (0.004 * rate))) * gaussian(rng);
+                }
+                nextClick += 1.5 + 3.0 * uniform(rng);
+            }
+        }
+
+        float peak = 0.0f;
+        for (float value : source) peak = std::max(peak, std::abs(value));
+        if (peak > 0.0f) {
+            const float scale = static_cast<float>(RENDER_PEAK) / peak;
+            for (float& value : source) value *= scale;
+        }
+        return source;
+    }
+
+    double rms(const std::vector<float>& signal) {
+        double sum = 0.0;
+        for (float value : signal) sum += static_cast<double>(value) * value;
+        return signal.empty() ? 0.0 : std::sqrt(sum / signal.size());
+    }
+
+    bool writeWav(const std::filesystem::path& file, const std::vector<float>& samples) {
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        auto u16 = [&out](uint16_t value) {
+            const char bytes[2] = {static_cast<char>(value & 0xFF), static_cast<char>(value >> 8)};
+            out.write(bytes, 2);
+        };
+        auto u32 = [&out](uint32_t value) {
+            const char bytes[4] = {static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF),
+                                   static_cast<char>((value >> 16) & 0xFF), static_cast<char>(value >> 24)};
+            out.write(bytes, 4);
+        };
+
+        const uint32_t dataBytes = static_cast<uint32_t>(samples.size() * 2);
+        out.write("RIFF", 4);
+        u32(36 + dataBytes);
+        out.write("WAVEfmt ", 8);
+        u32(16);
+        u16(1);                                   // PCM
+        u16(1);                                   // Mono
+        u32(RENDER_SAMPLE_RATE);
+        u32(RENDER_SAMPLE_RATE * 2);
+        u16(2);
+        u16(16);
+        out.write("data", 4);
+        u32(dataBytes);
+        for (float value : samples) {
+            const long quantized = std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+            u16(static_cast<uint16_t>(static_cast<int16_t>(quantized)));
+        }
+        return static_cast<bool>(out);
+    }
+
+    std::string jsonString(const std::string& text) {
+        std::string escaped = "\"";
+        for (char c : text) {
+            switch (c) {
+                case '"': escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n"; break;
+                case '\t': escaped += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char code[8];
+                        std::snprintf(code, sizeof(code), "\\u%04x", c);
+                        escaped += code;
+                    } else {
+                        escaped += c;
+                    }
+            }
+        }
+        return escaped + "\"";
+    }
+
+    std::string jsonNumber(double value) {
+        if (!std::isfinite(value)) return "null";
+        std::ostringstream text;
+        text << std::setprecision(9) << value;
+        return text.str();
+    }
+
+    void writeMeasurement(std::ostringstream& json, const BenchmarkMeasurement& m, double tolerance,
+                          const std::string& key, const std::string& indent) {
+        json << indent << "{" << jsonString(key) << ": " << jsonString(m.name)
+             << ", \"seconds\": " << jsonNumber(m.seconds)
+             << ", \"min_seconds\": " << jsonNumber(m.minSeconds)
+             << ", \"offset\": " << jsonNumber(m.offset)
+             << ", \"error\": " << jsonNumber(m.error)
+             << ", \"within_tolerance\": " << (std::abs(m.error) <= tolerance ? "true" : "false")
+             << ", \"confidence\": " << jsonNumber(m.confidence);
+        if (!m.algorithmsRun.empty() || !m.stages.empty()) {
+            json << ", \"drift_ppm\": " << jsonNumber(m.driftPpm) << ", \"algorithms_run\": [";
+            for (size_t i = 0; i < m.algorithmsRun.size(); ++i) {
+                json << (i ? ", " : "") << jsonString(m.algorithmsRun[i]);
+            }
+            json << "], \"stages\": {";
+            bool first = true;
+            for (const auto& [name, value] : m.stages) {
+                json << (first ? "" : ", ") << jsonString(name) << ": " << jsonNumber(value);
+                first = false;
+            }
+            json << "}";
+        }
+        json << "}";
+    }
+
+    std::string trim(const std::string& text) {
+        const auto first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos) return "";
+        return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    }
+}
+
+// ===========================
+// SyncBenchmark Implementation
+// ===========================
+
+SyncBenchmark::SyncBenchmark(BenchmarkOptions options) : options(std::move(options)) {
+    this->options.repetitions = std::max<size_t>(1, this->options.repetitions);
+}
+
+const char* SyncBenchmark::qualityName(SyncQuality quality) {
+    switch (quality) {
+        case SyncQuality::REAL_TIME: return "real-time";
+        case SyncQuality::STANDARD: return "standard";
+        case SyncQuality::HIGH_QUALITY: return "high-quality";
+    }
+    return "unknown";
+}
+
+std::vector<BenchmarkScenario> SyncBenchmark::syntheticScenarios() {
+    auto scenario = [](std::string name, double offset, double driftPpm, double snrDb, double duration) {
+        BenchmarkScenario s;
+        s.name = std::move(name);
+        s.offset = offset;
+        s.driftPpm = driftPpm;
+        s.snrDb = snrDb;
+        s.duration = duration;
+        return s;
+    };
+    return {
+        scenario("clean_late_start", 2.5, 0.0, 40.0, 60.0),
+        scenario("clean_early_start", -7.25, 0.0, 40.0, 60.0),
+        scenario("noisy_lav", 12.04, 0.0, 6.0, 60.0),
+        scenario("short_take", 0.731, 0.0, 30.0, 20.0),
+        scenario("drifting_recorder", 1.2, 40.0, 30.0, 300.0),
+    };
+}
+
+bool SyncBenchmark::loadCorpus(const std::filesystem::path& directory,
+                               std::vector<BenchmarkScenario>& scenarios, std::string& error) {
+    const auto manifest = directory / "offsets.csv";
+    std::ifstream in(manifest);
+    if (!in) {
+        error = "cannot read " + manifest.string();
+        return false;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        std::vector<std::string> fields;
+        std::stringstream row(line);
+        std::string field;
+        while (std::getline(row, field, ',')) {
+            fields.push_back(trim(field));
+        }
+        BenchmarkScenario scenario;
+        try {
+            if (fields.size() < 3) throw std::invalid_argument("too few fields");
+            scenario.offset = std::stod(fields[2]);
+            scenario.driftPpm = fields.size() > 3 ? std::stod(fields[3]) : 0.0;
+        } catch (const std::exception&) {
+            error = manifest.string() + ":" + std::to_string(lineNumber) +
+                    ": expected file1,file2,offset[,driftPpm]";
+            return false;
+        }
+        scenario.file1 = directory / fields[0];
+        scenario.file2 = directory / fields[1];
+        scenario.name = scenario.file2.stem().string();
+        scenario.duration = 0.0;
+        scenarios.push_back(std::move(scenario));
+    }
+    return true;
+}
+
+bool SyncBenchmark::renderScenario(const BenchmarkScenario& scenario, const std::filesystem::path& file1,
+                                   const std::filesystem::path& file2) {
+    std::mt19937 rng(seedFor(scenario.name));
+    const double rate = RENDER_SAMPLE_RATE;
+    const double stretch = 1.0 + scenario.driftPpm * 1e-6;
+
+    // Programme time tau covers both recordings; audio 2 starts at tau = offset
+    const double tauStart = std::min(0.0, scenario.offset) - 1.0;
+    const double tauEnd = std::max(scenario.duration, scenario.offset + scenario.duration * stretch) + 1.0;
+    const auto source = renderSource(static_cast<size_t>((tauEnd - tauStart) * rate), rng);
+    auto sourceAt = [&](double tau) {
+        const double position = (tau - tauStart) * rate;
+        const size_t index = static_cast<size_t>(position);
+        if (index + 1 >= source.size()) return 0.0f;
+        const float fraction = static_cast<float>(position - index);
+        return source[index] + fraction * (source[index + 1] - source[index]);
+    };
+
+    const size_t length = static_cast<size_t>(scenario.duration * rate);
+    std::vector<float> audio1(length);
+    std::vector<float> audio2(length);
+    for (size_t n = 0; n < length; ++n) {
+        const double t = n / rate;
+        audio1[n] = sourceAt(t);
+        audio2[n] = static_cast<float>(AUDIO2_GAIN) * sourceAt(scenario.offset + t * stretch);
+    }
+
+    std::normal_distribution<float> gaussian(0.0f, 1.0f);
+    const float floor1 = static_cast<float>(std::pow(10.0, NOISE_FLOOR_DB / 20.0));
+    const float noise2 = static_cast<float>(rms(audio2) * std::pow(10.0, -scenario.snrDb / 20.0));
+    for (size_t n = 0; n < length; ++n) {
+        audio1[n] += floor1 * gaussian(rng);
+        audio2[n] += noise2 * gaussian(rng);
+    }
+
+    return writeWav(file1, audio1) && writeWav(file2, audio2);
+}
+
+BenchmarkCaseResult SyncBenchmark::runScenario(const BenchmarkScenario& scenario, bool synthetic) {
+    BenchmarkCaseResult result;
+    result.scenario = scenario;
+    result.synthetic = synthetic;
+
+    std::filesystem::path file1 = scenario.file1;
+    std::filesystem::path file2 = scenario.file2;
+    if (synthetic) {
+        file1 = options.workDirectory / (scenario.name + "_1.wav");
+        file2 = options.workDirectory / (scenario.name + "_2.wav");
+        if (!renderScenario(scenario, file1, file2)) {
+            result.error = "cannot write scenario files to " + options.workDirectory.string();
+            return result;
+        }
+    }
+
+    double duration = synthetic ? scenario.duration
+                                : std::min(MediaProbeCache::probe(file1).duration,
+                                           MediaProbeCache::probe(file2).duration);
+    duration = std::min(duration, MAX_ANALYZED_SECONDS);
+    if (duration <= 0.0) {
+        result.error = "cannot probe " + file1.string() + " / " + file2.string();
+        return result;
+    }
+    result.audioSeconds = duration;
+    const double sampleRate = HybridAudioSync::analysisSampleRate();
+
+    // Stage 1: decode both files at the analysis rate
+    std::vector<float> samples1;
+    std::vector<float> samples2;
+    AudioDecoder decoder;
+    for (size_t rep = 0; rep < options.repetitions; ++rep) {
+        auto start = Clock::now();
+        if (!decoder.decode(file1, 0.0, duration, sampleRate, samples1) ||
+            !decoder.decode(file2, 0.0, duration, sampleRate, samples2)) {
+            result.error = "decode failed: " + decoder.getLastError();
+            return result;
+        }
+        result.decodeSeconds += secondsSince(start) / options.repetitions;
+    }
+
+    // Stage 2: features of the whole decoded audio
+    AudioFeatures features1;
+    AudioFeatures features2;
+    FeatureExtractor extractor(FEATURE_FRAME_SIZE, FEATURE_HOP_SIZE, FEATURE_BANDS, FEATURE_COEFFICIENTS);
+    for (size_t rep = 0; rep < options.repetitions; ++rep) {
+        auto start = Clock::now();
+        extractor.extract(samples1, sampleRate, features1);
+        extractor.extract(samples2, sampleRate, features2);
+        result.extractSeconds += secondsSince(start) / options.repetitions;
+    }
+    features1.waveform = std::move(samples1);
+    features2.waveform = std::move(samples2);
+
+    // Stage 3: every algorithm on the same features; one untimed run warms plans and caches
+    std::vector<std::unique_ptr<SyncAlgorithm>> algorithms;
+    algorithms.push_back(std::make_unique<CrossCorrelationSync>());
+    algorithms.push_back(std::make_unique<DTWSync>());
+    algorithms.push_back(std::make_unique<OnsetSync>());
+    algorithms.push_back(std::make_unique<SpectralCorrelationSync>());
+    for (auto& algorithm : algorithms) {
+        BenchmarkMeasurement measurement;
+        measurement.name = algorithm->getName();
+        measurement.minSeconds = std::numeric_limits<double>::max();
+        SyncResult sync = algorithm->synchronize(features1, features2);
+        for (size_t rep = 0; rep < options.repetitions; ++rep) {
+            auto start = Clock::now();
+            sync = algorithm->synchronize(features1, features2);
+            const double elapsed = secondsSince(start);
+            measurement.seconds += elapsed / options.repetitions;
+            measurement.minSeconds = std::min(measurement.minSeconds, elapsed);
+        }
+        // Algorithms report t2 - t1; the pipeline convention is its negation
+        measurement.offset = -sync.offset;
+        measurement.error = measurement.offset - scenario.offset;
+        measurement.confidence = sync.confidence;
+        result.algorithms.push_back(std::move(measurement));
+    }
+
+    // Stage 4: the full pipeline per quality mode
+    HybridAudioSync engine;
+    engine.setVerbose(options.verbose);
+    engine.setDriftMode(scenario.driftPpm != 0.0);
+    for (SyncQuality quality : options.qualities) {
+        BenchmarkMeasurement measurement;
+        measurement.name = qualityName(quality);
+        measurement.minSeconds = std::numeric_limits<double>::max();
+        SyncResult sync = engine.findOptimalSync(file1, file2, quality);
+        for (size_t rep = 0; rep < options.repetitions; ++rep) {
+            auto start = Clock::now();
+            sync = engine.findOptimalSync(file1, file2, quality);
+            const double elapsed = secondsSince(start);
+            measurement.seconds += elapsed / options.repetitions;
+            measurement.minSeconds = std::min(measurement.minSeconds, elapsed);
+        }
+        measurement.offset = sync.offset;
+        measurement.error = sync.offset - scenario.offset;
+        measurement.confidence = sync.confidence;
+        measurement.driftPpm = sync.driftPpm;
+        measurement.algorithmsRun = sync.algorithmsRun;
+        measurement.stages = engine.getPerformanceStats();
+        result.qualities.push_back(std::move(measurement));
+    }
+
+    result.ok = true;
+    return result;
+}
+
+bool SyncBenchmark::run() {
+    std::cout << "\n🏁 Running Sync Benchmark..." << std::endl;
+    std::cout << "====================================" << std::endl;
+#ifdef USE_FFTW
+    std::cout << "FFT: FFTW" << std::endl;
+#else
+    std::cout << "FFT: built-in radix-2" << std::endl;
+#endif
+    std::cout << "SIMD kernels: " << simd::activeKernelName() << std::endl;
+    std::cout << "Repetitions: " << options.repetitions << std::endl;
+
+    std::vector<std::pair<BenchmarkScenario, bool>> scenarios;
+    if (options.synthetic) {
+        for (auto& scenario : syntheticScenarios()) {
+            scenarios.emplace_back(std::move(scenario), true);
+        }
+    }
+    bool allOk = true;
+    if (!options.corpusDirectory.empty()) {
+        std::vector<BenchmarkScenario> corpus;
+        std::string error;
+        if (!loadCorpus(options.corpusDirectory, corpus, error)) {
+            std::cerr << "❌ Corpus: " << error << std::endl;
+            allOk = false;
+        }
+        for (auto& scenario : corpus) {
+            scenarios.emplace_back(std::move(scenario), false);
+        }
+    }
+
+    // Rendered files go to a private temporary directory unless one was given
+    bool ownsWorkDirectory = false;
+    if (options.synthetic && options.workDirectory.empty()) {
+        std::error_code ec;
+        options.workDirectory = std::filesystem::temp_directory_path(ec) /
+                                ("sync_benchmark_" + std::to_string(::getpid()));
+        ownsWorkDirectory = true;
+    }
+    if (options.synthetic) {
+        std::error_code ec;
+        std::filesystem::create_directories(options.workDirectory, ec);
+    }
+
+    caseResults.clear();
+    auto start = Clock::now();
+    for (const auto& [scenario, synthetic] : scenarios) {
+        std::cout << "▶️  " << scenario.name << "..." << std::flush;
+        caseResults.push_back(runScenario(scenario, synthetic));
+        const auto& result = caseResults.back();
+        if (result.ok) {
+            std::cout << " done" << std::endl;
+        } else {
+            std::cout << " ❌ " << result.error << std::endl;
+            allOk = false;
+        }
+    }
+    const double elapsed = secondsSince(start);
+
+    if (ownsWorkDirectory && !options.keepFiles) {
+        std::error_code ec;
+        std::filesystem::remove_all(options.workDirectory, ec);
+    }
+
+    printSummary();
+    std::cout << "Benchmark completed in " << std::fixed << std::setprecision(3) << elapsed << "s"
+              << std::defaultfloat << std::endl;
+
+    if (!options.jsonFile.empty()) {
+        std::ofstream out(options.jsonFile, std::ios::trunc);
+        out << toJson();
+        if (!out) {
+            std::cerr << "❌ Cannot write " << options.jsonFile << std::endl;
+            return false;
+        }
+        std::cout << "📄 Report: " << options.jsonFile.string() << std::endl;
+    }
+    return allOk;
+}
+
+void SyncBenchmark::printSummary() const {
+    auto line = [this](const BenchmarkMeasurement& m) {
+        std::cout << "   " << std::left << std::setw(20) << m.name << std::right << std::fixed
+                  << std::setprecision(4) << std::setw(9) << m.seconds << "s   offset "
+                  << std::showpos << std::setw(9) << m.offset << "s   error " << std::setw(8) << m.error
+                  << std::noshowpos << "s   conf " << std::setprecision(2) << m.confidence
+                  << (std::abs(m.error) <= options.tolerance ? "  ✅" : "  ❌") << std::endl;
+    };
+
+    for (const auto& result : caseResults) {
+        if (!result.ok) continue;
+        const auto& s = result.scenario;
+        std::cout << "\n📊 " << s.name << std::fixed << std::setprecision(3) << " (truth " << std::showpos
+                  << s.offset << "s" << std::noshowpos;
+        if (s.driftPpm != 0.0) std::cout << ", " << s.driftPpm << " ppm";
+        if (result.synthetic) std::cout << ", " << std::setprecision(0) << s.snrDb << " dB SNR";
+        std::cout << ", " << std::setprecision(0) << result.audioSeconds << "s)" << std::endl;
+        std::cout << "   decode " << std::setprecision(4) << result.decodeSeconds << "s, features "
+                  << result.extractSeconds << "s" << std::endl;
+        for (const auto& m : result.algorithms) line(m);
+        for (const auto& m : result.qualities) line(m);
+    }
+
+    // Accuracy per quality mode over every scenario
+    std::cout << "\n🎯 Summary (tolerance " << std::fixed << std::setprecision(1) << options.tolerance * 1000.0 << " ms)" << std::endl;
+    for (SyncQuality quality : options.qualities) {
+        size_t cases = 0, correct = 0;
+        double errorSum = 0.0, timeSum = 0.0;
+        for (const auto& result : caseResults) {
+            for (const auto& m : result.qualities) {
+                if (m.name != qualityName(quality)) continue;
+                cases++;
+                correct += std::abs(m.error) <= options.tolerance ? 1 : 0;
+                errorSum += std::abs(m.error);
+                timeSum += m.seconds;
+            }
+        }
+        if (cases == 0) continue;
+        std::cout << "   " << std::left << std::setw(14) << qualityName(quality) << std::right
+                  << correct << "/" << cases << " within tolerance, mean |error| " << std::setprecision(2)
+                  << errorSum / cases * 1000.0 << " ms, mean time " << std::setprecision(3)
+                  << timeSum / cases << "s" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+std::string SyncBenchmark::toJson() const {
+    std::ostringstream json;
+    json << "{\n  \"version\": 1,\n";
+#ifdef USE_FFTW
+    json << "  \"fft\": \"fftw\",\n";
+#else
+    json << "  \"fft\": \"radix2\",\n";
+#endif
+    json << "  \"simd\": " << jsonString(simd::activeKernelName()) << ",\n"
+         << "  \"repetitions\": " << options.repetitions << ",\n"
+         << "  \"tolerance\": " << jsonNumber(options.tolerance) << ",\n"
+         << "  \"cases\": [";
+
+    for (size_t c = 0; c < caseResults.size(); ++c) {
+        const auto& result = caseResults[c];
+        const auto& s = result.scenario;
+        json << (c ? ",\n" : "\n") << "    {\n"
+             << "      \"name\": " << jsonString(s.name) << ",\n"
+             << "      \"source\": " << (result.synthetic ? "\"synthetic\"" : "\"corpus\"") << ",\n"
+             << "      \"ok\": " << (result.ok ? "true" : "false") << ",\n";
+        if (!result.ok) {
+            json << "      \"error\": " << jsonString(result.error) << ",\n";
+        }
+        json << "      \"truth\": {\"offset\": " << jsonNumber(s.offset)
+             << ", \"drift_ppm\": " << jsonNumber(s.driftPpm);
+        if (result.synthetic) {
+            json << ", \"snr_db\": " << jsonNumber(s.snrDb);
+        } else {
+            json << ", \"file1\": " << jsonString(s.file1.string())
+                 << ", \"file2\": " << jsonString(s.file2.string());
+        }
+        json << "},\n"
+             << "      \"audio_seconds\": " << jsonNumber(result.audioSeconds) << ",\n"
+             << "      \"decode_seconds\": " << jsonNumber(result.decodeSeconds) << ",\n"
+             << "      \"extract_seconds\": " << jsonNumber(result.extractSeconds) << ",\n"
+             << "      \"algorithms\": [";
+        for (size_t i = 0; i < result.algorithms.size(); ++i) {
+            json << (i ? ",\n" : "\n");
+            writeMeasurement(json, result.algorithms[i], options.tolerance, "name", "        ");
+        }
+        json << (result.algorithms.empty() ? "" : "\n      ") << "],\n"
+             << "      \"qualities\": [";
+        for (size_t i = 0; i < result.qualities.size(); ++i) {
+            json << (i ? ",\n" : "\n");
+            writeMeasurement(json, result.qualities[i], options.tolerance, "quality", "        ");
+        }
+        json << (result.qualities.empty() ? "" : "\n      ") << "]\n    }";
+    }
+    json << (caseResults.empty() ? "" : "\n  ") << "],\n  \"summary\": {";
+
+    bool firstQuality = true;
+    for (SyncQuality quality : options.qualities) {
+        size_t cases = 0, correct = 0;
+        double errorSum = 0.0, errorMax = 0.0, timeSum = 0.0;
+        for (const auto& result : caseResults) {
+            for (const auto& m : result.qualities) {
+                if (m.name != qualityName(quality)) continue;
+                cases++;
+                correct += std::abs(m.error) <= options.tolerance ? 1 : 0;
+                errorSum += std::abs(m.error);
+                errorMax = std::max(errorMax, std::abs(m.error));
+                timeSum += m.seconds;
+            }
+        }
+        json << (firstQuality ? "\n" : ",\n") << "    " << jsonString(qualityName(quality))
+             << ": {\"cases\": " << cases << ", \"within_tolerance\": " << correct
+             << ", \"mean_abs_error\": " << jsonNumber(cases ? errorSum / cases : 0.0)
+             << ", \"max_abs_error\": " << jsonNumber(errorMax)
+             << ", \"mean_seconds\": " << jsonNumber(cases ? timeSum / cases : 0.0) << "}";
+        firstQuality = false;
+    }
+    json << (firstQuality ? "" : "\n  ") << "}\n}\n";
+    return json.str();
+}
@@ -0,0 +1,91 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Fixed-size worker pool implementation
+ */
+
+#include "thread_pool.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+    thread_local size_t workerIndex = 0;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    threadCount = std::max<size_t>(1, threadCount);
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return tasks.empty() && activeTasks == 0; });
+}
+
+bool ThreadPool::runPendingTask() {
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) {
+            return false;
+        }
+        task = std::move(tasks.front());
+        tasks.pop_front();
+        activeTasks++;
+    }
+
+    task();
+    finishTask();
+    return true;
+}
+
+size_t ThreadPool::currentWorkerIndex() {
+    return workerIndex;
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+void ThreadPool::finishTask() {
+    std::lock_guard<std::mutex> lock(mutex);
+    activeTasks--;
+    if (tasks.empty() && activeTasks == 0) {
+        idle.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    workerIndex = index;
+
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // stopping and fully drained
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            activeTasks++;
+        }
+
+        task();
+        finishTask();
+    }
+}
@@ -0,0 +1,1110 @@
+/**
+ * @file transcode_engine.cpp
+ * @brief Native transcode pipeline implementation
+ */
+
+#include "transcode_engine.h"
+#include "av_utils.h"
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <unistd.h>
+
+namespace {
+    // Audio output, identical to the former ffmpeg command line
+    constexpr int AUDIO_SAMPLE_RATE = 48000;
+    constexpr AVSampleFormat AUDIO_SAMPLE_FORMAT = AV_SAMPLE_FMT_S32;   // What pcm_s24le takes
+
+    constexpr double PROGRESS_INTERVAL_SECONDS = 1.0;
+
+    // Heads shorter than this are trimmed by decoding through them instead of seeking
+    constexpr double MIN_SEEK_SECONDS = 1.0;
+
+    // Headroom for resampler delay beyond the requested camera audio
+    constexpr size_t TEE_SLACK_SAMPLES = 8192;
+
+    /**
+     * @brief Fixed-size record in front of each spilled packet's payload
+     */
+    struct SpillRecord {
+        int64_t pts;
+        int64_t dts;
+        int64_t duration;
+        int64_t pos;
+        int32_t streamIndex;
+        int32_t flags;
+        int32_t size;
+        int32_t reserved;
+    };
+}
+
+// ===========================
+// Packet Spool
+// ===========================
+
+/**
+ * @brief Packets demuxed ahead of the transcode, replayed in read order
+ *
+ * The first packets stay in memory (as references, no copy); once the limit
+ * is reached every later packet goes to a temporary file, so replaying the
+ * memory part and then the file keeps the original order. Spilled packets
+ * lose their side data, which the decoders used here do not need.
+ */
+struct TranscodeEngine::Spool {
+    ~Spool() {
+        if (spill.is_open()) {
+            spill.close();
+        }
+        if (!spillPath.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(spillPath, ec);
+        }
+    }
+
+    bool push(const AVPacket* packet, std::string& error) {
+        if (spillPath.empty() && memoryBytes + packet->size <= memoryLimit) {
+            av::PacketPtr copy(av_packet_clone(packet));
+            if (!copy) {
+                error = "cannot reference packet";
+                return false;
+            }
+            memoryBytes += packet->size;
+            memory.push_back(std::move(copy));
+            return true;
+        }
+
+        if (spillPath.empty()) {
+            static std::atomic<unsigned> counter{0};
+            const auto directory = spillDirectory.empty()
+                ? std::filesystem::temp_directory_path() : spillDirectory;
+            spillPath = directory / ("sync-spool-" + std::to_string(::getpid()) + "-" +
+                                     std::to_string(counter++) + ".pkt");
+            spill.open(spillPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!spill) {
+                error = "cannot create spool file " + spillPath.string();
+                return false;
+            }
+        }
+
+        SpillRecord record{packet->pts, packet->dts, packet->duration, packet->pos,
+                           packet->stream_index, packet->flags, packet->size, 0};
+        spill.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        spill.write(reinterpret_cast<const char*>(packet->data), packet->size);
+        if (!spill) {
+            error = "cannot write spool file " + spillPath.string();
+            return false;
+        }
+        spillBytes += sizeof(record) + packet->size;
+        spillRecords++;
+        return true;
+    }
+
+    /**
+     * @brief Next packet: memory, then the spill file, then the demuxer
+     * @param demuxer The spooled demuxer, wherever it is owned by now
+     */
+    int read(AVFormatContext* demuxer, AVPacket* packet) {
+        if (!memory.empty()) {
+            int ret = av_packet_ref(packet, memory.front().get());
+            memoryBytes -= memory.front()->size;
+            memory.pop_front();
+            return ret;
+        }
+
+        if (readRecords < spillRecords) {
+            if (readRecords == 0) {
+                spill.flush();
+                spill.seekg(0);
+            }
+            SpillRecord record;
+            spill.read(reinterpret_cast<char*>(&record), sizeof(record));
+            int ret = spill ? av_new_packet(packet, record.size) : AVERROR(EIO);
+            if (ret < 0) {
+                return ret;
+            }
+            spill.read(reinterpret_cast<char*>(packet->data), record.size);
+            if (!spill) {
+                av_packet_unref(packet);
+                return AVERROR(EIO);
+            }
+            packet->pts = record.pts;
+            packet->dts = record.dts;
+            packet->duration = record.duration;
+            packet->pos = record.pos;
+            packet->stream_index = record.streamIndex;
+            packet->flags = record.flags;
+            readRecords++;
+            return 0;
+        }
+
+        return av_read_frame(demuxer, packet);
+    }
+
+    std::filesystem::path videoFile;
+    av::InputFormatPtr format;          // Positioned after the last spooled packet; moved out by run()
+
+    std::deque<av::PacketPtr> memory;
+    size_t memoryBytes = 0;
+    size_t memoryLimit = 0;
+
+    std::filesystem::path spillDirectory;
+    std::filesystem::path spillPath;
+    std::fstream spill;
+    size_t spillBytes = 0;
+    size_t spillRecords = 0;
+    size_t readRecords = 0;
+};
+
+// ===========================
+// Pipeline State
+// ===========================
+
+namespace {
+    /**
+     * @brief One decoded input stream feeding one encoded output stream
+     */
+    struct Lane {
+        bool isVideo = false;
+        bool copy = false;                // Packets are remuxed without decoding
+        size_t input = 0;                 // Index into Session::inputs
+        AVStream* source = nullptr;
+        av::CodecContextPtr decoder;
+        av::CodecContextPtr encoder;
+        AVStream* output = nullptr;
+        bool flushed = false;
+
+        // Video: pixel format conversion and monotonic timestamps (source time base)
+        av::ScalerPtr scaler;
+        av::FramePtr converted;
+        int64_t startPts = 0;
+        int64_t lastPts = AV_NOPTS_VALUE;
+
+        // Audio: resampling, head trim and sample-counted timestamps (1/48000)
+        av::ResamplerPtr resampler;
+        int resamplerFormat = AV_SAMPLE_FMT_NONE;
+        int resamplerRate = 0;
+        int resamplerChannels = 0;
+        double trim = 0.0;                // Source seconds dropped from the head
+        double tempo = 1.0;
+        int64_t compensationSamples = 0;  // Output samples the drift correction spreads over
+        bool anchored = false;            // nextPts fixed (external tracks start anchored)
+        int64_t nextPts = 0;
+        double nextFrameTime = 0.0;
+    };
+
+    /**
+     * @brief One demuxed file
+     */
+    struct Input {
+        av::InputFormatPtr format;
+        double containerStart = 0.0;
+        double offset = 0.0;              // Output time = (source time + offset) / tempo
+        double tempo = 1.0;
+        double position = -std::numeric_limits<double>::infinity();   // Output time of the last packet
+        bool finished = false;
+        std::vector<int> laneOf;          // Stream index -> lane index, -1 if unused
+    };
+
+    struct Session {
+        explicit Session(std::string& error) : error(error) {}
+        
+        std::vector<Input> inputs;
+        std::vector<Lane> lanes;
+        av::OutputFormatPtr output;
+        av::PacketPtr packet;
+        av::PacketPtr encoded;
+        av::FramePtr frame;
+        av::FramePtr samples;
+        double duration = 0.0;
+        std::string& error;            // The engine's lastError
+    };
+
+    double sourceSeconds(int64_t timestamp, AVRational timeBase, double containerStart) {
+        return timestamp * av_q2d(timeBase) - containerStart;
+    }
+
+    bool openInput(Input& input, av::InputFormatPtr format) {
+        input.format = std::move(format);
+        if (!input.format) {
+            return false;
+        }
+        input.containerStart = input.format->start_time != AV_NOPTS_VALUE
+            ? static_cast<double>(input.format->start_time) / AV_TIME_BASE : 0.0;
+        input.laneOf.assign(input.format->nb_streams, -1);
+        return true;
+    }
+
+    av::CodecContextPtr openDecoder(AVStream* stream, int threads, std::string& error) {
+        const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+        if (!codec) {
+            error = std::string("no decoder for ") + avcodec_get_name(stream->codecpar->codec_id);
+            return nullptr;
+        }
+        av::CodecContextPtr decoder(avcodec_alloc_context3(codec));
+        if (!decoder) {
+            error = "cannot allocate decoder";
+            return nullptr;
+        }
+        int ret = avcodec_parameters_to_context(decoder.get(), stream->codecpar);
+        if (ret >= 0) {
+            decoder->pkt_timebase = stream->time_base;
+            decoder->thread_count = threads;
+            ret = avcodec_open2(decoder.get(), codec, nullptr);
+        }
+        if (ret < 0) {
+            error = "cannot open " + std::string(codec->name) + " decoder: " + av::errorString(ret);
+            return nullptr;
+        }
+        return decoder;
+    }
+
+    AVStream* addOutputStream(AVFormatContext* output, const AVCodecContext* encoder,
+                              const std::string& title, std::string& error) {
+        AVStream* stream = avformat_new_stream(output, nullptr);
+        if (!stream) {
+            error = "cannot add output stream";
+            return nullptr;
+        }
+        int ret = avcodec_parameters_from_context(stream->codecpar, encoder);
+        if (ret < 0) {
+            error = "cannot copy encoder parameters: " + av::errorString(ret);
+            return nullptr;
+        }
+        stream->time_base = encoder->time_base;
+        if (!title.empty()) {
+            av_dict_set(&stream->metadata, "title", title.c_str(), 0);
+        }
+        return stream;
+    }
+
+    /**
+     * @brief Try to open one encoder of a profile for the decoded video
+     * @return Open encoder, or nullptr with error set
+     */
+    av::CodecContextPtr openVideoEncoder(const VideoEncoderSettings& settings, const Lane& lane,
+                                         Input& input, const AVFormatContext* output,
+                                         int threads, std::string& error) {
+        const AVCodec* codec = avcodec_find_encoder_by_name(settings.encoder.c_str());
+        if (!codec) {
+            error = settings.encoder + " encoder not available";
+            return nullptr;
+        }
+        const AVPixelFormat pixelFormat = av_get_pix_fmt(settings.pixelFormat.c_str());
+        if (pixelFormat == AV_PIX_FMT_NONE) {
+            error = "unknown pixel format " + settings.pixelFormat;
+            return nullptr;
+        }
+        av::CodecContextPtr encoder(avcodec_alloc_context3(codec));
+        if (!encoder) {
+            error = "cannot allocate video encoder";
+            return nullptr;
+        }
+
+        const AVCodecContext* decoder = lane.decoder.get();
+        encoder->width = decoder->width;
+        encoder->height = decoder->height;
+        encoder->pix_fmt = pixelFormat;
+        encoder->sample_aspect_ratio = decoder->sample_aspect_ratio;
+        encoder->color_range = decoder->color_range;
+        encoder->color_primaries = decoder->color_primaries;
+        encoder->color_trc = decoder->color_trc;
+        encoder->colorspace = decoder->colorspace;
+        encoder->time_base = lane.source->time_base;
+        encoder->framerate = av_guess_frame_rate(input.format.get(), lane.source, nullptr);
+        encoder->thread_count = threads;
+        if (output->oformat->flags & AVFMT_GLOBALHEADER) {
+            encoder->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+
+        AVDictionary* options = nullptr;
+        for (const auto& [key, value] : settings.options) {
+            av_dict_set(&options, key.c_str(), value.c_str(), 0);
+        }
+        // Hardware encoders fail here when their device or driver is missing
+        int ret = avcodec_open2(encoder.get(), codec, &options);
+        av_dict_free(&options);
+        if (ret < 0) {
+            error = "cannot open " + settings.encoder + ": " + av::errorString(ret);
+            return nullptr;
+        }
+        return encoder;
+    }
+
+    bool openCopyLane(Lane& lane, AVFormatContext* output, std::string& error) {
+        AVStream* stream = avformat_new_stream(output, nullptr);
+        if (!stream) {
+            error = "cannot add output stream";
+            return false;
+        }
+        int ret = avcodec_parameters_copy(stream->codecpar, lane.source->codecpar);
+        if (ret < 0) {
+            error = "cannot copy stream parameters: " + av::errorString(ret);
+            return false;
+        }
+        // The source container's tag may not exist in QuickTime; let the muxer pick
+        stream->codecpar->codec_tag = 0;
+        stream->time_base = lane.source->time_base;
+        stream->avg_frame_rate = lane.source->avg_frame_rate;
+        stream->sample_aspect_ratio = lane.source->sample_aspect_ratio;
+        lane.copy = true;
+        lane.output = stream;
+        return true;
+    }
+
+    bool openVideoLane(Lane& lane, Input& input, AVFormatContext* output, const OutputProfile& profile,
+                       int threads, std::string& error) {
+        // Video timestamps start at the container start, like ffmpeg's default
+        lane.startPts = av_rescale_q(static_cast<int64_t>(input.containerStart * AV_TIME_BASE),
+                                     AV_TIME_BASE_Q, lane.source->time_base);
+
+        if (profile.copyVideo) {
+            return openCopyLane(lane, output, error);
+        }
+
+        lane.decoder = openDecoder(lane.source, threads, error);
+        if (!lane.decoder) {
+            return false;
+        }
+
+        // First encoder of the profile that opens here
+        const VideoEncoderSettings* chosen = nullptr;
+        std::string attempts;
+        for (const auto& settings : profile.encoders) {
+            std::string reason;
+            lane.encoder = openVideoEncoder(settings, lane, input, output, threads, reason);
+            if (lane.encoder) {
+                chosen = &settings;
+                break;
+            }
+            attempts += (attempts.empty() ? "" : "; ") + reason;
+        }
+        if (!chosen) {
+            error = "no usable encoder for profile " + profile.name +
+                    (attempts.empty() ? "" : " (" + attempts + ")");
+            return false;
+        }
+
+        AVCodecContext* encoder = lane.encoder.get();
+        lane.output = addOutputStream(output, encoder, "", error);
+        if (!lane.output) {
+            return false;
+        }
+        lane.output->avg_frame_rate = encoder->framerate;
+        if (chosen->codecTag.size() == 4) {
+            const std::string& tag = chosen->codecTag;
+            lane.output->codecpar->codec_tag = MKTAG(tag[0], tag[1], tag[2], tag[3]);
+        }
+        return true;
+    }
+
+    bool openAudioLane(Lane& lane, AVFormatContext* output, const std::string& title,
+                       std::string& error) {
+        lane.decoder = openDecoder(lane.source, 1, error);
+        if (!lane.decoder) {
+            return false;
+        }
+
+        const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_PCM_S24LE);
+        if (!codec) {
+            error = "pcm_s24le encoder not available";
+            return false;
+        }
+        lane.encoder.reset(avcodec_alloc_context3(codec));
+        if (!lane.encoder) {
+            error = "cannot allocate audio encoder";
+            return false;
+        }
+
+        AVCodecContext* encoder = lane.encoder.get();
+        encoder->sample_fmt = AUDIO_SAMPLE_FORMAT;
+        encoder->sample_rate = AUDIO_SAMPLE_RATE;
+        av_channel_layout_default(&encoder->ch_layout, std::max(1, lane.decoder->ch_layout.nb_channels));
+        encoder->time_base = AVRational{1, AUDIO_SAMPLE_RATE};
+        if (output->oformat->flags & AVFMT_GLOBALHEADER) {
+            encoder->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        int ret = avcodec_open2(encoder, codec, nullptr);
+        if (ret < 0) {
+            error = "cannot open audio encoder: " + av::errorString(ret);
+            return false;
+        }
+
+        lane.output = addOutputStream(output, encoder, title, error);
+        return lane.output != nullptr;
+    }
+
+    /**
+     * @brief Send a frame (nullptr = flush) and mux every packet that comes out
+     */
+    bool encodeFrame(Session& session, Lane& lane, AVFrame* frame);
+
+    bool encodeVideoFrame(Session& session, Lane& lane, AVFrame* frame) {
+        int64_t pts = frame->best_effort_timestamp;
+        pts = pts != AV_NOPTS_VALUE ? pts - lane.startPts
+                                    : (lane.lastPts != AV_NOPTS_VALUE ? lane.lastPts + 1 : 0);
+        // The encoder needs strictly increasing timestamps
+        if (lane.lastPts != AV_NOPTS_VALUE && pts <= lane.lastPts) {
+            pts = lane.lastPts + 1;
+        }
+        lane.lastPts = pts;
+
+        AVFrame* input = frame;
+        const AVCodecContext* encoder = lane.encoder.get();
+        if (frame->format != encoder->pix_fmt || frame->width != encoder->width ||
+            frame->height != encoder->height) {
+            lane.scaler.reset(sws_getCachedContext(
+                lane.scaler.release(), frame->width, frame->height,
+                static_cast<AVPixelFormat>(frame->format), encoder->width, encoder->height,
+                encoder->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr));
+            if (!lane.scaler) {
+                session.error = "cannot convert pixel format";
+                return false;
+            }
+
+            int ret = 0;
+            if (!lane.converted) {
+                lane.converted.reset(av_frame_alloc());
+                lane.converted->format = encoder->pix_fmt;
+                lane.converted->width = encoder->width;
+                lane.converted->height = encoder->height;
+                ret = av_frame_get_buffer(lane.converted.get(), 0);
+            } else {
+                // The encoder may still reference the previous picture
+                ret = av_frame_make_writable(lane.converted.get());
+            }
+            if (ret < 0) {
+                session.error = "cannot allocate video frame: " + av::errorString(ret);
+                return false;
+            }
+            sws_scale(lane.scaler.get(), frame->data, frame->linesize, 0, frame->height,
+                      lane.converted->data, lane.converted->linesize);
+            lane.converted->sample_aspect_ratio = frame->sample_aspect_ratio;
+            input = lane.converted.get();
+        }
+
+        input->pts = pts;
+        return encodeFrame(session, lane, input);
+    }
+
+    bool ensureResampler(Session& session, Lane& lane, const AVFrame* frame) {
+        if (lane.resampler && frame->format == lane.resamplerFormat &&
+            frame->sample_rate == lane.resamplerRate &&
+            frame->ch_layout.nb_channels == lane.resamplerChannels) {
+            return true;
+        }
+
+        SwrContext* raw = nullptr;
+        int ret = swr_alloc_set_opts2(&raw, &lane.encoder->ch_layout, AUDIO_SAMPLE_FORMAT,
+                                      AUDIO_SAMPLE_RATE, &frame->ch_layout,
+                                      static_cast<AVSampleFormat>(frame->format),
+                                      frame->sample_rate, 0, nullptr);
+        lane.resampler.reset(raw);
+        if (ret < 0 || (ret = swr_init(lane.resampler.get())) < 0) {
+            session.error = "cannot initialize resampler: " + av::errorString(ret);
+            return false;
+        }
+
+        // Drift: spread the length difference evenly over the whole track
+        if (lane.tempo != 1.0 && lane.compensationSamples > 0) {
+            const int64_t distance = std::min<int64_t>(lane.compensationSamples, INT_MAX);
+            const int64_t delta = std::llround(distance * (1.0 / lane.tempo - 1.0));
+            ret = swr_set_compensation(lane.resampler.get(), static_cast<int>(delta),
+                                       static_cast<int>(distance));
+            if (ret < 0) {
+                session.error = "cannot set drift compensation: " + av::errorString(ret);
+                return false;
+            }
+        }
+
+        lane.resamplerFormat = frame->format;
+        lane.resamplerRate = frame->sample_rate;
+        lane.resamplerChannels = frame->ch_layout.nb_channels;
+        return true;
+    }
+
+    /**
+     * @brief Resample input samples (nullptr = drain) into one output frame and encode it
+     */
+    bool convertAudio(Session& session, Lane& lane,
+                      const uint8_t** planes, int count) {
+        const int capacity = swr_get_out_samples(lane.resampler.get(), count);
+        if (capacity <= 0) {
+            return true;
+        }
+
+        AVFrame* out = session.samples.get();
+        av_frame_unref(out);
+        out->format = AUDIO_SAMPLE_FORMAT;
+        out->sample_rate = AUDIO_SAMPLE_RATE;
+        out->nb_samples = capacity;
+        int ret = av_channel_layout_copy(&out->ch_layout, &lane.encoder->ch_layout);
+        if (ret >= 0) {
+            ret = av_frame_get_buffer(out, 0);
+        }
+        if (ret < 0) {
+            session.error = "cannot allocate audio frame: " + av::errorString(ret);
+            return false;
+        }
+
+        int converted = swr_convert(lane.resampler.get(), out->extended_data, capacity, planes, count);
+        if (converted < 0) {
+            session.error = "resampling failed: " + av::errorString(converted);
+            return false;
+        }
+        if (converted == 0) {
+            return true;
+        }
+        out->nb_samples = converted;
+        out->pts = lane.nextPts;
+        lane.nextPts += converted;
+        return encodeFrame(session, lane, out);
+    }
+
+    bool encodeAudioFrame(Session& session, Lane& lane, Input& input, AVFrame* frame) {
+        if (frame->nb_samples <= 0 || frame->sample_rate <= 0) {
+            return true;
+        }
+        if (!ensureResampler(session, lane, frame)) {
+            return false;
+        }
+
+        double frameTime = frame->best_effort_timestamp != AV_NOPTS_VALUE
+            ? sourceSeconds(frame->best_effort_timestamp, lane.source->time_base, input.containerStart)
+            : lane.nextFrameTime;
+        lane.nextFrameTime = frameTime + static_cast<double>(frame->nb_samples) / frame->sample_rate;
+
+        // Negative offsets drop the head of the track
+        int skip = 0;
+        if (frameTime < lane.trim) {
+            skip = static_cast<int>(std::llround((lane.trim - frameTime) * frame->sample_rate));
+            if (skip >= frame->nb_samples) {
+                return true;
+            }
+            frameTime = lane.trim;
+        }
+
+        // Camera audio keeps its container position relative to the video
+        if (!lane.anchored) {
+            lane.nextPts = std::max<int64_t>(0, std::llround(frameTime * AUDIO_SAMPLE_RATE));
+            lane.anchored = true;
+        }
+
+        auto format = static_cast<AVSampleFormat>(frame->format);
+        const int bytesPerSample = av_get_bytes_per_sample(format);
+        const int channels = frame->ch_layout.nb_channels;
+        std::vector<const uint8_t*> planes;
+        if (av_sample_fmt_is_planar(format)) {
+            planes.resize(channels);
+            for (int ch = 0; ch < channels; ++ch) {
+                planes[ch] = frame->extended_data[ch] + static_cast<size_t>(skip) * bytesPerSample;
+            }
+        } else {
+            planes.push_back(frame->extended_data[0] +
+                             static_cast<size_t>(skip) * bytesPerSample * channels);
+        }
+        return convertAudio(session, lane, planes.data(), frame->nb_samples - skip);
+    }
+
+    bool encodeFrame(Session& session, Lane& lane, AVFrame* frame) {
+        AVCodecContext* encoder = lane.encoder.get();
+        int ret = avcodec_send_frame(encoder, frame);
+        if (ret < 0 && !(frame == nullptr && ret == AVERROR_EOF)) {
+            session.error = "encoding failed: " + av::errorString(ret);
+            return false;
+        }
+
+        AVPacket* packet = session.encoded.get();
+        while ((ret = avcodec_receive_packet(encoder, packet)) >= 0) {
+            packet->stream_index = lane.output->index;
+            av_packet_rescale_ts(packet, encoder->time_base, lane.output->time_base);
+            ret = av_interleaved_write_frame(session.output.get(), packet);
+            if (ret < 0) {
+                session.error = "cannot write packet: " + av::errorString(ret);
+                return false;
+            }
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+            session.error = "encoding failed: " + av::errorString(ret);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Pass a video packet through with the container start removed
+     */
+    bool remuxPacket(Session& session, Lane& lane, AVPacket* packet) {
+        if (packet->pts != AV_NOPTS_VALUE) {
+            packet->pts -= lane.startPts;
+        }
+        if (packet->dts != AV_NOPTS_VALUE) {
+            packet->dts -= lane.startPts;
+        }
+        packet->stream_index = lane.output->index;
+        packet->pos = -1;
+        av_packet_rescale_ts(packet, lane.source->time_base, lane.output->time_base);
+        int ret = av_interleaved_write_frame(session.output.get(), packet);
+        if (ret < 0) {
+            session.error = "cannot write packet: " + av::errorString(ret);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Decode a packet (nullptr = flush) and push every frame downstream
+     */
+    bool decodePacket(Session& session, Lane& lane, Input& input, AVPacket* packet) {
+        // Corrupt packets are skipped rather than failing the whole file
+        avcodec_send_packet(lane.decoder.get(), packet);
+
+        AVFrame* frame = session.frame.get();
+        while (avcodec_receive_frame(lane.decoder.get(), frame) >= 0) {
+            bool ok = lane.isVideo ? encodeVideoFrame(session, lane, frame)
+                                   : encodeAudioFrame(session, lane, input, frame);
+            av_frame_unref(frame);
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool flushLane(Session& session, Lane& lane, Input& input) {
+        if (lane.flushed || lane.copy) {
+            return true;
+        }
+        lane.flushed = true;
+        if (!decodePacket(session, lane, input, nullptr)) {
+            return false;
+        }
+        if (lane.resampler && !convertAudio(session, lane, nullptr, 0)) {
+            return false;
+        }
+        return encodeFrame(session, lane, nullptr);
+    }
+}
+
+// ===========================
+// TranscodeEngine Implementation
+// ===========================
+
+TranscodeEngine::TranscodeEngine() = default;
+
+TranscodeEngine::~TranscodeEngine() = default;
+
+void TranscodeEngine::setSpoolLimit(size_t memoryBytes, std::filesystem::path directory) {
+    spoolMemoryLimit = memoryBytes;
+    spoolDirectory = std::move(directory);
+}
+
+size_t TranscodeEngine::spooledBytes() const {
+    return spool ? spool->memoryBytes + spool->spillBytes : 0;
+}
+
+bool TranscodeEngine::spoolHead(const std::filesystem::path& videoFile, double seconds,
+                                double sampleRate, std::vector<float>& cameraAudio,
+                                bool& reachedEnd) {
+    lastError.clear();
+    spool.reset();
+    cameraAudio.clear();
+    reachedEnd = false;
+
+    auto format = av::openInput(videoFile.string(), lastError);
+    if (!format) {
+        return false;
+    }
+    // Same stream choice as execute(), which the spool is replayed into
+    int videoStream = av_find_best_stream(format.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    int cameraStream = videoStream >= 0
+        ? av_find_best_stream(format.get(), AVMEDIA_TYPE_AUDIO, -1, videoStream, nullptr, 0)
+        : -1;
+    if (videoStream < 0 || cameraStream < 0) {
+        lastError = "no video with camera audio in " + videoFile.string();
+        return false;
+    }
+    for (unsigned int s = 0; s < format->nb_streams; ++s) {
+        if (static_cast<int>(s) != videoStream && static_cast<int>(s) != cameraStream) {
+            format->streams[s]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    AVStream* stream = format->streams[cameraStream];
+    av::CodecContextPtr decoder = openDecoder(stream, 1, lastError);
+    if (!decoder) {
+        return false;
+    }
+    const double containerStart = format->start_time != AV_NOPTS_VALUE
+        ? static_cast<double>(format->start_time) / AV_TIME_BASE : 0.0;
+
+    auto next = std::make_unique<Spool>();
+    next->videoFile = videoFile;
+    next->memoryLimit = spoolMemoryLimit;
+    next->spillDirectory = spoolDirectory;
+
+    // Camera audio as AudioDecoder would return it from the container start
+    const size_t targetSamples = static_cast<size_t>(std::llround(seconds * sampleRate));
+    cameraAudio.reserve(targetSamples + TEE_SLACK_SAMPLES);
+
+    AVChannelLayout mono;
+    av_channel_layout_default(&mono, 1);
+    av::ResamplerPtr resampler;
+    int resamplerFormat = AV_SAMPLE_FMT_NONE;
+    int resamplerRate = 0;
+    int resamplerChannels = 0;
+    double nextFrameTime = containerStart;
+
+    auto convert = [&](const uint8_t** planes, int count) -> bool {
+        const int capacity = swr_get_out_samples(resampler.get(), count);
+        if (capacity <= 0) {
+            return true;
+        }
+        const size_t written = cameraAudio.size();
+        cameraAudio.resize(written + capacity);
+        uint8_t* out = reinterpret_cast<uint8_t*>(cameraAudio.data() + written);
+        int converted = swr_convert(resampler.get(), &out, capacity, planes, count);
+        if (converted < 0) {
+            lastError = "resampling failed: " + av::errorString(converted);
+            return false;
+        }
+        cameraAudio.resize(written + converted);
+        return true;
+    };
+
+    auto teeFrame = [&](AVFrame* frame) -> bool {
+        if (frame->nb_samples <= 0 || frame->sample_rate <= 0) {
+            return true;
+        }
+        if (!resampler || frame->format != resamplerFormat || frame->sample_rate != resamplerRate ||
+            frame->ch_layout.nb_channels != resamplerChannels) {
+            SwrContext* raw = nullptr;
+            int ret = swr_alloc_set_opts2(&raw, &mono, AV_SAMPLE_FMT_FLT, static_cast<int>(sampleRate),
+                                          &frame->ch_layout, static_cast<AVSampleFormat>(frame->format),
+                                          frame->sample_rate, 0, nullptr);
+            resampler.reset(raw);
+            if (ret < 0 || (ret = swr_init(resampler.get())) < 0) {
+                lastError = "cannot initialize resampler: " + av::errorString(ret);
+                return false;
+            }
+            resamplerFormat = frame->format;
+            resamplerRate = frame->sample_rate;
+            resamplerChannels = frame->ch_layout.nb_channels;
+        }
+
+        double frameTime = frame->best_effort_timestamp != AV_NOPTS_VALUE
+            ? frame->best_effort_timestamp * av_q2d(stream->time_base) : nextFrameTime;
+        nextFrameTime = frameTime + static_cast<double>(frame->nb_samples) / frame->sample_rate;
+
+        int skip = 0;
+        if (frameTime < containerStart) {
+            skip = static_cast<int>(std::llround((containerStart - frameTime) * frame->sample_rate));
+            if (skip >= frame->nb_samples) {
+                return true;
+            }
+        }
+
+        auto sampleFormat = static_cast<AVSampleFormat>(frame->format);
+        const int bytesPerSample = av_get_bytes_per_sample(sampleFormat);
+        const int channels = frame->ch_layout.nb_channels;
+        std::vector<const uint8_t*> planes;
+        if (av_sample_fmt_is_planar(sampleFormat)) {
+            planes.resize(channels);
+            for (int ch = 0; ch < channels; ++ch) {
+                planes[ch] = frame->extended_data[ch] + static_cast<size_t>(skip) * bytesPerSample;
+            }
+        } else {
+            planes.push_back(frame->extended_data[0] +
+                             static_cast<size_t>(skip) * bytesPerSample * channels);
+        }
+        return convert(planes.data(), frame->nb_samples - skip);
+    };
+
+    av::PacketPtr packet(av_packet_alloc());
+    av::FramePtr frame(av_frame_alloc());
+    auto receiveFrames = [&]() -> bool {
+        while (avcodec_receive_frame(decoder.get(), frame.get()) >= 0) {
+            bool ok = teeFrame(frame.get());
+            av_frame_unref(frame.get());
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    while (cameraAudio.size() < targetSamples) {
+        if (cancelled) {
+            lastError = "cancelled";
+            return false;
+        }
+        if (av_read_frame(format.get(), packet.get()) < 0) {
+            reachedEnd = true;
+            break;
+        }
+
+        bool ok = next->push(packet.get(), lastError);
+        if (ok && packet->stream_index == cameraStream) {
+            avcodec_send_packet(decoder.get(), packet.get());
+            ok = receiveFrames();
+        }
+        av_packet_unref(packet.get());
+        if (!ok) {
+            return false;
+        }
+    }
+
+    if (reachedEnd) {
+        avcodec_send_packet(decoder.get(), nullptr);
+        if (!receiveFrames() || (resampler && !convert(nullptr, 0))) {
+            return false;
+        }
+    }
+    if (cameraAudio.empty()) {
+        lastError = "no decodable camera audio in " + videoFile.string();
+        return false;
+    }
+
+    next->format = std::move(format);
+    spool = std::move(next);
+    return true;
+}
+
+bool TranscodeEngine::run(const TranscodeSpec& spec) {
+    lastError.clear();
+
+    // The output is closed when execute returns; a partial file is removed
+    bool outputCreated = false;
+    bool success = execute(spec, outputCreated);
+    if (!success && cancelled) {
+        lastError = "cancelled";
+    }
+    if (!success && outputCreated) {
+        std::error_code ec;
+        std::filesystem::remove(spec.outputFile, ec);
+    }
+    return success;
+}
+
+bool TranscodeEngine::execute(const TranscodeSpec& spec, bool& outputCreated) {
+    if (cancelled) {
+        return false;
+    }
+    
+    Session session(lastError);
+
+    // A spool is consumed by this run whether or not it is for this video
+    std::unique_ptr<Spool> spooled = std::move(spool);
+    if (spooled && spooled->videoFile != spec.videoFile) {
+        spooled.reset();
+    }
+
+    // Video input: the video stream plus (optionally) the camera audio
+    session.inputs.resize(1 + spec.audioInputs.size());
+    Input& video = session.inputs[0];
+    if (!openInput(video, spooled ? std::move(spooled->format)
+                                   : av::openInput(spec.videoFile.string(), session.error))) {
+        return false;
+    }
+    int videoStream = av_find_best_stream(video.format.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (videoStream < 0) {
+        session.error = "no video stream in " + spec.videoFile.string();
+        return false;
+    }
+    int cameraStream = spec.includeCameraAudio
+        ? av_find_best_stream(video.format.get(), AVMEDIA_TYPE_AUDIO, -1, videoStream, nullptr, 0)
+        : -1;
+    if (video.format->duration != AV_NOPTS_VALUE && video.format->duration > 0) {
+        session.duration = static_cast<double>(video.format->duration) / AV_TIME_BASE;
+    }
+
+    // External tracks, positioned by offset and tempo
+    for (size_t i = 0; i < spec.audioInputs.size(); ++i) {
+        const TranscodeAudioInput& track = spec.audioInputs[i];
+        Input& input = session.inputs[1 + i];
+        if (!openInput(input, av::openInput(track.file.string(), session.error))) {
+            return false;
+        }
+        input.offset = track.offset;
+        input.tempo = track.tempo > 0.0 ? track.tempo : 1.0;
+    }
+
+    AVFormatContext* rawOutput = nullptr;
+    int ret = avformat_alloc_output_context2(&rawOutput, nullptr, "mov", spec.outputFile.string().c_str());
+    if (ret < 0 || !rawOutput) {
+        session.error = "cannot create output: " + av::errorString(ret);
+        return false;
+    }
+    session.output.reset(rawOutput);
+    AVFormatContext* output = session.output.get();
+
+    // Output stream order: video, external tracks, camera
+    auto addLane = [&](size_t inputIndex, int streamIndex, bool isVideo) -> Lane& {
+        Input& input = session.inputs[inputIndex];
+        input.laneOf[streamIndex] = static_cast<int>(session.lanes.size());
+        Lane& lane = session.lanes.emplace_back();
+        lane.isVideo = isVideo;
+        lane.input = inputIndex;
+        lane.source = input.format->streams[streamIndex];
+        return lane;
+    };
+    // Lanes are created up front so references stay valid while opening
+    session.lanes.reserve(2 + spec.audioInputs.size());
+
+    if (!openVideoLane(addLane(0, videoStream, true), video, output, spec.profile, threadCount,
+                       session.error)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < spec.audioInputs.size(); ++i) {
+        const TranscodeAudioInput& track = spec.audioInputs[i];
+        Input& input = session.inputs[1 + i];
+        int stream = av_find_best_stream(input.format.get(), AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+        if (stream < 0) {
+            session.error = "no audio stream in " + track.file.string();
+            return false;
+        }
+        Lane& lane = addLane(1 + i, stream, false);
+        if (!openAudioLane(lane, output, track.title, session.error)) {
+            return false;
+        }
+
+        // Offset > 0 starts the track later; offset < 0 drops its head. In
+        // both cases output time = (source time + offset) / tempo.
+        lane.tempo = input.tempo;
+        lane.trim = std::max(0.0, -track.offset);
+        lane.nextPts = std::llround(std::max(0.0, track.offset) / lane.tempo * AUDIO_SAMPLE_RATE);
+        lane.anchored = true;
+        if (input.format->duration != AV_NOPTS_VALUE && input.format->duration > 0) {
+            const double seconds = static_cast<double>(input.format->duration) / AV_TIME_BASE - lane.trim;
+            lane.compensationSamples = std::llround(std::max(0.0, seconds) * AUDIO_SAMPLE_RATE);
+        }
+
+        if (lane.trim >= MIN_SEEK_SECONDS) {
+            const int64_t target = static_cast<int64_t>((input.containerStart + lane.trim) * AV_TIME_BASE);
+            avformat_seek_file(input.format.get(), -1, std::numeric_limits<int64_t>::min(),
+                               target, target, 0);
+        }
+    }
+
+    if (cameraStream >= 0) {
+        if (!openAudioLane(addLane(0, cameraStream, false), output, spec.cameraTitle, session.error)) {
+            return false;
+        }
+    }
+
+    // Streams nobody reads are not even packetized
+    for (auto& input : session.inputs) {
+        for (unsigned int s = 0; s < input.format->nb_streams; ++s) {
+            if (input.laneOf[s] < 0) {
+                input.format->streams[s]->discard = AVDISCARD_ALL;
+            }
+        }
+    }
+
+    for (const auto& [key, value] : spec.metadata) {
+        av_dict_set(&output->metadata, key.c_str(), value.c_str(), 0);
+    }
+
+    if (!(output->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&output->pb, spec.outputFile.string().c_str(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            session.error = "cannot open " + spec.outputFile.string() + ": " + av::errorString(ret);
+            return false;
+        }
+        outputCreated = true;
+    }
+
+    // Custom sync_* tags are only written by mov with use_metadata_tags
+    AVDictionary* muxerOptions = nullptr;
+    av_dict_set(&muxerOptions, "movflags", "use_metadata_tags", 0);
+    ret = avformat_write_header(output, &muxerOptions);
+    av_dict_free(&muxerOptions);
+    if (ret < 0) {
+        session.error = "cannot write header: " + av::errorString(ret);
+        return false;
+    }
+
+    session.packet.reset(av_packet_alloc());
+    session.encoded.reset(av_packet_alloc());
+    session.frame.reset(av_frame_alloc());
+    session.samples.reset(av_frame_alloc());
+
+    // Always advance the input furthest behind in output time
+    double lastReport = 0.0;
+    while (true) {
+        if (cancelled) {
+            return false;
+        }
+
+        Input* next = nullptr;
+        size_t nextIndex = 0;
+        for (size_t i = 0; i < session.inputs.size(); ++i) {
+            Input& input = session.inputs[i];
+            if (!input.finished && (!next || input.position < next->position)) {
+                next = &input;
+                nextIndex = i;
+            }
+        }
+        if (!next) {
+            break;
+        }
+
+        AVPacket* packet = session.packet.get();
+        ret = nextIndex == 0 && spooled ? spooled->read(next->format.get(), packet)
+                                        : av_read_frame(next->format.get(), packet);
+        if (ret < 0) {
+            next->finished = true;
+            for (auto& lane : session.lanes) {
+                if (lane.input == nextIndex && !flushLane(session, lane, *next)) {
+                    return false;
+                }
+            }
+            continue;
+        }
+
+        const int laneIndex = packet->stream_index < static_cast<int>(next->laneOf.size())
+            ? next->laneOf[packet->stream_index] : -1;
+        if (laneIndex < 0) {
+            av_packet_unref(packet);
+            continue;
+        }
+        Lane& lane = session.lanes[laneIndex];
+
+        const int64_t timestamp = packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+        if (timestamp != AV_NOPTS_VALUE) {
+            double seconds = sourceSeconds(timestamp, lane.source->time_base, next->containerStart);
+            next->position = (seconds + next->offset) / next->tempo;
+        }
+
+        bool ok = lane.copy ? remuxPacket(session, lane, packet)
+                            : decodePacket(session, lane, *next, packet);
+        av_packet_unref(packet);
+        if (!ok) {
+            return false;
+        }
+
+        if (nextIndex == 0 && progressCallback &&
+            session.inputs[0].position - lastReport >= PROGRESS_INTERVAL_SECONDS) {
+            lastReport = session.inputs[0].position;
+            if (!progressCallback({lastReport, session.duration})) {
+                cancelled = true;
+            }
+        }
+    }
+
+    ret = av_write_trailer(output);
+    if (ret < 0) {
+        session.error = "cannot finalize output: " + av::errorString(ret);
+        return false;
+    }
+
+    if (progressCallback) {
+        progressCallback({session.duration, session.duration});
+    }
+    return true;
+}
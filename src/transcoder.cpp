@@ -4,12 +4,54 @@
  */
 
 #include "transcoder.h"
+#include "audio_decoder.h"
+#include "thread_pool.h"
+#include "console_log.h"
+#include "metrics.h"
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <atomic>
+#include <semaphore>
+#include <thread>
+
+namespace {
+    // Below this the drift is under 2 ms per hour and not worth a filter pass
+    constexpr double MIN_COMPENSATED_DRIFT_PPM = 0.5;
+    
+    // Fingerprint matching: WAV heads are indexed once per batch, each video
+    // is looked up with the head of its camera audio
+    constexpr double FINGERPRINT_REFERENCE_SECONDS = 1200.0;
+    constexpr double FINGERPRINT_QUERY_SECONDS = 60.0;
+    constexpr size_t FINGERPRINT_MIN_VOTES = 12;
+    constexpr double FINGERPRINT_MIN_MARGIN = 2.0;    // Best votes over the runner-up
+    constexpr double FINGERPRINT_HINT_TOLERANCE = 1.0;
+    
+    // Start timecodes further apart than half a day wrapped around midnight
+    constexpr double SECONDS_PER_DAY = 86400.0;
+    
+    // Case-insensitive Levenshtein distance between file stems
+    int editDistance(const std::string& a, const std::string& b) {
+        std::vector<int> previous(b.size() + 1);
+        std::vector<int> current(b.size() + 1);
+        for (size_t j = 0; j <= b.size(); ++j) previous[j] = static_cast<int>(j);
+        for (size_t i = 1; i <= a.size(); ++i) {
+            current[0] = static_cast<int>(i);
+            for (size_t j = 1; j <= b.size(); ++j) {
+                const bool same = std::tolower(static_cast<unsigned char>(a[i - 1])) ==
+                                  std::tolower(static_cast<unsigned char>(b[j - 1]));
+                current[j] = std::min({previous[j] + 1, current[j - 1] + 1,
+                                       previous[j - 1] + (same ? 0 : 1)});
+            }
+            std::swap(previous, current);
+        }
+        return previous[b.size()];
+    }
+}
 
 // ===========================
 // SyncStatistics Implementation
@@ -36,6 +78,31 @@ void SyncStatistics::addResult(const SyncResult& result) {
     algorithmUsage[result.algorithm]++;
 }
 
+void SyncStatistics::merge(const SyncStatistics& other) {
+    if (other.totalFiles == 0) {
+        return;
+    }
+    
+    size_t mergedSuccessful = successfulSyncs + other.successfulSyncs;
+    if (mergedSuccessful > 0) {
+        avgConfidence = (avgConfidence * successfulSyncs + other.avgConfidence * other.successfulSyncs)
+                      / mergedSuccessful;
+    }
+    
+    size_t mergedTotal = totalFiles + other.totalFiles;
+    avgProcessingTime = (avgProcessingTime * totalFiles + other.avgProcessingTime * other.totalFiles)
+                      / mergedTotal;
+    
+    totalFiles = mergedTotal;
+    successfulSyncs = mergedSuccessful;
+    highConfidenceSyncs += other.highConfidenceSyncs;
+    fallbackSyncs += other.fallbackSyncs;
+    
+    for (const auto& pair : other.algorithmUsage) {
+        algorithmUsage[pair.first] += pair.second;
+    }
+}
+
 void SyncStatistics::printReport() const {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "📊 SYNCHRONIZATION STATISTICS REPORT" << std::endl;
@@ -68,7 +135,7 @@ void SyncStatistics::printReport() const {
 // ===========================
 
 VideoTranscoder::VideoTranscoder() {
-    audioSync = std::make_unique<HybridAudioSync>();
+    syncEngines.push_back(std::make_unique<HybridAudioSync>());
     
     if (verbose) {
         std::cout << "🎬 Advanced Video Transcoder Initialized" << std::endl;
@@ -93,13 +160,7 @@ bool VideoTranscoder::processAll(const std::filesystem::path& inputDir,
         case SyncQuality::HIGH_QUALITY: std::cout << "High Quality (maximum accuracy)"; break;
     }
     std::cout << std::endl;
-    
-    // Reset statistics
-    statistics = SyncStatistics{};
-    
-    // Configure audio sync
-    audioSync->setVerbose(verbose);
-    audioSync->setQualityMode(syncQuality);
+    std::cout << "Workers: " << syncJobs << " sync, " << encodeJobs << " encode" << std::endl;
     
     // Find all video and audio files
     auto videoFiles = findVideoFiles(inputDir);
@@ -114,115 +175,134 @@ bool VideoTranscoder::processAll(const std::filesystem::path& inputDir,
         return false;
     }
     
-    bool allSuccessful = true;
-    size_t processedCount = 0;
-    
-    // Process each video file
-    for (const auto& videoFile : videoFiles) {
-        processedCount++;
-        
-        std::cout << "\n" << std::string(80, '=') << std::endl;
-        std::cout << "🎬 Processing (" << processedCount << "/" << videoFiles.size() 
-                  << "): " << videoFile.filename().string() << std::endl;
-        std::cout << std::string(80, '=') << std::endl;
-        
-        auto startTime = std::chrono::high_resolution_clock::now();
-        
-        // Find matching audio files
-        auto [highGain, lowGain, matchConfidence] = findAudioMatch(videoFile, audioFiles);
+    return processFiles(videoFiles, audioFiles, outputDir, syncQuality);
+}
+
+bool VideoTranscoder::processFiles(const std::vector<std::filesystem::path>& videoFiles,
+                                   const std::vector<std::filesystem::path>& audioFiles,
+                                   const std::filesystem::path& outputDir,
+                                   SyncQuality syncQuality) {
+    // Reset statistics
+    statistics = SyncStatistics{};
+    cancelRequested = false;
+    
+    prepareBatch(videoFiles, audioFiles, syncQuality);
+    
+    std::atomic<bool> allSuccessful{true};
+    
+    // Per-worker statistics, merged once the batch has drained
+    std::vector<SyncStatistics> syncWorkerStats(syncJobs);
+    std::vector<SyncStatistics> encodeWorkerStats(encodeJobs);
+    
+    {
+        // Sync of file N+1 overlaps the transcode of file N; the encode pool
+        // bounds how many transcodes run at once. A job holds a slot from
+        // before its spool until its encode ends, so synced jobs (and their
+        // spooled packets) cannot pile up in front of slow encoders.
+        std::counting_semaphore<> jobSlots(static_cast<std::ptrdiff_t>(syncJobs + encodeJobs));
+        struct SlotRelease {
+            std::counting_semaphore<>& slots;
+            ~SlotRelease() { slots.release(); }
+        };
+        ThreadPool encodePool(encodeJobs);
+        ThreadPool syncPool(syncJobs);
         
-        if (highGain.empty()) {
-            std::cout << "⚠️  No matching audio found - ";
-            if (fallbackProcessing) {
-                std::cout << "proceeding with fallback processing" << std::endl;
+        for (size_t index = 0; index < videoFiles.size(); ++index) {
+            syncPool.submit([&, index]() {
+                auto job = std::make_shared<TranscodeJob>();
+                job->index = index;
+                job->videoFile = videoFiles[index];
+                job->outputFile = outputDir / (job->videoFile.stem().string() + ".mov");
+                job->profileName = outputProfile.name;
                 
-                // Generate output filename
-                std::string outputName = videoFile.stem().string() + ".mov";
-                std::filesystem::path outputFile = outputDir / outputName;
+                if (cancelRequested) {
+                    allSuccessful = false;
+                    return;
+                }
+                
+                jobSlots.acquire();
+                auto slot = std::make_shared<SlotRelease>(SlotRelease{jobSlots});
+                
+                size_t worker = ThreadPool::currentWorkerIndex();
+                bool proceed = false;
+                {
+                    console::ScopedCapture capture;
+                    console::out() << "\n" << std::string(80, '=') << std::endl;
+                    console::out() << "🎬 Processing (" << (index + 1) << "/" << videoFiles.size()
+                                   << "): " << job->videoFile.filename().string() << std::endl;
+                    console::out() << std::string(80, '=') << std::endl;
+                    
+                    try {
+                        if (singlePass && nativeTranscode) {
+                            metrics::ScopedTimer timer("spool");
+                            spoolVideo(*job, *syncEngines[worker]);
+                        }
+                        proceed = runSyncStage(*job, audioFiles, *syncEngines[worker],
+                                               syncQuality, syncWorkerStats[worker]);
+                    } catch (const std::exception& e) {
+                        console::out() << "❌ Sync stage failed: " << e.what() << std::endl;
+                    }
+                    // Decodes past the sync stage (none expected) go to the file again
+                    AudioDecoder::release(job->videoFile);
+                }
                 
-                bool success = transcodeFallback(videoFile, outputFile);
-                if (success) {
-                    std::cout << "✅ Fallback transcoding successful: " << outputName << std::endl;
-                } else {
-                    std::cout << "❌ Fallback transcoding failed" << std::endl;
+                if (!proceed) {
                     allSuccessful = false;
+                    if (jobCallback && !cancelRequested) {
+                        jobCallback(*job, false);
+                    }
+                    return;
                 }
                 
-                // Record empty sync result
-                SyncResult emptyResult;
-                statistics.addResult(emptyResult);
-            } else {
-                std::cout << "skipping file" << std::endl;
-                allSuccessful = false;
-            }
-            continue;
-        }
-        
-        std::cout << "🎵 Audio Match Results:" << std::endl;
-        std::cout << "  High gain: " << highGain.filename().string() 
-                  << " (confidence: " << matchConfidence << ")" << std::endl;
-        if (!lowGain.empty()) {
-            std::cout << "  Low gain: " << lowGain.filename().string() << std::endl;
-        }
-        
-        // Perform advanced synchronization
-        auto syncResult = detectAdvancedSync(videoFile, highGain, syncQuality);
-        
-        // Log detailed sync information
-        logSyncDetails(videoFile, highGain, syncResult);
-        
-        // Validate sync result
-        bool syncAcceptable = validateSyncResult(syncResult, videoFile, highGain);
-        
-        if (!syncAcceptable && !fallbackProcessing) {
-            std::cout << "❌ Sync validation failed and fallback disabled - skipping" << std::endl;
-            allSuccessful = false;
-            statistics.addResult(syncResult);
-            continue;
-        }
-        
-        // Generate output filename
-        std::string outputName = videoFile.stem().string() + ".mov";
-        std::filesystem::path outputFile = outputDir / outputName;
-        
-        bool success = false;
-        
-        if (syncAcceptable) {
-            // Proceed with synchronized transcoding
-            success = transcodeWithSync(videoFile, highGain, lowGain, syncResult, outputFile);
-            
-            if (success) {
-                std::cout << "✅ Synchronized transcoding successful: " << outputName << std::endl;
-            } else {
-                std::cout << "❌ Synchronized transcoding failed" << std::endl;
-            }
-        } else if (fallbackProcessing) {
-            // Fallback to non-synchronized transcoding
-            std::cout << "⚠️  Using fallback processing due to low sync confidence" << std::endl;
-            success = transcodeFallback(videoFile, outputFile);
-            
-            if (success) {
-                std::cout << "✅ Fallback transcoding successful: " << outputName << std::endl;
-            } else {
-                std::cout << "❌ Fallback transcoding failed" << std::endl;
-            }
-        }
-        
-        if (!success) {
-            allSuccessful = false;
+                encodePool.submit([&, job, slot]() {
+                    if (cancelRequested) {
+                        allSuccessful = false;
+                        return;
+                    }
+                    console::ScopedCapture capture;
+                    size_t encodeWorker = ThreadPool::currentWorkerIndex();
+                    bool success = false;
+                    try {
+                        success = runEncodeStage(*job, encodeWorkerStats[encodeWorker]);
+                    } catch (const std::exception& e) {
+                        console::out() << "❌ Encode stage failed: " << e.what() << std::endl;
+                    }
+                    if (!success) {
+                        allSuccessful = false;
+                    }
+                    // A transcode aborted by cancel() is neither done nor failed
+                    if (jobCallback && (success || !cancelRequested)) {
+                        jobCallback(*job, success);
+                    }
+                });
+            });
         }
         
-        // Record statistics
-        statistics.addResult(syncResult);
-        
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration<double>(endTime - startTime).count();
-        std::cout << "⏱️  Total processing time: " << std::fixed << std::setprecision(2) 
-                  << duration << "s" << std::endl;
+        syncPool.waitIdle();
+        encodePool.waitIdle();
+    }
+    
+    for (const auto& workerStats : syncWorkerStats) {
+        statistics.merge(workerStats);
+    }
+    for (const auto& workerStats : encodeWorkerStats) {
+        statistics.merge(workerStats);
     }
     
     // Print final statistics
     statistics.printReport();
+    if (verbose) {
+        metrics::Registry::instance().printReport(std::cout);
+    }
+    
+    if (featureCache) {
+        std::cout << "🗃️  Feature cache: " << featureCache->hits() << " hits, "
+                  << featureCache->misses() << " misses" << std::endl;
+    }
+    
+    if (cancelRequested) {
+        std::cout << "\n🛑 Processing cancelled" << std::endl;
+    }
     
     std::cout << "\n🏁 Processing Complete!" << std::endl;
     std::cout << "Overall success rate: " << std::fixed << std::setprecision(1)
@@ -232,6 +312,165 @@ bool VideoTranscoder::processAll(const std::filesystem::path& inputDir,
     return allSuccessful;
 }
 
+bool VideoTranscoder::runSyncStage(TranscodeJob& job,
+                                   const std::vector<std::filesystem::path>& audioFiles,
+                                   HybridAudioSync& engine,
+                                   SyncQuality quality,
+                                   SyncStatistics& stats) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    // Find matching audio files
+    metrics::ScopedTimer matchTimer("match");
+    auto match = findAudioMatch(job.videoFile, audioFiles);
+    matchTimer.stop();
+    const auto& highGain = match.highGain;
+    const auto& lowGain = match.lowGain;
+    job.highGainAudio = match.highGain;
+    job.lowGainAudio = match.lowGain;
+    job.matchConfidence = match.confidence;
+    job.offsetHint = match.offsetHint;
+    const bool timecodeHint = match.hintFromTimecode;
+    
+    if (highGain.empty()) {
+        console::out() << "⚠️  No matching audio found - ";
+        if (!fallbackProcessing) {
+            console::out() << "skipping file" << std::endl;
+            return false;
+        }
+        console::out() << "proceeding with fallback processing" << std::endl;
+        
+        // Record empty sync result
+        job.syncResult = SyncResult{};
+        job.useSync = false;
+        job.syncTime = std::chrono::duration<double>(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+        return true;
+    }
+    
+    console::out() << "🎵 Audio Match Results:" << std::endl;
+    console::out() << "  High gain: " << highGain.filename().string() 
+                   << " (confidence: " << match.confidence << ")" << std::endl;
+    if (!lowGain.empty()) {
+        console::out() << "  Low gain: " << lowGain.filename().string() << std::endl;
+    }
+    if (job.offsetHint) {
+        console::out() << (timecodeHint ? "  Timecode offset: " : "  Fingerprint offset: ")
+                       << std::fixed << std::setprecision(2) << *job.offsetHint << "s" << std::endl;
+    }
+    
+    // Perform advanced synchronization
+    job.syncResult = detectAdvancedSync(engine, job.videoFile, highGain, quality, job.offsetHint);
+    
+    // Log detailed sync information
+    logSyncDetails(job.videoFile, highGain, job.syncResult);
+    
+    // Validate sync result
+    job.useSync = validateSyncResult(job.syncResult, job.videoFile, highGain, job.offsetHint);
+    
+    // Timecode is only as good as the jam sync; if seeding with it failed,
+    // search blind before giving up
+    if (!job.useSync && timecodeHint) {
+        console::out() << "⚠️  Timecode-seeded sync failed validation, retrying without it" << std::endl;
+        job.offsetHint.reset();
+        job.syncResult = detectAdvancedSync(engine, job.videoFile, highGain, quality);
+        logSyncDetails(job.videoFile, highGain, job.syncResult);
+        job.useSync = validateSyncResult(job.syncResult, job.videoFile, highGain);
+    }
+    job.syncTime = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    metrics::Registry::instance().record("sync_stage", job.syncTime);
+    metrics::Registry::instance().increment(job.useSync ? "sync_validated" : "sync_rejected");
+    
+    if (!job.useSync && !fallbackProcessing) {
+        console::out() << "❌ Sync validation failed and fallback disabled - skipping" << std::endl;
+        stats.addResult(job.syncResult);
+        return false;
+    }
+    
+    if (!job.useSync) {
+        console::out() << "⚠️  Using fallback processing due to low sync confidence" << std::endl;
+    }
+    
+    return true;
+}
+
+bool VideoTranscoder::runEncodeStage(const TranscodeJob& job, SyncStatistics& stats) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    std::string outputName = job.outputFile.filename().string();
+    
+    // Queued jobs carry the profile they were submitted with
+    const OutputProfile* requested = job.profileName.empty() ? nullptr : OutputProfile::find(job.profileName);
+    const OutputProfile& profile = requested ? *requested : outputProfile;
+    
+    bool success = false;
+    metrics::ScopedTimer transcodeTimer("transcode");
+    if (job.useSync) {
+        // Proceed with synchronized transcoding
+        success = transcodeWithSync(job.videoFile, job.highGainAudio, job.lowGainAudio,
+                                    job.syncResult, job.outputFile, profile, job.spooledEngine.get());
+        
+        if (success) {
+            console::out() << "✅ Synchronized transcoding successful: " << outputName << std::endl;
+        } else {
+            console::out() << "❌ Synchronized transcoding failed: " << outputName << std::endl;
+        }
+    } else {
+        // Fallback to non-synchronized transcoding
+        success = transcodeFallback(job.videoFile, job.outputFile, profile, job.spooledEngine.get());
+        
+        if (success) {
+            console::out() << "✅ Fallback transcoding successful: " << outputName << std::endl;
+        } else {
+            console::out() << "❌ Fallback transcoding failed: " << outputName << std::endl;
+        }
+    }
+    
+    transcodeTimer.stop();
+    metrics::Registry::instance().increment(success ? "transcode_ok" : "transcode_failed");
+    
+    // Record statistics
+    stats.addResult(job.syncResult);
+    
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration<double>(endTime - startTime).count() + job.syncTime;
+    console::out() << "⏱️  Total processing time (" << job.videoFile.filename().string() << "): "
+                   << std::fixed << std::setprecision(2) << duration << "s" << std::endl;
+    metrics::Registry::instance().record("job", duration);
+    
+    return success;
+}
+
+void VideoTranscoder::spoolVideo(TranscodeJob& job, const HybridAudioSync& engine) {
+    auto transcode = std::make_shared<TranscodeEngine>();
+    transcode->setSpoolLimit(spoolMemoryBytes, std::filesystem::path());
+    
+    const double sampleRate = HybridAudioSync::analysisSampleRate();
+    std::vector<float> cameraAudio;
+    bool wholeFile = false;
+    if (!transcode->spoolHead(job.videoFile, engine.headSeconds(), sampleRate, cameraAudio, wholeFile)) {
+        console::out() << "⚠️  Single-demux spool unavailable (" << transcode->getLastError()
+                       << ") - reading the video twice" << std::endl;
+        return;
+    }
+    
+    if (verbose) {
+        console::out() << "📼 Spooled " << std::fixed << std::setprecision(1)
+                       << transcode->spooledBytes() / (1024.0 * 1024.0) << " MB of "
+                       << job.videoFile.filename().string() << " ("
+                       << cameraAudio.size() / sampleRate << "s of camera audio"
+                       << (wholeFile ? ", whole file" : "") << ")" << std::endl;
+    }
+    AudioDecoder::preload(job.videoFile, std::move(cameraAudio), sampleRate, wholeFile);
+    job.spooledEngine = std::move(transcode);
+}
+
+int VideoTranscoder::encodeThreadsPerJob() const {
+    // Split the machine between concurrent encodes instead of letting each
+    // ffmpeg grab every core
+    unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<int>(std::max<size_t>(1, hardware / std::max<size_t>(1, encodeJobs)));
+}
+
 std::vector<std::filesystem::path> VideoTranscoder::findVideoFiles(const std::filesystem::path& directory) {
     std::vector<std::filesystem::path> videoFiles;
     
@@ -279,16 +518,31 @@ std::vector<std::filesystem::path> VideoTranscoder::findAudioFiles(const std::fi
     return audioFiles;
 }
 
-std::tuple<std::filesystem::path, std::filesystem::path, float> VideoTranscoder::findAudioMatch(
-    const std::filesystem::path& videoFile,
-    const std::vector<std::filesystem::path>& audioFiles) {
+AudioMatch VideoTranscoder::findAudioMatch(const std::filesystem::path& videoFile,
+                                           const std::vector<std::filesystem::path>& audioFiles) {
     
     std::string videoStem = videoFile.stem().string();
-    std::filesystem::path highGain, lowGain;
-    float matchConfidence = 0.0f;
+    AudioMatch match;
+    auto& highGain = match.highGain;
+    auto& lowGain = match.lowGain;
+    float& matchConfidence = match.confidence;
+    
+    // One lookup scores every indexed WAV against this video's camera audio
+    std::vector<FingerprintMatch> fingerprints = queryFingerprint(videoFile);
+    
+    auto findLowGain = [&](const std::filesystem::path& primary) {
+        std::string lowGainName = primary.stem().string() + "_D.wav";
+        std::filesystem::path lowGainPath = primary.parent_path() / lowGainName;
+        if (std::filesystem::exists(lowGainPath)) {
+            lowGain = lowGainPath;
+            if (verbose) {
+                console::out() << "  ✅ Found corresponding low gain: " << lowGainName << std::endl;
+            }
+        }
+    };
     
     if (verbose) {
-        std::cout << "🔍 Searching for audio matches for: " << videoStem << std::endl;
+        console::out() << "🔍 Searching for audio matches for: " << videoStem << std::endl;
     }
     
     // Strategy 1: Exact filename match (highest confidence)
@@ -299,22 +553,59 @@ std::tuple<std::filesystem::path, std::filesystem::path, float> VideoTranscoder:
             highGain = audioFile;
             matchConfidence = 1.0f;
             if (verbose) {
-                std::cout << "  ✅ Exact filename match: " << audioFile.filename().string() << std::endl;
+                console::out() << "  ✅ Exact filename match: " << audioFile.filename().string() << std::endl;
             }
         }
         // Look for low gain version (with _D suffix)
         else if (audioStem == videoStem + "_D") {
             lowGain = audioFile;
             if (verbose) {
-                std::cout << "  ✅ Low gain pair found: " << audioFile.filename().string() << std::endl;
+                console::out() << "  ✅ Low gain pair found: " << audioFile.filename().string() << std::endl;
+            }
+        }
+    }
+    
+    // Coarse offset for the exact match, if its audio agrees convincingly
+    if (!highGain.empty()) {
+        for (size_t i = 0; i < fingerprints.size(); ++i) {
+            if (fingerprints[i].file != highGain) continue;
+            size_t rival = i == 0 ? (fingerprints.size() > 1 ? fingerprints[1].votes : 0)
+                                  : fingerprints[0].votes;
+            if (fingerprints[i].votes >= FINGERPRINT_MIN_VOTES &&
+                fingerprints[i].votes >= FINGERPRINT_MIN_MARGIN * rival) {
+                match.offsetHint = -fingerprints[i].displacement;
+            }
+            break;
+        }
+    }
+    
+    // Strategy 2: Audio fingerprint (high confidence, survives renamed files)
+    if (highGain.empty() && !fingerprints.empty()) {
+        const FingerprintMatch& best = fingerprints.front();
+        const size_t runnerUp = fingerprints.size() > 1 ? fingerprints[1].votes : 0;
+        
+        if (best.votes >= FINGERPRINT_MIN_VOTES && best.votes >= FINGERPRINT_MIN_MARGIN * runnerUp) {
+            highGain = best.file;
+            match.offsetHint = -best.displacement;
+            // Confidence grows with how clearly the winner stands out
+            matchConfidence = 0.95f - 0.45f * static_cast<float>(runnerUp) / best.votes;
+            
+            if (verbose) {
+                console::out() << "  ✅ Fingerprint match: " << best.file.filename().string()
+                               << " (" << best.votes << " landmarks vs " << runnerUp
+                               << ", confidence: " << matchConfidence << ")" << std::endl;
             }
+            findLowGain(best.file);
+        } else if (verbose) {
+            console::out() << "  ⚠️  Fingerprint inconclusive (" << best.votes << " vs " << runnerUp
+                           << " landmarks)" << std::endl;
         }
     }
     
-    // Strategy 2: Duration-based matching (medium confidence)
+    // Strategy 3: Duration-based matching (medium confidence)
     if (highGain.empty()) {
         if (verbose) {
-            std::cout << "  🔍 No exact match found, trying duration-based matching..." << std::endl;
+            console::out() << "  🔍 No exact match found, trying duration-based matching..." << std::endl;
         }
         
         double videoDuration = getFileDuration(videoFile);
@@ -345,28 +636,19 @@ std::tuple<std::filesystem::path, std::filesystem::path, float> VideoTranscoder:
             matchConfidence = std::max(0.3f, 1.0f - static_cast<float>(bestDurationDiff) / 30.0f);
             
             if (verbose) {
-                std::cout << "  ✅ Duration-based match: " << bestMatch.filename().string() 
+                console::out() << "  ✅ Duration-based match: " << bestMatch.filename().string() 
                           << " (diff: " << bestDurationDiff << "s, confidence: " << matchConfidence << ")" << std::endl;
             }
             
             // Look for corresponding low gain file
-            std::string audioStem = bestMatch.stem().string();
-            std::string lowGainName = audioStem + "_D.wav";
-            std::filesystem::path lowGainPath = bestMatch.parent_path() / lowGainName;
-            
-            if (std::filesystem::exists(lowGainPath)) {
-                lowGain = lowGainPath;
-                if (verbose) {
-                    std::cout << "  ✅ Found corresponding low gain: " << lowGainName << std::endl;
-                }
-            }
+            findLowGain(bestMatch);
         }
     }
     
-    // Strategy 3: Pattern matching with edit distance (low confidence)
+    // Strategy 4: Pattern matching with edit distance (low confidence)
     if (highGain.empty()) {
         if (verbose) {
-            std::cout << "  🔍 Trying pattern-based matching..." << std::endl;
+            console::out() << "  🔍 Trying pattern-based matching..." << std::endl;
         }
         
         int bestEditDistance = std::numeric_limits<int>::max();
@@ -376,19 +658,10 @@ std::tuple<std::filesystem::path, std::filesystem::path, float> VideoTranscoder:
             std::string audioStem = audioFile.stem().string();
             if (audioStem.ends_with("_D")) continue;
             
-            // Simple edit distance calculation
-            int editDistance = 0;
-            size_t minLen = std::min(videoStem.length(), audioStem.length());
+            int distance = editDistance(videoStem, audioStem);
             
-            for (size_t i = 0; i < minLen; ++i) {
-                if (std::tolower(videoStem[i]) != std::tolower(audioStem[i])) {
-                    editDistance++;
-                }
-            }
-            editDistance += std::abs(static_cast<int>(videoStem.length()) - static_cast<int>(audioStem.length()));
-            
-            if (editDistance < bestEditDistance && editDistance <= 3) {
-                bestEditDistance = editDistance;
+            if (distance < bestEditDistance && distance <= 3) {
+                bestEditDistance = distance;
                 bestPatternMatch = audioFile;
             }
         }
@@ -398,49 +671,142 @@ std::tuple<std::filesystem::path, std::filesystem::path, float> VideoTranscoder:
             matchConfidence = std::max(0.1f, 1.0f - bestEditDistance / 10.0f);
             
             if (verbose) {
-                std::cout << "  ✅ Pattern-based match: " << bestPatternMatch.filename().string() 
+                console::out() << "  ✅ Pattern-based match: " << bestPatternMatch.filename().string() 
                           << " (edit distance: " << bestEditDistance << ", confidence: " << matchConfidence << ")" << std::endl;
             }
         }
     }
     
-    return std::make_tuple(highGain, lowGain, matchConfidence);
+    // Without an audio-derived offset, start timecodes (video timecode tag,
+    // BWF time reference) give the alignment for free when both carry one
+    if (!highGain.empty() && !match.offsetHint) {
+        const MediaInfo videoInfo = probeCache->get(videoFile);
+        const MediaInfo audioInfo = probeCache->get(highGain);
+        if (videoInfo.startTimecode && audioInfo.startTimecode) {
+            double hint = *audioInfo.startTimecode - *videoInfo.startTimecode;
+            if (hint > SECONDS_PER_DAY / 2) hint -= SECONDS_PER_DAY;
+            if (hint < -SECONDS_PER_DAY / 2) hint += SECONDS_PER_DAY;
+            
+            // Unrelated clocks produce offsets longer than either recording
+            if (std::abs(hint) <= std::max(videoInfo.duration, audioInfo.duration)) {
+                match.offsetHint = hint;
+                match.hintFromTimecode = true;
+                if (verbose) {
+                    console::out() << "  🕒 Timecode offset: " << std::fixed << std::setprecision(3)
+                                   << hint << "s" << std::endl;
+                }
+            } else if (verbose) {
+                console::out() << "  ⚠️  Start timecodes " << hint << "s apart, ignoring" << std::endl;
+            }
+        }
+    }
+    
+    return match;
 }
 
-SyncResult VideoTranscoder::detectAdvancedSync(const std::filesystem::path& videoFile,
+void VideoTranscoder::buildFingerprintIndex(const std::vector<std::filesystem::path>& audioFiles) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    // Low gain files carry the same content as their primary and would only
+    // split the votes
+    std::vector<std::filesystem::path> primaries;
+    for (const auto& audioFile : audioFiles) {
+        if (!audioFile.stem().string().ends_with("_D")) {
+            primaries.push_back(audioFile);
+        }
+    }
+    
+    // Files are fingerprinted in parallel, each task with its own FFT scratch
+    ThreadPool& pool = ThreadPool::shared();
+    std::vector<std::future<std::vector<Landmark>>> pending;
+    pending.reserve(primaries.size());
+    for (const auto& audioFile : primaries) {
+        pending.push_back(pool.submit([audioFile]() {
+            AudioFingerprinter fingerprinter;
+            std::vector<Landmark> landmarks;
+            fingerprinter.fingerprintFile(audioFile, FINGERPRINT_REFERENCE_SECONDS, landmarks);
+            return landmarks;
+        }));
+    }
+    
+    auto index = std::make_unique<FingerprintIndex>();
+    for (size_t i = 0; i < primaries.size(); ++i) {
+        auto landmarks = pool.waitFor(pending[i]);
+        if (!landmarks.empty()) {
+            index->add(primaries[i], landmarks);
+        }
+    }
+    
+    if (verbose) {
+        double elapsed = std::chrono::duration<double>(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+        std::cout << "🧬 Fingerprint index: " << index->fileCount() << " files, "
+                  << index->landmarkCount() << " landmarks (" << std::fixed << std::setprecision(2)
+                  << elapsed << "s)" << std::endl;
+    }
+    
+    if (index->fileCount() > 0) {
+        fingerprintIndex = std::move(index);
+    }
+}
+
+std::vector<FingerprintMatch> VideoTranscoder::queryFingerprint(const std::filesystem::path& videoFile) {
+    if (!fingerprintIndex) {
+        return {};
+    }
+    auto videoInfo = probeCache->get(videoFile);
+    if (videoInfo.valid && videoInfo.audioStreamCount() == 0) {
+        return {};
+    }
+    
+    AudioFingerprinter fingerprinter;
+    std::vector<Landmark> landmarks;
+    if (!fingerprinter.fingerprintFile(videoFile, FINGERPRINT_QUERY_SECONDS, landmarks)) {
+        return {};
+    }
+    return fingerprintIndex->query(landmarks);
+}
+
+SyncResult VideoTranscoder::detectAdvancedSync(HybridAudioSync& engine,
+                                              const std::filesystem::path& videoFile,
                                               const std::filesystem::path& audioFile,
-                                              SyncQuality quality) {
+                                              SyncQuality quality,
+                                              std::optional<double> offsetHint) {
     
     if (verbose) {
-        std::cout << "🎯 Starting advanced synchronization analysis..." << std::endl;
+        console::out() << "🎯 Starting advanced synchronization analysis..." << std::endl;
     }
     
-    auto result = audioSync->findOptimalSync(videoFile, audioFile, quality);
+    auto result = engine.findOptimalSync(videoFile, audioFile, quality, offsetHint);
     
     return result;
 }
 
 bool VideoTranscoder::validateSyncResult(const SyncResult& result,
                                         const std::filesystem::path& videoFile,
-                                        const std::filesystem::path& audioFile) {
+                                        const std::filesystem::path& audioFile,
+                                        std::optional<double> offsetHint) {
     
     if (verbose) {
-        std::cout << "🔍 Validating sync result..." << std::endl;
+        console::out() << "🔍 Validating sync result..." << std::endl;
     }
     
     // Check confidence threshold
     if (result.confidence < confidenceThreshold) {
         if (verbose) {
-            std::cout << "  ❌ Confidence too low: " << result.confidence 
+            console::out() << "  ❌ Confidence too low: " << result.confidence 
                       << " < " << confidenceThreshold << std::endl;
         }
         return false;
     }
     
-    // Check offset reasonableness
-    if (std::abs(result.offset) > 30.0) {
+    // Check offset reasonableness; larger offsets are fine when the
+    // fingerprint found the same alignment independently
+    const bool confirmedByFingerprint =
+        offsetHint && std::abs(result.offset - *offsetHint) <= FINGERPRINT_HINT_TOLERANCE;
+    if (std::abs(result.offset) > 30.0 && !confirmedByFingerprint) {
         if (verbose) {
-            std::cout << "  ❌ Offset too large: " << result.offset << "s" << std::endl;
+            console::out() << "  ❌ Offset too large: " << result.offset << "s" << std::endl;
         }
         return false;
     }
@@ -451,14 +817,14 @@ bool VideoTranscoder::validateSyncResult(const SyncResult& result,
     
     if (!isDurationCompatible(videoDuration, audioDuration, 60.0)) {
         if (verbose) {
-            std::cout << "  ❌ Duration mismatch: video=" << videoDuration 
+            console::out() << "  ❌ Duration mismatch: video=" << videoDuration 
                       << "s, audio=" << audioDuration << "s" << std::endl;
         }
         return false;
     }
     
     if (verbose) {
-        std::cout << "  ✅ Sync result validation passed" << std::endl;
+        console::out() << "  ✅ Sync result validation passed" << std::endl;
     }
     
     return true;
@@ -468,19 +834,65 @@ bool VideoTranscoder::transcodeWithSync(const std::filesystem::path& videoFile,
                                        const std::filesystem::path& highGainAudio,
                                        const std::filesystem::path& lowGainAudio,
                                        const SyncResult& syncResult,
-                                       const std::filesystem::path& outputFile) {
+                                       const std::filesystem::path& outputFile,
+                                       const OutputProfile& profile,
+                                       TranscodeEngine* spooled) {
     
     if (verbose) {
-        std::cout << "🎬 Starting synchronized transcoding..." << std::endl;
-        std::cout << "  Video: " << videoFile.filename().string() << std::endl;
-        std::cout << "  High gain audio: " << highGainAudio.filename().string() << std::endl;
+        console::out() << "🎬 Starting synchronized transcoding..." << std::endl;
+        console::out() << "  Video: " << videoFile.filename().string() << std::endl;
+        console::out() << "  High gain audio: " << highGainAudio.filename().string() << std::endl;
         if (!lowGainAudio.empty()) {
-            std::cout << "  Low gain audio: " << lowGainAudio.filename().string() << std::endl;
+            console::out() << "  Low gain audio: " << lowGainAudio.filename().string() << std::endl;
         }
-        std::cout << "  Sync offset: " << syncResult.offset << "s" << std::endl;
-        std::cout << "  Algorithm used: " << syncResult.algorithm << std::endl;
+        console::out() << "  Sync offset: " << syncResult.offset << "s" << std::endl;
+        if (syncResult.driftPpm != 0.0) {
+            console::out() << "  Clock drift: " << syncResult.driftPpm << " ppm" << std::endl;
+        }
+        console::out() << "  Algorithm used: " << syncResult.algorithm << std::endl;
     }
     
+    // Drift compensation: the recorder timeline is longer by (1 + ppm/1e6),
+    // so the lav tracks are sped up by that factor. atempo keeps the first
+    // timestamp, so a delay is applied in output time.
+    const double tempo = 1.0 + syncResult.driftPpm / 1e6;
+    const bool compensateDrift = std::abs(syncResult.driftPpm) >= MIN_COMPENSATED_DRIFT_PPM;
+    const double delay = compensateDrift ? syncResult.offset / tempo : syncResult.offset;
+    
+    if (nativeTranscode) {
+        TranscodeSpec spec;
+        spec.videoFile = videoFile;
+        spec.outputFile = outputFile;
+        spec.profile = profile;
+        spec.audioInputs.push_back({highGainAudio, syncResult.offset,
+                                    compensateDrift ? tempo : 1.0, "HighLav"});
+        if (!lowGainAudio.empty()) {
+            spec.audioInputs.push_back({lowGainAudio, syncResult.offset,
+                                        compensateDrift ? tempo : 1.0, "LowLav"});
+        }
+        
+        auto format = [](double value) {
+            std::ostringstream text;
+            text << value;
+            return text.str();
+        };
+        spec.metadata["sync_algorithm"] = syncResult.algorithm;
+        spec.metadata["sync_offset"] = format(syncResult.offset);
+        spec.metadata["sync_confidence"] = format(syncResult.confidence);
+        if (compensateDrift) {
+            spec.metadata["sync_drift_ppm"] = format(syncResult.driftPpm);
+        }
+        return runNativeTranscode(spec, spooled);
+    }
+    
+    auto addOffset = [&](std::ostringstream& out) {
+        if (syncResult.offset > 0.001) {
+            out << "-itsoffset " << std::fixed << std::setprecision(6) << delay << " ";
+        } else if (syncResult.offset < -0.001) {
+            out << "-ss " << std::fixed << std::setprecision(6) << (-syncResult.offset) << " ";
+        }
+    };
+    
     std::ostringstream cmd;
     cmd << "ffmpeg -hide_banner -loglevel error -y ";
     
@@ -488,72 +900,93 @@ bool VideoTranscoder::transcodeWithSync(const std::filesystem::path& videoFile,
     cmd << "-i \"" << videoFile.string() << "\" ";
     
     // Input high gain audio with sync offset
-    if (syncResult.offset > 0.001) {
-        cmd << "-itsoffset " << std::fixed << std::setprecision(6) << syncResult.offset << " ";
-    } else if (syncResult.offset < -0.001) {
-        cmd << "-ss " << std::fixed << std::setprecision(6) << (-syncResult.offset) << " ";
-    }
+    addOffset(cmd);
     cmd << "-i \"" << highGainAudio.string() << "\" ";
     
     // Input low gain audio with same offset (if available)
     if (!lowGainAudio.empty()) {
-        if (syncResult.offset > 0.001) {
-            cmd << "-itsoffset " << std::fixed << std::setprecision(6) << syncResult.offset << " ";
-        } else if (syncResult.offset < -0.001) {
-            cmd << "-ss " << std::fixed << std::setprecision(6) << (-syncResult.offset) << " ";
-        }
+        addOffset(cmd);
         cmd << "-i \"" << lowGainAudio.string() << "\" ";
     }
     
     // Video encoding settings (professional quality)
-    cmd << "-c:v prores_ks -profile:v 2 "; // ProRes 422 HQ
-    cmd << "-vendor apl0 -bits_per_mb 8000 ";
+    cmd << "-threads " << encodeThreadsPerJob() << " ";
+    cmd << profile.ffmpegVideoArguments();
     
     // Audio encoding settings (professional quality)
     cmd << "-c:a pcm_s24le -ar 48000 ";
     
-    // Audio mapping and metadata
+    // Audio mapping and metadata (camera track only if the source has audio)
+    auto videoInfo = probeCache->get(videoFile);
+    bool hasCameraAudio = !videoInfo.valid || videoInfo.audioStreamCount() > 0;
     if (!lowGainAudio.empty()) {
         // 3 tracks: HighLav, LowLav, Camera
-        cmd << "-map 0:v -map 1:a -map 2:a -map 0:a ";
+        cmd << "-map 0:v -map 1:a -map 2:a ";
         cmd << "-metadata:s:a:0 title=\"HighLav\" ";
         cmd << "-metadata:s:a:1 title=\"LowLav\" ";
-        cmd << "-metadata:s:a:2 title=\"Camera\" ";
+        if (hasCameraAudio) {
+            cmd << "-map 0:a -metadata:s:a:2 title=\"Camera\" ";
+        }
     } else {
         // 2 tracks: HighLav, Camera
-        cmd << "-map 0:v -map 1:a -map 0:a ";
+        cmd << "-map 0:v -map 1:a ";
         cmd << "-metadata:s:a:0 title=\"HighLav\" ";
-        cmd << "-metadata:s:a:1 title=\"Camera\" ";
+        if (hasCameraAudio) {
+            cmd << "-map 0:a -metadata:s:a:1 title=\"Camera\" ";
+        }
+    }
+    
+    // Time-stretch the lav tracks (always the first one or two outputs)
+    if (compensateDrift) {
+        const size_t lavTracks = lowGainAudio.empty() ? 1 : 2;
+        for (size_t track = 0; track < lavTracks; ++track) {
+            cmd << "-filter:a:" << track << " atempo=" << std::fixed << std::setprecision(9)
+                << tempo << " ";
+        }
     }
     
     // Add sync metadata
     cmd << "-metadata sync_algorithm=\"" << syncResult.algorithm << "\" ";
     cmd << "-metadata sync_offset=\"" << syncResult.offset << "\" ";
     cmd << "-metadata sync_confidence=\"" << syncResult.confidence << "\" ";
+    if (compensateDrift) {
+        cmd << "-metadata sync_drift_ppm=\"" << syncResult.driftPpm << "\" ";
+    }
     
     // Output file
     cmd << "\"" << outputFile.string() << "\"";
     
     if (verbose) {
-        std::cout << "  🔧 FFmpeg command: " << cmd.str() << std::endl;
+        console::out() << "  🔧 FFmpeg command: " << cmd.str() << std::endl;
     }
     
     int result = std::system(cmd.str().c_str());
     
     if (result == 0 && verbose) {
-        std::cout << "  ✅ Transcoding completed successfully" << std::endl;
+        console::out() << "  ✅ Transcoding completed successfully" << std::endl;
     } else if (result != 0 && verbose) {
-        std::cout << "  ❌ Transcoding failed with exit code: " << result << std::endl;
+        console::out() << "  ❌ Transcoding failed with exit code: " << result << std::endl;
     }
     
     return (result == 0);
 }
 
 bool VideoTranscoder::transcodeFallback(const std::filesystem::path& videoFile,
-                                       const std::filesystem::path& outputFile) {
+                                       const std::filesystem::path& outputFile,
+                                       const OutputProfile& profile,
+                                       TranscodeEngine* spooled) {
     
     if (verbose) {
-        std::cout << "🔄 Starting fallback transcoding (video only)..." << std::endl;
+        console::out() << "🔄 Starting fallback transcoding (video only)..." << std::endl;
+    }
+    
+    if (nativeTranscode) {
+        TranscodeSpec spec;
+        spec.videoFile = videoFile;
+        spec.outputFile = outputFile;
+        spec.profile = profile;
+        spec.metadata["sync_method"] = "fallback";
+        return runNativeTranscode(spec, spooled);
     }
     
     std::ostringstream cmd;
@@ -561,53 +994,73 @@ bool VideoTranscoder::transcodeFallback(const std::filesystem::path& videoFile,
     cmd << "-i \"" << videoFile.string() << "\" ";
     
     // Video encoding (same as synchronized version)
-    cmd << "-c:v prores_ks -profile:v 2 ";
-    cmd << "-vendor apl0 -bits_per_mb 8000 ";
+    cmd << "-threads " << encodeThreadsPerJob() << " ";
+    cmd << profile.ffmpegVideoArguments();
     
     // Audio encoding (camera audio only)
     cmd << "-c:a pcm_s24le -ar 48000 ";
     
     // Single track: Camera audio only
-    cmd << "-map 0:v -map 0:a ";
-    cmd << "-metadata:s:a:0 title=\"Camera\" ";
+    cmd << "-map 0:v ";
+    auto videoInfo = probeCache->get(videoFile);
+    if (!videoInfo.valid || videoInfo.audioStreamCount() > 0) {
+        cmd << "-map 0:a -metadata:s:a:0 title=\"Camera\" ";
+    }
     cmd << "-metadata sync_method=\"fallback\" ";
     
     cmd << "\"" << outputFile.string() << "\"";
     
     if (verbose) {
-        std::cout << "  🔧 FFmpeg command: " << cmd.str() << std::endl;
+        console::out() << "  🔧 FFmpeg command: " << cmd.str() << std::endl;
     }
     
     int result = std::system(cmd.str().c_str());
     
     if (result == 0 && verbose) {
-        std::cout << "  ✅ Fallback transcoding completed successfully" << std::endl;
+        console::out() << "  ✅ Fallback transcoding completed successfully" << std::endl;
     } else if (result != 0 && verbose) {
-        std::cout << "  ❌ Fallback transcoding failed with exit code: " << result << std::endl;
+        console::out() << "  ❌ Fallback transcoding failed with exit code: " << result << std::endl;
     }
     
     return (result == 0);
 }
 
-double VideoTranscoder::getFileDuration(const std::filesystem::path& filepath) {
-    std::string command = "ffprobe -v quiet -show_entries format=duration "
-                         "-of csv=p=0 \"" + filepath.string() + "\" 2>/dev/null";
-    
-    FILE* pipe = popen(command.c_str(), "r");
-    if (!pipe) return 0.0;
-    
-    char buffer[128];
-    std::string result = "";
-    while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        result += buffer;
+bool VideoTranscoder::runNativeTranscode(const TranscodeSpec& spec, TranscodeEngine* spooled) {
+    // A spooled engine continues on the demuxer the sync stage already read from
+    TranscodeEngine fresh;
+    TranscodeEngine& engine = spooled ? *spooled : fresh;
+    engine.setThreadCount(encodeThreadsPerJob());
+    
+    // Progress in quarter steps keeps the per-job log readable; returning
+    // false aborts the run once the batch is cancelled
+    int reportedQuarter = 0;
+    engine.setProgressCallback([&](const TranscodeProgress& progress) {
+        int quarter = static_cast<int>(progress.fraction() * 4.0);
+        if (verbose && quarter > reportedQuarter && quarter < 4) {
+            reportedQuarter = quarter;
+            console::out() << "  ⏳ " << quarter * 25 << "% (" << std::fixed << std::setprecision(1)
+                           << progress.position << "s / " << progress.duration << "s)" << std::endl;
+        }
+        return !cancelRequested.load();
+    });
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    bool success = engine.run(spec);
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    
+    if (success && verbose) {
+        console::out() << "  ✅ Transcoding completed successfully (" << std::fixed
+                       << std::setprecision(2) << elapsed << "s)" << std::endl;
+    } else if (!success) {
+        console::out() << "  ❌ Transcoding failed: " << engine.getLastError() << std::endl;
     }
-    pclose(pipe);
     
-    try {
-        return std::stod(result);
-    } catch (...) {
-        return 0.0;
-    }
+    return success;
+}
+
+double VideoTranscoder::getFileDuration(const std::filesystem::path& filepath) {
+    return probeCache->get(filepath).duration;
 }
 
 bool VideoTranscoder::isDurationCompatible(double duration1, double duration2, double tolerance) {
@@ -617,45 +1070,50 @@ bool VideoTranscoder::isDurationCompatible(double duration1, double duration2, d
 void VideoTranscoder::logSyncDetails(const std::filesystem::path& videoFile,
                                     const std::filesystem::path& audioFile,
                                     const SyncResult& result) {
-    std::cout << "\n📊 Synchronization Analysis Results:" << std::endl;
-    std::cout << "  Algorithm: " << result.algorithm << std::endl;
-    std::cout << "  Offset: " << std::fixed << std::setprecision(3) << result.offset << "s";
+    console::out() << "\n📊 Synchronization Analysis Results:" << std::endl;
+    console::out() << "  Algorithm: " << result.algorithm << std::endl;
+    console::out() << "  Offset: " << std::fixed << std::setprecision(3) << result.offset << "s";
     
     if (result.offset > 0) {
-        std::cout << " (audio starts after video)";
+        console::out() << " (audio starts after video)";
     } else if (result.offset < 0) {
-        std::cout << " (audio starts before video)";
+        console::out() << " (audio starts before video)";
     } else {
-        std::cout << " (perfect sync)";
+        console::out() << " (perfect sync)";
     }
-    std::cout << std::endl;
+    console::out() << std::endl;
     
-    std::cout << "  Confidence: " << std::setprecision(2) << result.confidence;
+    console::out() << "  Confidence: " << std::setprecision(2) << result.confidence;
     if (result.confidence >= 0.8f) {
-        std::cout << " (High) ✅";
+        console::out() << " (High) ✅";
     } else if (result.confidence >= 0.5f) {
-        std::cout << " (Medium) ⚠️";
+        console::out() << " (Medium) ⚠️";
     } else if (result.confidence >= 0.3f) {
-        std::cout << " (Low) 🔴";
+        console::out() << " (Low) 🔴";
     } else {
-        std::cout << " (Very Low) ❌";
+        console::out() << " (Very Low) ❌";
+    }
+    console::out() << std::endl;
+    
+    if (result.driftPpm != 0.0) {
+        console::out() << "  Drift: " << std::setprecision(2) << result.driftPpm << " ppm ("
+                       << std::setprecision(3) << result.driftPpm * 3.6e-3 << "s per hour)" << std::endl;
     }
-    std::cout << std::endl;
     
-    std::cout << "  Processing time: " << std::setprecision(3) << result.computationTime << "s" << std::endl;
+    console::out() << "  Processing time: " << std::setprecision(3) << result.computationTime << "s" << std::endl;
     
     // Additional context
     double videoDuration = getFileDuration(videoFile);
     double audioDuration = getFileDuration(audioFile);
-    std::cout << "  Duration compatibility: video=" << std::setprecision(1) << videoDuration 
+    console::out() << "  Duration compatibility: video=" << std::setprecision(1) << videoDuration 
               << "s, audio=" << audioDuration << "s (diff=" 
               << std::abs(videoDuration - audioDuration) << "s)" << std::endl;
 }
 
 void VideoTranscoder::setVerbose(bool verbose) {
     this->verbose = verbose;
-    if (audioSync) {
-        audioSync->setVerbose(verbose);
+    for (auto& engine : syncEngines) {
+        engine->setVerbose(verbose);
     }
 }
 
@@ -675,4 +1133,157 @@ void VideoTranscoder::setFallbackProcessing(bool enableFallback) {
     if (verbose) {
         std::cout << "🔄 Fallback processing: " << (enableFallback ? "enabled" : "disabled") << std::endl;
     }
+}
+
+void VideoTranscoder::setAnalysisBudget(double seconds) {
+    analysisBudget = std::max(0.0, seconds);
+    if (verbose && analysisBudget > 0.0) {
+        std::cout << "🔎 Analysis budget: " << analysisBudget << "s per file" << std::endl;
+    }
+}
+
+void VideoTranscoder::setDriftCompensation(bool enable) {
+    driftCompensation = enable;
+    if (verbose) {
+        std::cout << "🕰️  Drift compensation: " << (enable ? "enabled" : "disabled") << std::endl;
+    }
+}
+
+void VideoTranscoder::setFeatureCache(const std::filesystem::path& directory) {
+    featureCache.reset();
+    if (directory.empty()) {
+        return;
+    }
+    
+    auto cache = std::make_shared<FeatureCache>(directory);
+    if (!cache->enabled()) {
+        std::cerr << "⚠️  Feature cache disabled: cannot use " << directory << std::endl;
+        return;
+    }
+    featureCache = std::move(cache);
+    if (verbose) {
+        std::cout << "🗃️  Feature cache: " << directory << std::endl;
+    }
+}
+
+void VideoTranscoder::setFingerprintMatching(bool enable) {
+    fingerprintMatching = enable;
+    if (verbose) {
+        std::cout << "🧬 Fingerprint matching: " << (enable ? "enabled" : "disabled") << std::endl;
+    }
+}
+
+void VideoTranscoder::setNativeTranscode(bool enable) {
+    nativeTranscode = enable;
+    if (verbose) {
+        std::cout << "🎞️  Transcode engine: " << (enable ? "native (libav)" : "ffmpeg command line") << std::endl;
+    }
+}
+
+void VideoTranscoder::setSinglePass(bool enable, size_t spoolMegabytes) {
+    singlePass = enable;
+    spoolMemoryBytes = std::max<size_t>(1, spoolMegabytes) << 20;
+    if (verbose && enable) {
+        std::cout << "📼 Single-demux pipeline: enabled (" << spoolMegabytes
+                  << " MB spool per job)" << std::endl;
+        if (!nativeTranscode) {
+            std::cout << "⚠️  Single-demux pipeline needs the native engine - ignored" << std::endl;
+        }
+    }
+}
+
+void VideoTranscoder::setOutputProfile(const OutputProfile& profile) {
+    outputProfile = profile;
+    if (verbose) {
+        std::cout << "🎨 Output profile: " << profile.name << " - " << profile.description << std::endl;
+    }
+}
+
+void VideoTranscoder::prepareBatch(const std::vector<std::filesystem::path>& videoFiles,
+                                   const std::vector<std::filesystem::path>& audioFiles,
+                                   SyncQuality syncQuality) {
+    // One sync engine per sync worker; engines are not shared between threads
+    while (syncEngines.size() < syncJobs) {
+        syncEngines.push_back(std::make_unique<HybridAudioSync>());
+    }
+    for (auto& engine : syncEngines) {
+        engine->setVerbose(verbose);
+        engine->setQualityMode(syncQuality);
+        if (analysisBudget > 0.0) {
+            engine->setAnalysisBudget(analysisBudget);
+        }
+        engine->setDriftMode(driftCompensation);
+        engine->setFeatureCache(featureCache);
+        engine->setProbeCache(probeCache);
+    }
+    
+    // Probe every file once; matching, validation, logging and transcoding
+    // all read from the cache afterwards
+    std::vector<std::filesystem::path> mediaFiles = videoFiles;
+    mediaFiles.insert(mediaFiles.end(), audioFiles.begin(), audioFiles.end());
+    probeCache->prefetch(mediaFiles, syncJobs);
+    if (verbose) {
+        std::cout << "Probed " << probeCache->size() << " media files" << std::endl;
+    }
+    
+    fingerprintIndex.reset();
+    if (fingerprintMatching && !audioFiles.empty()) {
+        metrics::ScopedTimer timer("fingerprint_index");
+        buildFingerprintIndex(audioFiles);
+    }
+}
+
+bool VideoTranscoder::syncJob(TranscodeJob& job, const std::vector<std::filesystem::path>& audioFiles,
+                              SyncQuality syncQuality) {
+    HybridAudioSync& engine = *syncEngines[ThreadPool::currentWorkerIndex() % syncEngines.size()];
+    SyncStatistics jobStats;
+    bool proceed = false;
+    {
+        console::ScopedCapture capture;
+        console::out() << "\n" << std::string(80, '=') << std::endl;
+        console::out() << "🎬 Syncing: " << job.videoFile.filename().string() << std::endl;
+        console::out() << std::string(80, '=') << std::endl;
+        try {
+            proceed = runSyncStage(job, audioFiles, engine, syncQuality, jobStats);
+        } catch (const std::exception& e) {
+            console::out() << "❌ Sync stage failed: " << e.what() << std::endl;
+        }
+    }
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    statistics.merge(jobStats);
+    return proceed;
+}
+
+bool VideoTranscoder::encodeJob(const TranscodeJob& job) {
+    SyncStatistics jobStats;
+    bool success = false;
+    {
+        console::ScopedCapture capture;
+        console::out() << "\n🎬 Encoding: " << job.videoFile.filename().string() << std::endl;
+        try {
+            success = runEncodeStage(job, jobStats);
+        } catch (const std::exception& e) {
+            console::out() << "❌ Encode stage failed: " << e.what() << std::endl;
+        }
+    }
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    statistics.merge(jobStats);
+    return success;
+}
+
+void VideoTranscoder::setJobCallback(JobCallback callback) {
+    jobCallback = std::move(callback);
+}
+
+void VideoTranscoder::cancel() {
+    cancelRequested = true;
+}
+
+void VideoTranscoder::setParallelism(size_t encodeJobs, size_t syncJobs) {
+    this->encodeJobs = std::max<size_t>(1, encodeJobs);
+    this->syncJobs = std::max<size_t>(1, syncJobs);
+    if (verbose) {
+        std::cout << "⚙️  Scheduler: " << this->syncJobs << " sync worker(s), "
+                  << this->encodeJobs << " encode worker(s)" << std::endl;
+    }
 }
\ No newline at end of file
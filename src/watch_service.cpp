@@ -0,0 +1,379 @@
+/**
+ * @file watch_service.cpp
+ * @brief Watch-folder scanning, settle detection and the job database
+ */
+
+#include "watch_service.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+namespace {
+    constexpr const char* DATABASE_HEADER = "# video_transcoder job database v1";
+    constexpr const char* DEFAULT_STATE_FILE = ".transcode_jobs";
+
+    // Longest sleep between checks of the stop flag
+    constexpr double WAKE_SLICE_SECONDS = 0.25;
+
+    // Retry backoff stops doubling here
+    constexpr double MAX_RETRY_BACKOFF_SECONDS = 6.0 * 3600.0;
+
+    // Recorder files of a clip: CLIP.wav and its low gain pair CLIP_D.wav
+    std::string audioOwner(const std::filesystem::path& audio) {
+        std::string stem = audio.stem().string();
+        if (stem.ends_with("_D")) stem.resize(stem.size() - 2);
+        return stem;
+    }
+
+    double monotonicSeconds() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::string databaseKey(const std::filesystem::path& file) {
+        std::error_code ec;
+        return std::filesystem::absolute(file, ec).lexically_normal().string();
+    }
+
+    bool fileState(const std::filesystem::path& file, std::uintmax_t& size, int64_t& mtime) {
+        std::error_code ec;
+        size = std::filesystem::file_size(file, ec);
+        if (ec) return false;
+        auto time = std::filesystem::last_write_time(file, ec);
+        if (ec) return false;
+        mtime = static_cast<int64_t>(time.time_since_epoch().count());
+        return true;
+    }
+}
+
+// ===========================
+// JobDatabase Implementation
+// ===========================
+
+JobDatabase::JobDatabase(std::filesystem::path file) : file(std::move(file)) {}
+
+bool JobDatabase::load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+
+    std::error_code ec;
+    if (!std::filesystem::exists(file, ec)) {
+        return true;
+    }
+    std::ifstream in(file);
+    if (!in) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::vector<std::string> fields;
+        std::stringstream row(line);
+        std::string field;
+        // The source path is last so it may contain anything but a newline
+        while (fields.size() < 6 && std::getline(row, field, '\t')) {
+            fields.push_back(field);
+        }
+        std::getline(row, field);
+        fields.push_back(field);
+        if (fields.size() != 7 || fields[6].empty()) continue;
+
+        Entry entry;
+        try {
+            entry.state = fields[0] == "done" ? State::DONE : State::FAILED;
+            entry.size = std::stoull(fields[1]);
+            entry.mtime = std::stoll(fields[2]);
+            entry.attempts = std::stoul(fields[3]);
+            entry.finished = std::stoll(fields[4]);
+        } catch (const std::exception&) {
+            continue;   // A damaged line only costs a re-run of that video
+        }
+        entry.output = fields[5];
+        entries[fields[6]] = std::move(entry);
+    }
+    return true;
+}
+
+bool JobDatabase::needsProcessing(const std::filesystem::path& video, std::uintmax_t size, int64_t mtime,
+                                  size_t maxAttempts, double retryBackoff) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(databaseKey(video));
+    if (it == entries.end() || it->second.size != size || it->second.mtime != mtime) {
+        return true;
+    }
+    if (it->second.state == State::DONE) {
+        std::error_code ec;
+        return !std::filesystem::exists(it->second.output, ec);
+    }
+    if (it->second.attempts >= maxAttempts) {
+        return false;
+    }
+
+    // Exponential backoff from the end of the last failed attempt
+    const double exponent = static_cast<double>(std::max<size_t>(1, it->second.attempts) - 1);
+    const double backoff = std::min(MAX_RETRY_BACKOFF_SECONDS, retryBackoff * std::pow(2.0, exponent));
+    const double elapsed = static_cast<double>(static_cast<int64_t>(std::time(nullptr)) - it->second.finished);
+    return elapsed >= backoff;
+}
+
+void JobDatabase::record(const std::filesystem::path& video, std::uintmax_t size, int64_t mtime,
+                         bool success, const std::filesystem::path& output) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = entries[databaseKey(video)];
+    const bool sameFile = entry.size == size && entry.mtime == mtime;
+    entry.attempts = sameFile && entry.state == State::FAILED ? entry.attempts + 1 : 1;
+    entry.state = success ? State::DONE : State::FAILED;
+    entry.size = size;
+    entry.mtime = mtime;
+    entry.finished = static_cast<int64_t>(std::time(nullptr));
+    entry.output = output;
+
+    if (!save()) {
+        std::cerr << "⚠️  Could not write job database: " << file.string() << std::endl;
+    }
+}
+
+size_t JobDatabase::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+bool JobDatabase::save() const {
+    // Rewritten under a temporary name and renamed, so a crash keeps the old state
+    std::filesystem::path temp = file;
+    temp += ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        out << DATABASE_HEADER << "\n";
+        for (const auto& [key, entry] : entries) {
+            out << (entry.state == State::DONE ? "done" : "failed") << '\t' << entry.size << '\t'
+                << entry.mtime << '\t' << entry.attempts << '\t' << entry.finished << '\t'
+                << entry.output.string() << '\t' << key << '\n';
+        }
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, file, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+// ===========================
+// WatchService Implementation
+// ===========================
+
+WatchService::WatchService(VideoTranscoder& transcoder, std::filesystem::path inputDir,
+                           std::filesystem::path outputDir, SyncQuality quality, WatchOptions options)
+    : transcoder(transcoder), inputDir(std::move(inputDir)), outputDir(std::move(outputDir)),
+      quality(quality), options(std::move(options)),
+      database(this->options.stateFile.empty() ? this->outputDir / DEFAULT_STATE_FILE
+                                               : this->options.stateFile) {
+    this->options.pollInterval = std::max(WAKE_SLICE_SECONDS, this->options.pollInterval);
+    this->options.settleSeconds = std::max(0.0, this->options.settleSeconds);
+    this->options.maxAttempts = std::max<size_t>(1, this->options.maxAttempts);
+    this->options.retryBackoff = std::max(0.0, this->options.retryBackoff);
+
+#ifdef __linux__
+    // Finished writes and renames into the folder wake the scanner early
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0 &&
+        inotify_add_watch(inotifyFd, this->inputDir.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0) {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+#endif
+}
+
+WatchService::~WatchService() {
+#ifdef __linux__
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+    }
+#endif
+}
+
+bool WatchService::run() {
+    if (!database.load()) {
+        std::cerr << "❌ ERROR: Cannot read job database: " << database.path().string() << std::endl;
+        return false;
+    }
+
+    std::cout << "\n👀 Watching " << inputDir.string() << " (" << (inotifyFd >= 0 ? "inotify + " : "")
+              << "poll every " << options.pollInterval << "s, settle " << options.settleSeconds << "s)"
+              << std::endl;
+    std::cout << "🗂️  Job database: " << database.path().string() << " (" << database.size()
+              << " entries)" << std::endl;
+
+    // Outcomes are recorded against the file state the batch started from;
+    // a clip replaced mid-transcode no longer matches and is redone
+    std::map<std::string, FileState> batch;
+    std::mutex batchMutex;
+    transcoder.setJobCallback([&](const TranscodeJob& job, bool success) {
+        FileState state;
+        {
+            std::lock_guard<std::mutex> lock(batchMutex);
+            auto it = batch.find(job.videoFile.string());
+            if (it == batch.end()) return;
+            state = it->second;
+        }
+        database.record(job.videoFile, state.size, state.mtime, success, job.outputFile);
+    });
+
+    while (!stopRequested) {
+        const double now = monotonicSeconds();
+        auto videos = transcoder.findVideoFiles(inputDir);
+        auto audio = transcoder.findAudioFiles(inputDir);
+
+        // Forget files that disappeared so a re-copy starts settling afresh
+        std::map<std::string, FileState> present;
+        for (const auto* list : {&videos, &audio}) {
+            for (const auto& file : *list) {
+                auto it = observed.find(file.string());
+                if (it != observed.end()) present.insert(*it);
+            }
+        }
+        observed = std::move(present);
+
+        const auto settledVideos = settledFiles(videos, now);
+        const auto settledAudio = settledFiles(audio, now);
+
+        // A video waits while its own recorder files are still arriving, so
+        // it is never matched against half a WAV
+        std::vector<std::filesystem::path> unsettledAudio;
+        for (const auto& file : audio) {
+            if (std::find(settledAudio.begin(), settledAudio.end(), file) == settledAudio.end()) {
+                unsettledAudio.push_back(file);
+            }
+        }
+        std::vector<std::filesystem::path> pending;
+        for (const auto& video : settledVideos) {
+            if (!audioSettled(video, videos, unsettledAudio)) continue;
+            const FileState& state = observed[video.string()];
+            if (database.needsProcessing(video, state.size, state.mtime, options.maxAttempts,
+                                         options.retryBackoff)) {
+                pending.push_back(video);
+            }
+        }
+
+        if (!pending.empty()) {
+            std::cout << "\n📥 " << pending.size() << " new or changed clip"
+                      << (pending.size() == 1 ? "" : "s") << " ready" << std::endl;
+            {
+                std::lock_guard<std::mutex> lock(batchMutex);
+                batch.clear();
+                for (const auto& video : pending) {
+                    batch[video.string()] = observed[video.string()];
+                }
+            }
+            transcoder.processFiles(pending, settledAudio, outputDir, quality);
+            std::cout << "🗂️  Job database: " << database.size() << " entries" << std::endl;
+        }
+
+        // Sleep until the next poll, or until the earliest unsettled file could settle
+        double wait = options.pollInterval;
+        for (const auto& [path, state] : observed) {
+            const double remaining = state.unchangedSince + options.settleSeconds - now;
+            if (remaining > 0.0) {
+                wait = std::min(wait, remaining + WAKE_SLICE_SECONDS);
+            }
+        }
+        if (!stopRequested) {
+            waitForChange(wait);
+        }
+    }
+
+    transcoder.setJobCallback(nullptr);
+    std::cout << "\n🛑 Watch mode stopped" << std::endl;
+    return true;
+}
+
+std::vector<std::filesystem::path> WatchService::settledFiles(const std::vector<std::filesystem::path>& files,
+                                                              double now) {
+    std::vector<std::filesystem::path> settled;
+    for (const auto& file : files) {
+        std::uintmax_t size = 0;
+        int64_t mtime = 0;
+        if (!fileState(file, size, mtime)) continue;
+
+        // A file needs two looks: the first only starts its settle clock
+        auto [it, inserted] = observed.try_emplace(file.string());
+        FileState& state = it->second;
+        if (inserted || state.size != size || state.mtime != mtime) {
+            state.size = size;
+            state.mtime = mtime;
+            state.unchangedSince = now;
+            continue;
+        }
+        if (now - state.unchangedSince >= options.settleSeconds) {
+            settled.push_back(file);
+        }
+    }
+    return settled;
+}
+
+bool WatchService::audioSettled(const std::filesystem::path& video,
+                                const std::vector<std::filesystem::path>& videos,
+                                const std::vector<std::filesystem::path>& unsettledAudio) const {
+    const std::string stem = video.stem().string();
+    for (const auto& file : unsettledAudio) {
+        const std::string owner = audioOwner(file);
+        if (owner == stem) {
+            return false;
+        }
+        // Unclaimed recorder files may still be matched by fingerprint or duration
+        const bool claimed = std::any_of(videos.begin(), videos.end(), [&](const std::filesystem::path& other) {
+            return other.stem().string() == owner;
+        });
+        if (!claimed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WatchService::waitForChange(double seconds) {
+    const double deadline = monotonicSeconds() + seconds;
+    while (!stopRequested) {
+        const double remaining = deadline - monotonicSeconds();
+        if (remaining <= 0.0) break;
+        const double slice = std::min(remaining, WAKE_SLICE_SECONDS);
+
+#ifdef __linux__
+        if (inotifyFd >= 0) {
+            pollfd descriptor{inotifyFd, POLLIN, 0};
+            if (poll(&descriptor, 1, static_cast<int>(slice * 1000.0)) > 0) {
+                // Drain the queue; the next scan looks at the directory itself
+                alignas(inotify_event) char events[4096];
+                while (read(inotifyFd, events, sizeof(events)) > 0) {}
+                return true;
+            }
+            continue;
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::duration<double>(slice));
+    }
+    return false;
+}
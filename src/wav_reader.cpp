@@ -0,0 +1,300 @@
+/**
+ * @file wav_reader.cpp
+ * @brief RIFF/RF64 chunk parsing and windowed PCM conversion
+ */
+
+#include "wav_reader.h"
+#include "mapped_file.h"
+#include "polyphase_resampler.h"
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr uint16_t FORMAT_PCM = 0x0001;
+    constexpr uint16_t FORMAT_IEEE_FLOAT = 0x0003;
+    constexpr uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
+    // RF64 puts the real sizes in ds64 and this marker in the 32-bit fields
+    constexpr uint32_t RF64_SIZE_MARKER = 0xFFFFFFFF;
+
+    // bext: Description(256) Originator(32) OriginatorReference(32)
+    // OriginationDate(10) OriginationTime(8), then TimeReference low/high
+    constexpr size_t BEXT_TIME_REFERENCE_OFFSET = 338;
+
+    // Frames converted per step; bounds the scratch buffer for long windows
+    constexpr size_t CHUNK_FRAMES = 1 << 16;
+
+    uint16_t readU16(const unsigned char* p) {
+        return static_cast<uint16_t>(p[0] | p[1] << 8);
+    }
+
+    uint32_t readU32(const unsigned char* p) {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+               static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    uint64_t readU64(const unsigned char* p) {
+        return static_cast<uint64_t>(readU32(p)) | static_cast<uint64_t>(readU32(p + 4)) << 32;
+    }
+
+    bool isChunk(const unsigned char* p, const char* id) {
+        return std::memcmp(p, id, 4) == 0;
+    }
+}
+
+// ===========================
+// WavReader Implementation
+// ===========================
+
+WavReader::WavReader() = default;
+
+WavReader::~WavReader() = default;
+
+bool WavReader::isWavFile(const std::filesystem::path& file) {
+    std::string extension = file.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".wav" || extension == ".bwf" || extension == ".rf64";
+}
+
+std::optional<double> WavReader::timeReferenceSeconds() const {
+    if (!bextTimeReference || rate <= 0) {
+        return std::nullopt;
+    }
+    return static_cast<double>(*bextTimeReference) / rate;
+}
+
+bool WavReader::open(const std::filesystem::path& file) {
+    lastError.clear();
+    sampleData = nullptr;
+    frames = 0;
+    rate = 0;
+    bextTimeReference.reset();
+
+    mapping = std::make_unique<MappedFile>(file);
+    const unsigned char* data = mapping->data;
+    const size_t size = mapping->size;
+    if (!data || size < 12) {
+        lastError = "cannot map " + file.string();
+        return false;
+    }
+    const bool rf64 = isChunk(data, "RF64") || isChunk(data, "BW64");
+    if ((!isChunk(data, "RIFF") && !rf64) || !isChunk(data + 8, "WAVE")) {
+        lastError = file.string() + " is not a RIFF/WAVE file";
+        return false;
+    }
+
+    uint16_t formatTag = 0;
+    uint16_t bitsPerSample = 0;
+    bool haveFormat = false;
+    uint64_t ds64DataSize = 0;
+    size_t dataOffset = 0;
+    uint64_t dataSize = 0;
+
+    size_t position = 12;
+    while (position + 8 <= size) {
+        const unsigned char* chunk = data + position;
+        uint64_t chunkSize = readU32(chunk + 4);
+        const size_t body = position + 8;
+        const size_t available = size - body;
+
+        if (isChunk(chunk, "ds64") && chunkSize >= 16 && available >= 16) {
+            ds64DataSize = readU64(data + body + 8);
+        } else if (isChunk(chunk, "fmt ") && chunkSize >= 16 && available >= 16) {
+            formatTag = readU16(data + body);
+            channelCount = readU16(data + body + 2);
+            rate = static_cast<int>(readU32(data + body + 4));
+            blockAlign = readU16(data + body + 12);
+            bitsPerSample = readU16(data + body + 14);
+            // The extensible sub-format GUID starts with the plain format tag
+            if (formatTag == FORMAT_EXTENSIBLE && chunkSize >= 40 && available >= 40) {
+                formatTag = readU16(data + body + 24);
+            }
+            haveFormat = true;
+        } else if (isChunk(chunk, "bext") && chunkSize >= BEXT_TIME_REFERENCE_OFFSET + 8 &&
+                   available >= BEXT_TIME_REFERENCE_OFFSET + 8) {
+            bextTimeReference = readU64(data + body + BEXT_TIME_REFERENCE_OFFSET);
+        } else if (isChunk(chunk, "data")) {
+            if (rf64 && chunkSize == RF64_SIZE_MARKER) {
+                chunkSize = ds64DataSize;
+            }
+            dataOffset = body;
+            // Recorders that lost power leave 0 or a stale size: take what is there
+            dataSize = chunkSize == 0 || chunkSize > available ? available : chunkSize;
+            chunkSize = dataSize;
+        }
+
+        // Chunks are word aligned
+        const uint64_t next = static_cast<uint64_t>(body) + chunkSize + (chunkSize & 1);
+        if (next <= position || next > size) {
+            break;
+        }
+        position = static_cast<size_t>(next);
+    }
+
+    if (!haveFormat || dataOffset == 0) {
+        lastError = file.string() + " has no fmt or data chunk";
+        return false;
+    }
+
+    bytesPerSample = bitsPerSample / 8;
+    if (formatTag == FORMAT_PCM && bitsPerSample == 8) {
+        encoding = Encoding::PCM_U8;
+    } else if (formatTag == FORMAT_PCM && bitsPerSample == 16) {
+        encoding = Encoding::PCM_S16;
+    } else if (formatTag == FORMAT_PCM && bitsPerSample == 24) {
+        encoding = Encoding::PCM_S24;
+    } else if (formatTag == FORMAT_PCM && bitsPerSample == 32) {
+        encoding = Encoding::PCM_S32;
+    } else if (formatTag == FORMAT_IEEE_FLOAT && bitsPerSample == 32) {
+        encoding = Encoding::FLOAT32;
+    } else if (formatTag == FORMAT_IEEE_FLOAT && bitsPerSample == 64) {
+        encoding = Encoding::FLOAT64;
+    } else {
+        lastError = "unsupported WAV encoding (format " + std::to_string(formatTag) + ", " +
+                    std::to_string(bitsPerSample) + " bit) in " + file.string();
+        return false;
+    }
+    if (channelCount <= 0 || rate <= 0 || blockAlign != bytesPerSample * channelCount) {
+        lastError = "inconsistent WAV format in " + file.string();
+        return false;
+    }
+
+    sampleData = data + dataOffset;
+    frames = dataSize / blockAlign;
+    return true;
+}
+
+void WavReader::convertFrames(const unsigned char* source, size_t count, float* output) {
+    const size_t values = count * channelCount;
+    // Mono converts straight into the output
+    float* target = output;
+    if (channelCount > 1) {
+        interleaved.resize(values);
+        target = interleaved.data();
+    }
+
+    const auto& kernels = simd::kernels();
+    switch (encoding) {
+        case Encoding::PCM_U8:
+            for (size_t i = 0; i < values; ++i) {
+                target[i] = (static_cast<float>(source[i]) - 128.0f) * (1.0f / 128.0f);
+            }
+            break;
+        case Encoding::PCM_S16:
+            kernels.convertPcm16(source, target, values, 1.0f / 32768.0f);
+            break;
+        case Encoding::PCM_S24:
+            kernels.convertPcm24(source, target, values, 1.0f / 8388608.0f);
+            break;
+        case Encoding::PCM_S32:
+            kernels.convertPcm32(source, target, values, 1.0f / 2147483648.0f);
+            break;
+        case Encoding::FLOAT32:
+            std::memcpy(target, source, values * sizeof(float));
+            break;
+        case Encoding::FLOAT64:
+            for (size_t i = 0; i < values; ++i) {
+                double value;
+                std::memcpy(&value, source + i * sizeof(double), sizeof(double));
+                target[i] = static_cast<float>(value);
+            }
+            break;
+    }
+
+    if (channelCount > 1) {
+        const float gain = 1.0f / channelCount;
+        for (size_t frame = 0; frame < count; ++frame) {
+            const float* channels = target + frame * channelCount;
+            float sum = 0.0f;
+            for (int ch = 0; ch < channelCount; ++ch) {
+                sum += channels[ch];
+            }
+            output[frame] = sum * gain;
+        }
+    }
+}
+
+bool WavReader::read(double startTime, double duration, double sampleRate, std::vector<float>& samples) {
+    samples.clear();
+    if (sampleRate > 0.0 && duration > 0.0) {
+        samples.reserve(static_cast<size_t>(std::llround(std::min(duration, this->duration()) * sampleRate)));
+    }
+    return read(startTime, duration, sampleRate, CHUNK_FRAMES, [&samples](const float* block, size_t count) {
+        samples.insert(samples.end(), block, block + count);
+        return true;
+    });
+}
+
+bool WavReader::read(double startTime, double duration, double sampleRate, size_t blockSamples,
+                     const SampleSink& sink) {
+    if (!sampleData || duration <= 0.0 || sampleRate <= 0.0 || blockSamples == 0) {
+        lastError = "invalid read window";
+        return false;
+    }
+
+    const bool sameRate = std::abs(sampleRate - rate) < 1e-9;
+    const int outputRate = static_cast<int>(std::lround(sampleRate));
+    std::unique_ptr<PolyphaseResampler> resampler;
+    if (!sameRate) {
+        resampler = std::make_unique<PolyphaseResampler>(rate, outputRate);
+        if (std::abs(sampleRate - outputRate) > 1e-9 || !resampler->valid()) {
+            lastError = "no polyphase ratio for " + std::to_string(rate) + " Hz -> " +
+                        std::to_string(sampleRate) + " Hz";
+            return false;
+        }
+    }
+
+    const uint64_t first = static_cast<uint64_t>(std::llround(std::max(0.0, startTime) * rate));
+    if (first >= frames) {
+        lastError = "no audio samples in requested window";
+        return false;
+    }
+    const uint64_t count = std::min<uint64_t>(frames - first,
+                                              static_cast<uint64_t>(std::llround(duration * rate)));
+    const size_t targetSamples = static_cast<size_t>(std::llround(duration * sampleRate));
+
+    // Fault the window in ahead of the conversion (reads from network storage)
+    const size_t byteOffset = static_cast<size_t>(sampleData - mapping->data) + first * blockAlign;
+    mapping->willNeed(byteOffset, static_cast<size_t>(count * blockAlign));
+
+    size_t delivered = 0;
+    bool stopped = false;
+    auto emit = [&](const float* block, size_t size) {
+        size = std::min(size, targetSamples - delivered);
+        for (size_t begin = 0; begin < size && !stopped; begin += blockSamples) {
+            stopped = !sink(block + begin, std::min(blockSamples, size - begin));
+        }
+        delivered += size;
+    };
+
+    // Conversion steps never exceed a block of output, so scratch stays block sized
+    const uint64_t stepFrames = std::max<uint64_t>(1, std::min<uint64_t>(
+        CHUNK_FRAMES, static_cast<uint64_t>(blockSamples * rate / sampleRate)));
+    mono.resize(static_cast<size_t>(std::min(count, stepFrames)));
+    for (uint64_t done = 0; done < count && !stopped && delivered < targetSamples; done += stepFrames) {
+        const size_t step = static_cast<size_t>(std::min(stepFrames, count - done));
+        convertFrames(sampleData + (first + done) * blockAlign, step, mono.data());
+        if (resampler) {
+            resampled.clear();
+            resampler->process(mono.data(), step, resampled);
+            emit(resampled.data(), resampled.size());
+        } else {
+            emit(mono.data(), step);
+        }
+    }
+    if (resampler && !stopped && delivered < targetSamples) {
+        resampled.clear();
+        resampler->flush(resampled);
+        emit(resampled.data(), resampled.size());
+    }
+
+    if (delivered == 0) {
+        lastError = "no audio samples in requested window";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,831 @@
+/**
+ * @file work_queue.cpp
+ * @brief Work item format, the shared-directory claim protocol and queue node roles
+ */
+
+#include "work_queue.h"
+#include "console_log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    constexpr const char* ITEM_HEADER = "# video_transcoder work item v1";
+    constexpr const char* ITEM_EXTENSION = ".job";
+    constexpr const char* CLOSED_MARKER = "closed";
+
+    // State directories inside the queue
+    constexpr const char* SYNC_DIR = "sync";
+    constexpr const char* ENCODE_DIR = "encode";
+    constexpr const char* CLAIMED_DIR = "claimed";
+    constexpr const char* DONE_DIR = "done";
+    constexpr const char* FAILED_DIR = "failed";
+    constexpr const char* TMP_DIR = "tmp";
+
+    // Claims are renewed this often at most, and at least four times per lease
+    constexpr double HEARTBEAT_MAX_SECONDS = 30.0;
+
+    // Longest sleep between checks of the stop flag
+    constexpr double WAKE_SLICE_SECONDS = 0.25;
+
+    double monotonicSeconds() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const char* stageName(QueueStage stage) {
+        return stage == QueueStage::SYNC ? "sync" : "encode";
+    }
+
+    const char* qualityName(SyncQuality quality) {
+        switch (quality) {
+            case SyncQuality::REAL_TIME: return "realtime";
+            case SyncQuality::HIGH_QUALITY: return "high";
+            default: return "standard";
+        }
+    }
+
+    std::string nodeIdentity() {
+        char host[256] = {};
+        if (gethostname(host, sizeof(host) - 1) != 0 || host[0] == '\0') {
+            std::snprintf(host, sizeof(host), "node");
+        }
+        std::string name = host;
+        // '@' separates item id and node in claim names
+        std::replace(name.begin(), name.end(), '@', '_');
+        return name + "-" + std::to_string(::getpid());
+    }
+
+    std::string joined(const std::vector<std::string>& values) {
+        std::string text;
+        for (const auto& value : values) {
+            if (!text.empty()) text += ',';
+            text += value;
+        }
+        return text;
+    }
+
+    std::vector<std::string> split(const std::string& text) {
+        std::vector<std::string> values;
+        std::stringstream list(text);
+        std::string value;
+        while (std::getline(list, value, ',')) {
+            if (!value.empty()) values.push_back(value);
+        }
+        return values;
+    }
+
+    // Item files in a state directory
+    std::vector<std::filesystem::path> itemFiles(const std::filesystem::path& directory) {
+        std::vector<std::filesystem::path> files;
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->path().extension() == ITEM_EXTENSION) {
+                files.push_back(it->path());
+            }
+        }
+        return files;
+    }
+
+    // "<id>@<node>-<claim>.job" in claimed/, "<id>.job" everywhere else
+    std::string idOf(const std::filesystem::path& file) {
+        const std::string stem = file.stem().string();
+        return stem.substr(0, stem.find('@'));
+    }
+
+    // Seconds since the file was last touched, by this node's clock; nodes
+    // are assumed to agree to well within a lease
+    double ageOf(const std::filesystem::path& file) {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(file, ec);
+        if (ec) return 0.0;
+        return std::chrono::duration<double>(std::filesystem::file_time_type::clock::now() - time).count();
+    }
+
+    void touch(const std::filesystem::path& file) {
+        std::error_code ec;
+        std::filesystem::last_write_time(file, std::filesystem::file_time_type::clock::now(), ec);
+    }
+}
+
+// ===========================
+// WorkItem Implementation
+// ===========================
+
+std::string WorkItem::serialize() const {
+    std::ostringstream text;
+    text << std::setprecision(std::numeric_limits<double>::max_digits10);
+    text << ITEM_HEADER << "\n"
+         << "id=" << id << "\n"
+         << "stage=" << stageName(stage) << "\n"
+         << "input=" << inputDir.string() << "\n"
+         << "quality=" << qualityName(quality) << "\n"
+         << "video=" << job.videoFile.string() << "\n"
+         << "output=" << job.outputFile.string() << "\n"
+         << "profile=" << job.profileName << "\n"
+         << "high_gain=" << job.highGainAudio.string() << "\n"
+         << "low_gain=" << job.lowGainAudio.string() << "\n"
+         << "match_confidence=" << job.matchConfidence << "\n";
+    if (job.offsetHint) {
+        text << "offset_hint=" << *job.offsetHint << "\n";
+    }
+    text << "use_sync=" << (job.useSync ? 1 : 0) << "\n"
+         << "sync_time=" << job.syncTime << "\n"
+         << "sync.offset=" << job.syncResult.offset << "\n"
+         << "sync.confidence=" << job.syncResult.confidence << "\n"
+         << "sync.algorithm=" << job.syncResult.algorithm << "\n"
+         << "sync.drift_ppm=" << job.syncResult.driftPpm << "\n"
+         << "sync.computation_time=" << job.syncResult.computationTime << "\n"
+         << "sync.algorithms_run=" << joined(job.syncResult.algorithmsRun) << "\n"
+         << "sync.algorithms_skipped=" << joined(job.syncResult.algorithmsSkipped) << "\n"
+         << "sync.early_exit=" << (job.syncResult.earlyExit ? 1 : 0) << "\n"
+         << "success=" << (success ? 1 : 0) << "\n"
+         << "node=" << node << "\n";
+    return text.str();
+}
+
+bool WorkItem::parse(const std::string& text, WorkItem& item) {
+    std::map<std::string, std::string> fields;
+    std::stringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        // Values may contain '=' (paths); keys never do
+        const size_t separator = line.find('=');
+        if (separator == std::string::npos) continue;
+        fields[line.substr(0, separator)] = line.substr(separator + 1);
+    }
+
+    auto field = [&](const char* key) -> std::string {
+        auto it = fields.find(key);
+        return it == fields.end() ? std::string() : it->second;
+    };
+    if (field("id").empty() || field("video").empty() || field("output").empty()) {
+        return false;
+    }
+
+    WorkItem parsed;
+    try {
+        parsed.id = field("id");
+        parsed.stage = field("stage") == "encode" ? QueueStage::ENCODE : QueueStage::SYNC;
+        parsed.inputDir = field("input");
+        const std::string quality = field("quality");
+        parsed.quality = quality == "realtime" ? SyncQuality::REAL_TIME
+                       : quality == "high" ? SyncQuality::HIGH_QUALITY : SyncQuality::STANDARD;
+
+        TranscodeJob& job = parsed.job;
+        job.videoFile = field("video");
+        job.outputFile = field("output");
+        job.profileName = field("profile");
+        job.highGainAudio = field("high_gain");
+        job.lowGainAudio = field("low_gain");
+        if (!field("match_confidence").empty()) job.matchConfidence = std::stof(field("match_confidence"));
+        if (!field("offset_hint").empty()) job.offsetHint = std::stod(field("offset_hint"));
+        job.useSync = field("use_sync") == "1";
+        if (!field("sync_time").empty()) job.syncTime = std::stod(field("sync_time"));
+
+        SyncResult& result = job.syncResult;
+        if (!field("sync.offset").empty()) result.offset = std::stod(field("sync.offset"));
+        if (!field("sync.confidence").empty()) result.confidence = std::stof(field("sync.confidence"));
+        result.algorithm = field("sync.algorithm");
+        if (!field("sync.drift_ppm").empty()) result.driftPpm = std::stod(field("sync.drift_ppm"));
+        if (!field("sync.computation_time").empty()) {
+            result.computationTime = std::stod(field("sync.computation_time"));
+        }
+        result.algorithmsRun = split(field("sync.algorithms_run"));
+        result.algorithmsSkipped = split(field("sync.algorithms_skipped"));
+        result.earlyExit = field("sync.early_exit") == "1";
+
+        parsed.success = field("success") == "1";
+        parsed.node = field("node");
+    } catch (const std::exception&) {
+        return false;
+    }
+    item = std::move(parsed);
+    return true;
+}
+
+std::string WorkItem::makeId(const std::filesystem::path& video) {
+    std::string id = video.stem().string();
+    for (char& c : id) {
+        const bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                          c == '-' || c == '_';
+        if (!safe) c = '_';
+    }
+
+    // FNV-1a of the full path keeps same-named clips from different cards apart
+    std::error_code ec;
+    const std::string key = std::filesystem::absolute(video, ec).lexically_normal().string();
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    std::ostringstream text;
+    text << id << "-" << std::hex << std::setw(8) << std::setfill('0') << hash;
+    return text.str();
+}
+
+// ===========================
+// WorkQueue Implementation
+// ===========================
+
+WorkQueue::WorkQueue(std::filesystem::path directory, double leaseSeconds)
+    : directory(std::move(directory)), leaseSeconds(std::max(1.0, leaseSeconds)), node(nodeIdentity()) {}
+
+bool WorkQueue::open() {
+    for (const char* state : {SYNC_DIR, ENCODE_DIR, CLAIMED_DIR, DONE_DIR, FAILED_DIR, TMP_DIR}) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory / state, ec);
+        if (!std::filesystem::is_directory(directory / state, ec)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WorkQueue::submit(const WorkItem& item) {
+    if (!writeItem(item, pendingPath(item.stage, item.id))) {
+        return false;
+    }
+    const std::string name = item.id + ITEM_EXTENSION;
+    std::error_code ec;
+    std::filesystem::remove(directory / DONE_DIR / name, ec);
+    std::filesystem::remove(directory / FAILED_DIR / name, ec);
+    return true;
+}
+
+std::optional<std::string> WorkQueue::stateOf(const std::string& id) const {
+    const std::string name = id + ITEM_EXTENSION;
+    std::error_code ec;
+    for (const char* state : {SYNC_DIR, ENCODE_DIR, DONE_DIR, FAILED_DIR}) {
+        if (std::filesystem::exists(directory / state / name, ec)) {
+            return std::string(state);
+        }
+    }
+    for (const auto& file : itemFiles(directory / CLAIMED_DIR)) {
+        if (idOf(file) == id) {
+            return std::string(CLAIMED_DIR);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<WorkQueue::Claim> WorkQueue::claim(QueueStage stage) {
+    auto files = itemFiles(directory / stageName(stage));
+
+    // Oldest first, so a large backlog is worked through in submission order
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> ordered;
+    for (const auto& file : files) {
+        std::error_code ec;
+        ordered.emplace_back(std::filesystem::last_write_time(file, ec), file);
+    }
+    std::sort(ordered.begin(), ordered.end());
+
+    for (const auto& [time, file] : ordered) {
+        // Start the lease before the rename, so no node can take a fresh claim for a stale one
+        touch(file);
+        const std::filesystem::path claimed =
+            directory / CLAIMED_DIR / (idOf(file) + "@" + node + "-" + std::to_string(claimSequence++) +
+                                       ITEM_EXTENSION);
+        std::error_code ec;
+        std::filesystem::rename(file, claimed, ec);
+        if (ec) {
+            continue;   // Another node won this one
+        }
+
+        auto item = readItem(claimed);
+        if (!item) {
+            // Keep damaged items out of the way, but where an operator will find them
+            std::filesystem::rename(claimed, directory / FAILED_DIR / file.filename(), ec);
+            continue;
+        }
+        item->stage = stage;
+        return Claim{std::move(*item), claimed};
+    }
+    return std::nullopt;
+}
+
+bool WorkQueue::complete(const Claim& claim, const WorkItem& result, bool finished) {
+    // A requeued item belongs to whoever claims it next
+    if (!owns(claim)) {
+        return false;
+    }
+    const std::filesystem::path target = finished
+        ? directory / (result.success ? DONE_DIR : FAILED_DIR) / (result.id + ITEM_EXTENSION)
+        : pendingPath(result.stage, result.id);
+    if (!writeItem(result, target)) {
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::remove(claim.file, ec);
+    return true;
+}
+
+bool WorkQueue::release(const Claim& claim) {
+    std::error_code ec;
+    std::filesystem::rename(claim.file, pendingPath(claim.item.stage, claim.item.id), ec);
+    return !ec;
+}
+
+bool WorkQueue::owns(const Claim& claim) const {
+    std::error_code ec;
+    return std::filesystem::exists(claim.file, ec);
+}
+
+std::filesystem::path WorkQueue::stagingOutput(const Claim& claim) {
+    const std::filesystem::path& output = claim.item.job.outputFile;
+    return output.parent_path() /
+           ("." + output.stem().string() + "." + claim.file.stem().string() + ".part" +
+            output.extension().string());
+}
+
+void WorkQueue::heartbeat(const Claim& claim) {
+    touch(claim.file);
+}
+
+size_t WorkQueue::requeueStale() {
+    size_t requeued = 0;
+    for (const auto& file : itemFiles(directory / CLAIMED_DIR)) {
+        if (ageOf(file) < leaseSeconds) continue;
+
+        auto item = readItem(file);
+        std::error_code ec;
+        if (!item) {
+            std::filesystem::rename(file, directory / FAILED_DIR / (idOf(file) + ITEM_EXTENSION), ec);
+            continue;
+        }
+        // Delivery is at-least-once: should the owner be alive after all, both
+        // runs encode, but only the current holder moves its output into place
+        std::filesystem::rename(file, pendingPath(item->stage, item->id), ec);
+        if (!ec) {
+            requeued++;
+        }
+    }
+
+    // Half-written files of nodes that died while publishing
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory / TMP_DIR, ec), end; !ec && it != end; it.increment(ec)) {
+        if (ageOf(it->path()) >= leaseSeconds) {
+            std::error_code removeError;
+            std::filesystem::remove(it->path(), removeError);
+        }
+    }
+    return requeued;
+}
+
+QueueCounts WorkQueue::counts() const {
+    QueueCounts counts;
+    counts.pendingSync = itemFiles(directory / SYNC_DIR).size();
+    counts.pendingEncode = itemFiles(directory / ENCODE_DIR).size();
+    counts.claimed = itemFiles(directory / CLAIMED_DIR).size();
+    counts.done = itemFiles(directory / DONE_DIR).size();
+    counts.failed = itemFiles(directory / FAILED_DIR).size();
+    return counts;
+}
+
+std::vector<WorkItem> WorkQueue::finished(const std::set<std::string>& ids) const {
+    std::vector<WorkItem> items;
+    for (const auto& id : ids) {
+        for (const char* state : {DONE_DIR, FAILED_DIR}) {
+            if (auto item = readItem(directory / state / (id + ITEM_EXTENSION))) {
+                items.push_back(std::move(*item));
+                break;
+            }
+        }
+    }
+    return items;
+}
+
+std::set<std::string> WorkQueue::finishedIds() const {
+    std::set<std::string> ids;
+    for (const char* state : {DONE_DIR, FAILED_DIR}) {
+        for (const auto& file : itemFiles(directory / state)) {
+            ids.insert(idOf(file));
+        }
+    }
+    return ids;
+}
+
+void WorkQueue::setClosed(bool closed) {
+    std::error_code ec;
+    if (closed) {
+        std::ofstream(directory / CLOSED_MARKER) << node << "\n";
+    } else {
+        std::filesystem::remove(directory / CLOSED_MARKER, ec);
+    }
+}
+
+bool WorkQueue::isClosed() const {
+    std::error_code ec;
+    return std::filesystem::exists(directory / CLOSED_MARKER, ec);
+}
+
+bool WorkQueue::writeItem(const WorkItem& item, const std::filesystem::path& target) const {
+    // Written under tmp/ and renamed, so readers never see half an item
+    const std::filesystem::path temp =
+        directory / TMP_DIR / (item.id + "." + node + ".tmp");
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        out << item.serialize();
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp, target, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+std::optional<WorkItem> WorkQueue::readItem(const std::filesystem::path& file) const {
+    std::ifstream in(file);
+    if (!in) {
+        return std::nullopt;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    WorkItem item;
+    if (!WorkItem::parse(text.str(), item)) {
+        return std::nullopt;
+    }
+    return item;
+}
+
+std::filesystem::path WorkQueue::pendingPath(QueueStage stage, const std::string& id) const {
+    return directory / stageName(stage) / (id + ITEM_EXTENSION);
+}
+
+// ===========================
+// QueueNode Implementation
+// ===========================
+
+QueueNode::QueueNode(VideoTranscoder& transcoder, std::filesystem::path queueDir, QueueNodeOptions options)
+    : transcoder(transcoder), queue(std::move(queueDir), options.leaseSeconds), options(options) {
+    this->options.pollInterval = std::max(WAKE_SLICE_SECONDS, this->options.pollInterval);
+    this->options.syncWorkers = std::max<size_t>(1, this->options.syncWorkers);
+    this->options.encodeWorkers = std::max<size_t>(1, this->options.encodeWorkers);
+}
+
+bool QueueNode::submit(const std::filesystem::path& inputDir, const std::filesystem::path& outputDir,
+                       SyncQuality quality, const std::string& profileName) {
+    if (!queue.open()) {
+        std::cerr << "❌ ERROR: Cannot open work queue: " << queue.path().string() << std::endl;
+        return false;
+    }
+
+    auto videoFiles = transcoder.findVideoFiles(inputDir);
+    std::cout << "\n📁 Found " << videoFiles.size() << " video files in " << inputDir.string() << std::endl;
+    if (videoFiles.empty()) {
+        std::cout << "❌ No video files found!" << std::endl;
+        return false;
+    }
+
+    // Every node must be able to resolve the paths, whatever its working directory
+    std::error_code ec;
+    const std::filesystem::path input = std::filesystem::absolute(inputDir, ec).lexically_normal();
+    const std::filesystem::path output = std::filesystem::absolute(outputDir, ec).lexically_normal();
+
+    queue.setClosed(false);
+    size_t added = 0, retried = 0, queued = 0, done = 0;
+    for (const auto& video : videoFiles) {
+        WorkItem item;
+        item.job.videoFile = std::filesystem::absolute(video, ec).lexically_normal();
+        item.job.outputFile = output / (video.stem().string() + ".mov");
+        item.job.profileName = profileName;
+        item.id = WorkItem::makeId(item.job.videoFile);
+        item.inputDir = input;
+        item.quality = quality;
+
+        // A restarted coordinator picks up where the last one stopped
+        const auto state = queue.stateOf(item.id);
+        if (state && *state == DONE_DIR && std::filesystem::exists(item.job.outputFile, ec)) {
+            submittedIds.insert(item.id);
+            done++;
+            continue;
+        }
+        if (state && *state != DONE_DIR && *state != FAILED_DIR) {
+            submittedIds.insert(item.id);
+            queued++;
+            continue;
+        }
+
+        if (!queue.submit(item)) {
+            std::cerr << "⚠️  Could not enqueue " << video.filename().string() << std::endl;
+            continue;
+        }
+        submittedIds.insert(item.id);
+        if (state) {
+            retried++;
+        } else {
+            added++;
+        }
+    }
+
+    std::cout << "📥 Queue " << queue.path().string() << ": " << added << " added, " << retried
+              << " retried, " << queued << " already queued, " << done << " already done" << std::endl;
+    return !submittedIds.empty();
+}
+
+bool QueueNode::collect() {
+    std::cout << "⏳ Waiting for " << submittedIds.size() << " jobs (coordinator " << queue.nodeName()
+              << ")" << std::endl;
+
+    size_t reported = std::numeric_limits<size_t>::max();
+    while (!stopRequested) {
+        const size_t requeued = queue.requeueStale();
+        if (requeued > 0) {
+            std::cout << "♻️  Requeued " << requeued << " expired claim" << (requeued == 1 ? "" : "s")
+                      << std::endl;
+        }
+
+        const auto finishedIds = queue.finishedIds();
+        const size_t finishedCount = static_cast<size_t>(std::count_if(submittedIds.begin(), submittedIds.end(),
+            [&](const std::string& id) { return finishedIds.count(id) > 0; }));
+        if (finishedCount != reported) {
+            const auto counts = queue.counts();
+            std::cout << "📦 " << finishedCount << "/" << submittedIds.size() << " finished ("
+                      << counts.pendingSync << " awaiting sync, " << counts.pendingEncode
+                      << " awaiting encode, " << counts.claimed << " running)" << std::endl;
+            reported = finishedCount;
+        }
+        if (finishedCount == submittedIds.size()) break;
+
+        const double deadline = monotonicSeconds() + options.pollInterval;
+        while (!stopRequested && monotonicSeconds() < deadline) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(WAKE_SLICE_SECONDS));
+        }
+    }
+    if (stopRequested) {
+        std::cout << "\n🛑 Coordinator stopped; queued jobs continue and are collected by the next run"
+                  << std::endl;
+        return false;
+    }
+
+    // Statistics are rebuilt from the items, so they cover every node's work
+    const auto items = queue.finished(submittedIds);
+    statistics = SyncStatistics{};
+    std::map<std::string, size_t> jobsPerNode;
+    bool allSuccessful = items.size() == submittedIds.size();
+    for (const auto& item : items) {
+        statistics.addResult(item.job.syncResult);
+        jobsPerNode[item.node.empty() ? "unknown" : item.node]++;
+        if (!item.success) {
+            allSuccessful = false;
+            std::cout << "❌ Failed: " << item.job.videoFile.filename().string() << " (" << item.node << ")"
+                      << std::endl;
+        }
+    }
+
+    std::cout << "\n🖧 Jobs per node:" << std::endl;
+    for (const auto& [node, jobs] : jobsPerNode) {
+        std::cout << "  " << node << ": " << jobs << std::endl;
+    }
+    statistics.printReport();
+
+    queue.setClosed(true);
+    return allSuccessful;
+}
+
+bool QueueNode::work() {
+    if (!queue.open()) {
+        std::cerr << "❌ ERROR: Cannot open work queue: " << queue.path().string() << std::endl;
+        return false;
+    }
+    std::cout << "\n🛰️  Queue node " << queue.nodeName() << " (" << roleName(options.role) << ") on "
+              << queue.path().string() << std::endl;
+
+    std::unique_ptr<ThreadPool> syncPool;
+    std::unique_ptr<ThreadPool> encodePool;
+    if (runsStage(QueueStage::SYNC)) syncPool = std::make_unique<ThreadPool>(options.syncWorkers);
+    if (runsStage(QueueStage::ENCODE)) encodePool = std::make_unique<ThreadPool>(options.encodeWorkers);
+
+    heartbeatStop = false;
+    std::thread heartbeat(&QueueNode::heartbeatLoop, this);
+
+    // Only as many claims as free workers, so idle nodes get the rest
+    double nextRequeue = 0.0;
+    while (!stopRequested) {
+        if (monotonicSeconds() >= nextRequeue) {
+            queue.requeueStale();
+            nextRequeue = monotonicSeconds() + options.pollInterval;
+        }
+
+        bool dispatched = false;
+        if (syncPool && syncInFlight < options.syncWorkers) {
+            dispatched |= dispatch(QueueStage::SYNC, *syncPool);
+        }
+        if (encodePool && encodeInFlight < options.encodeWorkers) {
+            dispatched |= dispatch(QueueStage::ENCODE, *encodePool);
+        }
+        if (dispatched) continue;
+
+        if (syncInFlight == 0 && encodeInFlight == 0 && queue.isClosed()) {
+            const auto counts = queue.counts();
+            if ((!syncPool || counts.pendingSync == 0) && (!encodePool || counts.pendingEncode == 0)) {
+                break;
+            }
+        }
+
+        // Sleep until the next scan, or until a running job frees its worker
+        const size_t seen = completions;
+        const double deadline = monotonicSeconds() + options.pollInterval;
+        while (!stopRequested && completions == seen && monotonicSeconds() < deadline) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(WAKE_SLICE_SECONDS));
+        }
+    }
+
+    // Running jobs finish (or, when stopping, hand their items back) before we leave
+    if (syncPool) syncPool->waitIdle();
+    if (encodePool) encodePool->waitIdle();
+    heartbeatStop = true;
+    heartbeat.join();
+
+    std::cout << "\n" << (stopRequested ? "🛑 Queue node stopped" : "🏁 Queue closed and drained")
+              << std::endl;
+    return !jobFailed;
+}
+
+void QueueNode::stop() {
+    stopRequested = true;
+    transcoder.cancel();
+}
+
+const char* QueueNode::roleName(NodeRole role) {
+    switch (role) {
+        case NodeRole::COORDINATOR: return "coordinator";
+        case NodeRole::SYNC: return "sync";
+        case NodeRole::ENCODE: return "encode";
+        default: return "all";
+    }
+}
+
+std::optional<NodeRole> QueueNode::parseRole(const std::string& name) {
+    for (NodeRole role : {NodeRole::COORDINATOR, NodeRole::SYNC, NodeRole::ENCODE, NodeRole::ALL}) {
+        if (name == roleName(role)) {
+            return role;
+        }
+    }
+    return std::nullopt;
+}
+
+bool QueueNode::runsStage(QueueStage stage) const {
+    switch (options.role) {
+        case NodeRole::ALL: return true;
+        case NodeRole::SYNC: return stage == QueueStage::SYNC;
+        case NodeRole::ENCODE: return stage == QueueStage::ENCODE;
+        default: return false;
+    }
+}
+
+bool QueueNode::dispatch(QueueStage stage, ThreadPool& pool) {
+    auto claim = queue.claim(stage);
+    if (!claim) {
+        return false;
+    }
+    trackClaim(*claim);
+
+    if (stage == QueueStage::ENCODE) {
+        encodeInFlight++;
+        pool.submit([this, claim = std::move(*claim)]() mutable { runEncode(std::move(claim)); });
+        return true;
+    }
+
+    auto audioFiles = transcoder.findAudioFiles(claim->item.inputDir);
+    std::sort(audioFiles.begin(), audioFiles.end());
+
+    // Engines and the fingerprint index are rebuilt for a new audio set,
+    // which must not happen under a running sync job
+    if (!prepared || audioFiles != preparedAudio || claim->item.quality != preparedQuality) {
+        pool.waitIdle();
+        transcoder.prepareBatch({}, audioFiles, claim->item.quality);
+        preparedAudio = audioFiles;
+        preparedQuality = claim->item.quality;
+        prepared = true;
+    }
+
+    syncInFlight++;
+    pool.submit([this, claim = std::move(*claim), audioFiles = std::move(audioFiles)]() mutable {
+        runSync(std::move(claim), std::move(audioFiles));
+    });
+    return true;
+}
+
+void QueueNode::runSync(WorkQueue::Claim claim, std::vector<std::filesystem::path> audioFiles) {
+    WorkItem result = claim.item;
+    result.node = queue.nodeName();
+    const bool proceed = transcoder.syncJob(result.job, audioFiles, result.quality);
+
+    {
+        console::ScopedCapture capture;
+        const std::string name = result.job.videoFile.filename().string();
+        if (stopRequested) {
+            queue.release(claim);
+            console::out() << "↩️  Returned to queue: " << name << std::endl;
+        } else if (!queue.owns(claim)) {
+            console::out() << "⚠️  Lease lost, sync result discarded: " << name << std::endl;
+        } else if (proceed) {
+            result.stage = QueueStage::ENCODE;
+            if (queue.complete(claim, result, false)) {
+                console::out() << "📤 Queued for encode: " << name << std::endl;
+            } else {
+                console::out() << "⚠️  Could not publish sync result: " << name << std::endl;
+                jobFailed = true;
+            }
+        } else {
+            result.success = false;
+            queue.complete(claim, result, true);
+            console::out() << "❌ Sync stage failed: " << name << std::endl;
+            jobFailed = true;
+        }
+    }
+
+    untrackClaim(claim);
+    syncInFlight--;
+    completions++;
+}
+
+void QueueNode::runEncode(WorkQueue::Claim claim) {
+    WorkItem result = claim.item;
+    result.node = queue.nodeName();
+
+    // Encode under a name of this claim; the output only appears once the
+    // lease is known to be ours
+    TranscodeJob job = result.job;
+    job.outputFile = WorkQueue::stagingOutput(claim);
+    bool success = transcoder.encodeJob(job);
+    const bool owned = queue.owns(claim);
+    std::error_code ec;
+    if (success && owned) {
+        std::filesystem::rename(job.outputFile, result.job.outputFile, ec);
+        success = !ec;
+    }
+    std::filesystem::remove(job.outputFile, ec);
+
+    {
+        console::ScopedCapture capture;
+        const std::string name = result.job.videoFile.filename().string();
+        if (!owned) {
+            // The lease expired and the item was requeued; its new holder publishes
+            console::out() << "⚠️  Lease lost, output discarded: " << name << std::endl;
+        } else if (!success && stopRequested) {
+            // Cancelled mid-transcode; another node starts it afresh
+            queue.release(claim);
+            console::out() << "↩️  Returned to queue: " << name << std::endl;
+        } else {
+            result.success = success;
+            if (!queue.complete(claim, result, true)) {
+                console::out() << "⚠️  Could not publish encode result: " << name << std::endl;
+            }
+            if (!success) {
+                jobFailed = true;
+            }
+        }
+    }
+
+    untrackClaim(claim);
+    encodeInFlight--;
+    completions++;
+}
+
+void QueueNode::trackClaim(const WorkQueue::Claim& claim) {
+    std::lock_guard<std::mutex> lock(claimsMutex);
+    activeClaims.push_back(claim);
+}
+
+void QueueNode::untrackClaim(const WorkQueue::Claim& claim) {
+    std::lock_guard<std::mutex> lock(claimsMutex);
+    activeClaims.erase(std::remove_if(activeClaims.begin(), activeClaims.end(),
+                                      [&](const WorkQueue::Claim& active) { return active.file == claim.file; }),
+                       activeClaims.end());
+}
+
+void QueueNode::heartbeatLoop() {
+    const double interval = std::min(HEARTBEAT_MAX_SECONDS, options.leaseSeconds / 4.0);
+    while (!heartbeatStop) {
+        const double deadline = monotonicSeconds() + interval;
+        while (!heartbeatStop && monotonicSeconds() < deadline) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(WAKE_SLICE_SECONDS));
+        }
+        std::lock_guard<std::mutex> lock(claimsMutex);
+        for (const auto& claim : activeClaims) {
+            queue.heartbeat(claim);
+        }
+    }
+}
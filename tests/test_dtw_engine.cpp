@@ -0,0 +1,221 @@
+/**
+ * @file test_dtw_engine.cpp
+ * @brief Subsequence DTW against a full-matrix reference, refinement and band limits
+ */
+
+#include "dtw_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAIL: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    float frameDistance(const std::vector<float>& a, size_t i, const std::vector<float>& b, size_t j, size_t dim) {
+        double sum = 0.0;
+        for (size_t k = 0; k < dim; ++k) {
+            const double d = a[i * dim + k] - b[j * dim + k];
+            sum += d * d;
+        }
+        return static_cast<float>(std::sqrt(sum));
+    }
+
+    // Textbook subsequence DTW over the full matrix
+    float referenceCost(const std::vector<float>& query, const std::vector<float>& search, size_t dim) {
+        const size_t len1 = query.size() / dim;
+        const size_t len2 = search.size() / dim;
+        const float inf = std::numeric_limits<float>::infinity();
+        std::vector<std::vector<float>> cost(len1, std::vector<float>(len2, inf));
+        for (size_t i = 0; i < len1; ++i) {
+            for (size_t j = 0; j < len2; ++j) {
+                float best = 0.0f;
+                if (i > 0) {
+                    best = cost[i - 1][j];
+                    if (j > 0) best = std::min({best, cost[i - 1][j - 1], cost[i][j - 1]});
+                }
+                cost[i][j] = frameDistance(query, i, search, j, dim) + best;
+            }
+        }
+        float best = inf;
+        for (float value : cost[len1 - 1]) best = std::min(best, value);
+        return best;
+    }
+
+    std::vector<float> randomSequence(size_t frames, size_t dim, std::mt19937& rng) {
+        std::normal_distribution<float> gaussian(0.0f, 1.0f);
+        std::vector<float> sequence(frames * dim);
+        for (float& value : sequence) value = gaussian(rng);
+        return sequence;
+    }
+
+    // Starts in row 0, ends in the last row, moves by single steps, and its cells add up to cost
+    void checkPath(const DTWEngine::Path& path, const std::vector<float>& query, const std::vector<float>& search,
+                   size_t dim, float cost, const std::string& name) {
+        const size_t len1 = query.size() / dim;
+        check(!path.empty(), name + ": path found");
+        if (path.empty()) return;
+        check(path.front().first == 0 && path.back().first == len1 - 1, name + ": path spans every query row");
+
+        bool steps = true;
+        double sum = frameDistance(query, path[0].first, search, path[0].second, dim);
+        for (size_t n = 1; n < path.size(); ++n) {
+            const size_t di = path[n].first - path[n - 1].first;
+            const size_t dj = path[n].second - path[n - 1].second;
+            steps = steps && di <= 1 && dj <= 1 && di + dj > 0 &&
+                    path[n].first >= path[n - 1].first && path[n].second >= path[n - 1].second;
+            sum += frameDistance(query, path[n].first, search, path[n].second, dim);
+        }
+        check(steps, name + ": path moves by single monotone steps");
+        check(std::abs(sum - cost) <= 1e-3 * std::max(1.0, std::abs(sum)), name + ": path cost matches the result");
+    }
+
+    // The query is an exact excerpt: zero cost, path on the excerpt's diagonal
+    void testExactExcerpt() {
+        std::mt19937 rng(1);
+        const size_t dim = 13;
+        const std::vector<float> search = randomSequence(120, dim, rng);
+        const std::vector<float> query(search.begin() + 37 * dim, search.begin() + 77 * dim);
+
+        DTWEngine engine;
+        DTWEngine::Path path;
+        const float cost = engine.computeSubsequencePath(query, search, path, dim);
+        check(cost < 1e-4f, "exact excerpt: zero cost");
+        check(!path.empty() && path.front() == std::make_pair<size_t, size_t>(0, 37) &&
+              path.back() == std::make_pair<size_t, size_t>(39, 76), "exact excerpt: path on the excerpt diagonal");
+        check(engine.lastCellCount() == 40 * 120, "exact excerpt: full search evaluates every cell");
+    }
+
+    // Random inputs match the full-matrix reference, for vectors and scalars
+    void testAgainstReference() {
+        std::mt19937 rng(2);
+        for (size_t dim : {size_t(1), size_t(13)}) {
+            for (auto [len1, len2] : {std::pair<size_t, size_t>{1, 1}, {1, 9}, {7, 3}, {17, 40}, {33, 33}}) {
+                const auto query = randomSequence(len1, dim, rng);
+                const auto search = randomSequence(len2, dim, rng);
+                const std::string name = "reference " + std::to_string(len1) + "x" + std::to_string(len2) +
+                                         " dim " + std::to_string(dim);
+
+                DTWEngine engine;
+                DTWEngine::Path path;
+                const float cost = engine.computeSubsequencePath(query, search, path, dim);
+                const float expected = referenceCost(query, search, dim);
+                check(std::abs(cost - expected) <= 1e-4f * std::max(1.0f, expected), name + ": cost matches");
+                checkPath(path, query, search, dim, cost, name);
+            }
+        }
+
+        DTWEngine engine;
+        DTWEngine::Path path;
+        check(std::isinf(engine.computeSubsequencePath({}, std::vector<float>(4, 0.0f), path)) && path.empty(),
+              "empty query: no path");
+    }
+
+    // Coarse pass on downsampled sequences refined back to full rate finds the same alignment
+    void testRefinement() {
+        std::mt19937 rng(3);
+        const size_t dim = 4;
+        // Slowly varying features, so averaging frame pairs keeps the structure
+        std::vector<float> search = randomSequence(400, dim, rng);
+        for (size_t pass = 0; pass < 3; ++pass) {
+            for (size_t i = 1; i < 400; ++i) {
+                for (size_t k = 0; k < dim; ++k) {
+                    search[i * dim + k] = 0.7f * search[(i - 1) * dim + k] + 0.3f * search[i * dim + k];
+                }
+            }
+        }
+        const std::vector<float> query(search.begin() + 150 * dim, search.begin() + 250 * dim);
+
+        DTWEngine engine;
+        const auto coarse1 = DTWEngine::downsample(query, dim);
+        const auto coarse2 = DTWEngine::downsample(search, dim);
+        DTWEngine::Path coarsePath;
+        engine.computeSubsequencePath(coarse1, coarse2, coarsePath, dim);
+
+        DTWEngine::Path path;
+        const float cost = engine.computeSubsequencePathAround(query, search, coarsePath, 2, 4, path, dim);
+        check(cost < 1e-3f, "refinement: finds the excerpt");
+        check(!path.empty() && path.front().second == 150 && path.back().second == 249,
+              "refinement: path on the excerpt diagonal");
+        check(engine.lastCellCount() < 100 * 400 / 4, "refinement: evaluates only cells near the projection");
+        checkPath(path, query, search, dim, cost, "refinement");
+    }
+
+    // A time-stretched query drifts off its diagonal; the band keeps the path within radius of the median
+    void testBand() {
+        std::mt19937 rng(4);
+        const size_t dim = 3;
+        const std::vector<float> search = randomSequence(200, dim, rng);
+        std::vector<float> query;
+        for (size_t i = 60; i < 140; ++i) {
+            // Every eighth frame twice: the content runs 10 frames longer than in search
+            const size_t repeats = i % 8 == 0 ? 2 : 1;
+            for (size_t r = 0; r < repeats; ++r) {
+                query.insert(query.end(), search.begin() + i * dim, search.begin() + (i + 1) * dim);
+            }
+        }
+
+        DTWEngine free;
+        DTWEngine::Path coarsePath;
+        free.computeSubsequencePath(query, search, coarsePath, dim);
+        DTWEngine::Path unbanded;
+        const float freeCost = free.computeSubsequencePathAround(query, search, coarsePath, 1, 20, unbanded, dim);
+
+        DTWEngine banded(2);
+        DTWEngine::Path path;
+        const float bandedCost = banded.computeSubsequencePathAround(query, search, coarsePath, 1, 20, path, dim);
+        checkPath(path, query, search, dim, bandedCost, "band");
+        check(freeCost < 1e-4f, "band: the unconstrained path absorbs the stretch");
+        check(bandedCost > freeCost, "band: the constrained path costs more");
+        check(banded.lastCellCount() <= 5 * (query.size() / dim), "band: evaluates only the band");
+
+        long lowest = std::numeric_limits<long>::max();
+        long highest = std::numeric_limits<long>::min();
+        for (const auto& [i, j] : path) {
+            lowest = std::min(lowest, static_cast<long>(j) - static_cast<long>(i));
+            highest = std::max(highest, static_cast<long>(j) - static_cast<long>(i));
+        }
+        check(highest - lowest <= 4, "band: diagonal stays within the radius");
+
+        // A band that leaves the search sequence altogether has no path
+        DTWEngine::Path farPath = {{0, 180}, {1, 181}};
+        check(std::isinf(banded.computeSubsequencePathAround(query, std::vector<float>(search.begin(),
+                                                                 search.begin() + 20 * dim),
+                                                             farPath, 1, 1, path, dim)) && path.empty(),
+              "band outside the search sequence: no path");
+    }
+
+    void testDownsample() {
+        const std::vector<float> sequence = {1, 10, 3, 30, 5, 50, 7, 70, 9, 90};
+        const auto reduced = DTWEngine::downsample(sequence, 2);
+        const std::vector<float> expected = {2, 20, 6, 60, 9, 90};
+        check(std::vector<float>(reduced.begin(), reduced.end()) == expected,
+              "downsample: pairs averaged, odd last frame kept");
+    }
+}
+
+int main() {
+    testExactExcerpt();
+    testAgainstReference();
+    testRefinement();
+    testBand();
+    testDownsample();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All DTW engine checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file test_dtw_sync.cpp
+ * @brief DTW finds a short reference window inside a longer search window
+ */
+
+#include "audio_sync.h"
+#include "feature_extractor.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr double SAMPLE_RATE = 44100.0;
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double TOLERANCE_SECONDS = 2.0 * 512 / SAMPLE_RATE;    // Two MFCC hops
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAIL: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    // Syllable-like tone bursts with varying pitch and timbre, plus noise bursts
+    std::vector<float> makeProgramme(double seconds, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::normal_distribution<float> gaussian(0.0f, 1.0f);
+        std::vector<float> audio(static_cast<size_t>(seconds * SAMPLE_RATE), 0.0f);
+
+        double time = 0.1;
+        while (time < seconds - 1.0) {
+            const size_t first = static_cast<size_t>(time * SAMPLE_RATE);
+            const double length = 0.1 + 0.3 * uniform(rng);
+            const size_t count = static_cast<size_t>(length * SAMPLE_RATE);
+            const double amplitude = 0.05 + 0.2 * uniform(rng);
+            if (uniform(rng) < 0.25) {
+                for (size_t n = 0; n < count; ++n) {
+                    audio[first + n] += static_cast<float>(amplitude * 0.5) * gaussian(rng);
+                }
+            } else {
+                const double f0 = 90.0 + 250.0 * uniform(rng);
+                const int harmonics = 2 + static_cast<int>(10 * uniform(rng));
+                double phase = 0.0;
+                for (size_t n = 0; n < count; ++n) {
+                    phase += 2.0 * PI * f0 / SAMPLE_RATE;
+                    double value = 0.0;
+                    for (int h = 1; h <= harmonics; ++h) value += std::sin(h * phase) / h;
+                    const double envelope = std::sin(PI * static_cast<double>(n) / count);
+                    audio[first + n] += static_cast<float>(amplitude * envelope * value);
+                }
+            }
+            time += length + 0.05 + 0.3 * uniform(rng);
+        }
+        return audio;
+    }
+
+    AudioFeatures extractWindow(const std::vector<float>& audio, double start, double duration,
+                                float noiseLevel, unsigned seed, size_t hop = 512) {
+        std::mt19937 rng(seed);
+        std::normal_distribution<float> gaussian(0.0f, noiseLevel);
+        const size_t first = static_cast<size_t>(start * SAMPLE_RATE);
+        const size_t count = static_cast<size_t>(duration * SAMPLE_RATE);
+        std::vector<float> window(audio.begin() + first, audio.begin() + first + count);
+        for (float& sample : window) sample += gaussian(rng);
+
+        FeatureExtractor extractor(2048, hop);
+        AudioFeatures features;
+        extractor.extract(window, SAMPLE_RATE, features);
+        return features;
+    }
+
+    // The reference starts referenceStart seconds into the programme, the
+    // search window searchStart seconds: DTW must report their difference
+    void checkOffset(const std::vector<float>& programme, double referenceStart, double referenceLength,
+                     double searchStart, double searchLength, const std::string& name) {
+        const AudioFeatures reference = extractWindow(programme, referenceStart, referenceLength, 0.002f, 1);
+        const AudioFeatures search = extractWindow(programme, searchStart, searchLength, 0.002f, 2);
+
+        DTWSync dtw;
+        const SyncResult result = dtw.synchronize(reference, search);
+        const double expected = referenceStart - searchStart;
+        std::cout << name << ": offset " << result.offset << " s (expected " << expected
+                  << "), confidence " << result.confidence << std::endl;
+        check(std::abs(result.offset - expected) <= TOLERANCE_SECONDS, name + ": offset within two hops");
+        check(result.confidence >= 0.5f, name + ": confident on matching material");
+    }
+
+    // A reference from different material must not look like a match
+    void checkUnrelated(const std::vector<float>& programme) {
+        const std::vector<float> other = makeProgramme(60.0, 99);
+        const AudioFeatures reference = extractWindow(other, 20.0, 20.0, 0.002f, 1);
+        const AudioFeatures search = extractWindow(programme, 5.0, 50.0, 0.002f, 2);
+
+        DTWSync dtw;
+        const SyncResult result = dtw.synchronize(reference, search);
+        std::cout << "unrelated material: confidence " << result.confidence << std::endl;
+        check(result.confidence < 0.3f, "unrelated material: low confidence");
+    }
+
+    // The offset follows the hop the features were extracted with; mixed hops are rejected
+    void checkHop(const std::vector<float>& programme) {
+        const AudioFeatures reference = extractWindow(programme, 30.0, 20.0, 0.002f, 1, 256);
+        const AudioFeatures search = extractWindow(programme, 22.0, 50.0, 0.002f, 2, 256);
+
+        DTWSync dtw;
+        const SyncResult result = dtw.synchronize(reference, search);
+        std::cout << "hop 256: offset " << result.offset << " s (expected 8)" << std::endl;
+        check(std::abs(result.offset - 8.0) <= TOLERANCE_SECONDS, "hop 256: offset within two hops");
+
+        const AudioFeatures mismatched = extractWindow(programme, 22.0, 50.0, 0.002f, 2, 512);
+        check(dtw.synchronize(reference, mismatched).confidence == 0.0f, "mismatched hops: no result");
+    }
+}
+
+int main() {
+    const std::vector<float> programme = makeProgramme(80.0, 42);
+
+    // 20 s reference inside a 50 s search window, content later and earlier than nominal
+    checkOffset(programme, 30.0, 20.0, 5.0, 50.0, "late start");
+    checkOffset(programme, 30.0, 20.0, 22.0, 50.0, "early start");
+
+    // Equally long windows, as used when no analysis window could be selected
+    checkOffset(programme, 10.0, 40.0, 14.5, 40.0, "equal windows, audio 2 ahead");
+    checkOffset(programme, 14.5, 40.0, 10.0, 40.0, "equal windows, audio 2 behind");
+
+    checkUnrelated(programme);
+    checkHop(programme);
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All DTW sync checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file test_fft.cpp
+ * @brief Real FFT and unnormalized inverse against a direct DFT
+ */
+
+#include "fft_processor.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAIL: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    // Float rounding grows with the transform length; a wrong bin is off by O(1)
+    double tolerance(size_t size) {
+        return 1e-5 * static_cast<double>(size) + 1e-5;
+    }
+
+    std::vector<std::complex<double>> referenceForward(const std::vector<float>& input) {
+        const size_t size = input.size();
+        std::vector<std::complex<double>> output(size / 2 + 1);
+        for (size_t k = 0; k <= size / 2; ++k) {
+            for (size_t n = 0; n < size; ++n) {
+                const double angle = -2.0 * PI * static_cast<double>((k * n) % size) / size;
+                output[k] += static_cast<double>(input[n]) * std::polar(1.0, angle);
+            }
+        }
+        return output;
+    }
+
+    // Unnormalized c2r: DC and Nyquist once, every other bin with its conjugate mirror
+    std::vector<double> referenceInverse(const std::vector<std::complex<float>>& input, size_t size) {
+        std::vector<double> output(size, 0.0);
+        for (size_t n = 0; n < size; ++n) {
+            for (size_t k = 0; k <= size / 2; ++k) {
+                const double angle = 2.0 * PI * static_cast<double>((k * n) % size) / size;
+                const double weight = (k == 0 || 2 * k == size) ? 1.0 : 2.0;
+                output[n] += weight * (std::complex<double>(input[k]) * std::polar(1.0, angle)).real();
+            }
+        }
+        return output;
+    }
+
+    std::vector<float> randomSignal(size_t size, std::mt19937& rng) {
+        std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+        std::vector<float> signal(size);
+        for (float& value : signal) value = uniform(rng);
+        return signal;
+    }
+
+    // Spectrum of a real signal: DC and Nyquist bins are purely real
+    std::vector<std::complex<float>> randomSpectrum(size_t size, std::mt19937& rng) {
+        std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+        std::vector<std::complex<float>> spectrum(size / 2 + 1);
+        for (size_t k = 0; k < spectrum.size(); ++k) {
+            const bool real = k == 0 || 2 * k == size;
+            spectrum[k] = {uniform(rng), real ? 0.0f : uniform(rng)};
+        }
+        return spectrum;
+    }
+
+    double maxError(const std::vector<std::complex<float>>& actual, const std::vector<std::complex<double>>& expected) {
+        double error = 0.0;
+        for (size_t k = 0; k < expected.size(); ++k) {
+            error = std::max(error, std::abs(std::complex<double>(actual[k]) - expected[k]));
+        }
+        return error;
+    }
+
+    double maxError(std::span<const float> actual, const std::vector<double>& expected, double scale = 1.0) {
+        double error = 0.0;
+        for (size_t n = 0; n < expected.size(); ++n) {
+            error = std::max(error, std::abs(actual[n] - scale * expected[n]));
+        }
+        return error;
+    }
+
+    void testSize(size_t size, std::mt19937& rng) {
+        const std::string name = "size " + std::to_string(size);
+        fftw::FFTProcessor fft(size);
+        const size_t bins = fft.getSpectrumSize();
+
+        // Forward, through the vector and span overloads
+        const std::vector<float> signal = randomSignal(size, rng);
+        const auto expectedSpectrum = referenceForward(signal);
+        std::vector<std::complex<float>> spectrum;
+        fft.forward(signal, spectrum);
+        check(spectrum.size() == bins, name + ": forward yields size/2 + 1 bins");
+        check(maxError(spectrum, expectedSpectrum) <= tolerance(size), name + ": forward matches the DFT");
+
+        // Unaligned caller memory takes the staging path
+        std::vector<float> shiftedSignal(size + 1);
+        std::copy(signal.begin(), signal.end(), shiftedSignal.begin() + 1);
+        std::vector<std::complex<float>> shiftedSpectrum(bins + 1);
+        fft.forward(std::span<const float>(shiftedSignal.data() + 1, size),
+                    std::span<std::complex<float>>(shiftedSpectrum.data() + 1, bins));
+        check(maxError(std::vector<std::complex<float>>(shiftedSpectrum.begin() + 1, shiftedSpectrum.end()),
+                       expectedSpectrum) <= tolerance(size), name + ": unaligned forward matches the DFT");
+
+        // Inverse of an arbitrary Hermitian spectrum, including the Nyquist bin
+        const std::vector<std::complex<float>> input = randomSpectrum(size, rng);
+        const std::vector<double> expectedSignal = referenceInverse(input, size);
+        std::vector<std::complex<float>> scratch = input;
+        std::vector<float> output(size);
+        fft.inverse(std::span<std::complex<float>>(scratch), std::span<float>(output));
+        check(maxError(output, expectedSignal) <= tolerance(size), name + ": inverse matches the DFT");
+
+        std::vector<float> normalized;
+        fft.inverse(input, normalized);
+        check(normalized.size() == size && maxError(normalized, expectedSignal, 1.0 / size) <= tolerance(size) / size,
+              name + ": vector inverse is normalized");
+
+        // In-place transforms on an odd float offset
+        std::vector<float> inPlace(2 * bins + 1, 0.0f);
+        std::copy(signal.begin(), signal.end(), inPlace.begin() + 1);
+        fft.forwardInPlace(std::span<float>(inPlace.data() + 1, 2 * bins));
+        std::vector<std::complex<float>> inPlaceSpectrum(bins);
+        for (size_t k = 0; k < bins; ++k) inPlaceSpectrum[k] = {inPlace[1 + 2 * k], inPlace[2 + 2 * k]};
+        check(maxError(inPlaceSpectrum, expectedSpectrum) <= tolerance(size), name + ": in-place forward matches the DFT");
+
+        // Round trip: the unnormalized inverse returns size times the signal; two
+        // chained transforms accumulate rounding from both
+        const double roundTripTolerance = 4.0 * tolerance(size);
+        std::copy(spectrum.begin(), spectrum.end(), scratch.begin());
+        fft.inverse(std::span<std::complex<float>>(scratch), std::span<float>(output));
+        std::vector<double> scaled(signal.begin(), signal.end());
+        check(maxError(output, scaled, static_cast<double>(size)) <= roundTripTolerance, name + ": round trip is scaled by N");
+
+        std::vector<std::complex<float>> inPlaceInverse(spectrum.begin(), spectrum.end());
+        fft.inverseInPlace(std::span<std::complex<float>>(inPlaceInverse));
+        const float* samples = reinterpret_cast<const float*>(inPlaceInverse.data());
+        check(maxError(std::span<const float>(samples, size), scaled, static_cast<double>(size)) <= roundTripTolerance,
+              name + ": in-place round trip is scaled by N");
+    }
+}
+
+int main() {
+    std::mt19937 rng(7);
+
+    // Size 2 is the degenerate case with a single complex point (half == 1)
+    for (size_t size = 2; size <= 4096; size *= 2) {
+        testSize(size, rng);
+    }
+
+    // Sizes the radix-2 path does not handle use the direct transform
+    for (size_t size : {size_t(6), size_t(12), size_t(100)}) {
+        testSize(size, rng);
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All FFT checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
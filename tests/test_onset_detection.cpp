@@ -0,0 +1,182 @@
+/**
+ * @file test_onset_detection.cpp
+ * @brief Onsets are found on claps and speech at realistic recording levels
+ */
+
+#include "audio_sync.h"
+#include "feature_extractor.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr double SAMPLE_RATE = 44100.0;
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double NOISE_FLOOR_DBFS = -60.0;
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAIL: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    double fromDb(double db) {
+        return std::pow(10.0, db / 20.0);
+    }
+
+    std::vector<float> noiseFloor(size_t length, std::mt19937& rng) {
+        std::normal_distribution<float> gaussian(0.0f, static_cast<float>(fromDb(NOISE_FLOOR_DBFS)));
+        std::vector<float> audio(length);
+        for (float& sample : audio) sample = gaussian(rng);
+        return audio;
+    }
+
+    // Scale the non-silent part of the signal to the given RMS level
+    void normalizeActive(std::vector<float>& audio, const std::vector<float>& floor, double dbfs) {
+        double sum = 0.0;
+        size_t active = 0;
+        for (size_t n = 0; n < audio.size(); ++n) {
+            const double signal = audio[n] - floor[n];
+            if (std::abs(signal) > 1e-6) {
+                sum += signal * signal;
+                active++;
+            }
+        }
+        const double scale = active > 0 ? fromDb(dbfs) / std::sqrt(sum / active) : 1.0;
+        for (size_t n = 0; n < audio.size(); ++n) {
+            audio[n] = static_cast<float>(floor[n] + (audio[n] - floor[n]) * scale);
+        }
+    }
+
+    std::vector<size_t> detect(const std::vector<float>& audio) {
+        FeatureExtractor extractor;
+        AudioFeatures features;
+        extractor.extract(audio, SAMPLE_RATE, features);
+        return features.onsets;
+    }
+
+    // Every expected onset has a detection within the tolerance, and nothing else was detected
+    void checkMatches(const std::vector<size_t>& detected, const std::vector<size_t>& expected,
+                      size_t tolerance, size_t allowedExtra, const std::string& name) {
+        size_t matched = 0;
+        for (size_t truth : expected) {
+            for (size_t onset : detected) {
+                const size_t distance = onset > truth ? onset - truth : truth - onset;
+                if (distance <= tolerance) {
+                    matched++;
+                    break;
+                }
+            }
+        }
+        std::cout << name << ": " << detected.size() << " onsets detected, " << matched << "/"
+                  << expected.size() << " expected matched" << std::endl;
+        check(matched == expected.size(), name + ": every expected onset is detected");
+        check(detected.size() <= expected.size() + allowedExtra, name + ": no burst of false onsets");
+    }
+
+    // Hand claps (4 ms decaying noise bursts) every 0.8 s at about -20 dBFS
+    void testClaps() {
+        std::mt19937 rng(7);
+        std::normal_distribution<float> gaussian(0.0f, 1.0f);
+        const size_t length = static_cast<size_t>(10.0 * SAMPLE_RATE);
+        const std::vector<float> floor = noiseFloor(length, rng);
+        std::vector<float> audio = floor;
+
+        std::vector<size_t> expected;
+        for (double time = 0.5; time < 9.5; time += 0.8) {
+            const size_t at = static_cast<size_t>(time * SAMPLE_RATE);
+            for (size_t n = 0; n < static_cast<size_t>(0.05 * SAMPLE_RATE); ++n) {
+                audio[at + n] += static_cast<float>(std::exp(-static_cast<double>(n) / (0.004 * SAMPLE_RATE))) * gaussian(rng);
+            }
+            expected.push_back(at);
+        }
+        normalizeActive(audio, floor, -20.0);
+
+        checkMatches(detect(audio), expected, 2 * 512, 0, "claps at -20 dBFS");
+    }
+
+    // Voiced syllables with a fast attack and phrase pauses at -20 and -35 dBFS
+    void testSpeech(double dbfs) {
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        const size_t length = static_cast<size_t>(20.0 * SAMPLE_RATE);
+        const std::vector<float> floor = noiseFloor(length, rng);
+        std::vector<float> audio = floor;
+
+        std::vector<size_t> expected;
+        double time = 0.3;
+        while (time < 19.0) {
+            const double syllable = 0.12 + 0.15 * uniform(rng);
+            const double f0 = 100.0 + 120.0 * uniform(rng);
+            const double amplitude = 0.5 + 0.5 * uniform(rng);
+            const size_t first = static_cast<size_t>(time * SAMPLE_RATE);
+            const size_t count = static_cast<size_t>(syllable * SAMPLE_RATE);
+            const size_t attack = static_cast<size_t>(0.01 * SAMPLE_RATE);
+            double phase = 0.0;
+            for (size_t n = 0; n < count; ++n) {
+                phase += 2.0 * PI * f0 / SAMPLE_RATE;
+                double value = 0.0;
+                for (int h = 1; h <= 6; ++h) value += std::sin(h * phase) / h;
+                const double envelope = n < attack ? static_cast<double>(n) / attack
+                                                   : std::exp(-3.0 * static_cast<double>(n - attack) / count);
+                audio[first + n] += static_cast<float>(amplitude * envelope * value);
+            }
+            expected.push_back(first);
+            // Gaps between syllables, longer pauses between phrases
+            time += syllable + (uniform(rng) < 0.2 ? 0.5 : 0.08 + 0.12 * uniform(rng));
+        }
+        normalizeActive(audio, floor, dbfs);
+
+        const std::string name = "speech at " + std::to_string(static_cast<int>(dbfs)) + " dBFS";
+        checkMatches(detect(audio), expected, 2 * 512, expected.size() / 10, name);
+    }
+
+    // Steady noise without events must not produce onsets
+    void testSteadyNoise() {
+        std::mt19937 rng(3);
+        std::normal_distribution<float> gaussian(0.0f, static_cast<float>(fromDb(-25.0)));
+        std::vector<float> audio(static_cast<size_t>(10.0 * SAMPLE_RATE));
+        for (float& sample : audio) sample = gaussian(rng);
+
+        const auto detected = detect(audio);
+        std::cout << "steady noise: " << detected.size() << " onsets detected" << std::endl;
+        check(detected.size() <= 1, "steady noise yields no onsets");
+    }
+
+    // Onsets do not depend on the recording level
+    void testLevelIndependence() {
+        std::mt19937 rng(5);
+        std::normal_distribution<float> gaussian(0.0f, 1.0f);
+        std::vector<float> loud(static_cast<size_t>(6.0 * SAMPLE_RATE), 0.0f);
+        for (double time = 0.4; time < 5.5; time += 0.7) {
+            const size_t at = static_cast<size_t>(time * SAMPLE_RATE);
+            for (size_t n = 0; n < static_cast<size_t>(0.05 * SAMPLE_RATE); ++n) {
+                loud[at + n] += static_cast<float>(0.5 * std::exp(-static_cast<double>(n) / (0.004 * SAMPLE_RATE))) * gaussian(rng);
+            }
+        }
+        std::vector<float> quiet = loud;
+        for (float& sample : quiet) sample *= static_cast<float>(fromDb(-24.0));
+
+        check(detect(loud) == detect(quiet), "a 24 dB gain change leaves the onsets unchanged");
+    }
+}
+
+int main() {
+    testClaps();
+    testSpeech(-20.0);
+    testSpeech(-35.0);
+    testSteadyNoise();
+    testLevelIndependence();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All onset detection checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file test_simd_kernels.cpp
+ * @brief Every SIMD kernel variant the CPU supports against the scalar reference
+ */
+
+#include "simd_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr size_t MAX_LENGTH = 40;     // Covers every vector width and its tails several times over
+    constexpr size_t MAX_OFFSET = 3;      // Element offsets from the allocation, so loads are unaligned
+    constexpr float SENTINEL = 12345.0f;  // Marks output past the end that a kernel must not touch
+    constexpr size_t GUARD_LENGTH = 16;   // One AVX-512 vector of poisoned input after the last element
+    constexpr float TOLERANCE = 1e-5f;    // Relative, for sums the variants reassociate
+
+    int failures = 0;
+
+    void check(bool condition, const std::string& message) {
+        if (!condition) {
+            std::cerr << "FAIL: " << message << std::endl;
+            failures++;
+        }
+    }
+
+    bool close(double actual, double expected, double magnitude) {
+        return std::abs(actual - expected) <= TOLERANCE * std::max(1.0, magnitude);
+    }
+
+    // Values of both signs with exact and negative zeros, so sign tests hit every case
+    std::vector<float> randomFloats(size_t count, std::mt19937& rng) {
+        std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+        std::uniform_int_distribution<int> pick(0, 7);
+        std::vector<float> values(count);
+        for (float& value : values) {
+            const int kind = pick(rng);
+            value = kind == 0 ? 0.0f : kind == 1 ? -0.0f : uniform(rng);
+        }
+        return values;
+    }
+
+    // NaN past the end, so a tail that reads beyond n poisons the result
+    std::vector<float> guarded(std::vector<float> values) {
+        values.insert(values.end(), GUARD_LENGTH, std::numeric_limits<float>::quiet_NaN());
+        return values;
+    }
+
+    std::vector<uint8_t> randomBytes(size_t count, std::mt19937& rng) {
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::vector<uint8_t> bytes(count);
+        for (uint8_t& value : bytes) value = static_cast<uint8_t>(byte(rng));
+        return bytes;
+    }
+
+    void testReductions(const simd::KernelTable& table, const simd::KernelTable& reference,
+                        size_t n, size_t offset, std::mt19937& rng, const std::string& name) {
+        const std::vector<float> a = guarded(randomFloats(n + offset, rng));
+        const std::vector<float> b = guarded(randomFloats(n + offset, rng));
+        const float* x = a.data() + offset;
+        const float* y = b.data() + offset;
+
+        double squares = 0.0, products = 0.0, distances = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            squares += x[i] * x[i];
+            products += std::abs(x[i] * y[i]);
+            distances += (x[i] - y[i]) * (x[i] - y[i]);
+        }
+
+        check(close(table.sumSquares(x, n), reference.sumSquares(x, n), squares), name + ": sumSquares");
+        check(table.zeroCrossings(x, n) == reference.zeroCrossings(x, n), name + ": zeroCrossings");
+        check(close(table.dot(x, y, n), reference.dot(x, y, n), products), name + ": dot");
+        check(close(table.squaredDistance(x, y, n), reference.squaredDistance(x, y, n), distances),
+              name + ": squaredDistance");
+    }
+
+    // Both conjugate products, with a sentinel after the last output bin
+    void testSpectral(const simd::KernelTable& table, const simd::KernelTable& reference,
+                      size_t n, size_t offset, std::mt19937& rng, const std::string& name) {
+        // Offsets count floats, so odd ones leave the complex values misaligned too
+        const std::vector<float> a = guarded(randomFloats(2 * n + offset, rng));
+        const std::vector<float> b = guarded(randomFloats(2 * n + offset, rng));
+        const std::vector<float> initial = randomFloats(2 * n + offset, rng);
+        const auto* x = reinterpret_cast<const std::complex<float>*>(a.data() + offset);
+        const auto* y = reinterpret_cast<const std::complex<float>*>(b.data() + offset);
+        const float scale = 0.37f;
+
+        for (bool accumulate : {false, true}) {
+            std::vector<float> actual(initial);
+            std::vector<float> expected(initial);
+            actual.insert(actual.end(), 2, SENTINEL);
+            auto* out = reinterpret_cast<std::complex<float>*>(actual.data() + offset);
+            auto* ref = reinterpret_cast<std::complex<float>*>(expected.data() + offset);
+            if (accumulate) {
+                table.conjugateMultiplyAccumulate(x, y, out, n, scale);
+                reference.conjugateMultiplyAccumulate(x, y, ref, n, scale);
+            } else {
+                table.conjugateMultiply(x, y, out, n, scale);
+                reference.conjugateMultiply(x, y, ref, n, scale);
+            }
+
+            bool matches = true;
+            for (size_t k = 0; k < n; ++k) {
+                const double magnitude = std::abs(x[k]) * std::abs(y[k]) * scale + std::abs(ref[k]);
+                matches = matches && close(out[k].real(), ref[k].real(), magnitude) &&
+                          close(out[k].imag(), ref[k].imag(), magnitude);
+            }
+            const std::string kernel = accumulate ? "conjugateMultiplyAccumulate" : "conjugateMultiply";
+            check(matches, name + ": " + kernel);
+            check(actual[actual.size() - 2] == SENTINEL && actual.back() == SENTINEL,
+                  name + ": " + kernel + " stays within n bins");
+        }
+    }
+
+    void testConversions(const simd::KernelTable& table, const simd::KernelTable& reference,
+                         size_t n, size_t offset, std::mt19937& rng, const std::string& name) {
+        struct Conversion {
+            const char* kernel;
+            void (*simd::KernelTable::*function)(const uint8_t*, float*, size_t, float);
+            size_t bytes;
+            float scale;
+        };
+        const Conversion conversions[] = {
+            {"convertPcm16", &simd::KernelTable::convertPcm16, 2, 1.0f / 32768.0f},
+            {"convertPcm24", &simd::KernelTable::convertPcm24, 3, 1.0f / 8388608.0f},
+            {"convertPcm32", &simd::KernelTable::convertPcm32, 4, 1.0f / 2147483648.0f},
+        };
+
+        for (const Conversion& conversion : conversions) {
+            // Byte offsets, so multi-byte samples straddle alignment boundaries
+            const std::vector<uint8_t> input = randomBytes(n * conversion.bytes + offset, rng);
+            std::vector<float> actual(n + offset + 1, SENTINEL);
+            std::vector<float> expected(n + offset + 1, SENTINEL);
+            (table.*conversion.function)(input.data() + offset, actual.data() + offset, n, conversion.scale);
+            (reference.*conversion.function)(input.data() + offset, expected.data() + offset, n, conversion.scale);
+
+            bool matches = true;
+            for (size_t i = 0; i < n; ++i) {
+                matches = matches && close(actual[offset + i], expected[offset + i], 0.0);
+            }
+            check(matches, name + ": " + conversion.kernel);
+            check(actual.back() == SENTINEL, name + ": " + conversion.kernel + " stays within n samples");
+        }
+    }
+
+    void testTable(const simd::KernelTable& table, std::mt19937& rng) {
+        const simd::KernelTable& reference = simd::scalarKernels();
+        for (size_t n = 0; n <= MAX_LENGTH; ++n) {
+            for (size_t offset = 0; offset <= MAX_OFFSET; ++offset) {
+                const std::string name = std::string(table.name) + " length " + std::to_string(n) +
+                                         " offset " + std::to_string(offset);
+                testReductions(table, reference, n, offset, rng, name);
+                testSpectral(table, reference, n, offset, rng, name);
+                testConversions(table, reference, n, offset, rng, name);
+            }
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(11);
+
+    // The dispatched table, then every variant this CPU can run
+    std::cout << "active kernels: " << simd::activeKernelName() << std::endl;
+    testTable(simd::kernels(), rng);
+    for (const char* name : {"avx2", "avx512", "neon"}) {
+        const simd::KernelTable* table = simd::kernelsNamed(name);
+        if (!table) {
+            std::cout << name << ": not supported, skipped" << std::endl;
+            continue;
+        }
+        testTable(*table, rng);
+    }
+
+    check(simd::kernelsNamed("scalar") == &simd::scalarKernels(), "scalar kernels by name");
+    check(simd::kernelsNamed("sse9") == nullptr, "unknown kernel name");
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All SIMD kernel checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}